@@ -0,0 +1,262 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+// Replays a trace of dhash_ptr operations recorded with
+// MCXX_DHASH_PTR_TRACE (see dhash_ptr.h) with the current open addressing
+// table and with the former separate chaining one and reports both times.
+// Both the traces and this program need --enable-dhash-ptr-trace
+//
+//   MCXX_DHASH_PTR_TRACE=lookups.trace mcxx -c file.cpp
+//   benchmarks/dhash_ptr/dhash_ptr_bench lookups.trace [repetitions]
+//
+// Keys are the original pointers, they are hashed but never dereferenced
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dhash_ptr.h"
+#include "dhash_ptr_chained.h"
+#include "mem.h"
+
+typedef
+struct trace_op_tag
+{
+    char op;
+    uint32_t table;
+    uintptr_t arg;
+} trace_op_t;
+
+typedef
+struct trace_tag
+{
+    int num_ops;
+    trace_op_t* ops;
+    uint32_t num_tables;
+    int num_queries;
+    int num_inserts;
+    int num_removes;
+} trace_t;
+
+static void read_trace(const char* filename, trace_t* trace)
+{
+    FILE* f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(trace, 0, sizeof(*trace));
+    int size_ops = 1024;
+    trace->ops = NEW_VEC(trace_op_t, size_ops);
+
+    char op;
+    uint32_t table;
+    uintptr_t arg;
+    while (fscanf(f, " %c %" SCNu32 " %" SCNxPTR, &op, &table, &arg) == 3)
+    {
+        if (trace->num_ops == size_ops)
+        {
+            size_ops *= 2;
+            trace->ops = NEW_REALLOC(trace_op_t, trace->ops, size_ops);
+        }
+        trace->ops[trace->num_ops].op = op;
+        trace->ops[trace->num_ops].table = table;
+        trace->ops[trace->num_ops].arg = arg;
+        trace->num_ops++;
+
+        if (table >= trace->num_tables)
+            trace->num_tables = table + 1;
+
+        switch (op)
+        {
+            case 'q': trace->num_queries++; break;
+            case 'i': trace->num_inserts++; break;
+            case 'r': trace->num_removes++; break;
+            default: break;
+        }
+    }
+
+    fclose(f);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Returns the elapsed time. The checksum of the queried values is used to
+// check both tables behave the same
+static double replay_open_addressing(trace_t* trace, uintptr_t *checksum)
+{
+    dhash_ptr_t** tables = NEW_VEC0(dhash_ptr_t*, trace->num_tables);
+    uintptr_t sum = 0;
+
+    double start = now();
+    int i;
+    for (i = 0; i < trace->num_ops; i++)
+    {
+        trace_op_t* op = &trace->ops[i];
+        switch (op->op)
+        {
+            case 'n':
+                tables[op->table] = dhash_ptr_new((int)op->arg);
+                break;
+            case 'd':
+                dhash_ptr_destroy(tables[op->table]);
+                tables[op->table] = NULL;
+                break;
+            case 'i':
+                dhash_ptr_insert(tables[op->table], (const char*)op->arg, (void*)op->arg);
+                break;
+            case 'q':
+                sum += (uintptr_t)dhash_ptr_query(tables[op->table], (const char*)op->arg);
+                break;
+            case 'r':
+                dhash_ptr_remove(tables[op->table], (const char*)op->arg);
+                break;
+            case 's':
+                dhash_ptr_reserve(tables[op->table], (int)op->arg);
+                break;
+            default:
+                break;
+        }
+    }
+    for (i = 0; i < (int)trace->num_tables; i++)
+    {
+        if (tables[i] != NULL)
+            dhash_ptr_destroy(tables[i]);
+    }
+    double elapsed = now() - start;
+
+    DELETE(tables);
+    *checksum = sum;
+    return elapsed;
+}
+
+static double replay_chained(trace_t* trace, uintptr_t *checksum)
+{
+    chained_dhash_ptr_t** tables = NEW_VEC0(chained_dhash_ptr_t*, trace->num_tables);
+    uintptr_t sum = 0;
+
+    double start = now();
+    int i;
+    for (i = 0; i < trace->num_ops; i++)
+    {
+        trace_op_t* op = &trace->ops[i];
+        switch (op->op)
+        {
+            case 'n':
+                tables[op->table] = chained_dhash_ptr_new((int)op->arg);
+                break;
+            case 'd':
+                chained_dhash_ptr_destroy(tables[op->table]);
+                tables[op->table] = NULL;
+                break;
+            case 'i':
+                chained_dhash_ptr_insert(tables[op->table], (const char*)op->arg, (void*)op->arg);
+                break;
+            case 'q':
+                sum += (uintptr_t)chained_dhash_ptr_query(tables[op->table], (const char*)op->arg);
+                break;
+            case 'r':
+                chained_dhash_ptr_remove(tables[op->table], (const char*)op->arg);
+                break;
+            default:
+                // The chained table cannot reserve
+                break;
+        }
+    }
+    for (i = 0; i < (int)trace->num_tables; i++)
+    {
+        if (tables[i] != NULL)
+            chained_dhash_ptr_destroy(tables[i]);
+    }
+    double elapsed = now() - start;
+
+    DELETE(tables);
+    *checksum = sum;
+    return elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s trace-file [repetitions]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int repetitions = 5;
+    if (argc > 2)
+        repetitions = atoi(argv[2]);
+    if (repetitions <= 0)
+        repetitions = 1;
+
+    trace_t trace;
+    read_trace(argv[1], &trace);
+
+    fprintf(stdout, "%d operations on %" PRIu32 " tables: %d queries, %d inserts, %d removes\n",
+            trace.num_ops, trace.num_tables,
+            trace.num_queries, trace.num_inserts, trace.num_removes);
+
+    // Keep the best of every repetition
+    double best_chained = 0, best_open_addressing = 0;
+    uintptr_t checksum_chained = 0, checksum_open_addressing = 0;
+    int i;
+    for (i = 0; i < repetitions; i++)
+    {
+        double t = replay_chained(&trace, &checksum_chained);
+        if (i == 0 || t < best_chained)
+            best_chained = t;
+
+        t = replay_open_addressing(&trace, &checksum_open_addressing);
+        if (i == 0 || t < best_open_addressing)
+            best_open_addressing = t;
+    }
+
+    if (checksum_chained != checksum_open_addressing)
+    {
+        fprintf(stderr, "error: both tables answered the queries differently\n");
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stdout, "separate chaining: %.4f s\n", best_chained);
+    fprintf(stdout, "open addressing:   %.4f s\n", best_open_addressing);
+    if (best_open_addressing > 0)
+    {
+        fprintf(stdout, "speedup:           %.2fx\n", best_chained / best_open_addressing);
+    }
+
+    DELETE(trace.ops);
+    return EXIT_SUCCESS;
+}
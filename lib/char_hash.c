@@ -22,30 +22,47 @@
   not, write to the Free Software Foundation, Inc., 675 Mass Ave,
   Cambridge, MA 02139, USA.
   --------------------------------------------------------------------*/
-
-
-
 #include "uniquestr.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <limits.h>
 #include <string.h>
-#include <math.h>
 
 #include "mem.h"
 
-typedef struct string_link_tag string_link_t;
-
-struct string_link_tag
+// Open addressing table (linear probing) of unique strings. Strings are
+// never removed so no tombstones are required
+typedef struct string_entry_tag
 {
-    unsigned int hash;
+    uint32_t hash;
+    uint32_t length;
     const char *string;
-    string_link_t *next;
+} string_entry_t;
+
+enum
+{
+    // Must be a power of two
+    INITIAL_TABLE_SIZE = 16384,
+    // Payload of each of the chunks where strings are stored
+    STRING_CHUNK_SIZE = 64 * 1024,
+};
+
+static string_entry_t *hash_table = NULL;
+static uint32_t hash_table_size = 0;
+static uint32_t number_of_strings = 0;
+
+typedef struct string_chunk_tag string_chunk_t;
+struct string_chunk_tag
+{
+    string_chunk_t *next;
+    char data[];
 };
 
-enum { HASH_LENGTH = 76003 };
+static string_chunk_t *string_chunks = NULL;
+static char *chunk_top = NULL;
+static char *chunk_end = NULL;
 
-static string_link_t *hash_table[HASH_LENGTH];
 static unsigned long long int bytes_used = 0;
 
 unsigned long long int char_trie_used_memory(void)
@@ -53,113 +70,180 @@ unsigned long long int char_trie_used_memory(void)
     return bytes_used;
 }
 
-static unsigned int hash_string(const char *string)
+static inline uint64_t read_word(const char *p)
 {
-    unsigned int hash = 0;
-    const char *p;
-
-    for (p = string; *p; p++)
-        hash = ((hash << 5) + hash) ^ *p;
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
 
-    return hash;
+static inline uint64_t mix_word(uint64_t h, uint64_t w)
+{
+    h ^= w;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 32;
+    return h;
 }
 
-const char *uniquestr(const char *string)
+// Hashes the string a word at a time
+static uint32_t hash_string(const char *string, size_t length)
 {
-    if (string == NULL)
-        return NULL;
+    uint64_t h = UINT64_C(0x9e3779b97f4a7c15) ^ length;
 
-    unsigned int hash = hash_string(string);
-    unsigned int hash_index = hash % (sizeof(hash_table) / sizeof(hash_table[0]));
-    string_link_t *p, *p_prev = 0, *new_link;
+    const char *p = string;
+    size_t remaining = length;
+    while (remaining >= sizeof(uint64_t))
+    {
+        h = mix_word(h, read_word(p));
+        p += sizeof(uint64_t);
+        remaining -= sizeof(uint64_t);
+    }
 
-    for (p = hash_table[hash_index]; p; p_prev = p, p = p->next)
+    if (remaining > 0)
     {
-        if (p->hash == hash && !strcmp(p->string, string))
-        {
-            if (p != hash_table[hash_index])
-            {
-                p_prev->next = p->next;
-                p->next = hash_table[hash_index];
-                hash_table[hash_index] = p;
-            }
-
-            return p->string;
-        }
+        uint64_t w = 0;
+        memcpy(&w, p, remaining);
+        h = mix_word(h, w);
     }
 
-    bytes_used += sizeof(string_link_t) + strlen(string) + 1;
+    // Finalizer of MurmurHash3
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
 
-    new_link = NEW(string_link_t);
-    new_link->string = xstrdup(string); 
-    new_link->hash = hash; 
-    new_link->next = hash_table[hash_index];
-    hash_table[hash_index] = new_link; 
+    return (uint32_t)h;
+}
+
+static const char *store_string(const char *string, size_t length)
+{
+    if ((size_t)(chunk_end - chunk_top) < length + 1)
+    {
+        size_t chunk_size = STRING_CHUNK_SIZE;
+        if (chunk_size < length + 1)
+            chunk_size = length + 1;
 
-    return new_link->string;
+        string_chunk_t *chunk = (string_chunk_t*)xmalloc(sizeof(*chunk) + chunk_size);
+        chunk->next = string_chunks;
+        string_chunks = chunk;
+
+        chunk_top = chunk->data;
+        chunk_end = chunk_top + chunk_size;
+    }
+
+    char *result = chunk_top;
+    memcpy(result, string, length);
+    result[length] = '\0';
+    chunk_top += length + 1;
+
+    return result;
 }
 
-void uniquestr_stats(void)
+static void grow_hash_table(void)
 {
-    unsigned long long bucket_length[HASH_LENGTH];
-    unsigned long long number_of_strings = 0;
-    unsigned long long number_of_bytes = 0;
+    string_entry_t *old_table = hash_table;
+    uint32_t old_size = hash_table_size;
 
-    int i, j;
-    for (i = 0; i < HASH_LENGTH; i++)
-    {
-        string_link_t *p = hash_table[i];
+    hash_table_size = (old_size == 0) ? INITIAL_TABLE_SIZE : old_size * 2;
+    hash_table = NEW_VEC0(string_entry_t, hash_table_size);
 
-        j = 0;
-        while (p != NULL)
-        {
-            // fprintf(stderr, "%d.%d |%s|\n", i, j, p->string);
-            number_of_strings++;
-            number_of_bytes += strlen(p->string) + 1; // +1 for NULL
+    uint32_t mask = hash_table_size - 1;
+    uint32_t i;
+    for (i = 0; i < old_size; i++)
+    {
+        if (old_table[i].string == NULL)
+            continue;
 
-            p = p->next;
-            j++;
-        }
+        uint32_t j = old_table[i].hash & mask;
+        while (hash_table[j].string != NULL)
+            j = (j + 1) & mask;
 
-        bucket_length[i] = j;
+        hash_table[j] = old_table[i];
     }
 
-    unsigned long long max_bucket = 0;
-    unsigned long long min_bucket = ULLONG_MAX;
-    unsigned long long sum_buckets = 0;
-    unsigned long long num_empty_buckets = 0;
+    bytes_used += (unsigned long long)(hash_table_size - old_size) * sizeof(string_entry_t);
 
-    for (i = 0; i < HASH_LENGTH; i++)
-    {
-        if (bucket_length[i] >= max_bucket)
-            max_bucket = bucket_length[i];
-        if (bucket_length[i] <= min_bucket)
-            min_bucket = bucket_length[i];
+    xfree(old_table);
+}
+
+const char *uniquestr_n(const char *string, size_t length)
+{
+    if (string == NULL)
+        return NULL;
+
+    if (length > UINT32_MAX)
+        abort();
 
-        sum_buckets += bucket_length[i];
+    // Keep the load factor below 3/4
+    if (((uint64_t)number_of_strings + 1) * 4 > (uint64_t)hash_table_size * 3)
+        grow_hash_table();
 
-        num_empty_buckets += (bucket_length[i] == 0);
+    uint32_t hash = hash_string(string, length);
+    uint32_t mask = hash_table_size - 1;
+    uint32_t i = hash & mask;
+
+    while (hash_table[i].string != NULL)
+    {
+        if (hash_table[i].hash == hash
+                && hash_table[i].length == length
+                && memcmp(hash_table[i].string, string, length) == 0)
+        {
+            return hash_table[i].string;
+        }
+        i = (i + 1) & mask;
     }
 
-    float avg_bucket = 0.0f;
-    avg_bucket = ((float)sum_buckets / (float)HASH_LENGTH);
+    bytes_used += length + 1;
 
-    float stddev_bucket = 0.0f;
-    for (i = 0; i < HASH_LENGTH; i++)
+    hash_table[i].hash = hash;
+    hash_table[i].length = length;
+    hash_table[i].string = store_string(string, length);
+    number_of_strings++;
+
+    return hash_table[i].string;
+}
+
+const char *uniquestr(const char *string)
+{
+    if (string == NULL)
+        return NULL;
+
+    return uniquestr_n(string, strlen(string));
+}
+
+void uniquestr_stats(void)
+{
+    unsigned long long number_of_bytes = 0;
+    unsigned long long sum_probes = 0;
+    unsigned long long max_probe = 0;
+
+    uint32_t mask = hash_table_size - 1;
+    uint32_t i;
+    for (i = 0; i < hash_table_size; i++)
     {
-        stddev_bucket += fabsf(bucket_length[i] - avg_bucket);
+        if (hash_table[i].string == NULL)
+            continue;
+
+        number_of_bytes += hash_table[i].length + 1; // +1 for NULL
+
+        // Distance from the slot where the string should have been
+        unsigned long long probe = (i - (hash_table[i].hash & mask)) & mask;
+        sum_probes += probe;
+        if (probe > max_probe)
+            max_probe = probe;
     }
-    stddev_bucket = sqrtf(stddev_bucket / (float)(HASH_LENGTH - 1));
+
+    float avg_probe = 0.0f;
+    if (number_of_strings > 0)
+        avg_probe = ((float)sum_probes / (float)number_of_strings);
 
     fprintf(stderr, "String table statistics\n");
     fprintf(stderr, "=======================\n\n");
 
-    fprintf(stderr, "Size of hash: %d\n", HASH_LENGTH);
-    fprintf(stderr, "Number of strings: %llu\n", number_of_strings);
+    fprintf(stderr, "Size of hash: %u\n", hash_table_size);
+    fprintf(stderr, "Number of strings: %u\n", number_of_strings);
     fprintf(stderr, "Number of bytes taken by the strings: %llu\n", number_of_bytes);
-    fprintf(stderr, "Number of empty buckets: %llu\n", num_empty_buckets);
-    fprintf(stderr, "Minimum bucket length: %llu\n", min_bucket);
-    fprintf(stderr, "Maximum bucket length: %llu\n", max_bucket);
-    fprintf(stderr, "Average bucket length: %.2f\n", avg_bucket);
-    fprintf(stderr, "StdDev  bucket length: %.2f\n", stddev_bucket);
+    fprintf(stderr, "Load factor: %.2f\n",
+            hash_table_size == 0 ? 0.0f : (float)number_of_strings / (float)hash_table_size);
+    fprintf(stderr, "Maximum probe length: %llu\n", max_probe);
+    fprintf(stderr, "Average probe length: %.2f\n", avg_probe);
 }
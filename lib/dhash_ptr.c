@@ -26,298 +26,254 @@
 
 
 #include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "dhash_ptr.h"
 #include "mem.h"
 
+// Open addressing with linear probing. Keys are pointers so an empty slot is
+// represented by a NULL key. Removal shifts back the following entries of
+// the cluster so no tombstones are ever left behind
+
 typedef
-struct bucket_ptr_tag
+struct entry_ptr_tag
 {
     const char* key;
     dhash_ptr_info_t info;
-    struct bucket_ptr_tag* next;
-} bucket_ptr_t;
-
-enum { MAX_BUCKET_SIZE = 76003 };
-const static int prime_set[] = { 5, 11, 23, 53, 131, 317, 787, 1951, 4877, 12163, 30403, MAX_BUCKET_SIZE };
-const static int last_prime = (sizeof(prime_set) / sizeof(prime_set[0])) - 1;
-
-#ifdef __GNUC__
-  #if __GNUC__ == 4
-     #if __GNUC_MINOR__ >= 6
-       #define STATIC_INLINE static inline
-     #else
-       // This is a workaround for GCC 4.4 generating wrong code
-       #define STATIC_INLINE static
-     #endif
-  #else
-     #define STATIC_INLINE static inline
-  #endif
-#else
-   #define STATIC_INLINE static inline
-#endif
+} entry_ptr_t;
 
-STATIC_INLINE uint32_t Murmur3_32(const char* ptr);
+enum { MIN_CAPACITY = 8 };
 
 struct dhash_ptr_tag
 {
-    bucket_ptr_t **buckets;
-    int num_buckets_idx;
-    int num_items;
+    entry_ptr_t *entries;
+    // Always a power of two
+    uint32_t capacity;
+    uint32_t num_items;
+#ifdef DHASH_PTR_TRACE
+    uint32_t trace_id;
+#endif
 };
 
-dhash_ptr_t* dhash_ptr_new(int initial_size)
-{
-    if (initial_size < 0) abort();
+#ifdef DHASH_PTR_TRACE
+// See MCXX_DHASH_PTR_TRACE in dhash_ptr.h
+static FILE* trace_file = NULL;
+static uint32_t trace_num_tables = 0;
 
-    dhash_ptr_t* result = NEW(dhash_ptr_t);
+static void trace_init(dhash_ptr_t* dhash)
+{
+    dhash->trace_id = trace_num_tables++;
 
-    result->num_items = 0;
+    static char trace_initialized = 0;
+    if (trace_initialized)
+        return;
+    trace_initialized = 1;
 
-    if (initial_size >= MAX_BUCKET_SIZE)
+    const char* trace_filename = getenv("MCXX_DHASH_PTR_TRACE");
+    if (trace_filename != NULL
+            && trace_filename[0] != '\0')
     {
-        result->num_buckets_idx = last_prime;
+        trace_file = fopen(trace_filename, "w");
     }
-    else
+}
+
+static inline void trace_op(char op, dhash_ptr_t* dhash, uintptr_t arg)
+{
+    if (trace_file != NULL)
     {
-        // Round to next prime
-        result->num_buckets_idx = 0;
-        while (prime_set[result->num_buckets_idx] < initial_size)
-        {
-            result->num_buckets_idx++;
-        }
+        fprintf(trace_file, "%c %" PRIu32 " %" PRIxPTR "\n", op, dhash->trace_id, arg);
     }
-
-    result->buckets = NEW_VEC0(bucket_ptr_t*, prime_set[result->num_buckets_idx]);
-
-    return result;
 }
+#else
+#define trace_init(dhash)
+#define trace_op(op, dhash, arg)
+#endif
 
-static void free_bucket_list(bucket_ptr_t* bucket)
+static inline uint32_t hash_ptr(const char* key)
 {
-    if (bucket == NULL)
-        return;
-
-    free_bucket_list(bucket->next);
-    xfree(bucket);
+    // Finalizer of MurmurHash3, pointers have their low bits always zero and
+    // the high ones mostly equal
+    uint64_t k = (uint64_t)(uintptr_t)key;
+    k ^= k >> 33;
+    k *= UINT64_C(0xff51afd7ed558ccd);
+    k ^= k >> 33;
+
+    return (uint32_t)k;
 }
 
-void dhash_ptr_destroy(dhash_ptr_t* dhash)
+// Keep the load factor below 3/4
+static inline char too_loaded(uint32_t num_items, uint32_t capacity)
 {
-    int num_buckets = prime_set[dhash->num_buckets_idx];
+    return ((uint64_t)num_items * 4) > ((uint64_t)capacity * 3);
+}
 
-    int i;
-    for (i = 0; i < num_buckets; i++)
+static uint32_t capacity_for(uint32_t num_items)
+{
+    uint32_t capacity = MIN_CAPACITY;
+    while (too_loaded(num_items, capacity))
     {
-        free_bucket_list(dhash->buckets[i]);
+        if (capacity > (UINT32_MAX / 2)) abort();
+        capacity *= 2;
     }
 
-    xfree(dhash->buckets);
-    xfree(dhash);
+    return capacity;
 }
 
-void* dhash_ptr_query(dhash_ptr_t* dhash, const char* key)
+dhash_ptr_t* dhash_ptr_new(int initial_size)
 {
-    if (key == NULL) abort();
+    if (initial_size < 0) abort();
 
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-    uint32_t hash = Murmur3_32(key) % num_buckets;
+    dhash_ptr_t* result = NEW(dhash_ptr_t);
 
-    bucket_ptr_t* b = dhash->buckets[hash];
-    while (b != NULL)
-    {
-        if (b->key == key)
-        {
-            return b->info;
-        }
-        b = b->next;
-    }
+    result->num_items = 0;
+    result->capacity = capacity_for(initial_size);
+    result->entries = NEW_VEC0(entry_ptr_t, result->capacity);
 
-    return NULL;
-}
+    trace_init(result);
+    trace_op('n', result, (uintptr_t)initial_size);
 
+    return result;
+}
 
-static void dhash_ptr_do_insert(dhash_ptr_t* dhash, const char* key, dhash_ptr_info_t info)
+void dhash_ptr_destroy(dhash_ptr_t* dhash)
 {
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-    uint32_t hash = Murmur3_32(key) % num_buckets;
+    trace_op('d', dhash, 0);
 
-    bucket_ptr_t* b = dhash->buckets[hash];
+    xfree(dhash->entries);
+    xfree(dhash);
+}
 
-    while (b != NULL)
+// Returns the slot of key or the empty slot where it should be inserted
+static inline uint32_t dhash_ptr_find_slot(dhash_ptr_t* dhash, const char* key)
+{
+    uint32_t mask = dhash->capacity - 1;
+    uint32_t i = hash_ptr(key) & mask;
+
+    while (dhash->entries[i].key != NULL
+            && dhash->entries[i].key != key)
     {
-        if (b->key == key)
-        {
-            // Update
-            b->info = info;
-            return;
-        }
-        b = b->next;
+        i = (i + 1) & mask;
     }
 
-    // Insert
-    b = NEW(bucket_ptr_t);
-    b->key = key;
-    b->info = info;
-    b->next = dhash->buckets[hash];
-    dhash->buckets[hash] = b;
-
-    dhash->num_items++;
+    return i;
 }
 
-static void dhash_ptr_increase_rehash(dhash_ptr_t* dhash)
+void* dhash_ptr_query(dhash_ptr_t* dhash, const char* key)
 {
-    // Do not rehash anymore
-    if (dhash->num_buckets_idx == last_prime)
-        return;
+    if (key == NULL) abort();
+    trace_op('q', dhash, (uintptr_t)key);
 
-    int num_old_buckets = prime_set[dhash->num_buckets_idx];
-    bucket_ptr_t **old_buckets = dhash->buckets;
+    // Note that empty slots have a NULL info
+    return dhash->entries[dhash_ptr_find_slot(dhash, key)].info;
+}
 
-    dhash->num_buckets_idx++;
-    int num_new_buckets = prime_set[dhash->num_buckets_idx];
-    bucket_ptr_t **new_buckets = NEW_VEC0(bucket_ptr_t*, num_new_buckets);
+static void dhash_ptr_rehash(dhash_ptr_t* dhash, uint32_t new_capacity)
+{
+    entry_ptr_t* old_entries = dhash->entries;
+    uint32_t old_capacity = dhash->capacity;
 
-    int i;
-    for (i = 0; i < num_old_buckets; i++)
-    {
-        bucket_ptr_t* old_b = old_buckets[i];
+    dhash->entries = NEW_VEC0(entry_ptr_t, new_capacity);
+    dhash->capacity = new_capacity;
 
-        while (old_b != NULL)
+    uint32_t i;
+    for (i = 0; i < old_capacity; i++)
+    {
+        if (old_entries[i].key != NULL)
         {
-            uint32_t new_hash = Murmur3_32(old_b->key) % num_new_buckets;
-
-            bucket_ptr_t* new_b = NEW(bucket_ptr_t);
-            new_b->key = old_b->key;
-            new_b->info = old_b->info;
-            new_b->next = new_buckets[new_hash];
-            new_buckets[new_hash] = new_b;
-
-            old_b = old_b->next;
+            dhash->entries[dhash_ptr_find_slot(dhash, old_entries[i].key)] = old_entries[i];
         }
     }
 
-    for (i = 0; i < num_old_buckets; i++)
+    xfree(old_entries);
+}
+
+void dhash_ptr_reserve(dhash_ptr_t* dhash, int num_items)
+{
+    if (num_items < 0) abort();
+    trace_op('s', dhash, (uintptr_t)num_items);
+
+    uint32_t new_capacity = capacity_for(num_items);
+    if (new_capacity > dhash->capacity)
     {
-        free_bucket_list(old_buckets[i]);
+        dhash_ptr_rehash(dhash, new_capacity);
     }
-    xfree(old_buckets);
-
-    dhash->buckets = new_buckets;
 }
 
 void dhash_ptr_insert(dhash_ptr_t* dhash, const char* key, dhash_ptr_info_t info)
 {
     if (key == NULL) abort();
     if (info == NULL) abort();
+    trace_op('i', dhash, (uintptr_t)key);
+
+    uint32_t i = dhash_ptr_find_slot(dhash, key);
+    if (dhash->entries[i].key == key)
+    {
+        // Update
+        dhash->entries[i].info = info;
+        return;
+    }
 
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-    if (((num_buckets * 3) / 4) < dhash->num_items)
+    if (too_loaded(dhash->num_items + 1, dhash->capacity))
     {
-        dhash_ptr_increase_rehash(dhash);
+        dhash_ptr_rehash(dhash, dhash->capacity * 2);
+        i = dhash_ptr_find_slot(dhash, key);
     }
 
-    dhash_ptr_do_insert(dhash, key, info);
+    // Insert
+    dhash->entries[i].key = key;
+    dhash->entries[i].info = info;
+
+    dhash->num_items++;
 }
 
 void dhash_ptr_remove(dhash_ptr_t* dhash, const char* key)
 {
     if (key == NULL) abort();
+    trace_op('r', dhash, (uintptr_t)key);
 
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-    uint32_t hash = Murmur3_32(key) % num_buckets;
+    uint32_t mask = dhash->capacity - 1;
+    uint32_t i = dhash_ptr_find_slot(dhash, key);
 
-    bucket_ptr_t** b = &(dhash->buckets[hash]);
+    // Not found
+    if (dhash->entries[i].key == NULL)
+        return;
 
-    while ((*b) != NULL)
+    // Move back every entry of the cluster that could not be placed at its
+    // home slot (or closer to it) because of slot i
+    uint32_t j = i;
+    for (;;)
     {
-        if ((*b)->key == key)
-        {
-            bucket_ptr_t* current = *b;
-            *b = (*b)->next;
-            xfree(current);
-            dhash->num_items--;
-            return;
-        }
-        b = &((*b)->next);
+        j = (j + 1) & mask;
+        if (dhash->entries[j].key == NULL)
+            break;
+
+        uint32_t home = hash_ptr(dhash->entries[j].key) & mask;
+        char home_in_i_j = (i <= j)
+            ? (i < home && home <= j)
+            : (i < home || home <= j);
+        if (home_in_i_j)
+            continue;
+
+        dhash->entries[i] = dhash->entries[j];
+        i = j;
     }
 
-    // Not found
+    dhash->entries[i].key = NULL;
+    dhash->entries[i].info = NULL;
+
+    dhash->num_items--;
 }
 
 void dhash_ptr_walk(dhash_ptr_t* dhash, dhash_ptr_walk_fn walk_fn, void *walk_info)
 {
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-
-    int i;
-    for (i = 0; i < num_buckets; i++)
+    uint32_t i;
+    for (i = 0; i < dhash->capacity; i++)
     {
-        bucket_ptr_t* b = dhash->buckets[i];
-        while (b != NULL)
+        if (dhash->entries[i].key != NULL)
         {
-            walk_fn(b->key, b->info, walk_info);
-            b = b->next;
+            walk_fn(dhash->entries[i].key, dhash->entries[i].info, walk_info);
         }
     }
 }
-
-// Hash function
-// Taken from wikipedia
-STATIC_INLINE uint32_t Murmur3_32(const char* ptr)
-{
-	static const uint32_t c1 = 0xcc9e2d51;
-	static const uint32_t c2 = 0x1b873593;
-	static const uint32_t r1 = 15;
-	static const uint32_t r2 = 13;
-	static const uint32_t m = 5;
-	static const uint32_t n = 0xe6546b64;
-
-    // Size of a pointer
-    uint32_t len = sizeof(ptr);
-    const char* key = (const char*)&ptr;
-
-	uint32_t hash = 0;
- 
-	uint32_t* keydata = (uint32_t*) key; //used to extract 32 bits at a time
-	int keydata_it = 0;
- 
-	while (len >= 4)
-	{
-		uint32_t k = keydata[keydata_it++];
-		len -= 4;
- 
-		k *= c1;
-		k = (k << r1) | (k >> (32-r1));
-		k *= c2;
- 
-		hash ^= k;
-		hash = ((hash << r2) | (hash >> (32-r2)) * m) + n;
-	}
- 
-	const uint8_t * tail = (const uint8_t*)(keydata + keydata_it*4);
-	uint32_t k1 = 0;
- 
-	switch(len & 3) {
-	case 3:
-		k1 ^= tail[2] << 16;
-	case 2:
-		k1 ^= tail[1] << 8;
-	case 1:
-		k1 ^= tail[0];
- 
-		k1 *= c1;
-		k1 = (k1 << r1) | (k1 >> (32-r1));
-		k1 *= c2;
-		hash ^= k1;
-	}
- 
-	hash ^= len;
-	hash ^= (hash >> 16);
-	hash *= 0x85ebca6b;
-	hash ^= (hash >> 13);
-	hash *= 0xc2b2ae35;
-	hash ^= (hash >> 16);
- 
-	return hash;
-}
@@ -38,16 +38,24 @@ typedef void* dhash_ptr_info_t;
 
 typedef struct dhash_ptr_tag dhash_ptr_t;
 
+// initial_size is the number of items expected
 dhash_ptr_t* dhash_ptr_new(int initial_size);
 void dhash_ptr_destroy(dhash_ptr_t*);
 void* dhash_ptr_query(dhash_ptr_t*, const char* key);
 void dhash_ptr_insert(dhash_ptr_t*, const char* key, dhash_ptr_info_t info);
 void dhash_ptr_remove(dhash_ptr_t*, const char* key);
+// Makes room for num_items without further rehashing
+void dhash_ptr_reserve(dhash_ptr_t*, int num_items);
 
 typedef void dhash_ptr_walk_fn(const char* key, void* info, void *walk_info);
 
 void dhash_ptr_walk(dhash_ptr_t*, dhash_ptr_walk_fn walk_fn, void* walk_info);
 
+// When configured with --enable-dhash-ptr-trace and the environment variable
+// MCXX_DHASH_PTR_TRACE names a file, every operation on every table is
+// recorded there so benchmarks/dhash_ptr/dhash_ptr_bench can replay it.
+// Record traces without -j, workers would share the file
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,137 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#include <string.h>
+#include "open_hash.h"
+#include "mem.h"
+
+static unsigned int open_hash_fix_hash(unsigned int hash)
+{
+    return hash != 0 ? hash : 1;
+}
+
+static int open_hash_slot(open_hash_t* t, unsigned int hash)
+{
+    // Avalanche the bits before masking
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+
+    return hash & (t->num_slots - 1);
+}
+
+static void* open_hash_entry(open_hash_t* t, int i)
+{
+    return t->entries + i * t->entry_size;
+}
+
+static void* open_hash_insert_slot(open_hash_t* t, unsigned int hash, const void* entry)
+{
+    int i = open_hash_slot(t, hash);
+    while (t->hashes[i] != 0)
+    {
+        i = (i + 1) & (t->num_slots - 1);
+    }
+    t->hashes[i] = hash;
+    memcpy(open_hash_entry(t, i), entry, t->entry_size);
+    t->num_items++;
+
+    return open_hash_entry(t, i);
+}
+
+void open_hash_init(open_hash_t* t, size_t entry_size)
+{
+    memset(t, 0, sizeof(*t));
+    t->entry_size = entry_size;
+}
+
+void open_hash_destroy(open_hash_t* t)
+{
+    DELETE(t->hashes);
+    DELETE(t->entries);
+    open_hash_init(t, t->entry_size);
+}
+
+void* open_hash_query(open_hash_t* t, unsigned int hash,
+        open_hash_match_fn* match, const void* key)
+{
+    if (t->num_items == 0)
+        return NULL;
+
+    hash = open_hash_fix_hash(hash);
+    int i = open_hash_slot(t, hash);
+    while (t->hashes[i] != 0)
+    {
+        if (t->hashes[i] == hash
+                && match(open_hash_entry(t, i), key))
+            return open_hash_entry(t, i);
+
+        i = (i + 1) & (t->num_slots - 1);
+    }
+
+    return NULL;
+}
+
+void* open_hash_insert(open_hash_t* t, unsigned int hash, const void* entry)
+{
+    // Keep the load factor under 3/4
+    if (4 * (t->num_items + 1) > 3 * t->num_slots)
+    {
+        int old_num_slots = t->num_slots;
+        unsigned int* old_hashes = t->hashes;
+        char* old_entries = t->entries;
+
+        t->num_items = 0;
+        t->num_slots = (old_num_slots == 0) ? 8 : 2 * old_num_slots;
+        t->hashes = NEW_VEC0(unsigned int, t->num_slots);
+        t->entries = NEW_VEC(char, t->num_slots * t->entry_size);
+
+        int i;
+        for (i = 0; i < old_num_slots; i++)
+        {
+            if (old_hashes[i] != 0)
+                open_hash_insert_slot(t, old_hashes[i], old_entries + i * t->entry_size);
+        }
+
+        DELETE(old_hashes);
+        DELETE(old_entries);
+    }
+
+    return open_hash_insert_slot(t, open_hash_fix_hash(hash), entry);
+}
+
+void open_hash_walk(open_hash_t* t, open_hash_walk_fn* walk_fn, void* walk_info)
+{
+    int i;
+    for (i = 0; i < t->num_slots; i++)
+    {
+        if (t->hashes[i] != 0)
+            walk_fn(open_hash_entry(t, i), walk_info);
+    }
+}
@@ -0,0 +1,83 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef OPEN_HASH_H
+#define OPEN_HASH_H
+
+// Open addressing hash table with linear probing. Entries of a fixed size
+// are stored in the table itself. Callers compute the hashes and compare
+// the keys, so an entry can be keyed on several fields
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libutils-common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct open_hash_tag open_hash_t;
+struct open_hash_tag
+{
+    size_t entry_size;
+    int num_items;
+    int num_slots;
+    // Zero marks an empty slot
+    unsigned int* hashes;
+    char* entries;
+};
+
+// Returns nonzero if the entry has the key
+typedef char open_hash_match_fn(const void* entry, const void* key);
+typedef void open_hash_walk_fn(void* entry, void* walk_info);
+
+LIBUTILS_EXTERN void open_hash_init(open_hash_t*, size_t entry_size);
+// Frees the storage of the table, not what the entries point to
+LIBUTILS_EXTERN void open_hash_destroy(open_hash_t*);
+
+LIBUTILS_EXTERN void* open_hash_query(open_hash_t*, unsigned int hash,
+        open_hash_match_fn* match, const void* key);
+// Copies the entry, whose key must not be in the table yet. Returns the
+// copy, which moves when the table grows
+LIBUTILS_EXTERN void* open_hash_insert(open_hash_t*, unsigned int hash, const void* entry);
+
+LIBUTILS_EXTERN void open_hash_walk(open_hash_t*, open_hash_walk_fn* walk_fn, void* walk_info);
+
+// Adds a value to a hash being computed
+static inline uint64_t open_hash_combine(uint64_t h, uint64_t v)
+{
+    return h * 0x9e3779b97f4a7c15ULL + v;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OPEN_HASH_H
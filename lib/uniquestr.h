@@ -31,6 +31,7 @@
 #define UNIQUESTR_H
 
 #include "libutils-common.h"
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +39,9 @@ extern "C" {
 
 #define uniqstr uniquestr
 LIBUTILS_EXTERN const char *uniquestr(const char*);
+// Like uniquestr but for the first 'length' chars of 'string', which does not
+// have to be NUL-terminated
+LIBUTILS_EXTERN const char *uniquestr_n(const char* string, size_t length);
 
 #define UNIQUESTR_LITERAL(literal) \
   ({ static const char* _cached_uniquestr = NULL; \
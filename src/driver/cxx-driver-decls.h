@@ -115,6 +115,8 @@ typedef struct translation_unit_tag
     const char* output_filename;
 
     struct AST_tag* parsed_tree;
+    // Arena of the nodes created by the parser
+    struct ast_arena_tag* parse_arena;
     nodecl_t nodecl;
     const decl_context_t* global_decl_context;
 
@@ -183,6 +185,13 @@ typedef struct debug_options_tag
     char show_template_packs;
     char vectorization_verbose;
     char stats_string_table;
+    char do_not_pipeline;
+    char benchmark_ast_walk;
+    char benchmark_lexer;
+    char keep_module_database;
+    char eager_module_loading;
+    char stats_fortran_modules;
+    char sqlite_module_files;
 } debug_options_t;
 
 extern debug_options_t debug_options;
@@ -229,6 +238,14 @@ typedef struct subgoal_tag
     struct compilation_configuration_tag* configuration;
 } subgoal_t;
 
+// Forms of --scan-deps
+typedef enum scan_dependences_format_tag
+{
+    SCAN_DEPENDENCES_NONE = 0,
+    SCAN_DEPENDENCES_MAKE,
+    SCAN_DEPENDENCES_JSON,
+} scan_dependences_format_t;
+
 typedef struct compilation_process_tag
 {
     // Result of the execution
@@ -277,6 +294,14 @@ typedef struct compilation_process_tag
 
     // Flags
     char parallel_process; // enables features allowing parallel compilation
+
+    // Maximum number of translation units compiled at the same time (-j)
+    int num_jobs;
+
+    // Only the module dependences of the Fortran files are written (--scan-deps)
+    scan_dependences_format_t scan_dependences;
+    // Meaningful only if we scan dependences. NULL means stdout
+    const char *scan_dependences_output_filename;
 } compilation_process_t;
 
 typedef struct compilation_configuration_conditional_flags
@@ -511,6 +536,8 @@ typedef struct compilation_configuration_tag
 
     // Enable explicit instantiation
     char explicit_instantiation;
+    // Only instantiate functions referenced by the emitted code
+    char explicit_instantiation_only_used;
 
     // Disable 'sizeof' computation
     char disable_sizeof;
@@ -0,0 +1,534 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifdef HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "cxx-driver-jobs.h"
+#include "cxx-driver-utils.h"
+#include "cxx-driver.h"
+#include "cxx-utils.h"
+#include "uniquestr.h"
+
+struct driver_job_tag
+{
+    const char* description;
+    pid_t pid;
+
+    // Workers of the driver
+    driver_job_finish_fun_t finish;
+    // External programs
+    char is_program;
+    const char* program_name;
+    driver_program_finish_fun_t finish_program;
+
+    void *data;
+
+    const char* stdout_filename;
+    const char* stderr_filename;
+    const char* results_filename;
+
+    int exit_status;
+    char finished;
+    char retired;
+};
+
+static driver_job_t** job_list = NULL;
+static int num_jobs = 0;
+// Jobs before this one have already been replayed and finished
+static int first_unretired_job = 0;
+static int num_running_jobs = 0;
+
+static char in_worker = 0;
+static char some_job_failed = 0;
+
+char driver_jobs_in_worker(void)
+{
+    return in_worker;
+}
+
+char driver_jobs_enabled(void)
+{
+    return !in_worker
+        && compilation_process.num_jobs > 1;
+}
+
+char driver_jobs_pipeline_enabled(void)
+{
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    // Without -j external programs are run synchronously, as usual
+    return compilation_process.num_jobs > 1
+        && !debug_options.do_not_pipeline;
+#else
+    return 0;
+#endif
+}
+
+static int max_running_jobs(void)
+{
+    return compilation_process.num_jobs;
+}
+
+static void redirect_output(int fd, const char* filename)
+{
+    int new_fd = open(filename, O_WRONLY | O_TRUNC);
+    if (new_fd < 0
+            || dup2(new_fd, fd) < 0)
+    {
+        fatal_error("error: could not redirect output of worker to '%s' (%s)",
+                filename, strerror(errno));
+    }
+    close(new_fd);
+}
+
+static void run_job_in_worker(driver_job_t* job,
+        driver_job_run_fun_t run,
+        void *data)
+{
+    in_worker = 1;
+
+    // Jobs of the driver are not our business
+    job_list = NULL;
+    num_jobs = 0;
+    first_unretired_job = 0;
+    num_running_jobs = 0;
+
+    // Temporal files of the driver belong to the driver
+    temporal_files_forget();
+
+    redirect_output(STDOUT_FILENO, job->stdout_filename);
+    redirect_output(STDERR_FILENO, job->stderr_filename);
+
+    FILE* results = fopen(job->results_filename, "w");
+    if (results == NULL)
+    {
+        fatal_error("error: could not open results file '%s' (%s)",
+                job->results_filename, strerror(errno));
+    }
+
+    run(data, results);
+
+    // Programs run asynchronously by the worker
+    driver_jobs_wait_all();
+
+    // Now the driver is responsible of the temporal files of this worker
+    temporal_files_export(results);
+    fclose(results);
+
+    fflush(stdout);
+    fflush(stderr);
+
+    // Do not run atexit routines, they would remove the temporal files
+    _exit(EXIT_SUCCESS);
+}
+
+static driver_job_t* running_job_of_pid(pid_t pid)
+{
+    int i;
+    for (i = first_unretired_job; i < num_jobs; i++)
+    {
+        driver_job_t* job = job_list[i];
+        if (!job->finished
+                && job->pid == pid)
+            return job;
+    }
+    return NULL;
+}
+
+// Returns nonzero if the job has finished given the status returned by waitpid
+static char job_status_finished(driver_job_t* job, int status)
+{
+    if (job->is_program)
+    {
+        job->exit_status = program_exit_status(job->program_name, status);
+    }
+    else if (WIFEXITED(status))
+    {
+        job->exit_status = WEXITSTATUS(status);
+    }
+    else if (WIFSIGNALED(status))
+    {
+        fprintf(stderr, "Worker for '%s' was ended with signal %d\n",
+                job->description, WTERMSIG(status));
+        job->exit_status = 1;
+    }
+    else
+    {
+        // Stopped or continued, keep waiting
+        return 0;
+    }
+
+    job->finished = 1;
+    num_running_jobs--;
+    return 1;
+}
+
+static pid_t wait_pid(pid_t pid, int *status, int options)
+{
+    for (;;)
+    {
+        pid_t result = waitpid(pid, status, options);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            fatal_error("error: could not wait for workers (%s)", strerror(errno));
+        }
+        return result;
+    }
+}
+
+// Only our jobs are reaped, other children of the driver are left to whoever
+// created them
+static void wait_one_job(void)
+{
+    ERROR_CONDITION(num_running_jobs == 0, "There are no running jobs", 0);
+
+    for (;;)
+    {
+        int status;
+        int i;
+        for (i = first_unretired_job; i < num_jobs; i++)
+        {
+            driver_job_t* job = job_list[i];
+            if (job->finished)
+                continue;
+
+            if (wait_pid(job->pid, &status, WNOHANG) == job->pid
+                    && job_status_finished(job, status))
+                return;
+        }
+
+        // Sleep until some child ends but do not reap it yet
+        siginfo_t info;
+        memset(&info, 0, sizeof(info));
+        if (waitid(P_ALL, 0, &info, WEXITED | WNOWAIT) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            fatal_error("error: could not wait for workers (%s)", strerror(errno));
+        }
+
+        driver_job_t* job = running_job_of_pid(info.si_pid);
+        if (job == NULL)
+        {
+            // Not one of our jobs, block on the oldest running one instead
+            for (i = first_unretired_job; i < num_jobs; i++)
+            {
+                if (!job_list[i]->finished)
+                {
+                    job = job_list[i];
+                    break;
+                }
+            }
+        }
+
+        if (wait_pid(job->pid, &status, 0) == job->pid
+                && job_status_finished(job, status))
+            return;
+    }
+}
+
+static void replay_output(const char* filename, FILE* output)
+{
+    FILE* f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        fatal_error("error: could not open output of worker '%s' (%s)",
+                filename, strerror(errno));
+    }
+
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        if (fwrite(buffer, 1, n, output) != n)
+            break;
+    }
+    fflush(output);
+
+    fclose(f);
+}
+
+static void split_result_line(char* line, driver_job_result_t* result)
+{
+    result->num_fields = 0;
+    result->fields = NULL;
+
+    char* start = line;
+    for (;;)
+    {
+        char* end = strchr(start, '\t');
+        if (end != NULL)
+            *end = '\0';
+
+        P_LIST_ADD(result->fields, result->num_fields, uniquestr(start));
+
+        if (end == NULL)
+            break;
+        start = end + 1;
+    }
+}
+
+static void retire_job(driver_job_t* job)
+{
+    job->retired = 1;
+
+    if (job->stdout_filename != NULL)
+        replay_output(job->stdout_filename, stdout);
+    replay_output(job->stderr_filename, stderr);
+
+    if (job->exit_status != 0)
+    {
+        if (job->is_program)
+        {
+            fprintf(stderr, "%s\n", job->description);
+        }
+        some_job_failed = 1;
+        return;
+    }
+
+    if (job->is_program)
+    {
+        if (job->finish_program != NULL)
+        {
+            (job->finish_program)(job->data);
+        }
+        return;
+    }
+
+    FILE* f = fopen(job->results_filename, "r");
+    if (f == NULL)
+    {
+        fatal_error("error: could not open results of worker '%s' (%s)",
+                job->results_filename, strerror(errno));
+    }
+
+    int num_results = 0;
+    driver_job_result_t* results = NULL;
+
+    char* line = NULL;
+    size_t line_size = 0;
+    ssize_t length;
+    while ((length = getline(&line, &line_size, f)) > 0)
+    {
+        if (line[length - 1] == '\n')
+            line[length - 1] = '\0';
+
+        driver_job_result_t current_result;
+        split_result_line(line, &current_result);
+
+        if (current_result.num_fields == 4
+                && strcmp(current_result.fields[0], "temporal") == 0)
+        {
+            temporal_files_import(current_result.fields[3],
+                    /* is_temporary */ atoi(current_result.fields[1]),
+                    /* is_dir */ atoi(current_result.fields[2]));
+            DELETE(current_result.fields);
+        }
+        else
+        {
+            P_LIST_ADD(results, num_results, current_result);
+        }
+    }
+    free(line);
+    fclose(f);
+
+    if (job->finish != NULL)
+    {
+        (job->finish)(job->data, num_results, results);
+    }
+
+    int i;
+    for (i = 0; i < num_results; i++)
+    {
+        DELETE(results[i].fields);
+    }
+    DELETE(results);
+}
+
+// Replays finished jobs in submission order. If any of them failed wait the
+// remaining workers and finish the driver
+static void retire_finished_jobs(void)
+{
+    while (first_unretired_job < num_jobs
+            && job_list[first_unretired_job]->finished)
+    {
+        retire_job(job_list[first_unretired_job]);
+        first_unretired_job++;
+    }
+
+    if (some_job_failed)
+    {
+        while (num_running_jobs > 0)
+        {
+            wait_one_job();
+        }
+
+        while (first_unretired_job < num_jobs)
+        {
+            retire_job(job_list[first_unretired_job]);
+            first_unretired_job++;
+        }
+
+        exit(EXIT_FAILURE);
+    }
+}
+
+driver_job_t* driver_jobs_submit(const char* description,
+        driver_job_run_fun_t run,
+        driver_job_finish_fun_t finish,
+        void *data)
+{
+    ERROR_CONDITION(in_worker, "Cannot submit jobs inside a worker", 0);
+
+    while (num_running_jobs >= max_running_jobs())
+    {
+        wait_one_job();
+        retire_finished_jobs();
+    }
+
+    driver_job_t* job = NEW0(driver_job_t);
+    job->description = uniquestr(description);
+    job->finish = finish;
+    job->data = data;
+    job->stdout_filename = new_temporal_file()->name;
+    job->stderr_filename = new_temporal_file()->name;
+    job->results_filename = new_temporal_file()->name;
+
+    P_LIST_ADD(job_list, num_jobs, job);
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Starting worker for '%s'\n", job->description);
+    }
+
+    // Do not let the worker output what we have not flushed yet
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        fatal_error("error: could not fork worker for '%s' (%s)",
+                job->description, strerror(errno));
+    }
+    else if (pid == 0)
+    {
+        run_job_in_worker(job, run, data);
+    }
+
+    job->pid = pid;
+    num_running_jobs++;
+
+    return job;
+}
+
+char driver_jobs_succeeded(driver_job_t* job)
+{
+    return job->finished
+        && job->exit_status == 0;
+}
+
+char driver_jobs_wait_one(void)
+{
+    if (num_running_jobs == 0)
+        return 0;
+
+    wait_one_job();
+    retire_finished_jobs();
+    return 1;
+}
+
+void driver_jobs_wait_all(void)
+{
+    while (num_running_jobs > 0)
+    {
+        wait_one_job();
+        retire_finished_jobs();
+    }
+    retire_finished_jobs();
+}
+
+driver_job_t* driver_jobs_spawn_program(const char* failure_message,
+        const char* program_name,
+        const char** arguments,
+        const char* stdout_f,
+        driver_program_finish_fun_t finish,
+        void *data)
+{
+    ERROR_CONDITION(!driver_jobs_pipeline_enabled(), "External programs cannot be run asynchronously", 0);
+
+    while (num_running_jobs >= max_running_jobs())
+    {
+        wait_one_job();
+        retire_finished_jobs();
+    }
+
+    driver_job_t* job = NEW0(driver_job_t);
+    job->description = uniquestr(failure_message);
+    job->is_program = 1;
+    job->program_name = uniquestr(program_name);
+    job->finish_program = finish;
+    job->data = data;
+    job->stderr_filename = new_temporal_file()->name;
+
+    P_LIST_ADD(job_list, num_jobs, job);
+
+    fflush(stdout);
+    fflush(stderr);
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    job->pid = spawn_program(program_name, arguments, stdout_f, job->stderr_filename);
+#endif
+    num_running_jobs++;
+
+    return job;
+}
+
+void driver_jobs_wait(driver_job_t* job)
+{
+    while (!job->retired)
+    {
+        if (!job->finished)
+        {
+            wait_one_job();
+        }
+        retire_finished_jobs();
+    }
+}
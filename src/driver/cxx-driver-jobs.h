@@ -0,0 +1,114 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef CXX_DRIVER_JOBS_H
+#define CXX_DRIVER_JOBS_H
+
+#include <stdio.h>
+#include "cxx-process.h"
+
+MCXX_BEGIN_DECLS
+
+// Parallel jobs of the driver
+//
+// A job is run in a forked worker of the driver. The standard output and
+// standard error of the worker are captured and replayed by the driver in the
+// same order the jobs were submitted, so diagnostics do not interleave.
+//
+// The worker reports its results by writing lines of tab-separated fields
+// into the FILE* received by the run function. Once the job finishes, these
+// lines are handed, again in submission order, to the finish function which
+// runs in the driver itself. Temporal files created by the worker are
+// transferred to the driver and removed at the end as usual.
+//
+// If a job fails the driver waits the remaining workers, replays their output
+// and exits with failure.
+//
+// External programs (like the preprocessor or the native compiler) can be run
+// as jobs as well. This way the driver can keep working while they run. Their
+// standard error is also replayed in submission order.
+
+typedef struct driver_job_tag driver_job_t;
+
+typedef struct driver_job_result_tag
+{
+    int num_fields;
+    const char** fields;
+} driver_job_result_t;
+
+typedef void (*driver_job_run_fun_t)(void* data, FILE* results);
+typedef void (*driver_job_finish_fun_t)(void* data,
+        int num_results,
+        driver_job_result_t* results);
+
+// States whether new jobs can be submitted. This is false if -j was not
+// specified or if we are already inside a worker
+char driver_jobs_enabled(void);
+
+// States whether we are running inside a worker
+char driver_jobs_in_worker(void);
+
+driver_job_t* driver_jobs_submit(const char* description,
+        driver_job_run_fun_t run,
+        driver_job_finish_fun_t finish,
+        void *data);
+
+// States whether the job has finished successfully. Its output may have not
+// been replayed yet
+char driver_jobs_succeeded(driver_job_t* job);
+
+// Waits until one of the running jobs finishes. Returns zero if there were
+// no running jobs
+char driver_jobs_wait_one(void);
+
+// States whether external programs can be run asynchronously. This only
+// happens with -j
+char driver_jobs_pipeline_enabled(void);
+
+typedef void (*driver_program_finish_fun_t)(void* data);
+
+// Runs program_name without waiting for it. If the program fails,
+// failure_message is printed and the driver finishes. Otherwise finish is
+// called, if not NULL, once the program has been waited
+driver_job_t* driver_jobs_spawn_program(const char* failure_message,
+        const char* program_name,
+        const char** arguments,
+        const char* stdout_f,
+        driver_program_finish_fun_t finish,
+        void *data);
+
+// Waits the given job and every job submitted before it
+void driver_jobs_wait(driver_job_t* job);
+
+// Waits every submitted job
+void driver_jobs_wait_all(void);
+
+MCXX_END_DECLS
+
+#endif // CXX_DRIVER_JOBS_H
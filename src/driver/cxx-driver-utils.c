@@ -123,6 +123,38 @@ void temporal_files_cleanup(void)
     temporal_file_list = NULL;
 }
 
+void temporal_files_forget(void)
+{
+    temporal_file_list_t iter = temporal_file_list;
+
+    while (iter != NULL)
+    {
+        temporal_file_list_t prev = iter;
+        iter = iter->next;
+        DELETE(prev->info);
+        DELETE(prev);
+    }
+
+    temporal_file_list = NULL;
+}
+
+void temporal_files_export(FILE* f)
+{
+    temporal_file_list_t iter = temporal_file_list;
+
+    while (iter != NULL)
+    {
+        if (iter->info != NULL)
+        {
+            fprintf(f, "temporal\t%d\t%d\t%s\n",
+                    iter->info->is_temporary,
+                    iter->info->is_dir,
+                    iter->info->name);
+        }
+        iter = iter->next;
+    }
+}
+
 static char name_is_in_temporal_files(const char* name)
 {
     temporal_file_list_t it = temporal_file_list;
@@ -161,6 +193,11 @@ static void add_to_list_of_temporal_files_(const char* name, char is_temporary,
     add_to_list_of_temporal_files(name, is_temporary, is_dir);
 }
 
+void temporal_files_import(const char* name, char is_temporary, char is_dir)
+{
+    add_to_list_of_temporal_files_(name, is_temporary, is_dir);
+}
+
 void mark_file_for_cleanup(const char* name)
 {
     add_to_list_of_temporal_files_(name, /* is_temporary */ 0, /* is_dir */ 0);
@@ -345,7 +382,7 @@ int execute_program(const char* program_name, const char** arguments)
 }
 
 #if !defined(WIN32_BUILD) || defined(__CYGWIN__)
-static int execute_program_flags_unix(const char* program_name, const char** arguments, const char* stdout_f, const char* stderr_f)
+pid_t spawn_program(const char* program_name, const char** arguments, const char* stdout_f, const char* stderr_f)
 {
     if (program_name == NULL)
         program_name = "";
@@ -449,29 +486,44 @@ static int execute_program_flags_unix(const char* program_name, const char** arg
         // Execvp should not return
         fatal_error("error: execution of subprocess '%s' failed (%s)", program_name, strerror(errno));
     }
-    else // I'm the parent
+
+    return spawned_process;
+}
+
+int program_exit_status(const char* program_name, int status)
+{
+    if (WIFEXITED(status))
     {
-        // Wait for my son
-        int status;
-        wait(&status);
-        if (WIFEXITED(status))
-        {
-            return (WEXITSTATUS(status));
-        }
-        else if (WIFSIGNALED(status))
-        {
-            fprintf(stderr, "Subprocess '%s' was ended with signal %d\n",
-                    program_name, WTERMSIG(status));
+        return (WEXITSTATUS(status));
+    }
+    else if (WIFSIGNALED(status))
+    {
+        fprintf(stderr, "Subprocess '%s' was ended with signal %d\n",
+                program_name, WTERMSIG(status));
 
-            return 1;
-        }
-        else
-        {
-            internal_error(
-                    "Subprocess '%s' ended but neither by normal exit nor signal", 
-                    program_name);
-        }
+        return 1;
     }
+    else
+    {
+        internal_error(
+                "Subprocess '%s' ended but neither by normal exit nor signal", 
+                program_name);
+    }
+}
+
+static int execute_program_flags_unix(const char* program_name, const char** arguments, const char* stdout_f, const char* stderr_f)
+{
+    pid_t spawned_process = spawn_program(program_name, arguments, stdout_f, stderr_f);
+
+    // Wait for my son. Do not use wait here as there may be other
+    // children of the driver running (see cxx-driver-jobs.c)
+    int status;
+    if (waitpid(spawned_process, &status, 0) < 0)
+    {
+        fatal_error("error: could not wait for subprocess '%s' (%s)", program_name, strerror(errno));
+    }
+
+    return program_exit_status(program_name, status);
 }
 #else
 
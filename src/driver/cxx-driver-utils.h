@@ -31,6 +31,7 @@
 #define CXX_DRIVERUTILS_H
 
 #include <stdio.h>
+#include <sys/types.h>
 #include <sys/time.h>
 #include <time.h>
 #include "cxx-process.h"
@@ -75,12 +76,30 @@ temporal_file_t new_temporal_file_extension(const char* extension);
 // file is closed and erased.
 void temporal_files_cleanup(void);
 
+// Forgets every temporal file without removing it. Used by parallel workers
+// so they do not remove files owned by the driver
+void temporal_files_forget(void);
+
+// Writes the current list of temporal files (one per line) so it can be
+// imported by another process of the driver using temporal_files_import
+void temporal_files_export(FILE* f);
+void temporal_files_import(const char* name, char is_temporary, char is_dir);
+
 const char* get_extension_filename(const char* filename);
 
 int execute_program(const char* program_name, const char** arguments);
 int execute_program_flags(const char* program_name, const char** arguments, 
         const char *stdout_f, const char *stderr_f);
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Like execute_program_flags but it does not wait for the program. The
+// returned process must be waited using waitpid and its status converted with
+// program_exit_status
+pid_t spawn_program(const char* program_name, const char** arguments,
+        const char *stdout_f, const char *stderr_f);
+int program_exit_status(const char* program_name, int status);
+#endif
+
 // char** routines
 int count_null_ended_array(void** v);
 void remove_string_from_null_ended_string_array(const char** string_arr, const char* to_remove);
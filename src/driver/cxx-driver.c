@@ -58,6 +58,7 @@
 #include "cxx-utils.h"
 #include "cxx-driver.h"
 #include "cxx-driver-utils.h"
+#include "cxx-driver-jobs.h"
 #include "cxx-ast.h"
 #include "cxx-ambiguity.h"
 #include "cxx-graphviz.h"
@@ -72,6 +73,7 @@
 #include "cxx-exprtype.h"
 #include "cxx-typededuc.h"
 #include "cxx-overload.h"
+#include "cxx-koenig.h"
 #include "cxx-lexer.h"
 #include "cxx-parser.h"
 #include "c99-parser.h"
@@ -98,6 +100,7 @@
 #include "fortran03-codegen.h"
 #include "fortran03-typeenviron.h"
 #include "fortran03-mangling.h"
+#include "fortran03-modules.h"
 #include "cxx-driver-fortran.h"
 #include "cxx-driver-build-info.h"
 
@@ -130,6 +133,15 @@
 "  -J <dir>                 Sets <dir> as the output module directory\n" \
 "                           This flag is only meaningful for Fortran\n" \
 "                           See flag --module-out-pattern flag\n" \
+"  -j <n>, --jobs=<n>       Compiles up to <n> files at the same\n" \
+"                           time. Fortran files are started once\n" \
+"                           the files defining the modules they\n" \
+"                           use have been compiled. The preprocessor\n" \
+"                           and the native compiler are also run\n" \
+"                           while the frontend works on other files\n" \
+"  --scan-deps[=make|json]  Only scans the Fortran input files and\n" \
+"                           prints the modules each one provides\n" \
+"                           and requires. Default format is 'make'\n" \
 "  --output-dir=<dir>       Prettyprinted files will be left in\n" \
 "                           directory <dir>. Otherwise the input\n" \
 "                           file directory is used\n" \
@@ -204,6 +216,9 @@
 "                           file and quits\n" \
 "  --instantiate            Instantiate explicitly templates. This is\n" \
 "                           an unsupported experimental feature\n" \
+"  --instantiate-only-used  Like --instantiate but do not instantiate\n" \
+"                           functions only referenced by code that\n" \
+"                           is not emitted\n" \
 "  --pp[=on]                Preprocess files\n"\
 "                           This is the default for files ending with\n"\
 "                           C/C++: .c, .cc, .C, .cp, .cpp, .cxx, .c++\n"\
@@ -408,6 +423,8 @@ typedef enum
     OPTION_HELP_TARGET_OPTIONS,
     OPTION_IFORT_COMPATIBILITY,
     OPTION_INSTANTIATE_TEMPLATES,
+    OPTION_INSTANTIATE_ONLY_USED,
+    OPTION_JOBS,
     OPTION_LINE_MARKERS,
     OPTION_LINKER_NAME,
     OPTION_LIST_ENVIRONMENTS,
@@ -427,6 +444,7 @@ typedef enum
     OPTION_PREPROCESSOR_USES_STDOUT,
     OPTION_PRINT_CONFIG_DIR,
     OPTION_PROFILE,
+    OPTION_SCAN_DEPENDENCES,
     OPTION_SEARCH_INCLUDES,
     OPTION_SEARCH_MODULES,
     OPTION_SET_ENVIRONMENT,
@@ -440,7 +458,7 @@ typedef enum
 
 
 // It mimics getopt
-#define SHORT_OPTIONS_STRING "vVkKcho:EyI:J:L:l:gD:U:x:"
+#define SHORT_OPTIONS_STRING "vVkKcho:EyI:J:j:L:l:gD:U:x:"
 // This one mimics getopt_long but with one less field (the third one is not given)
 struct command_line_long_options command_line_long_options[] =
 {
@@ -485,6 +503,7 @@ struct command_line_long_options command_line_long_options[] =
     {"opencl-build-opts",  CLP_REQUIRED_ARGUMENT, OPTION_OPENCL_OPTIONS},
     {"do-not-unload-phases", CLP_NO_ARGUMENT, OPTION_DO_NOT_UNLOAD_PHASES},
     {"instantiate", CLP_NO_ARGUMENT, OPTION_INSTANTIATE_TEMPLATES},
+    {"instantiate-only-used", CLP_NO_ARGUMENT, OPTION_INSTANTIATE_ONLY_USED},
     {"pp", CLP_OPTIONAL_ARGUMENT, OPTION_ALWAYS_PREPROCESS},
     {"fpp", CLP_OPTIONAL_ARGUMENT, OPTION_FORTRAN_PREPROCESSOR},
     {"width", CLP_REQUIRED_ARGUMENT, OPTION_FORTRAN_COLUMN_WIDTH},
@@ -523,6 +542,8 @@ struct command_line_long_options command_line_long_options[] =
     {"ifort-compat", CLP_NO_ARGUMENT, OPTION_IFORT_COMPATIBILITY },
     {"line-markers", CLP_NO_ARGUMENT, OPTION_LINE_MARKERS },
     {"parallel", CLP_NO_ARGUMENT, OPTION_PARALLEL },
+    {"jobs", CLP_REQUIRED_ARGUMENT, OPTION_JOBS },
+    {"scan-deps", CLP_OPTIONAL_ARGUMENT, OPTION_SCAN_DEPENDENCES },
     {"Xcompiler", CLP_REQUIRED_ARGUMENT, OPTION_XCOMPILER },
     // sentinel
     {NULL, 0, 0}
@@ -552,6 +573,9 @@ static void load_configuration(void);
 static void finalize_committed_configuration(compilation_configuration_t*);
 static void commit_configuration(void);
 static void compile_every_translation_unit(void);
+static void scan_every_translation_unit(void);
+static void compile_every_translation_unit_aux_(int num_translation_units,
+        compilation_file_process_t** translation_units);
 
 static void compiler_phases_execution(
         compilation_configuration_t* config,
@@ -562,7 +586,11 @@ static void compiler_phases_pre_execution(
         translation_unit_t* translation_unit,
         const char* parsed_filename);
 static const char* preprocess_translation_unit(translation_unit_t* translation_unit, const char* input_filename);
+static void preprocess_translation_unit_ahead(compilation_file_process_t* file_process);
+static void register_preprocessed_translation_unit(translation_unit_t* translation_unit,
+        const char* preprocessed_filename);
 static void parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename);
+static void benchmark_lexer(translation_unit_t* translation_unit, const char* parsed_filename);
 static void initialize_semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename);
 static void semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename);
 static const char* codegen_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename);
@@ -667,14 +695,22 @@ int main(int argc, char* argv[])
     // (besides the built in ones)
     run_dynamic_initializers();
 
-    // Compilation of every specified translation unit
-    compile_every_translation_unit();
+    if (compilation_process.scan_dependences != SCAN_DEPENDENCES_NONE)
+    {
+        // Only report the module dependences of the files
+        scan_every_translation_unit();
+    }
+    else
+    {
+        // Compilation of every specified translation unit
+        compile_every_translation_unit();
 
-    // Embed files
-    embed_files();
+        // Embed files
+        embed_files();
 
-    // Link all generated objects
-    link_objects();
+        // Link all generated objects
+        link_objects();
+    }
 
     // Unload phases
     if (!do_not_unload_phases)
@@ -699,6 +735,11 @@ int main(int argc, char* argv[])
         stats_string_table();
     }
 
+    if (debug_options.stats_fortran_modules)
+    {
+        fortran_modules_stats();
+    }
+
     return compilation_process.execution_result;
 }
 
@@ -1509,6 +1550,12 @@ int parse_arguments(int argc, const char* argv[],
                         CURRENT_CONFIGURATION->explicit_instantiation = 1;
                         break;
                     }
+                case OPTION_INSTANTIATE_ONLY_USED:
+                    {
+                        CURRENT_CONFIGURATION->explicit_instantiation = 1;
+                        CURRENT_CONFIGURATION->explicit_instantiation_only_used = 1;
+                        break;
+                    }
                 case OPTION_ALWAYS_PREPROCESS:
                     {
                         if (parameter_info.argument == NULL
@@ -1659,6 +1706,42 @@ int parse_arguments(int argc, const char* argv[],
                         compilation_process.parallel_process = 1;
                         break;
                     }
+                case 'j':
+                case OPTION_JOBS:
+                    {
+                        int num_jobs = atoi(parameter_info.argument);
+                        if (num_jobs <= 0)
+                        {
+                            fprintf(stderr, "%s: invalid number of jobs '%s'. Ignoring\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                        }
+                        else
+                        {
+                            compilation_process.num_jobs = num_jobs;
+                        }
+                        break;
+                    }
+                case OPTION_SCAN_DEPENDENCES:
+                    {
+                        if (parameter_info.argument == NULL
+                                || strcmp(parameter_info.argument, "make") == 0)
+                        {
+                            compilation_process.scan_dependences = SCAN_DEPENDENCES_MAKE;
+                        }
+                        else if (strcmp(parameter_info.argument, "json") == 0)
+                        {
+                            compilation_process.scan_dependences = SCAN_DEPENDENCES_JSON;
+                        }
+                        else
+                        {
+                            fprintf(stderr, "%s: invalid format '%s' for --scan-deps, valid values are 'make' or 'json'\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                            return 1;
+                        }
+                        break;
+                    }
                 case OPTION_XCOMPILER:
                     {
                         const char * parameter[] = { uniquestr(parameter_info.argument) };
@@ -1716,6 +1799,13 @@ int parse_arguments(int argc, const char* argv[],
         exit(EXIT_SUCCESS);
     }
 
+    // When only scanning dependences -o names the file where they are written
+    if (compilation_process.scan_dependences != SCAN_DEPENDENCES_NONE)
+    {
+        compilation_process.scan_dependences_output_filename = output_file;
+        output_file = NULL;
+    }
+
     // "-o -" is not valid when compilation or linking will be done
     if (output_file != NULL
             && (strcmp(output_file, "-") == 0)
@@ -3047,394 +3137,1005 @@ static void register_upc_pragmae(compilation_configuration_t* configuration)
     register_new_directive(configuration, "distributed", "", /* is_construct */ 0, /* bound_to_single_stmt */ 0);
 }
 
-static void compile_every_translation_unit_aux_(int num_translation_units,
-        compilation_file_process_t** translation_units)
+// If the file is not preprocessed or we've ben told to preprocess it
+static char translation_unit_needs_preprocessing(struct extensions_table_t* current_extension)
 {
-    // This is just to avoid having a return in this function by mistake
-#define return 1 = 1;
-    // Save the old current file
-    compilation_file_process_t* saved_file_process = CURRENT_FILE_PROCESS;
-    compilation_configuration_t* saved_configuration = CURRENT_CONFIGURATION;
+    return ((BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_NOT_PREPROCESSED)
+                || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_NOT_PREPROCESSED))
+            && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_PREPROCESSED))
+        && !CURRENT_CONFIGURATION->pass_through;
+}
 
-    int i;
-    for (i = 0; i < num_translation_units; i++)
-    {
-        compilation_file_process_t* file_process = translation_units[i];
+static char translation_unit_is_fixed_form(struct extensions_table_t* current_extension)
+{
+    return (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
+            // We prescan from fixed to free if 
+            //  - the file is fixed form OR we are forced to be fixed for (--fixed)
+            //  - AND we were NOT told to be DELETE form (--free)
+            && (BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_FIXED_FORM)
+                || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_FIXED_FORM))
+            && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_FREE_FORM)
+            && !CURRENT_CONFIGURATION->pass_through);
+}
 
-        // Ensure we do not get in a strange loop
-        if (file_process->already_compiled)
-            continue;
+// Fortran files are preprocessed with the Fortran preprocessor
+static const char* preprocess_translation_unit_with_language_preprocessor(translation_unit_t* translation_unit)
+{
+    const char* old_preprocessor_name = CURRENT_CONFIGURATION->preprocessor_name;
+    const char** old_preprocessor_options = CURRENT_CONFIGURATION->preprocessor_options;
 
-        // Note: This is the only place where
-        // CURRENT_{FILE_PROCESS,CONFIGURATION} can be changed. Everywhere else
-        // these two variables are constants. 
-        // Whenever you modify SET_CURRENT_FILE_PROCESS update also
-        // SET_CURRENT_CONFIGURATION to its configuration
-        SET_CURRENT_FILE_PROCESS(file_process);
-        // This looks a bit redundant but it turns that the compiler has a
-        // configuration even before of any file
-        SET_CURRENT_CONFIGURATION(file_process->compilation_configuration);
+    FORTRAN_LANGUAGE()
+    {
+        CURRENT_CONFIGURATION->preprocessor_name = CURRENT_CONFIGURATION->fortran_preprocessor_name;
+        CURRENT_CONFIGURATION->preprocessor_options = CURRENT_CONFIGURATION->fortran_preprocessor_options;
+    }
 
-        translation_unit_t* translation_unit = CURRENT_COMPILED_FILE;
+    const char* preprocessed_filename = preprocess_translation_unit(translation_unit, translation_unit->input_filename);
 
-        // Ensure phases are loaded for current profile
-        load_compiler_phases(CURRENT_CONFIGURATION);
+    FORTRAN_LANGUAGE()
+    {
+        CURRENT_CONFIGURATION->preprocessor_name = old_preprocessor_name;
+        CURRENT_CONFIGURATION->preprocessor_options = old_preprocessor_options;
+    }
 
-        // First check the file type
-        const char* extension = get_extension_filename(translation_unit->input_filename);
+    return preprocessed_filename;
+}
 
-        struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+static void compile_translation_unit(compilation_file_process_t* file_process)
+{
+    translation_unit_t* translation_unit = file_process->translation_unit;
 
-        // Linker data is not processed anymore
-        if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA)
-        {
-            file_process->already_compiled = 1;
-            continue;
-        }
+    const char* extension = get_extension_filename(translation_unit->input_filename);
+    struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
 
-        char file_not_processed = BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_DO_NOT_PROCESS)
-            || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_DO_NOT_PROCESS);
+    char file_not_processed = BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_DO_NOT_PROCESS)
+        || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_DO_NOT_PROCESS);
 
-        if (!CURRENT_CONFIGURATION->force_language
-                && (current_extension->source_language != CURRENT_CONFIGURATION->source_language)
-                && !file_not_processed)
-        {
-            fprintf(stderr, "%s: %s was configured for %s language but file '%s' looks %s language (it will be compiled anyways)\n",
-                    compilation_process.exec_basename,
-                    compilation_process.exec_basename, 
-                    source_language_names[CURRENT_CONFIGURATION->source_language],
-                    translation_unit->input_filename,
-                    source_language_names[current_extension->source_language]);
-        }
+    if (!CURRENT_CONFIGURATION->force_language
+            && (current_extension->source_language != CURRENT_CONFIGURATION->source_language)
+            && !file_not_processed)
+    {
+        fprintf(stderr, "%s: %s was configured for %s language but file '%s' looks %s language (it will be compiled anyways)\n",
+                compilation_process.exec_basename,
+                compilation_process.exec_basename, 
+                source_language_names[CURRENT_CONFIGURATION->source_language],
+                translation_unit->input_filename,
+                source_language_names[current_extension->source_language]);
+    }
 
-        char old_cuda_flag = CURRENT_CONFIGURATION->enable_cuda;
-        // For cuda enable CUDA
-        if (current_extension->source_language == SOURCE_SUBLANGUAGE_CUDA)
+    char old_cuda_flag = CURRENT_CONFIGURATION->enable_cuda;
+    // For cuda enable CUDA
+    if (current_extension->source_language == SOURCE_SUBLANGUAGE_CUDA)
+    {
+        if (!old_cuda_flag)
         {
-            if (!old_cuda_flag)
-            {
-                fprintf(stderr, "%s: info: enabling experimental CUDA support\n",
-                        translation_unit->input_filename);
-                CURRENT_CONFIGURATION->enable_cuda = 1;
-            }
+            fprintf(stderr, "%s: info: enabling experimental CUDA support\n",
+                    translation_unit->input_filename);
+            CURRENT_CONFIGURATION->enable_cuda = 1;
         }
+    }
 
-        if (CURRENT_CONFIGURATION->verbose)
-        {
-            fprintf(stderr, "Compiling file '%s'\n", translation_unit->input_filename);
-        }
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Compiling file '%s'\n", translation_unit->input_filename);
+    }
 
-        const char* parsed_filename = translation_unit->input_filename;
+    const char* parsed_filename = translation_unit->input_filename;
 #ifndef FORTRAN_NEW_SCANNER
-        char preprocessed = 0;
+    char preprocessed = 0;
 #endif
-        // If the file is not preprocessed or we've ben told to preprocess it
-        if (((BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_NOT_PREPROCESSED)
-                    || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_NOT_PREPROCESSED))
-                    && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_PREPROCESSED))
-                && !CURRENT_CONFIGURATION->pass_through)
-        {
+    // If the file is not preprocessed or we've ben told to preprocess it
+    if (translation_unit_needs_preprocessing(current_extension))
+    {
 #ifndef FORTRAN_NEW_SCANNER
-            preprocessed = 1;
+        preprocessed = 1;
 #endif
-            timing_t timing_preprocessing;
-
-            const char* old_preprocessor_name = CURRENT_CONFIGURATION->preprocessor_name;
-            const char** old_preprocessor_options = CURRENT_CONFIGURATION->preprocessor_options;
-
-            FORTRAN_LANGUAGE()
-            {
-                CURRENT_CONFIGURATION->preprocessor_name = CURRENT_CONFIGURATION->fortran_preprocessor_name;
-                CURRENT_CONFIGURATION->preprocessor_options = CURRENT_CONFIGURATION->fortran_preprocessor_options;
-            }
+        timing_t timing_preprocessing;
 
-            timing_start(&timing_preprocessing);
-            parsed_filename = preprocess_translation_unit(translation_unit, translation_unit->input_filename);
-            timing_end(&timing_preprocessing);
+        timing_start(&timing_preprocessing);
+        parsed_filename = preprocess_translation_unit_with_language_preprocessor(translation_unit);
+        timing_end(&timing_preprocessing);
 
-            FORTRAN_LANGUAGE()
-            {
-                CURRENT_CONFIGURATION->preprocessor_name = old_preprocessor_name;
-                CURRENT_CONFIGURATION->preprocessor_options = old_preprocessor_options;
-            }
-
-            if (parsed_filename != NULL
-                    && CURRENT_CONFIGURATION->verbose)
-            {
-                fprintf(stderr, "File '%s' preprocessed in %.2f seconds\n",
-                        translation_unit->input_filename, 
-                        timing_elapsed(&timing_preprocessing));
-            }
+        if (parsed_filename != NULL
+                && CURRENT_CONFIGURATION->verbose)
+        {
+            fprintf(stderr, "File '%s' preprocessed in %.2f seconds\n",
+                    translation_unit->input_filename, 
+                    timing_elapsed(&timing_preprocessing));
+        }
 
-            if (parsed_filename == NULL)
-            {
-                fatal_error("Preprocess failed for file '%s'", translation_unit->input_filename);
-            }
+        if (parsed_filename == NULL)
+        {
+            fatal_error("Preprocess failed for file '%s'", translation_unit->input_filename);
         }
+    }
 
-        char is_fixed_form  = (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
-                // We prescan from fixed to free if 
-                //  - the file is fixed form OR we are forced to be fixed for (--fixed)
-                //  - AND we were NOT told to be DELETE form (--free)
-                && (BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_FIXED_FORM)
-                    || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_FIXED_FORM))
-                && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_FREE_FORM)
-                && !CURRENT_CONFIGURATION->pass_through);
+    char is_fixed_form = translation_unit_is_fixed_form(current_extension);
 
 #ifndef FORTRAN_NEW_SCANNER
-        if (is_fixed_form)
-        {
-            timing_t timing_prescanning;
-
-            timing_start(&timing_prescanning);
-            parsed_filename = fortran_prescan_file(translation_unit, parsed_filename, preprocessed);
-            timing_end(&timing_prescanning);
+    if (is_fixed_form)
+    {
+        timing_t timing_prescanning;
 
-            if (parsed_filename != NULL
-                    && CURRENT_CONFIGURATION->verbose)
-            {
-                fprintf(stderr, "File '%s' converted from fixed to free form in %.2f seconds\n",
-                        parsed_filename,
-                        timing_elapsed(&timing_prescanning));
-            }
+        timing_start(&timing_prescanning);
+        parsed_filename = fortran_prescan_file(translation_unit, parsed_filename, preprocessed);
+        timing_end(&timing_prescanning);
 
-            if (parsed_filename == NULL)
-            {
-                fatal_error("Conversion from fixed Fortran form to free Fortran form failed for file '%s'\n",
-                        translation_unit->input_filename);
-            }
+        if (parsed_filename != NULL
+                && CURRENT_CONFIGURATION->verbose)
+        {
+            fprintf(stderr, "File '%s' converted from fixed to free form in %.2f seconds\n",
+                    parsed_filename,
+                    timing_elapsed(&timing_prescanning));
+        }
 
-            is_fixed_form = 0;
+        if (parsed_filename == NULL)
+        {
+            fatal_error("Conversion from fixed Fortran form to free Fortran form failed for file '%s'\n",
+                    translation_unit->input_filename);
         }
+
+        is_fixed_form = 0;
+    }
 #endif
 
-        if (!CURRENT_CONFIGURATION->do_not_parse)
+    if (!CURRENT_CONFIGURATION->do_not_parse)
+    {
+        if (!CURRENT_CONFIGURATION->pass_through
+                && !file_not_processed)
         {
-            if (!CURRENT_CONFIGURATION->pass_through
-                    && !file_not_processed)
-            {
-                // * Do this before open for scan since we might to internally parse some sources
-                mcxx_flex_debug = mc99_flex_debug = debug_options.debug_lexer;
-                mcxxdebug = mc99debug = debug_options.debug_parser;
-                mf03_flex_debug = debug_options.debug_lexer;
-                mf03debug = debug_options.debug_parser;
+            // * Do this before open for scan since we might to internally parse some sources
+            mcxx_flex_debug = mc99_flex_debug = debug_options.debug_lexer;
+            mcxxdebug = mc99debug = debug_options.debug_parser;
+            mf03_flex_debug = debug_options.debug_lexer;
+            mf03debug = debug_options.debug_parser;
+
+            // Load codegen if not yet loaded
+            ensure_codegen_is_loaded();
+
+            // Initialize diagnostics
+            diagnostics_reset();
 
-                // Load codegen if not yet loaded
-                ensure_codegen_is_loaded();
+            // Fill the context with initial information
+            initialize_semantic_analysis(translation_unit, parsed_filename);
 
-                // Initialize diagnostics
-                diagnostics_reset();
+            if (debug_options.benchmark_lexer)
+            {
+                benchmark_lexer(translation_unit, parsed_filename);
+            }
 
-                // Fill the context with initial information
-                initialize_semantic_analysis(translation_unit, parsed_filename);
+            // Only the parser allocates its nodes in an arena, released once
+            // the translation unit has been completely processed. Everything
+            // built by semantic analysis may end in global caches so it
+            // stays in the heap
+            translation_unit->parse_arena = ast_arena_new();
+            ast_arena_t* previous_arena = ast_arena_set_current(translation_unit->parse_arena);
 
-                // * Open file
-                CXX_LANGUAGE()
+            // * Open file
+            CXX_LANGUAGE()
+            {
+                if (mcxx_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
                 {
-                    if (mcxx_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
-                    {
-                        fatal_error("Could not open file '%s'", parsed_filename);
-                    }
+                    fatal_error("Could not open file '%s'", parsed_filename);
                 }
+            }
 
-                C_LANGUAGE()
+            C_LANGUAGE()
+            {
+                if (mc99_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
                 {
-                    if (mc99_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
-                    {
-                        fatal_error("Could not open file '%s'", parsed_filename);
-                    }
+                    fatal_error("Could not open file '%s'", parsed_filename);
                 }
+            }
 
-                FORTRAN_LANGUAGE()
+            FORTRAN_LANGUAGE()
+            {
+                if (mf03_open_file_for_scanning(parsed_filename, translation_unit->input_filename, is_fixed_form) != 0)
                 {
-                    if (mf03_open_file_for_scanning(parsed_filename, translation_unit->input_filename, is_fixed_form) != 0)
-                    {
-                        fatal_error("Could not open file '%s'", parsed_filename);
-                    }
+                    fatal_error("Could not open file '%s'", parsed_filename);
                 }
+            }
 
-                // * Parse file
-                parse_translation_unit(translation_unit, parsed_filename);
-                // The scanner automatically closes the file
+            // * Parse file
+            parse_translation_unit(translation_unit, parsed_filename);
+            // The scanner automatically closes the file
 
-                if (debug_options.print_ast_graphviz)
-                {
-                    fprintf(stderr, "Printing parse tree in graphviz format\n");
+            ast_arena_set_current(previous_arena);
 
-                    ast_dump_graphviz(translation_unit->parsed_tree, stdout);
-                }
+            if (debug_options.print_ast_graphviz)
+            {
+                fprintf(stderr, "Printing parse tree in graphviz format\n");
 
-                // * Prepare DTO
-                initialize_dto(translation_unit);
+                ast_dump_graphviz(translation_unit->parsed_tree, stdout);
+            }
 
-                // * TL::pre_run
-                compiler_phases_pre_execution(CURRENT_CONFIGURATION, translation_unit, parsed_filename);
+            // * Prepare DTO
+            initialize_dto(translation_unit);
 
-                // * Semantic analysis
-                semantic_analysis(translation_unit, parsed_filename);
+            // * TL::pre_run
+            compiler_phases_pre_execution(CURRENT_CONFIGURATION, translation_unit, parsed_filename);
 
-                // * Check nodecl generated by semantic analysis
-                timing_t timing_check_tree;
-                if (CURRENT_CONFIGURATION->verbose)
-                {
-                    fprintf(stderr, "Checking integrity of nodecl tree\n");
-                }
-                // This checks links
-                timing_start(&timing_check_tree);
-                if (!ast_check(nodecl_get_ast(translation_unit->nodecl)))
-                {
-                    internal_error("Invalid nodecl tree generated by the frontend\n", 0);
-                }
-                // This checks structure
-                nodecl_check_tree(nodecl_get_ast(translation_unit->nodecl));
-                timing_end(&timing_check_tree);
-                if (CURRENT_CONFIGURATION->verbose)
-                {
-                    fprintf(stderr, "Nodecl integrity verified in %.2f seconds\n",
-                            timing_elapsed(&timing_check_tree));
-                }
+            // * Semantic analysis
+            semantic_analysis(translation_unit, parsed_filename);
 
-                // * TL::run and TL::phase_cleanup
-                compiler_phases_execution(CURRENT_CONFIGURATION, translation_unit, parsed_filename);
+            // * Check nodecl generated by semantic analysis
+            timing_t timing_check_tree;
+            if (CURRENT_CONFIGURATION->verbose)
+            {
+                fprintf(stderr, "Checking integrity of nodecl tree\n");
+            }
+            // This checks links
+            timing_start(&timing_check_tree);
+            if (!ast_check(nodecl_get_ast(translation_unit->nodecl)))
+            {
+                internal_error("Invalid nodecl tree generated by the frontend\n", 0);
+            }
+            // This checks structure
+            nodecl_check_tree(nodecl_get_ast(translation_unit->nodecl));
+            timing_end(&timing_check_tree);
+            if (CURRENT_CONFIGURATION->verbose)
+            {
+                fprintf(stderr, "Nodecl integrity verified in %.2f seconds\n",
+                        timing_elapsed(&timing_check_tree));
+            }
 
-                // * print ast if requested
-                if (debug_options.print_nodecl_graphviz)
-                {
-                    fprintf(stderr, "Printing nodecl tree in graphviz format\n");
+            // * TL::run and TL::phase_cleanup
+            compiler_phases_execution(CURRENT_CONFIGURATION, translation_unit, parsed_filename);
 
-                    ast_dump_graphviz(nodecl_get_ast(translation_unit->nodecl), stdout);
-                }
-                else if (debug_options.print_nodecl_html)
-                {
-                    fprintf(stderr, "Printing nodecl tree in HTML format\n");
-                    ast_dump_html(nodecl_get_ast(translation_unit->nodecl), stdout);
-                }
+            // * print ast if requested
+            if (debug_options.print_nodecl_graphviz)
+            {
+                fprintf(stderr, "Printing nodecl tree in graphviz format\n");
 
-                // * print symbol table if requested
-                if (debug_options.print_scope)
-                {
-                    fprintf(stderr, "============ SYMBOL TABLE ===============\n");
-                    print_scope(translation_unit->global_decl_context);
-                    fprintf(stderr, "========= End of SYMBOL TABLE ===========\n");
-                }
+                ast_dump_graphviz(nodecl_get_ast(translation_unit->nodecl), stdout);
+            }
+            else if (debug_options.print_nodecl_html)
+            {
+                fprintf(stderr, "Printing nodecl tree in HTML format\n");
+                ast_dump_html(nodecl_get_ast(translation_unit->nodecl), stdout);
             }
 
-            // * Codegen
-            const char* prettyprinted_filename = NULL;
-            if (!file_not_processed
-                    && !debug_options.do_not_codegen)
+            // * print symbol table if requested
+            if (debug_options.print_scope)
             {
-                prettyprinted_filename
-                    = codegen_translation_unit(translation_unit, parsed_filename);
+                fprintf(stderr, "============ SYMBOL TABLE ===============\n");
+                print_scope(translation_unit->global_decl_context);
+                fprintf(stderr, "========= End of SYMBOL TABLE ===========\n");
             }
+        }
 
-            timing_t timing_free_tree;
-            if (CURRENT_CONFIGURATION->verbose)
+        // Only the phases of this file may extend the modules it wrote
+        FORTRAN_LANGUAGE()
+        {
+            fortran_close_module_databases();
+        }
+
+        // * Codegen
+        const char* prettyprinted_filename = NULL;
+        if (!file_not_processed
+                && !debug_options.do_not_codegen)
+        {
+            prettyprinted_filename
+                = codegen_translation_unit(translation_unit, parsed_filename);
+        }
+
+        timing_t timing_free_tree;
+        if (CURRENT_CONFIGURATION->verbose)
+        {
+            DEBUG_CODE()
             {
-                DEBUG_CODE()
-                {
-                    fprintf(stderr, "Freeing nodecl tree\n");
-                }
+                fprintf(stderr, "Freeing nodecl tree\n");
             }
-            timing_start(&timing_free_tree);
-            nodecl_free(translation_unit->nodecl);
-            timing_end(&timing_free_tree);
-            if (CURRENT_CONFIGURATION->verbose)
+        }
+        timing_start(&timing_free_tree);
+        nodecl_free(translation_unit->nodecl);
+        timing_end(&timing_free_tree);
+        if (CURRENT_CONFIGURATION->verbose)
+        {
+            DEBUG_CODE()
             {
-                DEBUG_CODE()
-                {
-                    fprintf(stderr, "Nodecl tree freed in %.2f seconds\n", timing_elapsed(&timing_free_tree));
-                }
+                fprintf(stderr, "Nodecl tree freed in %.2f seconds\n", timing_elapsed(&timing_free_tree));
             }
+        }
 
-            // * Recursively process secondary translation units
-            if (file_process->num_secondary_translation_units != 0)
+        // * Release the nodes of the parse tree
+        ambiguity_memo_reset();
+        overload_ics_cache_reset();
+        scope_lookup_memo_reset();
+        koenig_lookup_reset();
+        deduction_cache_reset();
+        ast_arena_release(translation_unit->parse_arena);
+        translation_unit->parse_arena = NULL;
+
+        // * Recursively process secondary translation units
+        if (file_process->num_secondary_translation_units != 0)
+        {
+            if (CURRENT_CONFIGURATION->verbose)
             {
-                if (CURRENT_CONFIGURATION->verbose)
-                {
-                    fprintf(stderr, "\nThere are secondary translation units for '%s'. Processing.\n",
-                            translation_unit->input_filename);
-                }
-                compile_every_translation_unit_aux_(
-                        file_process->num_secondary_translation_units,
-                        file_process->secondary_translation_units);
-
-                if (CURRENT_CONFIGURATION->verbose)
-                {
-                    fprintf(stderr, "All secondary translation units of '%s' have been processed\n\n",
-                            translation_unit->input_filename);
-                }
+                fprintf(stderr, "\nThere are secondary translation units for '%s'. Processing.\n",
+                        translation_unit->input_filename);
             }
+            compile_every_translation_unit_aux_(
+                    file_process->num_secondary_translation_units,
+                    file_process->secondary_translation_units);
 
-            // * Hide all the wrap modules lest they were found by the native compiler
-            if (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
-                    && !CURRENT_CONFIGURATION->do_not_compile)
+            if (CURRENT_CONFIGURATION->verbose)
             {
-                driver_fortran_hide_mercurium_modules();
+                fprintf(stderr, "All secondary translation units of '%s' have been processed\n\n",
+                        translation_unit->input_filename);
             }
+        }
 
-            if (!BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_DO_NOT_COMPILE))
+        // * Hide all the wrap modules lest they were found by the native compiler
+        if (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
+                && !CURRENT_CONFIGURATION->do_not_compile)
+        {
+            driver_fortran_hide_mercurium_modules();
+        }
+
+        if (!BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_DO_NOT_COMPILE))
+        {
+            // * Native compilation
+            if (!file_not_processed)
             {
-                // * Native compilation
-                if (!file_not_processed)
-                {
-                    native_compilation(translation_unit, prettyprinted_filename, /* remove_input */ 1);
-                }
-                else
-                {
-                    // Do not process
-                    native_compilation(translation_unit, translation_unit->input_filename, /* remove_input */ 0);
-                }
+                native_compilation(translation_unit, prettyprinted_filename, /* remove_input */ 1);
             }
-
-            // * Restore all the wrap modules for subsequent uses
-            if (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
-                    && !CURRENT_CONFIGURATION->do_not_compile)
+            else
             {
-                driver_fortran_restore_mercurium_modules();
+                // Do not process
+                native_compilation(translation_unit, translation_unit->input_filename, /* remove_input */ 0);
             }
-            //
-            // * Wrap all the modules of Fortran, only if native compilation was actually performed
-            if (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN)
+        }
+
+        // * Restore all the wrap modules for subsequent uses
+        if (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
+                && !CURRENT_CONFIGURATION->do_not_compile)
+        {
+            driver_fortran_restore_mercurium_modules();
+        }
+        //
+        // * Wrap all the modules of Fortran, only if native compilation was actually performed
+        if (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN)
+        {
+            if (!CURRENT_CONFIGURATION->do_not_wrap_fortran_modules)
             {
-                if (!CURRENT_CONFIGURATION->do_not_wrap_fortran_modules)
+                if (!CURRENT_CONFIGURATION->do_not_compile)
                 {
-                    if (!CURRENT_CONFIGURATION->do_not_compile)
-                    {
-                        // Wrap .mf03 along with .mod files
-                        driver_fortran_wrap_all_modules();
-                    }
-                    else
-                    {
-                        // Remove .mf03 files when wrapping is enabled but we
-                        // are not calling the native compiler
-                        driver_fortran_discard_all_modules();
-                    }
+                    // Wrap .mf03 along with .mod files
+                    driver_fortran_wrap_all_modules();
+                }
+                else
+                {
+                    // Remove .mf03 files when wrapping is enabled but we
+                    // are not calling the native compiler
+                    driver_fortran_discard_all_modules();
                 }
             }
         }
-
-        // * Restore CUDA flag
-        // FIXME. Is this the best place for this?
-        CURRENT_CONFIGURATION->enable_cuda = old_cuda_flag;
-
-        // * This file has already been compiled
-        file_process->already_compiled = 1;
     }
 
-    // Restore previous state
-    SET_CURRENT_FILE_PROCESS(saved_file_process);
-    SET_CURRENT_CONFIGURATION(saved_configuration);
-#undef return
+    // * Restore CUDA flag
+    // FIXME. Is this the best place for this?
+    CURRENT_CONFIGURATION->enable_cuda = old_cuda_flag;
 }
 
-static void compile_every_translation_unit(void)
+static void write_secondary_translation_units(FILE* results,
+        compilation_file_process_t* file_process,
+        int parent_index,
+        int *num_secondary)
 {
-    compile_every_translation_unit_aux_(compilation_process.num_translation_units,
-            compilation_process.translation_units);
-}
+    int i;
+    for (i = 0; i < file_process->num_secondary_translation_units; i++)
+    {
+        compilation_file_process_t* secondary = file_process->secondary_translation_units[i];
+        int current_index = *num_secondary;
+        (*num_secondary)++;
 
-static void compiler_phases_pre_execution(
+        fprintf(results, "secondary\t%d\t%d\t%s\t%s\t%s\n",
+                parent_index,
+                secondary->tag,
+                secondary->compilation_configuration->configuration_name,
+                secondary->translation_unit->output_filename != NULL
+                ? secondary->translation_unit->output_filename : "",
+                secondary->translation_unit->input_filename);
+
+        write_secondary_translation_units(results, secondary, current_index, num_secondary);
+    }
+}
+
+// This is run in a worker of the driver
+static void compile_translation_unit_in_worker(void* data, FILE* results)
+{
+    compilation_file_process_t* file_process = (compilation_file_process_t*)data;
+
+    compile_translation_unit(file_process);
+
+    if (file_process->translation_unit->output_filename != NULL)
+    {
+        fprintf(results, "output\t%s\n", file_process->translation_unit->output_filename);
+    }
+
+    // The driver needs the secondary translation units for embedding
+    int num_secondary = 0;
+    write_secondary_translation_units(results, file_process, /* parent_index */ -1, &num_secondary);
+}
+
+static compilation_configuration_t* get_configuration_by_name(const char* configuration_name)
+{
+    int i;
+    for (i = 0; i < compilation_process.num_configurations; i++)
+    {
+        if (strcmp(compilation_process.configuration_set[i]->configuration_name, configuration_name) == 0)
+            return compilation_process.configuration_set[i];
+    }
+    return NULL;
+}
+
+// This is run in the driver once the worker has finished
+static void compile_translation_unit_finished(void* data,
+        int num_results,
+        driver_job_result_t* results)
+{
+    compilation_file_process_t* file_process = (compilation_file_process_t*)data;
+
+    int num_secondary = 0;
+    compilation_file_process_t** secondary_list = NULL;
+
+    int i;
+    for (i = 0; i < num_results; i++)
+    {
+        driver_job_result_t* current_result = &results[i];
+
+        if (current_result->num_fields == 2
+                && strcmp(current_result->fields[0], "output") == 0)
+        {
+            file_process->translation_unit->output_filename = current_result->fields[1];
+        }
+        else if (current_result->num_fields == 6
+                && strcmp(current_result->fields[0], "secondary") == 0)
+        {
+            int parent_index = atoi(current_result->fields[1]);
+            ERROR_CONDITION(parent_index >= num_secondary, "Invalid secondary translation unit", 0);
+
+            compilation_file_process_t* parent_file_process =
+                (parent_index < 0) ? file_process : secondary_list[parent_index];
+
+            compilation_configuration_t* configuration = get_configuration_by_name(current_result->fields[3]);
+            ERROR_CONDITION(configuration == NULL, "Configuration '%s' not found\n", current_result->fields[3]);
+
+            translation_unit_t* translation_unit = add_new_file_to_compilation_process(
+                    parent_file_process,
+                    current_result->fields[5],
+                    /* output_file */ NULL,
+                    configuration,
+                    atoi(current_result->fields[2]));
+            if (current_result->fields[4][0] != '\0')
+            {
+                translation_unit->output_filename = current_result->fields[4];
+            }
+
+            compilation_file_process_t* secondary = parent_file_process->secondary_translation_units[
+                parent_file_process->num_secondary_translation_units - 1];
+            secondary->already_compiled = 1;
+
+            P_LIST_ADD(secondary_list, num_secondary, secondary);
+        }
+        else
+        {
+            internal_error("Invalid result of worker", 0);
+        }
+    }
+
+    DELETE(secondary_list);
+}
+
+typedef struct fortran_file_dependences_tag fortran_file_dependences_t;
+struct fortran_file_dependences_tag
+{
+    compilation_file_process_t* file_process;
+
+    int num_provided_modules;
+    const char** provided_modules;
+
+    int num_required_modules;
+    const char** required_modules;
+
+    // Files of the same set that define the modules required by this one
+    int num_providers;
+    fortran_file_dependences_t** providers;
+
+    char submitted;
+    driver_job_t* job;
+};
+
+typedef struct fortran_dependences_tag
+{
+    int num_files;
+    fortran_file_dependences_t** files;
+} fortran_dependences_t;
+
+static char translation_unit_is_fortran(compilation_file_process_t* file_process)
+{
+    const char* extension = get_extension_filename(file_process->translation_unit->input_filename);
+    struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+
+    return current_extension->source_language == SOURCE_LANGUAGE_FORTRAN;
+}
+
+static void scan_fortran_file_dependences(fortran_file_dependences_t* file)
+{
+    translation_unit_t* translation_unit = file->file_process->translation_unit;
+
+    const char* extension = get_extension_filename(translation_unit->input_filename);
+    struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Scanning module dependences of file '%s'\n", translation_unit->input_filename);
+    }
+
+    const char* scanned_filename = translation_unit->input_filename;
+    if (translation_unit_needs_preprocessing(current_extension))
+    {
+        scanned_filename = preprocess_translation_unit_with_language_preprocessor(translation_unit);
+        if (scanned_filename == NULL)
+        {
+            fatal_error("Preprocess failed for file '%s'", translation_unit->input_filename);
+        }
+
+        // Compiling the file will reuse this preprocessed file
+        register_preprocessed_translation_unit(translation_unit, scanned_filename);
+    }
+
+    mf03_scan_module_dependences(scanned_filename,
+            translation_unit->input_filename,
+            translation_unit_is_fixed_form(current_extension),
+            &file->num_provided_modules,
+            &file->provided_modules,
+            &file->num_required_modules,
+            &file->required_modules);
+}
+
+// Scans every Fortran file not compiled yet. The providers of a module are
+// looked up in command line order
+static void scan_fortran_dependences(int num_translation_units,
+        compilation_file_process_t** translation_units,
+        fortran_dependences_t* dependences)
+{
+    memset(dependences, 0, sizeof(*dependences));
+
+    compilation_file_process_t* saved_file_process = CURRENT_FILE_PROCESS;
+    compilation_configuration_t* saved_configuration = CURRENT_CONFIGURATION;
+
+    int i;
+    for (i = 0; i < num_translation_units; i++)
+    {
+        compilation_file_process_t* file_process = translation_units[i];
+
+        if (file_process->already_compiled
+                || !translation_unit_is_fortran(file_process)
+                // -E and -y write their output where the user told us
+                || file_process->compilation_configuration->do_not_parse
+                || file_process->compilation_configuration->pass_through)
+            continue;
+
+        // See compile_every_translation_unit_aux_
+        SET_CURRENT_FILE_PROCESS(file_process);
+        SET_CURRENT_CONFIGURATION(file_process->compilation_configuration);
+
+        fortran_file_dependences_t* file = NEW0(fortran_file_dependences_t);
+        file->file_process = file_process;
+
+        scan_fortran_file_dependences(file);
+
+        P_LIST_ADD(dependences->files, dependences->num_files, file);
+    }
+
+    SET_CURRENT_FILE_PROCESS(saved_file_process);
+    SET_CURRENT_CONFIGURATION(saved_configuration);
+
+    for (i = 0; i < dependences->num_files; i++)
+    {
+        fortran_file_dependences_t* file = dependences->files[i];
+
+        int j;
+        for (j = 0; j < file->num_required_modules; j++)
+        {
+            int k;
+            for (k = 0; k < dependences->num_files; k++)
+            {
+                fortran_file_dependences_t* provider = dependences->files[k];
+                if (provider == file)
+                    continue;
+
+                char found = 0;
+                int m;
+                for (m = 0; m < provider->num_provided_modules && !found; m++)
+                {
+                    // Names are uniquestr'd lowercase
+                    found = (provider->provided_modules[m] == file->required_modules[j]);
+                }
+
+                if (found)
+                {
+                    P_LIST_ADD_ONCE(file->providers, file->num_providers, provider);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void free_fortran_dependences(fortran_dependences_t* dependences)
+{
+    int i;
+    for (i = 0; i < dependences->num_files; i++)
+    {
+        fortran_file_dependences_t* file = dependences->files[i];
+        DELETE(file->provided_modules);
+        DELETE(file->required_modules);
+        DELETE(file->providers);
+        DELETE(file);
+    }
+    DELETE(dependences->files);
+    memset(dependences, 0, sizeof(*dependences));
+}
+
+// Same object name as native_compilation
+static const char* fortran_dependences_object_filename(fortran_file_dependences_t* file)
+{
+    char temp[256];
+    strncpy(temp, give_basename(file->file_process->translation_unit->input_filename), 255);
+    temp[255] = '\0';
+    char* p = strrchr(temp, '.');
+    if (p != NULL)
+    {
+        *p = '\0';
+    }
+
+    return strappend(temp, ".o");
+}
+
+static void print_make_dependences(FILE* f, fortran_dependences_t* dependences)
+{
+    int i;
+    for (i = 0; i < dependences->num_files; i++)
+    {
+        fortran_file_dependences_t* file = dependences->files[i];
+        const char* input_filename = file->file_process->translation_unit->input_filename;
+
+        int j;
+        fprintf(f, "# %s provides:", input_filename);
+        for (j = 0; j < file->num_provided_modules; j++)
+        {
+            fprintf(f, " %s", file->provided_modules[j]);
+        }
+        fprintf(f, "\n# %s requires:", input_filename);
+        for (j = 0; j < file->num_required_modules; j++)
+        {
+            fprintf(f, " %s", file->required_modules[j]);
+        }
+        fprintf(f, "\n");
+
+        fprintf(f, "%s: %s", fortran_dependences_object_filename(file), input_filename);
+        for (j = 0; j < file->num_providers; j++)
+        {
+            fprintf(f, " %s", fortran_dependences_object_filename(file->providers[j]));
+        }
+        fprintf(f, "\n");
+    }
+}
+
+static void print_json_string(FILE* f, const char* str)
+{
+    fprintf(f, "\"");
+    const char* p;
+    for (p = str; *p != '\0'; p++)
+    {
+        if (*p == '"' || *p == '\\')
+        {
+            fprintf(f, "\\%c", *p);
+        }
+        else if ((unsigned char)*p < 0x20)
+        {
+            fprintf(f, "\\u%04x", (unsigned char)*p);
+        }
+        else
+        {
+            fputc(*p, f);
+        }
+    }
+    fprintf(f, "\"");
+}
+
+static void print_json_string_list(FILE* f, int num_strings, const char** strings)
+{
+    fprintf(f, "[");
+    int i;
+    for (i = 0; i < num_strings; i++)
+    {
+        if (i > 0)
+            fprintf(f, ", ");
+        print_json_string(f, strings[i]);
+    }
+    fprintf(f, "]");
+}
+
+static void print_json_dependences(FILE* f, fortran_dependences_t* dependences)
+{
+    fprintf(f, "{\n  \"files\": [");
+    int i;
+    for (i = 0; i < dependences->num_files; i++)
+    {
+        fortran_file_dependences_t* file = dependences->files[i];
+
+        fprintf(f, "%s\n    {\n      \"source\": ", i > 0 ? "," : "");
+        print_json_string(f, file->file_process->translation_unit->input_filename);
+        fprintf(f, ",\n      \"object\": ");
+        print_json_string(f, fortran_dependences_object_filename(file));
+        fprintf(f, ",\n      \"provides\": ");
+        print_json_string_list(f, file->num_provided_modules, file->provided_modules);
+        fprintf(f, ",\n      \"requires\": ");
+        print_json_string_list(f, file->num_required_modules, file->required_modules);
+
+        int num_depends = 0;
+        const char** depends = NULL;
+        int j;
+        for (j = 0; j < file->num_providers; j++)
+        {
+            P_LIST_ADD(depends, num_depends,
+                    file->providers[j]->file_process->translation_unit->input_filename);
+        }
+        fprintf(f, ",\n      \"depends\": ");
+        print_json_string_list(f, num_depends, depends);
+        DELETE(depends);
+
+        fprintf(f, "\n    }");
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
+
+// Implements --scan-deps: nothing is compiled nor linked
+static void scan_every_translation_unit(void)
+{
+    fortran_dependences_t dependences;
+    scan_fortran_dependences(compilation_process.num_translation_units,
+            compilation_process.translation_units,
+            &dependences);
+
+    const char* output_filename = compilation_process.scan_dependences_output_filename;
+
+    FILE* f = stdout;
+    if (output_filename != NULL
+            && strcmp(output_filename, "-") != 0)
+    {
+        f = fopen(output_filename, "w");
+        if (f == NULL)
+        {
+            fatal_error("Cannot open file '%s' for writing. %s\n",
+                    output_filename,
+                    strerror(errno));
+        }
+    }
+
+    switch (compilation_process.scan_dependences)
+    {
+        case SCAN_DEPENDENCES_MAKE:
+            {
+                print_make_dependences(f, &dependences);
+                break;
+            }
+        case SCAN_DEPENDENCES_JSON:
+            {
+                print_json_dependences(f, &dependences);
+                break;
+            }
+        default:
+            internal_error("Invalid dependences format", 0);
+    }
+
+    if (f != stdout)
+    {
+        fclose(f);
+    }
+
+    free_fortran_dependences(&dependences);
+}
+
+static char fortran_file_is_ready(fortran_file_dependences_t* file)
+{
+    int i;
+    for (i = 0; i < file->num_providers; i++)
+    {
+        if (file->providers[i]->job == NULL
+                || !driver_jobs_succeeded(file->providers[i]->job))
+            return 0;
+    }
+    return 1;
+}
+
+// Returns the first file whose providers have been compiled, waiting for
+// running workers if none is ready. If nothing is running the remaining
+// files depend on each other so they are taken in command line order
+static fortran_file_dependences_t* fortran_dependences_next(fortran_dependences_t* dependences)
+{
+    for (;;)
+    {
+        fortran_file_dependences_t* first_pending = NULL;
+
+        int i;
+        for (i = 0; i < dependences->num_files; i++)
+        {
+            fortran_file_dependences_t* file = dependences->files[i];
+            if (file->submitted)
+                continue;
+
+            if (first_pending == NULL)
+                first_pending = file;
+
+            if (fortran_file_is_ready(file))
+                return file;
+        }
+
+        if (first_pending == NULL)
+            return NULL;
+
+        if (!driver_jobs_wait_one())
+            return first_pending;
+    }
+}
+
+// Compiles the Fortran files in workers, each one once the files defining
+// the modules it uses have been compiled
+static void compile_fortran_translation_units_in_parallel(int num_translation_units,
+        compilation_file_process_t** translation_units)
+{
+    int num_fortran_files = 0;
+    int i;
+    for (i = 0; i < num_translation_units; i++)
+    {
+        compilation_file_process_t* file_process = translation_units[i];
+        if (!file_process->already_compiled
+                && translation_unit_is_fortran(file_process)
+                // -E and -y write their output where the user told us
+                && !file_process->compilation_configuration->do_not_parse
+                && !file_process->compilation_configuration->pass_through)
+            num_fortran_files++;
+    }
+
+    if (num_fortran_files < 2)
+        return;
+
+    fortran_dependences_t dependences;
+    scan_fortran_dependences(num_translation_units, translation_units, &dependences);
+
+    fortran_file_dependences_t* file;
+    while ((file = fortran_dependences_next(&dependences)) != NULL)
+    {
+        compilation_file_process_t* file_process = file->file_process;
+        file->submitted = 1;
+
+        // See compile_every_translation_unit_aux_
+        SET_CURRENT_FILE_PROCESS(file_process);
+        SET_CURRENT_CONFIGURATION(file_process->compilation_configuration);
+
+        load_compiler_phases(CURRENT_CONFIGURATION);
+        // Load codegen now so every worker inherits it
+        ensure_codegen_is_loaded();
+
+        file->job = driver_jobs_submit(file_process->translation_unit->input_filename,
+                compile_translation_unit_in_worker,
+                compile_translation_unit_finished,
+                file_process);
+
+        file_process->already_compiled = 1;
+    }
+
+    free_fortran_dependences(&dependences);
+}
+
+static void compile_every_translation_unit_aux_(int num_translation_units,
+        compilation_file_process_t** translation_units)
+{
+    // This is just to avoid having a return in this function by mistake
+#define return 1 = 1;
+    // Save the old current file
+    compilation_file_process_t* saved_file_process = CURRENT_FILE_PROCESS;
+    compilation_configuration_t* saved_configuration = CURRENT_CONFIGURATION;
+
+    // Fortran files are submitted first in the order their modules require
+    if (driver_jobs_enabled())
+    {
+        compile_fortran_translation_units_in_parallel(num_translation_units, translation_units);
+    }
+
+    int i;
+    for (i = 0; i < num_translation_units; i++)
+    {
+        compilation_file_process_t* file_process = translation_units[i];
+
+        // Ensure we do not get in a strange loop
+        if (file_process->already_compiled)
+            continue;
+
+        // Note: This, along with the Fortran dependence scan and scheduling
+        // above, is the only place where CURRENT_{FILE_PROCESS,CONFIGURATION}
+        // can be changed. Everywhere else these two variables are constants.
+        // Whenever you modify SET_CURRENT_FILE_PROCESS update also
+        // SET_CURRENT_CONFIGURATION to its configuration
+        SET_CURRENT_FILE_PROCESS(file_process);
+        // This looks a bit redundant but it turns that the compiler has a
+        // configuration even before of any file
+        SET_CURRENT_CONFIGURATION(file_process->compilation_configuration);
+
+        translation_unit_t* translation_unit = CURRENT_COMPILED_FILE;
+
+        // Ensure phases are loaded for current profile
+        load_compiler_phases(CURRENT_CONFIGURATION);
+
+        // First check the file type
+        const char* extension = get_extension_filename(translation_unit->input_filename);
+
+        struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+
+        // Linker data is not processed anymore
+        if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA)
+        {
+            file_process->already_compiled = 1;
+            continue;
+        }
+
+        // Fortran files left here were not scheduled by their module
+        // dependences so they are compiled one after the other
+        if (driver_jobs_enabled()
+                && current_extension->source_language != SOURCE_LANGUAGE_FORTRAN)
+        {
+            // Load codegen now so every worker inherits it
+            ensure_codegen_is_loaded();
+
+            driver_jobs_submit(translation_unit->input_filename,
+                    compile_translation_unit_in_worker,
+                    compile_translation_unit_finished,
+                    file_process);
+        }
+        else
+        {
+            // Files compiled by the driver itself must wait previous workers
+            // so diagnostics are emitted in order
+            if (driver_jobs_enabled())
+            {
+                driver_jobs_wait_all();
+            }
+
+            // Preprocess the next file while we compile this one
+            if (!driver_jobs_enabled()
+                    && i + 1 < num_translation_units)
+            {
+                preprocess_translation_unit_ahead(translation_units[i + 1]);
+            }
+
+            compile_translation_unit(file_process);
+        }
+
+        // * This file has already been compiled
+        file_process->already_compiled = 1;
+    }
+
+    driver_jobs_wait_all();
+
+    // Restore previous state
+    SET_CURRENT_FILE_PROCESS(saved_file_process);
+    SET_CURRENT_CONFIGURATION(saved_configuration);
+#undef return
+}
+
+static void compile_every_translation_unit(void)
+{
+    compile_every_translation_unit_aux_(compilation_process.num_translation_units,
+            compilation_process.translation_units);
+}
+
+static void compiler_phases_pre_execution(
         compilation_configuration_t* config,
         translation_unit_t* translation_unit,
         const char* parsed_filename UNUSED_PARAMETER)
@@ -3548,6 +4249,90 @@ static void initialize_semantic_analysis(translation_unit_t* translation_unit,
     }
 }
 
+static int count_ast_nodes(AST a)
+{
+    if (a == NULL)
+        return 0;
+
+    int num_nodes = 1;
+    if (ASTKind(a) == AST_AMBIGUITY)
+    {
+        int i;
+        for (i = 0; i < ast_get_num_ambiguities(a); i++)
+        {
+            num_nodes += count_ast_nodes(ast_get_ambiguity(a, i));
+        }
+    }
+    else
+    {
+        int i;
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+        {
+            num_nodes += count_ast_nodes(ASTChild(a, i));
+        }
+    }
+
+    return num_nodes;
+}
+
+// Scans the whole file without parsing it, the file is opened again
+// afterwards for the actual parsing
+static void benchmark_lexer(translation_unit_t* translation_unit, const char* parsed_filename)
+{
+    if (!IS_C_LANGUAGE
+            && !IS_CXX_LANGUAGE)
+        return;
+
+    int num_tokens = 0;
+
+    timing_t timing_lexer;
+    timing_start(&timing_lexer);
+    CXX_LANGUAGE()
+    {
+        mcxx_open_file_for_scanning(parsed_filename, translation_unit->input_filename);
+        num_tokens = mcxx_lexer_count_tokens();
+    }
+    C_LANGUAGE()
+    {
+        mc99_open_file_for_scanning(parsed_filename, translation_unit->input_filename);
+        num_tokens = mc99_lexer_count_tokens();
+    }
+    timing_end(&timing_lexer);
+
+    double elapsed = timing_elapsed(&timing_lexer);
+    fprintf(stderr, "File '%s' scanned in %.4f seconds: %d tokens (%.0f tokens per second)\n",
+            translation_unit->input_filename,
+            elapsed,
+            num_tokens,
+            elapsed == 0.0 ? 0.0 : num_tokens / elapsed);
+}
+
+// Measures how long it takes to walk the tree, mostly affected by the
+// layout of the nodes in memory
+static void benchmark_ast_walk(AST a)
+{
+    enum { NUM_WALKS = 10 };
+
+    int num_nodes = 0;
+
+    timing_t timing_walk;
+    timing_start(&timing_walk);
+    int i;
+    for (i = 0; i < NUM_WALKS; i++)
+    {
+        num_nodes = count_ast_nodes(a);
+    }
+    timing_end(&timing_walk);
+
+    double elapsed = timing_elapsed(&timing_walk);
+    fprintf(stderr, "Parse tree of %d nodes (%d bytes per node) walked %d times in %.4f seconds (%.2f ns per node)\n",
+            num_nodes,
+            ast_node_size(),
+            (int)NUM_WALKS,
+            elapsed,
+            num_nodes == 0 ? 0.0 : (elapsed * 1e9) / ((double)num_nodes * NUM_WALKS));
+}
+
 static void semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename)
 {
     timing_t timing_semantic;
@@ -3619,6 +4404,11 @@ static void semantic_analysis(translation_unit_t* translation_unit, const char*
                 timing_elapsed(&timing_check_tree));
     }
 
+    if (debug_options.benchmark_ast_walk)
+    {
+        benchmark_ast_walk(translation_unit->parsed_tree);
+    }
+
     timing_t timing_free_tree;
     if (CURRENT_CONFIGURATION->verbose)
     {
@@ -3981,7 +4771,9 @@ static void warn_preprocessor_flags(
     }
 }
 
-static const char* preprocess_single_file(const char* input_filename, const char* output_filename)
+static const char* preprocess_single_file(const char* input_filename,
+        const char* output_filename,
+        driver_job_t** async_job)
 {
     int num_arguments = count_null_ended_array((void**)CURRENT_CONFIGURATION->preprocessor_options);
 
@@ -4087,6 +4879,18 @@ static const char* preprocess_single_file(const char* input_filename, const char
         return preprocessed_filename;
     }
 
+    if (async_job != NULL)
+    {
+        const char* failure_message = NULL;
+        uniquestr_sprintf(&failure_message, "Preprocess failed for file '%s'", input_filename);
+        *async_job = driver_jobs_spawn_program(failure_message,
+                CURRENT_CONFIGURATION->preprocessor_name,
+                preprocessor_options,
+                stdout_file,
+                /* finish */ NULL, /* data */ NULL);
+        return preprocessed_filename;
+    }
+
     int result_preprocess = execute_program_flags(CURRENT_CONFIGURATION->preprocessor_name,
             preprocessor_options, stdout_file, /* stderr_f */ NULL);
 
@@ -4102,16 +4906,110 @@ static const char* preprocess_single_file(const char* input_filename, const char
     }
 }
 
+typedef struct preprocessed_ahead_tag
+{
+    translation_unit_t* translation_unit;
+    driver_job_t* job;
+    const char* preprocessed_filename;
+} preprocessed_ahead_t;
+
+static int num_preprocessed_ahead = 0;
+static preprocessed_ahead_t* preprocessed_ahead = NULL;
+
+// Remembers a file already preprocessed so compiling it does not preprocess
+// it again
+static void register_preprocessed_translation_unit(translation_unit_t* translation_unit,
+        const char* preprocessed_filename)
+{
+    preprocessed_ahead_t new_preprocessed_ahead;
+    new_preprocessed_ahead.translation_unit = translation_unit;
+    new_preprocessed_ahead.job = NULL;
+    new_preprocessed_ahead.preprocessed_filename = preprocessed_filename;
+
+    P_LIST_ADD(preprocessed_ahead, num_preprocessed_ahead, new_preprocessed_ahead);
+}
+
 static const char* preprocess_translation_unit(translation_unit_t* translation_unit,
         const char* input_filename)
 {
-    return preprocess_single_file(input_filename, translation_unit->output_filename);
+    int i;
+    for (i = 0; i < num_preprocessed_ahead; i++)
+    {
+        if (preprocessed_ahead[i].translation_unit == translation_unit)
+        {
+            const char* preprocessed_filename = preprocessed_ahead[i].preprocessed_filename;
+            // Files preprocessed while scanning dependences have no job
+            if (preprocessed_ahead[i].job != NULL)
+                driver_jobs_wait(preprocessed_ahead[i].job);
+
+            num_preprocessed_ahead--;
+            preprocessed_ahead[i] = preprocessed_ahead[num_preprocessed_ahead];
+
+            return preprocessed_filename;
+        }
+    }
+
+    return preprocess_single_file(input_filename, translation_unit->output_filename, /* async_job */ NULL);
+}
+
+// Starts preprocessing the given file so it is ready once the driver gets to
+// it. Only files that compile_translation_unit would preprocess with the
+// usual preprocessor are considered
+static void preprocess_translation_unit_ahead(compilation_file_process_t* file_process)
+{
+    if (!driver_jobs_pipeline_enabled()
+            || file_process->already_compiled)
+        return;
+
+    translation_unit_t* translation_unit = file_process->translation_unit;
+    compilation_configuration_t* configuration = file_process->compilation_configuration;
+
+    int i;
+    for (i = 0; i < num_preprocessed_ahead; i++)
+    {
+        if (preprocessed_ahead[i].translation_unit == translation_unit)
+            return;
+    }
+
+    const char* extension = get_extension_filename(translation_unit->input_filename);
+    struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+
+    if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA
+            || current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
+            || configuration->source_language == SOURCE_LANGUAGE_FORTRAN
+            // -E and -y write the preprocessed output where the user told us
+            || configuration->do_not_parse
+            || configuration->pass_through)
+        return;
+
+    if (!((BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_NOT_PREPROCESSED)
+                    || BITMAP_TEST(configuration->force_source_kind, SOURCE_KIND_NOT_PREPROCESSED))
+                && !BITMAP_TEST(configuration->force_source_kind, SOURCE_KIND_PREPROCESSED)))
+        return;
+
+    compilation_file_process_t* saved_file_process = CURRENT_FILE_PROCESS;
+    compilation_configuration_t* saved_configuration = CURRENT_CONFIGURATION;
+
+    SET_CURRENT_FILE_PROCESS(file_process);
+    SET_CURRENT_CONFIGURATION(configuration);
+
+    preprocessed_ahead_t new_preprocessed_ahead;
+    new_preprocessed_ahead.translation_unit = translation_unit;
+    new_preprocessed_ahead.preprocessed_filename = preprocess_single_file(
+            translation_unit->input_filename,
+            translation_unit->output_filename,
+            &new_preprocessed_ahead.job);
+
+    P_LIST_ADD(preprocessed_ahead, num_preprocessed_ahead, new_preprocessed_ahead);
+
+    SET_CURRENT_FILE_PROCESS(saved_file_process);
+    SET_CURRENT_CONFIGURATION(saved_configuration);
 }
 
 // This one is meant to be used outside the driver. Some phases may need it
 const char* preprocess_file(const char* input_filename)
 {
-    return preprocess_single_file(input_filename, NULL);
+    return preprocess_single_file(input_filename, NULL, /* async_job */ NULL);
 }
 
 #ifndef FORTRAN_NEW_SCANNER
@@ -4212,6 +5110,27 @@ static const char* fortran_prescan_file(translation_unit_t* translation_unit, co
 }
 #endif
 
+typedef struct native_compilation_job_tag
+{
+    const char* input_filename;
+    const char* prettyprinted_filename;
+    timing_t timing_compilation;
+} native_compilation_job_t;
+
+// Only used with -v, once a pipelined native compilation has been retired
+static void native_compilation_finished(void* data)
+{
+    native_compilation_job_t* native_job = (native_compilation_job_t*)data;
+    timing_end(&native_job->timing_compilation);
+
+    fprintf(stderr, "File '%s' ('%s') natively compiled in %.2f seconds\n",
+            native_job->input_filename,
+            native_job->prettyprinted_filename,
+            timing_elapsed(&native_job->timing_compilation));
+
+    DELETE(native_job);
+}
+
 static void native_compilation(translation_unit_t* translation_unit, 
         const char* prettyprinted_filename, 
         char remove_input)
@@ -4375,6 +5294,32 @@ static void native_compilation(translation_unit_t* translation_unit,
                 prettyprinted_filename, output_object_filename);
     }
 
+    // Fortran needs the native modules right after the native compilation
+    if (driver_jobs_pipeline_enabled()
+            && CURRENT_CONFIGURATION->source_language != SOURCE_LANGUAGE_FORTRAN
+            && !debug_options.binary_check)
+    {
+        // The driver waits the native compilation before embedding and linking
+        const char* failure_message = NULL;
+        uniquestr_sprintf(&failure_message, "Native compilation failed for file '%s'",
+                translation_unit->input_filename);
+        native_compilation_job_t* native_job = NULL;
+        if (CURRENT_CONFIGURATION->verbose)
+        {
+            native_job = NEW0(native_compilation_job_t);
+            native_job->input_filename = translation_unit->input_filename;
+            native_job->prettyprinted_filename = prettyprinted_filename;
+            timing_start(&native_job->timing_compilation);
+        }
+        driver_jobs_spawn_program(failure_message,
+                CURRENT_CONFIGURATION->native_compiler_name,
+                native_compilation_args,
+                /* stdout_f */ NULL,
+                native_job != NULL ? native_compilation_finished : NULL,
+                native_job);
+        return;
+    }
+
     timing_t timing_compilation;
     timing_start(&timing_compilation);
 
@@ -5404,6 +6349,15 @@ static void print_memory_report(void)
     {
         fprintf(stderr, " - Nodes with %d real children: %d\n", i, children_real_count[i]);
     }
+    ast_arena_stats();
+
+    // -- Scopes
+    fprintf(stderr, "\n");
+    scope_lookup_memo_stats();
+
+    // -- Overload
+    fprintf(stderr, "\n");
+    overload_ics_cache_stats();
 
     fprintf(stderr, "\n");
 }
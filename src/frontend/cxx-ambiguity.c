@@ -42,6 +42,8 @@
 #include "cxx-entrylist.h"
 #include "cxx-overload.h"
 #include "cxx-diagnostic.h"
+#include "cxx-scope.h"
+#include "dhash_ptr.h"
 
 /*
  * This file performs disambiguation. If a symbol table is passed along the
@@ -50,6 +52,198 @@
  *
  */
 
+// Verdicts of the checks done on (parse tree node, context). Interpretations
+// of an ambiguity may share subtrees and the checks of a failing
+// interpretation do not replace the ambiguous nodes in them, so without
+// this the same subtrees would be checked again for every enclosing
+// interpretation
+enum ambiguity_memo_kind_tag
+{
+    AMK_INVALID = 0,
+    AMK_TRY_GENERIC,
+    AMK_TRY_INIT_DECLARATOR,
+    AMK_EXPRESSION_STATEMENT,
+    AMK_DECLARATION_STATEMENT,
+    AMK_INIT_DECLARATOR,
+};
+
+typedef struct ambiguity_memo_tag ambiguity_memo_t;
+struct ambiguity_memo_tag
+{
+    enum ambiguity_memo_kind_tag kind;
+    ambiguity_check_intepretation_fun_t* check_fun;
+    const decl_context_t* decl_context;
+    // The parts of the info of the check that decide its verdict
+    int variant;
+    // Verdicts are only valid while no symbol is declared
+    unsigned int generation;
+    char verdict;
+    // Diagnostics emitted by the check, replayed every time the verdict is
+    // reused so callers that commit them (e.g. when every interpretation
+    // fails) still report the error. NULL if there were none
+    diagnostic_context_t* diagnostics;
+
+    ambiguity_memo_t* next;
+};
+
+// A check being memoized, from ambiguity_memo_query to ambiguity_memo_record
+typedef struct ambiguity_memo_key_tag
+{
+    AST a;
+    enum ambiguity_memo_kind_tag kind;
+    ambiguity_check_intepretation_fun_t* check_fun;
+    const decl_context_t* decl_context;
+    int variant;
+
+    // The check emits its diagnostics in the current buffered context after
+    // this mark
+    diagnostic_mark_t diagnostics_mark;
+} ambiguity_memo_key_t;
+
+static dhash_ptr_t* _ambiguity_memo = NULL;
+
+// Of all the gather info, the checks only read is_friend
+static int gather_info_memo_variant(gather_decl_spec_t* gather_info)
+{
+    return gather_info != NULL
+        && gather_info->is_friend;
+}
+
+static ambiguity_memo_t* ambiguity_memo_find(ambiguity_memo_key_t* key)
+{
+    if (_ambiguity_memo == NULL)
+        return NULL;
+
+    ambiguity_memo_t* memo = (ambiguity_memo_t*)dhash_ptr_query(_ambiguity_memo, (const char*)key->a);
+    while (memo != NULL)
+    {
+        if (memo->kind == key->kind
+                && memo->check_fun == key->check_fun
+                && memo->decl_context == key->decl_context
+                && memo->variant == key->variant)
+            return memo;
+        memo = memo->next;
+    }
+
+    return NULL;
+}
+
+// Returns nonzero if the verdict of the check is known, replaying its
+// diagnostics. Otherwise the check must be run and its verdict passed to
+// ambiguity_memo_record
+static char ambiguity_memo_query(ambiguity_memo_key_t* key,
+        AST a,
+        enum ambiguity_memo_kind_tag kind,
+        ambiguity_check_intepretation_fun_t* check_fun,
+        const decl_context_t* decl_context,
+        int variant,
+        char* verdict)
+{
+    key->a = NULL;
+
+    // Heap nodes may be freed and their address reused
+    if (!ast_is_in_arena(a))
+        return 0;
+
+    key->a = a;
+    key->kind = kind;
+    key->check_fun = check_fun;
+    key->decl_context = decl_context;
+    key->variant = variant;
+
+    ambiguity_memo_t* memo = ambiguity_memo_find(key);
+    if (memo != NULL
+            && memo->generation == scope_get_generation())
+    {
+        key->a = NULL;
+
+        if (memo->diagnostics != NULL)
+        {
+            diagnostic_context_commit(diagnostic_context_new_buffered_copy(memo->diagnostics));
+        }
+
+        *verdict = memo->verdict;
+        return 1;
+    }
+
+    // Checks are almost always done in the buffered context of an
+    // interpretation. Elsewhere their diagnostics cannot be recorded
+    if (!diagnostic_context_mark(&key->diagnostics_mark))
+        key->a = NULL;
+
+    return 0;
+}
+
+// Successful try_to_solve_* replace the ambiguous node so they are not
+// remembered
+static char ambiguity_memo_remembers(enum ambiguity_memo_kind_tag kind, char verdict)
+{
+    return !verdict
+        || (kind != AMK_TRY_GENERIC
+                && kind != AMK_TRY_INIT_DECLARATOR);
+}
+
+static char ambiguity_memo_record(ambiguity_memo_key_t* key,
+        char verdict)
+{
+    if (key->a == NULL)
+        return verdict;
+
+    diagnostic_context_t* diagnostics = NULL;
+    if (ambiguity_memo_remembers(key->kind, verdict)
+            && diagnostic_context_copy_since_mark(&key->diagnostics_mark, &diagnostics))
+    {
+        if (_ambiguity_memo == NULL)
+            _ambiguity_memo = dhash_ptr_new(1024);
+
+        ambiguity_memo_t* memo = ambiguity_memo_find(key);
+        if (memo == NULL)
+        {
+            memo = NEW0(ambiguity_memo_t);
+            memo->kind = key->kind;
+            memo->check_fun = key->check_fun;
+            memo->decl_context = key->decl_context;
+            memo->variant = key->variant;
+            memo->next = (ambiguity_memo_t*)dhash_ptr_query(_ambiguity_memo, (const char*)key->a);
+            dhash_ptr_insert(_ambiguity_memo, (const char*)key->a, memo);
+        }
+        else if (memo->diagnostics != NULL)
+        {
+            diagnostic_context_discard(memo->diagnostics);
+        }
+        memo->generation = scope_get_generation();
+        memo->verdict = verdict;
+        memo->diagnostics = diagnostics;
+    }
+
+    key->a = NULL;
+
+    return verdict;
+}
+
+static void ambiguity_memo_free(const char* key UNUSED_PARAMETER, void* info, void* walk_info UNUSED_PARAMETER)
+{
+    ambiguity_memo_t* memo = (ambiguity_memo_t*)info;
+    while (memo != NULL)
+    {
+        ambiguity_memo_t* next = memo->next;
+        if (memo->diagnostics != NULL)
+            diagnostic_context_discard(memo->diagnostics);
+        DELETE(memo);
+        memo = next;
+    }
+}
+
+void ambiguity_memo_reset(void)
+{
+    if (_ambiguity_memo == NULL)
+        return;
+
+    dhash_ptr_walk(_ambiguity_memo, ambiguity_memo_free, NULL);
+    dhash_ptr_destroy(_ambiguity_memo);
+    _ambiguity_memo = NULL;
+}
+
 // Generic routines
 void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *info,
         ambiguity_check_intepretation_fun_t* ambiguity_check_intepretation,
@@ -175,13 +369,21 @@ void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *in
     ast_replace_with_ambiguity(a, valid_option);
 }
 
-static char try_to_solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *info,
+static char try_to_solve_ambiguity_generic(AST a, const decl_context_t* decl_context,
+        void *info, int memo_variant,
         ambiguity_check_intepretation_fun_t* ambiguity_check_intepretation,
         ambiguity_choose_interpretation_fun_t* ambiguity_choose_interpretation
         )
 {
     ERROR_CONDITION(ASTKind(a) != AST_AMBIGUITY, "Tree is not an ambiguity", 0);
 
+    // A successful check replaces the ambiguity, so only failures are remembered
+    ambiguity_memo_key_t memo_key;
+    char verdict = 0;
+    if (ambiguity_memo_query(&memo_key, a, AMK_TRY_GENERIC, ambiguity_check_intepretation,
+                decl_context, memo_variant, &verdict))
+        return verdict;
+
     int valid_option = -1;
 
     int i, n = ast_get_num_ambiguities(a);
@@ -225,7 +427,7 @@ static char try_to_solve_ambiguity_generic(AST a, const decl_context_t* decl_con
                 }
                 else
                 {
-                    return 0;
+                    return ambiguity_memo_record(&memo_key, /* verdict */ 0);
                 }
             }
         }
@@ -233,11 +435,11 @@ static char try_to_solve_ambiguity_generic(AST a, const decl_context_t* decl_con
 
     if (valid_option < 0)
     {
-        return 0;
+        return ambiguity_memo_record(&memo_key, /* verdict */ 0);
     }
 
     ast_replace_with_ambiguity(a, valid_option);
-    return 1;
+    return ambiguity_memo_record(&memo_key, /* verdict */ 1);
 }
 
 static int select_node_type(AST a, node_t type);
@@ -795,7 +997,8 @@ static char check_type_specifier_aux(AST type_id, const decl_context_t* decl_con
         case AST_AMBIGUITY :
             {
                 return try_to_solve_ambiguity_generic(
-                        type_id, decl_context, &allow_class_templates,
+                        type_id, decl_context,
+                        &allow_class_templates, allow_class_templates,
                         solve_ambiguity_type_specifier_check_interpretation,
                         NULL);
                 break;
@@ -1045,7 +1248,7 @@ static char check_simple_or_member_declaration(AST a, const decl_context_t* decl
 
             if (ASTKind(init_declarator) == AST_AMBIGUITY)
             {
-                if (!try_to_solve_ambiguity_generic(init_declarator, decl_context, NULL,
+                if (!try_to_solve_ambiguity_generic(init_declarator, decl_context, NULL, 0,
                             solve_typeless_init_declarator_check_interpretation, NULL))
                     return 0;
             }
@@ -1087,12 +1290,19 @@ static char check_declaration_statement(AST declaration_statement,
     // In general only AST_SIMPLE_DECLARATION gets ambiguous here
     if (ASTKind(a) == AST_SIMPLE_DECLARATION)
     {
-        return check_simple_or_member_declaration(a, decl_context, gather_info);
+        ambiguity_memo_key_t memo_key;
+        char verdict = 0;
+        if (ambiguity_memo_query(&memo_key, a, AMK_DECLARATION_STATEMENT, NULL,
+                    decl_context, gather_info_memo_variant(gather_info), &verdict))
+            return verdict;
+
+        return ambiguity_memo_record(&memo_key,
+                check_simple_or_member_declaration(a, decl_context, gather_info));
     }
     else if (ASTKind(a) == AST_AMBIGUITY)
     {
         return try_to_solve_ambiguity_generic(
-                a, decl_context, gather_info,
+                a, decl_context, gather_info, gather_info_memo_variant(gather_info),
                 solve_ambiguous_declaration_statement_check_interpretation,
                 NULL);
     }
@@ -1259,13 +1469,19 @@ static char check_typeless_declarator(AST declarator, const decl_context_t* decl
 
 static char check_expression_statement(AST a, const decl_context_t* decl_context)
 {
+    ambiguity_memo_key_t memo_key;
+    char verdict = 0;
+    if (ambiguity_memo_query(&memo_key, a, AMK_EXPRESSION_STATEMENT, NULL,
+                decl_context, /* variant */ 0, &verdict))
+        return verdict;
+
     AST expression = ASTSon0(a);
 
     nodecl_t nodecl_expr = nodecl_null();
     char result = check_expression(expression, decl_context, &nodecl_expr);
     nodecl_free(nodecl_expr);
 
-    return result;
+    return ambiguity_memo_record(&memo_key, result);
 }
 
 char solve_ambiguous_list_of_expressions(AST ambiguous_list, const decl_context_t* decl_context,
@@ -1474,6 +1690,13 @@ void solve_ambiguous_init_declarator(AST a, const decl_context_t* decl_context,
 // Like solve_ambiguous_init_declarator but does not fail
 static char try_to_solve_ambiguous_init_declarator(AST a, const decl_context_t* decl_context, gather_decl_spec_t* gather_info)
 {
+    // Like in try_to_solve_ambiguity_generic only failures are remembered
+    ambiguity_memo_key_t memo_key;
+    char verdict = 0;
+    if (ambiguity_memo_query(&memo_key, a, AMK_TRY_INIT_DECLARATOR, NULL,
+                decl_context, gather_info_memo_variant(gather_info), &verdict))
+        return verdict;
+
     int correct_choice = -1;
     int i;
 
@@ -1536,7 +1759,7 @@ static char try_to_solve_ambiguous_init_declarator(AST a, const decl_context_t*
         diagnostic_context_pop();
         diagnostic_context_commit(combine_diagnostics);
 
-        return 0;
+        return ambiguity_memo_record(&memo_key, /* verdict */ 0);
     }
     else
     {
@@ -1552,11 +1775,11 @@ static char try_to_solve_ambiguous_init_declarator(AST a, const decl_context_t*
             }
         }
         ast_replace_with_ambiguity(a, correct_choice);
-        return 1;
+        return ambiguity_memo_record(&memo_key, /* verdict */ 1);
     }
 }
 
-static char check_init_declarator(AST init_declarator,
+static char check_init_declarator_aux(AST init_declarator,
         const decl_context_t* decl_context,
         gather_decl_spec_t* gather_info)
 {
@@ -1632,6 +1855,20 @@ static char check_init_declarator(AST init_declarator,
     return result;
 }
 
+static char check_init_declarator(AST init_declarator,
+        const decl_context_t* decl_context,
+        gather_decl_spec_t* gather_info)
+{
+    ambiguity_memo_key_t memo_key;
+    char verdict = 0;
+    if (ambiguity_memo_query(&memo_key, init_declarator, AMK_INIT_DECLARATOR, NULL,
+                decl_context, gather_info_memo_variant(gather_info), &verdict))
+        return verdict;
+
+    return ambiguity_memo_record(&memo_key,
+            check_init_declarator_aux(init_declarator, decl_context, gather_info));
+}
+
 static char check_declarator_rec(AST declarator, const decl_context_t* decl_context, char enclosing_is_array, char enclosing_is_function)
 {
     if (declarator == NULL)
@@ -1817,7 +2054,7 @@ static char check_function_declarator_parameters(AST parameter_declaration_claus
 
         if (ASTKind(parameter) == AST_AMBIGUITY)
         {
-            if (!try_to_solve_ambiguity_generic(parameter, decl_context, NULL,
+            if (!try_to_solve_ambiguity_generic(parameter, decl_context, NULL, 0,
                     solve_ambiguous_function_declarator_parameter_check_intepretation,
                     solve_ambiguous_function_declarator_parameter_choose_intepretation))
                 return 0;
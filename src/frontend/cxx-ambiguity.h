@@ -45,6 +45,10 @@ typedef int ambiguity_choose_interpretation_fun_t(AST current, AST previous,
         const decl_context_t*, void* info);
 typedef char ambiguity_fallback_interpretation_fun_t(AST, const decl_context_t*, int option_idx, void* info);
 
+// Forgets the verdicts of the ambiguity checks, called once the trees of a
+// translation unit are released
+LIBMCXX_EXTERN void ambiguity_memo_reset(void);
+
 LIBMCXX_EXTERN void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *info,
         ambiguity_check_intepretation_fun_t* ambiguity_check_intepretation,
         ambiguity_choose_interpretation_fun_t* ambiguity_choose_interpretation,
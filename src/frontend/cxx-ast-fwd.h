@@ -36,6 +36,9 @@ typedef struct AST_tag *AST;
 
 typedef const struct AST_tag * const_AST;
 
+struct ast_arena_tag;
+typedef struct ast_arena_tag ast_arena_t;
+
 MCXX_END_DECLS
 
 #endif // CXX_AST_FWD_H
@@ -34,6 +34,10 @@
 
 MCXX_BEGIN_DECLS
 
+// Nodes are referred by 32-bit identifiers. The upper bits give the chunk of
+// the node and the lower bits its slot in the chunk. 0 is the null node
+typedef uint32_t ast_node_id_t;
+
 // Definition of the type
 typedef
 struct AST_tag
@@ -44,14 +48,22 @@ struct AST_tag
     // This is a bitmap for the sons
     unsigned int bitmap_sons:MCXX_MAX_AST_CHILDREN;
 
-    // Number of ambiguities of this node
-    int num_ambig;
+    // The node (or the interpretations of an AST_AMBIGUITY) were allocated
+    // in an AST arena
+    unsigned int node_in_arena:1;
+    unsigned int ambig_in_arena:1;
+
+    // Set by ast_free on the nodes already visited
+    unsigned int visited:1;
+
+    // Index in ast_expr_info_table, 0 if none. This is used by nodecl trees
+    unsigned int expr_info_index;
 
     // Parent node
-    struct AST_tag* parent;
+    ast_node_id_t parent;
 
     // Node locus
-    const locus_t* locus;
+    locus_id_t locus;
 
     // Textual information linked to the node
     // normally the symbol or the literal
@@ -59,16 +71,60 @@ struct AST_tag
 
     union
     {
-        // The children of this tree (except for AST_AMBIGUITY)
-        struct AST_tag** children;
+        // The children of this tree (except for AST_AMBIGUITY). Only those
+        // in bitmap_sons are meaningful
+        ast_node_id_t children[MCXX_MAX_AST_CHILDREN];
         // When type == AST_AMBIGUITY, all intepretations are here
-        struct AST_tag** ambig;
+        struct
+        {
+            struct AST_tag** options;
+            int num_options;
+        } ambig;
     };
-
-    // This is used by nodecl trees
-    struct nodecl_expr_info_tag* expr_info;
 } AST_node_t;
 
+enum
+{
+    // Nodes are allocated in chunks aligned to their size, so the chunk of
+    // a node is found from its address
+    AST_NODE_CHUNK_SIZE = 256 * 1024,
+    AST_NODE_SLOT_BITS = 13,
+    AST_NODE_SLOT_MASK = (1 << AST_NODE_SLOT_BITS) - 1,
+};
+
+// The first slot of every chunk is never a node and keeps this header
+typedef struct ast_node_chunk_tag ast_node_chunk_t;
+struct ast_node_chunk_tag
+{
+    unsigned int index;
+    // Next chunk of the same arena
+    ast_node_chunk_t* next;
+    // As returned by xmalloc
+    void* storage;
+};
+
+// First slot of every chunk, by chunk index
+LIBMCXX_EXTERN AST* ast_node_chunks;
+
+static inline ast_node_id_t ast_node_id(const_AST a)
+{
+    if (a == NULL)
+        return 0;
+
+    const ast_node_chunk_t* chunk =
+        (const ast_node_chunk_t*)((uintptr_t)a & ~(uintptr_t)(AST_NODE_CHUNK_SIZE - 1));
+    return (chunk->index << AST_NODE_SLOT_BITS)
+        | (ast_node_id_t)(a - (const_AST)chunk);
+}
+
+static inline AST ast_node_of_id(ast_node_id_t id)
+{
+    if (id == 0)
+        return NULL;
+
+    return ast_node_chunks[id >> AST_NODE_SLOT_BITS] + (id & AST_NODE_SLOT_MASK);
+}
+
 
 static inline node_t ast_get_kind(const_AST a)
 {
@@ -77,7 +133,7 @@ static inline node_t ast_get_kind(const_AST a)
 
 static inline AST ast_get_parent(const_AST a)
 {
-    return a->parent;
+    return ast_node_of_id(a->parent);
 }
 
 static inline unsigned int ast_get_line(const_AST a)
@@ -105,31 +161,6 @@ static inline void ast_set_kind(AST a, node_t node_type)
     a->node_type = node_type;
 }
 
-static inline int ast_bitmap_to_index(unsigned int bitmap, int num)
-{
-    ERROR_CONDITION(((1 << num) & bitmap) == 0,
-            "Invalid bitmap!", 0);
-#if HAVE__BUILTIN_POPCOUNT
-    bitmap = bitmap & (~(~0U << num));
-    return __builtin_popcount(bitmap);
-#else
-    int i;
-    int s = 0;
-    for (i = 0; i < num; i++)
-    {
-        s += bitmap & 1;
-        bitmap = bitmap >> 1;
-    }
-
-    return s;
-#endif
-}
-
-ALWAYS_INLINE static inline int ast_son_num_to_son_index(const_AST a, int num_son)
-{
-    return ast_bitmap_to_index(a->bitmap_sons, num_son);
-}
-
 ALWAYS_INLINE static inline char ast_has_son(const_AST a, int son)
 {
     return (((1 << son) & a->bitmap_sons) != 0);
@@ -139,7 +170,7 @@ ALWAYS_INLINE static inline AST ast_get_child(const_AST a, int num_child)
 {
     if (ast_has_son(a, num_child))
     {
-        return a->children[ast_son_num_to_son_index(a, num_child)];
+        return ast_node_of_id(a->children[num_child]);
     }
     else
     {
@@ -149,7 +180,7 @@ ALWAYS_INLINE static inline AST ast_get_child(const_AST a, int num_child)
 
 static inline void ast_set_parent(AST a, AST parent)
 {
-    a->parent = parent;
+    a->parent = ast_node_id(parent);
 }
 
 static inline int ast_count_bitmap(unsigned int bitmap)
@@ -169,41 +200,97 @@ static inline int ast_count_bitmap(unsigned int bitmap)
 #endif
 }
 
+// Arena where ast_make allocates the nodes. If NULL nodes are allocated
+// in the heap
+LIBMCXX_EXTERN ast_arena_t* ast_current_arena;
+// Set when a heap node hangs from an arena node. While this is not set
+// ast_free does not have to walk arena trees
+LIBMCXX_EXTERN char ast_arena_has_heap_nodes;
+
+LIBMCXX_EXTERN void* ast_arena_allocate(ast_arena_t* arena, size_t size, node_t kind);
+LIBMCXX_EXTERN AST ast_arena_allocate_node(ast_arena_t* arena, node_t kind);
+
+// Nodes not allocated in an arena
+LIBMCXX_EXTERN AST ast_heap_allocate_node(void);
+LIBMCXX_EXTERN void ast_heap_release_node(AST a);
+
+// Side table of the expression information of nodecl trees. Entry 0 is
+// always NULL
+LIBMCXX_EXTERN struct nodecl_expr_info_tag** ast_expr_info_table;
+LIBMCXX_EXTERN unsigned int ast_expr_info_new_index(void);
+// Makes the index available again
+LIBMCXX_EXTERN void ast_expr_info_release_index(unsigned int index);
+
+static inline void ast_arena_note_link(const_AST parent, const_AST child)
+{
+    if (parent->node_in_arena
+            && child != NULL
+            && !child->node_in_arena)
+        ast_arena_has_heap_nodes = 1;
+}
+
+static inline AST* ast_allocate_ambiguities(AST a, int num_ambig)
+{
+    if (a->node_in_arena
+            && ast_current_arena != NULL)
+    {
+        a->ambig_in_arena = 1;
+        return (AST*)ast_arena_allocate(ast_current_arena,
+                num_ambig * sizeof(AST), a->node_type);
+    }
+    else
+    {
+        if (a->node_in_arena)
+            ast_arena_has_heap_nodes = 1;
+        a->ambig_in_arena = 0;
+        return NEW_VEC(AST, num_ambig);
+    }
+}
+
+static inline void ast_release_ambiguities(AST a)
+{
+    // Arena vectors are released along with their arena
+    if (!a->ambig_in_arena)
+        DELETE(a->ambig.options);
+}
+
 static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER, 
         AST child0, AST child1, AST child2, AST child3, 
         const locus_t* location, const char *text)
 {
-    AST result = NEW(AST_node_t);
+    AST result;
+    if (ast_current_arena != NULL)
+    {
+        result = ast_arena_allocate_node(ast_current_arena, type);
+        result->node_in_arena = 1;
+    }
+    else
+    {
+        result = ast_heap_allocate_node();
+        result->node_in_arena = 0;
+    }
     // ERROR_CONDITION(result & 0x1 != 0, "Invalid pointer for AST", 0);
 
     result->node_type = type;
 
-    int num_children = 0;
-    unsigned int bitmap_sons = 0;
-
-    result->bitmap_sons = bitmap_sons;
-    result->parent = NULL;
-    result->locus = location;
+    result->parent = 0;
+    result->locus = locus_get_id(location);
 
     result->text = text;
 
-    bitmap_sons =
+    result->bitmap_sons =
         (!!child0)
         | (!!child1 << 1)
         | (!!child2 << 2)
         | (!!child3 << 3);
-    num_children = ast_count_bitmap(bitmap_sons);
-
-    result->bitmap_sons = bitmap_sons;
-    result->children = NEW_VEC(AST, num_children);
 
-    int idx = 0;
+    ast_node_id_t result_id = ast_node_id(result);
 #define ADD_SON(n) \
+    result->children[n] = ast_node_id(child##n); \
     if (child##n != NULL) \
     { \
-        result->children[idx] = child##n; \
-        child##n->parent = result; \
-        idx++; \
+        ast_arena_note_link(result, child##n); \
+        child##n->parent = result_id; \
     }
 
     ADD_SON(0);
@@ -212,21 +299,18 @@ static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER,
     ADD_SON(3);
 #undef ADD_SON
 
-    result->expr_info = NULL;
+    result->ambig_in_arena = 0;
+    result->visited = 0;
+    result->expr_info_index = 0;
 
     return result;
 }
 
-// This function works both for shrinking or widening
-static inline void ast_reallocate_children(AST a, int num_child, AST new_child)
+static inline void ast_set_child_but_parent(AST a, int num_child, AST new_child)
 {
-    // Reallocate childrens
-    // Save the old children array
-    AST* old_children = a->children;
-    // And the old children bitmap
-    unsigned int old_bitmap = a->bitmap_sons;
+    ast_arena_note_link(a, new_child);
 
-    // Enable or disable this new son depending on it being null
+    // Enable or disable this son depending on it being null
     if (new_child != NULL)
     {
         a->bitmap_sons = (a->bitmap_sons | (1 << num_child));
@@ -235,58 +319,7 @@ static inline void ast_reallocate_children(AST a, int num_child, AST new_child)
     {
         a->bitmap_sons = (a->bitmap_sons & (~(1 << num_child)));
     }
-
-    a->children = NEW_VEC(AST, ast_count_bitmap(a->bitmap_sons));
-
-    // Now for every old son, update the new children
-    int i;
-    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
-    {
-        // Note that when shrinking the node ast_has_son
-        // will always return false for num_child.
-        if (ast_has_son(a, i))
-        {
-            if (i == num_child)
-            {
-                // The new son
-                a->children[ast_son_num_to_son_index(a, i)] = new_child;
-            }
-            else
-            {
-                // Old sons that are updated their position
-                a->children[ast_son_num_to_son_index(a, i)] = 
-                    old_children[ast_bitmap_to_index(old_bitmap, i)];
-            }
-        }
-    }
-
-    // Now DELETE the old children (if any)
-    if (old_children != NULL)
-        DELETE(old_children);
-}
-
-static inline void ast_set_child_but_parent(AST a, int num_child, AST new_child)
-{
-    if (new_child == NULL)
-    {
-        if (ast_has_son(a, num_child))
-        {
-            // Shrink the node if we have it
-            ast_reallocate_children(a, num_child, new_child);
-        }
-    }
-    else
-    {
-        if (ast_has_son(a, num_child))
-        {
-            a->children[ast_son_num_to_son_index(a, num_child)] = new_child;
-        }
-        else
-        {
-            // This will widen the node
-            ast_reallocate_children(a, num_child, new_child);
-        }
-    }
+    a->children[num_child] = ast_node_id(new_child);
 }
 
 static inline void ast_set_child(AST a, int num_child, AST new_child)
@@ -294,7 +327,7 @@ static inline void ast_set_child(AST a, int num_child, AST new_child)
     ast_set_child_but_parent(a, num_child, new_child);
     if (new_child != NULL)
     {
-        new_child->parent = a;
+        new_child->parent = ast_node_id(a);
     }
 }
 
@@ -359,14 +392,22 @@ static inline const char* ast_location(const_AST a)
     return locus_to_str(ast_get_locus(a));
 }
 
+static inline char ast_is_in_arena(const_AST a)
+{
+    return a != NULL
+        && a->node_in_arena;
+}
+
 static inline int ast_get_num_ambiguities(const_AST a)
 {
-    return a->num_ambig;
+    if (a->node_type != AST_AMBIGUITY)
+        return 0;
+    return a->ambig.num_options;
 }
 
 static inline AST ast_get_ambiguity(const_AST a, int num)
 {
-    return a->ambig[num];
+    return a->ambig.options[num];
 }
 
 static inline void ast_fix_parents_inside_intepretation(AST node)
@@ -401,6 +442,34 @@ int ast_num_of_given_child(const_AST parent, const_AST child)
     return -1;
 }
 
+static inline void ast_add_ambiguities(AST a, int num_new, AST* new_options)
+{
+    int num_options = a->ambig.num_options;
+    AST* old_options = a->ambig.options;
+
+    if (a->ambig_in_arena)
+    {
+        a->ambig.options = ast_allocate_ambiguities(a, num_options + num_new);
+        int i;
+        for (i = 0; i < num_options; i++)
+        {
+            a->ambig.options[i] = old_options[i];
+        }
+    }
+    else
+    {
+        a->ambig.options = NEW_REALLOC(AST, old_options, num_options + num_new);
+    }
+
+    int i;
+    for (i = 0; i < num_new; i++)
+    {
+        ast_arena_note_link(a, new_options[i]);
+        a->ambig.options[num_options + i] = new_options[i];
+    }
+    a->ambig.num_options = num_options + num_new;
+}
+
 // Be careful when handling ambiguity nodes, the set of interpretations may not
 // be an actual tree but a DAG
 static inline AST ast_make_ambiguous(AST son0, AST son1)
@@ -409,44 +478,30 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
     {
         if (ASTKind(son1) == AST_AMBIGUITY)
         {
-            int original_son0 = son0->num_ambig;
-
-            son0->num_ambig += son1->num_ambig;
-            son0->ambig = NEW_REALLOC(AST, son0->ambig, son0->num_ambig);
-
-            int i;
-            for (i = 0; i < son1->num_ambig; i++)
-            {
-                son0->ambig[original_son0 + i] = son1->ambig[i];
-            }
-
+            ast_add_ambiguities(son0, son1->ambig.num_options, son1->ambig.options);
             return son0;
         }
         else
         {
-            son0->num_ambig++;
-            son0->ambig = NEW_REALLOC(AST, son0->ambig, son0->num_ambig);
-            son0->ambig[son0->num_ambig-1] = son1;
-
+            ast_add_ambiguities(son0, 1, &son1);
             return son0;
         }
     }
     else if (ASTKind(son1) == AST_AMBIGUITY)
     {
-        son1->num_ambig++;
-        son1->ambig = NEW_REALLOC(AST, son1->ambig, son1->num_ambig);
-        son1->ambig[son1->num_ambig-1] = son0;
-
+        ast_add_ambiguities(son1, 1, &son0);
         return son1;
     }
     else
     {
         AST result = ASTLeaf(AST_AMBIGUITY, make_locus("", 0, 0), NULL);
 
-        result->num_ambig = 2;
-        result->ambig = NEW_VEC(AST, result->num_ambig);
-        result->ambig[0] = son0;
-        result->ambig[1] = son1;
+        result->ambig.num_options = 2;
+        result->ambig.options = ast_allocate_ambiguities(result, result->ambig.num_options);
+        ast_arena_note_link(result, son0);
+        ast_arena_note_link(result, son1);
+        result->ambig.options[0] = son0;
+        result->ambig.options[1] = son1;
         result->locus = son0->locus;
 
         return result;
@@ -455,7 +510,19 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
 
 static inline void ast_replace(AST dest, const_AST src)
 {
+    // The storage of dest does not change, only its contents
+    char node_in_arena = dest->node_in_arena;
+    if (node_in_arena
+            && (!src->node_in_arena
+                || (src->node_type == AST_AMBIGUITY && !src->ambig_in_arena)))
+        ast_arena_has_heap_nodes = 1;
+
+    unsigned int expr_info_index = dest->expr_info_index;
+
     *dest = *src;
+    dest->node_in_arena = node_in_arena;
+    dest->expr_info_index = expr_info_index;
+    ast_set_expr_info(dest, ast_get_expr_info(src));
 }
 
 static inline void ast_free(AST a)
@@ -463,14 +530,19 @@ static inline void ast_free(AST a)
     if (a == NULL)
         return;
 
+    // Nothing reachable from here lives in the heap, the whole tree will be
+    // released along with its arena
+    if (a->node_in_arena
+            && !ast_arena_has_heap_nodes)
+        return;
+
     // Already visited. See below
-    if (__builtin_expect(((((intptr_t)a->parent) & 0x1) == 0x1), 0))
+    if (__builtin_expect(a->visited, 0))
         return;
 
     // Tag this node as visited to avoid infinite recursion under the presence
-    // of cycles (note that this works as long as AST pointers are at least
-    // aligned to two bytes)
-    a->parent = (struct AST_tag*)(((intptr_t)a->parent) | 0x1);
+    // of cycles
+    a->visited = 1;
 
     if (ast_get_kind(a) == AST_AMBIGUITY)
     {
@@ -489,11 +561,14 @@ static inline void ast_free(AST a)
         }
     }
 
-    DELETE(a->expr_info);
-    DELETE(a->children);
+    if (ast_get_kind(a) == AST_AMBIGUITY)
+        ast_release_ambiguities(a);
+    DELETE(ast_get_expr_info(a));
+    ast_set_expr_info(a, NULL);
     // Clear the node for safety
     // __builtin_memset(a, 0, sizeof(*a));
-    DELETE(a);
+    if (!a->node_in_arena)
+        ast_heap_release_node(a);
 }
 
 static inline void ast_replace_with_ambiguity(AST a, int n)
@@ -530,7 +605,7 @@ static inline const locus_t* ast_get_locus(const_AST a)
     if (a == NULL)
         return NULL;
     else if (ASTKind(a) != AST_NODE_LIST)
-        return a->locus;
+        return locus_from_id(a->locus);
     else
         return ast_get_locus(
                 ASTSon1(ast_list_head(a))
@@ -541,7 +616,7 @@ static inline void ast_set_locus(AST a, const locus_t* locus)
 {
     ERROR_CONDITION(ASTKind(a) == AST_NODE_LIST,
             "list nodes do not have locus", 0);
-    a->locus = locus;
+    a->locus = locus_get_id(locus);
 }
 
 static inline const char *ast_get_filename(const_AST a)
@@ -556,12 +631,25 @@ static inline int ast_node_size(void)
 
 static inline struct nodecl_expr_info_tag* ast_get_expr_info(const_AST a)
 {
-    return a->expr_info;
+    return ast_expr_info_table[a->expr_info_index];
 }
 
 static inline void ast_set_expr_info(AST a, struct nodecl_expr_info_tag* expr_info)
 {
-    a->expr_info = expr_info;
+    if (expr_info != NULL)
+    {
+        // expr_info is always in the heap
+        if (a->node_in_arena)
+            ast_arena_has_heap_nodes = 1;
+        if (a->expr_info_index == 0)
+            a->expr_info_index = ast_expr_info_new_index();
+        ast_expr_info_table[a->expr_info_index] = expr_info;
+    }
+    else if (a->expr_info_index != 0)
+    {
+        ast_expr_info_release_index(a->expr_info_index);
+        a->expr_info_index = 0;
+    }
 }
 
 static inline const char* ast_node_type_name(node_t n)
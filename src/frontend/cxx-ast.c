@@ -35,6 +35,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <limits.h>
 
 #include "cxx-ast.h"
 #include "cxx-locus.h"
@@ -117,9 +118,9 @@ char ast_check(const_AST root)
         }
         else
         {
-            for (i = 0; i < node->num_ambig; i++)
+            for (i = 0; i < ast_get_num_ambiguities(node); i++)
             {
-                AST c = node->ambig[i];
+                AST c = ast_get_ambiguity(node, i);
                 PUSH_BACK(c);
             }
         }
@@ -216,9 +217,16 @@ char ast_check_list_tree(const_AST a)
 
 static void ast_copy_one_node(AST dest, AST orig)
 {
+    char node_in_arena = dest->node_in_arena;
     *dest = *orig;
+    dest->node_in_arena = node_in_arena;
+    dest->ambig_in_arena = 0;
+    dest->visited = 0;
     dest->bitmap_sons = 0;
-    dest->children = 0;
+    memset(dest->children, 0, sizeof(dest->children));
+
+    dest->expr_info_index = 0;
+    ast_set_expr_info(dest, ast_get_expr_info(orig));
 }
 
 AST ast_duplicate_one_node(AST orig)
@@ -234,28 +242,23 @@ AST ast_copy(const_AST a)
     if (a == NULL)
         return NULL;
 
-    AST result = NEW0(AST_node_t);
+    AST result = ast_heap_allocate_node();
+    memset(result, 0, sizeof(*result));
 
     ast_copy_one_node(result, (AST)a);
 
     int i;
-    if (a->node_type == AST_AMBIGUITY
-            && a->num_ambig > 0)
+    if (a->node_type == AST_AMBIGUITY)
     {
-        result->num_ambig = a->num_ambig;
-        result->ambig = NEW_VEC(AST, a->num_ambig);
-        for (i = 0; i < a->num_ambig; i++)
+        result->ambig.num_options = a->ambig.num_options;
+        result->ambig.options = NEW_VEC(AST, a->ambig.num_options);
+        for (i = 0; i < a->ambig.num_options; i++)
         {
-            result->ambig[i] = ast_copy(a->ambig[i]);
+            result->ambig.options[i] = ast_copy(a->ambig.options[i]);
         }
     }
     else
     {
-        result->bitmap_sons = a->bitmap_sons;
-        int num_children = ast_count_bitmap(result->bitmap_sons);
-
-        result->children = NEW_VEC(AST, num_children);
-
         for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
         {
             AST c = ast_copy(ast_get_child(a, i));
@@ -269,7 +272,7 @@ AST ast_copy(const_AST a)
         result->text = a->text;
     }
 
-    result->parent = NULL;
+    result->parent = 0;
 
     return result;
 }
@@ -345,3 +348,384 @@ char ast_equal (const_AST ast1, const_AST ast2)
     return 1;
 }
 
+
+// Chunks of nodes
+
+// Every chunk holds the header slot plus the nodes
+#define AST_NODES_PER_CHUNK (AST_NODE_CHUNK_SIZE / sizeof(AST_node_t))
+
+// Fails to compile if the slot of a node does not fit in AST_NODE_SLOT_BITS
+typedef char ast_node_chunk_slots_fit[
+    (AST_NODES_PER_CHUNK <= (1 << AST_NODE_SLOT_BITS)) ? 1 : -1];
+typedef char ast_node_chunk_header_fits[
+    (sizeof(ast_node_chunk_t) <= sizeof(AST_node_t)) ? 1 : -1];
+
+AST* ast_node_chunks = NULL;
+static unsigned int ast_node_chunks_size = 0;
+static unsigned int ast_node_chunks_capacity = 0;
+
+// Indexes released by ast_node_chunk_release
+static unsigned int* ast_node_chunks_free_indexes = NULL;
+static unsigned int ast_node_chunks_num_free_indexes = 0;
+static unsigned int ast_node_chunks_free_indexes_capacity = 0;
+
+static ast_node_chunk_t* ast_node_chunk_new(void)
+{
+    // Aligned to its size, see ast_node_id
+    void* storage = xmalloc(2 * AST_NODE_CHUNK_SIZE);
+    ast_node_chunk_t* chunk = (ast_node_chunk_t*)
+        (((uintptr_t)storage + AST_NODE_CHUNK_SIZE - 1) & ~(uintptr_t)(AST_NODE_CHUNK_SIZE - 1));
+    chunk->storage = storage;
+    chunk->next = NULL;
+
+    if (ast_node_chunks_num_free_indexes > 0)
+    {
+        ast_node_chunks_num_free_indexes--;
+        chunk->index = ast_node_chunks_free_indexes[ast_node_chunks_num_free_indexes];
+    }
+    else
+    {
+        if (ast_node_chunks_size == ast_node_chunks_capacity)
+        {
+            ast_node_chunks_capacity = ast_node_chunks_capacity * 2 + 64;
+            ast_node_chunks = NEW_REALLOC(AST, ast_node_chunks, ast_node_chunks_capacity);
+        }
+
+        ERROR_CONDITION(ast_node_chunks_size
+                == (UINT32_MAX >> AST_NODE_SLOT_BITS), "Too many AST nodes", 0);
+
+        chunk->index = ast_node_chunks_size;
+        ast_node_chunks_size++;
+    }
+    ast_node_chunks[chunk->index] = (AST)chunk;
+
+    return chunk;
+}
+
+static void ast_node_chunk_release(ast_node_chunk_t* chunk)
+{
+    ast_node_chunks[chunk->index] = NULL;
+
+    if (ast_node_chunks_num_free_indexes == ast_node_chunks_free_indexes_capacity)
+    {
+        ast_node_chunks_free_indexes_capacity = ast_node_chunks_free_indexes_capacity * 2 + 64;
+        ast_node_chunks_free_indexes = NEW_REALLOC(unsigned int,
+                ast_node_chunks_free_indexes,
+                ast_node_chunks_free_indexes_capacity);
+    }
+    ast_node_chunks_free_indexes[ast_node_chunks_num_free_indexes] = chunk->index;
+    ast_node_chunks_num_free_indexes++;
+
+    DELETE(chunk->storage);
+}
+
+// Free slots of a chunk, the first slot is the header
+typedef
+struct ast_node_slots_tag
+{
+    AST top;
+    AST end;
+} ast_node_slots_t;
+
+static AST ast_node_slots_allocate(ast_node_slots_t* slots, ast_node_chunk_t** chunks)
+{
+    if (slots->top == slots->end)
+    {
+        ast_node_chunk_t* chunk = ast_node_chunk_new();
+        chunk->next = *chunks;
+        *chunks = chunk;
+
+        slots->top = (AST)chunk + 1;
+        slots->end = (AST)chunk + AST_NODES_PER_CHUNK;
+    }
+
+    AST result = slots->top;
+    slots->top++;
+
+    return result;
+}
+
+// Nodes in the heap. Their chunks are never released, released nodes are
+// chained through their parent
+static ast_node_chunk_t* ast_heap_node_chunks = NULL;
+static ast_node_slots_t ast_heap_node_slots = { NULL, NULL };
+static AST ast_heap_free_nodes = NULL;
+
+AST ast_heap_allocate_node(void)
+{
+    if (ast_heap_free_nodes != NULL)
+    {
+        AST result = ast_heap_free_nodes;
+        ast_heap_free_nodes = ast_node_of_id(result->parent);
+        return result;
+    }
+
+    return ast_node_slots_allocate(&ast_heap_node_slots, &ast_heap_node_chunks);
+}
+
+void ast_heap_release_node(AST a)
+{
+    a->node_type = AST_INVALID_NODE;
+    a->parent = ast_node_id(ast_heap_free_nodes);
+    ast_heap_free_nodes = a;
+}
+
+// AST arenas
+
+enum
+{
+    // Payload of every chunk of an arena
+    AST_ARENA_CHUNK_SIZE = 64 * 1024,
+};
+
+typedef struct ast_arena_chunk_tag ast_arena_chunk_t;
+struct ast_arena_chunk_tag
+{
+    ast_arena_chunk_t* next;
+    // Keeps the payload suitably aligned for AST nodes
+    void* payload[];
+};
+
+struct ast_arena_tag
+{
+    ast_arena_chunk_t* chunks;
+
+    // Free space of the current chunk
+    char* top;
+    char* end;
+
+    size_t num_bytes;
+
+    // Nodes are allocated in their own chunks
+    ast_node_chunk_t* node_chunks;
+    ast_node_slots_t node_slots;
+};
+
+ast_arena_t* ast_current_arena = NULL;
+char ast_arena_has_heap_nodes = 0;
+
+static int ast_num_live_arenas = 0;
+
+// Statistics of all the arenas created so far
+static unsigned long long ast_arena_num_nodes[AST_LAST_NODE];
+static unsigned long long ast_arena_num_bytes[AST_LAST_NODE];
+static unsigned long long ast_arena_num_chunks = 0;
+static unsigned long long ast_arena_num_node_chunks = 0;
+static unsigned long long ast_arena_peak_bytes = 0;
+
+ast_arena_t* ast_arena_new(void)
+{
+    ast_arena_t* arena = NEW0(ast_arena_t);
+    ast_num_live_arenas++;
+
+    return arena;
+}
+
+ast_arena_t* ast_arena_set_current(ast_arena_t* arena)
+{
+    ast_arena_t* previous = ast_current_arena;
+    ast_current_arena = arena;
+
+    return previous;
+}
+
+static void ast_arena_new_chunk(ast_arena_t* arena, size_t size)
+{
+    if (size < AST_ARENA_CHUNK_SIZE)
+        size = AST_ARENA_CHUNK_SIZE;
+
+    ast_arena_chunk_t* chunk = (ast_arena_chunk_t*)xmalloc(sizeof(*chunk) + size);
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+
+    arena->top = (char*)chunk->payload;
+    arena->end = arena->top + size;
+
+    ast_arena_num_chunks++;
+}
+
+void* ast_arena_allocate(ast_arena_t* arena, size_t size, node_t kind)
+{
+    // Keep everything aligned to pointers so the low bit of AST pointers is
+    // always available to ast_free
+    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    if ((size_t)(arena->end - arena->top) < size)
+        ast_arena_new_chunk(arena, size);
+
+    void* result = arena->top;
+    arena->top += size;
+    arena->num_bytes += size;
+
+    if (arena->num_bytes > ast_arena_peak_bytes)
+        ast_arena_peak_bytes = arena->num_bytes;
+    ast_arena_num_bytes[kind] += size;
+
+    return result;
+}
+
+AST ast_arena_allocate_node(ast_arena_t* arena, node_t kind)
+{
+    ast_arena_num_nodes[kind]++;
+    ast_arena_num_bytes[kind] += sizeof(AST_node_t);
+
+    if (arena->node_slots.top == arena->node_slots.end)
+        ast_arena_num_node_chunks++;
+
+    arena->num_bytes += sizeof(AST_node_t);
+    if (arena->num_bytes > ast_arena_peak_bytes)
+        ast_arena_peak_bytes = arena->num_bytes;
+
+    return ast_node_slots_allocate(&arena->node_slots, &arena->node_chunks);
+}
+
+void ast_arena_release(ast_arena_t* arena)
+{
+    if (arena == NULL)
+        return;
+
+    if (ast_current_arena == arena)
+        ast_current_arena = NULL;
+
+    ast_arena_chunk_t* chunk = arena->chunks;
+    while (chunk != NULL)
+    {
+        ast_arena_chunk_t* next = chunk->next;
+        DELETE(chunk);
+        chunk = next;
+    }
+    ast_node_chunk_t* node_chunk = arena->node_chunks;
+    while (node_chunk != NULL)
+    {
+        ast_node_chunk_t* next = node_chunk->next;
+        ast_node_chunk_release(node_chunk);
+        node_chunk = next;
+    }
+    DELETE(arena);
+
+    ast_num_live_arenas--;
+    if (ast_num_live_arenas == 0)
+    {
+        // No arena node remains so there cannot be heap nodes hanging from them
+        ast_arena_has_heap_nodes = 0;
+    }
+}
+
+static int ast_arena_compare_kinds(const void* p1, const void* p2)
+{
+    node_t k1 = *(const node_t*)p1;
+    node_t k2 = *(const node_t*)p2;
+
+    if (ast_arena_num_bytes[k1] > ast_arena_num_bytes[k2])
+        return -1;
+    else if (ast_arena_num_bytes[k1] < ast_arena_num_bytes[k2])
+        return 1;
+    else
+        return (int)k1 - (int)k2;
+}
+
+void ast_arena_stats(void)
+{
+    node_t kinds[AST_LAST_NODE];
+    int num_kinds = 0;
+
+    unsigned long long total_nodes = 0;
+    unsigned long long total_bytes = 0;
+
+    int i;
+    for (i = 0; i < AST_LAST_NODE; i++)
+    {
+        if (ast_arena_num_bytes[i] == 0)
+            continue;
+
+        kinds[num_kinds] = (node_t)i;
+        num_kinds++;
+
+        total_nodes += ast_arena_num_nodes[i];
+        total_bytes += ast_arena_num_bytes[i];
+    }
+
+    qsort(kinds, num_kinds, sizeof(*kinds), ast_arena_compare_kinds);
+
+    fprintf(stderr, " - AST arena chunks allocated: %llu (%d bytes each)\n",
+            ast_arena_num_chunks, AST_ARENA_CHUNK_SIZE);
+    fprintf(stderr, " - AST arena node chunks allocated: %llu (%d bytes each)\n",
+            ast_arena_num_node_chunks, AST_NODE_CHUNK_SIZE);
+    fprintf(stderr, " - AST arena peak usage (bytes): %llu\n",
+            ast_arena_peak_bytes);
+    fprintf(stderr, " - AST arena total usage: %llu nodes, %llu bytes\n",
+            total_nodes, total_bytes);
+
+    for (i = 0; i < num_kinds; i++)
+    {
+        fprintf(stderr, "    %-40s %10llu nodes %12llu bytes\n",
+                ast_node_type_name(kinds[i]),
+                ast_arena_num_nodes[kinds[i]],
+                ast_arena_num_bytes[kinds[i]]);
+    }
+}
+
+// Expression information side table
+
+static struct nodecl_expr_info_tag* ast_expr_info_empty_table[1] = { NULL };
+struct nodecl_expr_info_tag** ast_expr_info_table = ast_expr_info_empty_table;
+
+static unsigned int ast_expr_info_table_size = 1;
+static unsigned int ast_expr_info_table_capacity = 1;
+
+// Indexes released by ast_expr_info_release_index
+static unsigned int* ast_expr_info_free_indexes = NULL;
+static unsigned int ast_expr_info_num_free_indexes = 0;
+static unsigned int ast_expr_info_free_indexes_capacity = 0;
+
+unsigned int ast_expr_info_new_index(void)
+{
+    if (ast_expr_info_num_free_indexes > 0)
+    {
+        ast_expr_info_num_free_indexes--;
+        return ast_expr_info_free_indexes[ast_expr_info_num_free_indexes];
+    }
+
+    if (ast_expr_info_table_size == ast_expr_info_table_capacity)
+    {
+        unsigned int new_capacity = ast_expr_info_table_capacity * 2;
+        if (new_capacity < 1024)
+            new_capacity = 1024;
+
+        struct nodecl_expr_info_tag** new_table = NEW_VEC(struct nodecl_expr_info_tag*, new_capacity);
+        memcpy(new_table, ast_expr_info_table,
+                ast_expr_info_table_size * sizeof(*new_table));
+        if (ast_expr_info_table != ast_expr_info_empty_table)
+            DELETE(ast_expr_info_table);
+
+        ast_expr_info_table = new_table;
+        ast_expr_info_table_capacity = new_capacity;
+    }
+
+    ERROR_CONDITION(ast_expr_info_table_size == UINT_MAX,
+            "Too many nodes with expression information", 0);
+
+    unsigned int index = ast_expr_info_table_size;
+    ast_expr_info_table_size++;
+    ast_expr_info_table[index] = NULL;
+
+    return index;
+}
+
+void ast_expr_info_release_index(unsigned int index)
+{
+    ERROR_CONDITION(index == 0 || index >= ast_expr_info_table_size,
+            "Invalid expression information index %u", index);
+
+    ast_expr_info_table[index] = NULL;
+
+    if (ast_expr_info_num_free_indexes == ast_expr_info_free_indexes_capacity)
+    {
+        ast_expr_info_free_indexes_capacity = ast_expr_info_free_indexes_capacity * 2 + 1024;
+        ast_expr_info_free_indexes = NEW_REALLOC(unsigned int,
+                ast_expr_info_free_indexes,
+                ast_expr_info_free_indexes_capacity);
+    }
+    ast_expr_info_free_indexes[ast_expr_info_num_free_indexes] = index;
+    ast_expr_info_num_free_indexes++;
+}
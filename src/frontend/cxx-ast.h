@@ -133,6 +133,26 @@ LIBMCXX_EXTERN char ast_check_list_tree(const_AST a);
 
 static inline void ast_free(AST a);
 
+// Creates a new arena of AST nodes
+LIBMCXX_EXTERN ast_arena_t* ast_arena_new(void);
+
+// Makes ast_make allocate nodes and their children in 'arena' (or in the heap
+// if NULL). Returns the previously current arena
+LIBMCXX_EXTERN ast_arena_t* ast_arena_set_current(ast_arena_t* arena);
+
+// Releases at once all the nodes allocated in 'arena'. ast_free does not
+// release them individually
+LIBMCXX_EXTERN void ast_arena_release(ast_arena_t* arena);
+
+// Prints the usage of arenas per node kind, used by memory report
+LIBMCXX_EXTERN void ast_arena_stats(void);
+
+// States if the node lives in an arena. Arena nodes are never released
+// individually so their address identifies them until the arena is released.
+// Only the parser allocates in arenas, so trees built by semantic analysis
+// only have arena nodes where they wrap a parse tree
+static inline char ast_is_in_arena(const_AST a);
+
 // Gives a copy of all the tree but extended data is the same as original trees
 LIBMCXX_EXTERN AST ast_copy(const_AST a);
 
@@ -631,7 +631,7 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
     builtin_va_list->defined = 1;
     builtin_va_list->type_information = get_gcc_builtin_va_list_type();
     builtin_va_list->do_not_print = 1;
-    builtin_va_list->locus = make_locus("(global scope)", 0, 0);
+    builtin_va_list->locus = locus_get_id(make_locus("(global scope)", 0, 0));
 
     CXX_LANGUAGE()
     {
@@ -662,7 +662,7 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
 
             symbol_entity_specs_reserve_default_argument_info(global_operator_new, 1);
 
-            global_operator_new->locus = make_locus("(global scope)", 0, 0);
+            global_operator_new->locus = locus_get_id(make_locus("(global scope)", 0, 0));
         }
         // Version for arrays
         {
@@ -680,7 +680,7 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
             global_operator_new->type_information = get_new_function_type(return_type, parameter_info, 1, REF_QUALIFIER_NONE);
             symbol_entity_specs_reserve_default_argument_info(global_operator_new, 1);
 
-            global_operator_new->locus = make_locus("(global scope)", 0, 0);
+            global_operator_new->locus = locus_get_id(make_locus("(global scope)", 0, 0));
         }
 
         {
@@ -698,7 +698,7 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
             global_operator_delete->type_information = get_new_function_type(return_type, parameter_info, 1, REF_QUALIFIER_NONE);
             symbol_entity_specs_reserve_default_argument_info(global_operator_delete, 1);
 
-            global_operator_delete->locus = make_locus("(global scope)", 0, 0);
+            global_operator_delete->locus = locus_get_id(make_locus("(global scope)", 0, 0));
         }
         {
             scope_entry_t* global_operator_delete;
@@ -715,7 +715,7 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
             global_operator_delete->type_information = get_new_function_type(return_type, parameter_info, 1, REF_QUALIFIER_NONE);
             symbol_entity_specs_reserve_default_argument_info(global_operator_delete, 1);
 
-            global_operator_delete->locus = make_locus("(global scope)", 0, 0);
+            global_operator_delete->locus = locus_get_id(make_locus("(global scope)", 0, 0));
         }
     }
 
@@ -738,13 +738,13 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
         scope_entry_t* __int128_t_type = new_symbol(decl_context, decl_context->global_scope, uniquestr("__int128_t"));
         __int128_t_type->kind = SK_TYPEDEF;
         __int128_t_type->type_information = get_signed_int128_type();
-        __int128_t_type->locus = make_locus("(global scope)", 0, 0);
+        __int128_t_type->locus = locus_get_id(make_locus("(global scope)", 0, 0));
     }
     {
         scope_entry_t* __uint128_t_type = new_symbol(decl_context, decl_context->global_scope, uniquestr("__uint128_t"));
         __uint128_t_type->kind = SK_TYPEDEF;
         __uint128_t_type->type_information = get_unsigned_int128_type();
-        __uint128_t_type->locus = make_locus("(global scope)", 0, 0);
+        __uint128_t_type->locus = locus_get_id(make_locus("(global scope)", 0, 0));
     }
 #endif
     // Mercurium basic types
@@ -763,7 +763,7 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
                 mercurium_basic_types[i].type_name);
         typedef_sym->kind = SK_TYPEDEF;
         typedef_sym->type_information = mercurium_basic_types[i].related_type;
-        typedef_sym->locus = make_locus("(global scope)", 0, 0);
+        typedef_sym->locus = locus_get_id(make_locus("(global scope)", 0, 0));
         symbol_entity_specs_set_is_user_declared(typedef_sym, 1);
     }
 
@@ -821,7 +821,7 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
                 strappend(base_name, "_max"));
         max_sym->kind = SK_VARIABLE;
         max_sym->type_information = get_const_qualified_type(current_type);
-        max_sym->locus = make_locus("(global scope)", 0, 0);
+        max_sym->locus = locus_get_id(make_locus("(global scope)", 0, 0));
         max_sym->value = const_value_to_nodecl(value_max);
         symbol_entity_specs_set_is_user_declared(max_sym, 1);
 
@@ -829,7 +829,7 @@ void c_initialize_builtin_symbols(const decl_context_t* decl_context)
                 strappend(base_name, "_min"));
         min_sym->kind = SK_VARIABLE;
         min_sym->type_information = get_const_qualified_type(current_type);
-        min_sym->locus = make_locus("(global scope)", 0, 0);
+        min_sym->locus = locus_get_id(make_locus("(global scope)", 0, 0));
         min_sym->value = const_value_to_nodecl(value_min);
         symbol_entity_specs_set_is_user_declared(min_sym, 1);
     }
@@ -1646,7 +1646,7 @@ void introduce_using_entities_in_class(
 
         scope_entry_t* used_name = new_symbol(decl_context, decl_context->current_scope, symbol_name);
         used_name->kind = !is_typename ? SK_USING : SK_USING_TYPENAME;
-        used_name->locus = locus;
+        used_name->locus = locus_get_id(locus);
         symbol_entity_specs_set_alias_to(used_name, entry);
 
         symbol_entity_specs_set_is_member(used_name, 1);
@@ -1662,7 +1662,7 @@ void introduce_using_entities_in_class(
     used_hub_symbol->kind = !is_typename ? SK_USING : SK_USING_TYPENAME;
     used_hub_symbol->type_information = get_unresolved_overloaded_type(used_entities, NULL);
     symbol_entity_specs_set_access(used_hub_symbol, current_access);
-    used_hub_symbol->locus = locus;
+    used_hub_symbol->locus = locus_get_id(locus);
 
     class_type_add_member(current_class->type_information,
             used_hub_symbol,
@@ -1722,7 +1722,7 @@ static void introduce_using_entities(
 
         scope_entry_t* used_name = new_symbol(decl_context, decl_context->current_scope, symbol_name);
         used_name->kind = !is_typename ? SK_USING : SK_USING_TYPENAME;
-        used_name->locus = locus;
+        used_name->locus = locus_get_id(locus);
         symbol_entity_specs_set_alias_to(used_name, original_entry);
 
         insert_entry(decl_context->current_scope, used_name);
@@ -1956,7 +1956,7 @@ static void build_scope_common_template_alias_declaration(AST a,
                     ASTText(identifier));
         }
 
-        info_printf_at(entry->locus, "previous declaration of '%s'\n",
+        info_printf_at(locus_from_id(entry->locus), "previous declaration of '%s'\n",
                 entry->symbol_name);
         return;
     }
@@ -2413,12 +2413,12 @@ static void build_scope_simple_declaration(AST a, const decl_context_t* decl_con
                 {
                     error_printf_at(ast_get_locus(declarator), "redefined entity '%s', first declared in '%s'\n",
                             get_qualified_symbol_name(entry, current_decl_context),
-                            locus_to_str(entry->locus));
+                            locus_to_str(locus_from_id(entry->locus)));
                 }
                 else
                 {
                     // Update the location
-                    entry->locus = ast_get_locus(declarator);
+                    entry->locus = locus_get_id(ast_get_locus(declarator));
                 }
 
                 if (is_array_type(declarator_type)
@@ -3885,7 +3885,7 @@ static void gather_type_spec_from_friend_elaborated_class_specifier_common(
             scope_entry_t* fake_template = NEW0(scope_entry_t);
             fake_template->kind = SK_TEMPLATE;
             fake_template->decl_context = decl_context;
-            fake_template->locus = ast_get_locus(id_expression);
+            fake_template->locus = locus_get_id(ast_get_locus(id_expression));
             fake_template->type_information = get_new_template_type(
                     decl_context->template_parameters,
                     type_of_decl,
@@ -3993,7 +3993,7 @@ static scope_entry_t* new_friend_declared_class(
             context_of_new_declared_class,
             class_kind);
 
-    new_class->locus = locus;
+    new_class->locus = locus_get_id(locus);
     symbol_entity_specs_set_is_friend_declared(new_class, 1);
     symbol_entity_specs_set_is_user_declared(new_class, 0);
 
@@ -4030,7 +4030,7 @@ static scope_entry_t* new_friend_declared_template_class(
             locus);
     template_type_set_related_symbol(new_template->type_information, new_template);
 
-    new_template->locus = locus;
+    new_template->locus = locus_get_id(locus);
     symbol_entity_specs_set_is_friend_declared(new_template, 1);
     symbol_entity_specs_set_is_user_declared(new_template, 0);
 
@@ -4591,7 +4591,7 @@ static void gather_type_spec_from_elaborated_class_specifier(AST a,
             scope_entry_t* new_class = NULL;
             new_class = new_symbol(decl_context, decl_context->current_scope, class_name);
 
-            new_class->locus = ast_get_locus(id_expression);
+            new_class->locus = locus_get_id(ast_get_locus(id_expression));
 
             if ((!class_gather_info.is_template
                         || !class_gather_info.no_declarators)
@@ -4628,7 +4628,7 @@ static void gather_type_spec_from_elaborated_class_specifier(AST a,
                             ast_get_locus(id_expression));
                     template_type_set_related_symbol(new_class->type_information, new_class);
 
-                    new_class->locus = ast_get_locus(a);
+                    new_class->locus = locus_get_id(ast_get_locus(a));
 
                     if (decl_context->current_scope->kind == CLASS_SCOPE)
                     {
@@ -4644,7 +4644,7 @@ static void gather_type_spec_from_elaborated_class_specifier(AST a,
                             template_type_get_primary_type(new_class->type_information)
                             );
                     // Update some fields
-                    class_entry->locus = ast_get_locus(a);
+                    class_entry->locus = locus_get_id(ast_get_locus(a));
 
                     class_type = class_entry->type_information;
                 }
@@ -4735,7 +4735,7 @@ static void gather_type_spec_from_elaborated_class_specifier(AST a,
 
         DEBUG_CODE()
         {
-            fprintf(stderr, "BUILDSCOPE: Class type found already declared in %s, using it\n", locus_to_str(entry->locus));
+            fprintf(stderr, "BUILDSCOPE: Class type found already declared in %s, using it\n", locus_to_str(locus_from_id(entry->locus)));
         }
 
         ERROR_CONDITION(entry->kind != SK_CLASS, "This must be a class", 0);
@@ -4912,7 +4912,7 @@ static void gather_type_spec_from_elaborated_enum_specifier(AST a,
                 && current_entry->kind != SK_DEPENDENT_ENTITY)
 
         {
-            error_printf_at(current_entry->locus, "'%s' is not an enum-name\n", current_entry->symbol_name);
+            error_printf_at(locus_from_id(current_entry->locus), "'%s' is not an enum-name\n", current_entry->symbol_name);
             *type_info = get_error_type();
             return;
         }
@@ -4998,7 +4998,7 @@ static void gather_type_spec_from_elaborated_enum_specifier(AST a,
             }
 
             scope_entry_t* new_enum = new_symbol(new_decl_context, new_decl_context->current_scope, enum_name);
-            new_enum->locus = ast_get_locus(id_expression);
+            new_enum->locus = locus_get_id(ast_get_locus(id_expression));
             new_enum->kind = SK_ENUM;
             new_enum->type_information = get_new_enum_type(decl_context, enum_is_scoped);
 
@@ -5037,7 +5037,7 @@ static void gather_type_spec_from_elaborated_enum_specifier(AST a,
     {
         DEBUG_CODE()
         {
-            fprintf(stderr, "BUILDSCOPE: Enum type found in %s, using it\n", locus_to_str(entry->locus));
+            fprintf(stderr, "BUILDSCOPE: Enum type found in %s, using it\n", locus_to_str(locus_from_id(entry->locus)));
         }
 
         *type_info = get_user_defined_type(entry);
@@ -5464,7 +5464,7 @@ void gather_type_spec_from_enum_specifier(AST a, type_t** type_info,
             }
 
             new_enum = new_symbol(decl_context, decl_context->current_scope, enum_name_str);
-            new_enum->locus = ast_get_locus(enum_name);
+            new_enum->locus = locus_get_id(ast_get_locus(enum_name));
             new_enum->kind = SK_ENUM;
             new_enum->type_information = get_new_enum_type(decl_context, enum_is_scoped);
             symbol_entity_specs_set_is_user_declared(new_enum, 1);
@@ -5493,7 +5493,7 @@ void gather_type_spec_from_enum_specifier(AST a, type_t** type_info,
 
         anonymous_enums++;
 
-        new_enum->locus = ast_get_locus(a);
+        new_enum->locus = locus_get_id(ast_get_locus(a));
         new_enum->kind = SK_ENUM;
         new_enum->type_information = get_new_enum_type(decl_context, enum_is_scoped);
 
@@ -5607,7 +5607,7 @@ void gather_type_spec_from_enum_specifier(AST a, type_t** type_info,
 
             scope_entry_t* enumeration_item = new_symbol(enumerators_context,
                     enumerators_context->current_scope, ASTText(enumeration_name));
-            enumeration_item->locus = ast_get_locus(enumeration_name);
+            enumeration_item->locus = locus_get_id(ast_get_locus(enumeration_name));
             enumeration_item->kind = SK_ENUMERATOR;
             enumeration_item->type_information = get_signed_int_type();
 
@@ -6030,7 +6030,7 @@ static void build_scope_base_clause(AST base_clause, scope_entry_t* class_entry,
                 // Craft a dependent typename since we will need it later for proper updates
                 scope_entry_t* new_sym = NEW0(scope_entry_t);
                 new_sym->kind = SK_DEPENDENT_ENTITY;
-                new_sym->locus = nodecl_get_locus(nodecl_name);
+                new_sym->locus = locus_get_id(nodecl_get_locus(nodecl_name));
                 new_sym->symbol_name = result->symbol_name;
                 new_sym->decl_context = decl_context;
                 new_sym->type_information = build_dependent_typename_for_entry(
@@ -6974,7 +6974,7 @@ void register_symbol_this(const decl_context_t* decl_context,
 
     scope_entry_t* this_symbol = new_symbol(decl_context, decl_context->current_scope, UNIQUESTR_LITERAL("this"));
 
-    this_symbol->locus = locus;
+    this_symbol->locus = locus_get_id(locus);
 
     this_symbol->kind = SK_VARIABLE;
     this_symbol->type_information = this_type;
@@ -7066,7 +7066,7 @@ static void default_constructor_determine_if_constexpr(
                 {
                     scope_entry_t* constructor = NULL;
 
-                    diagnostic_context_push_buffered();
+                    diagnostic_context_push_counting();
                     char valid = check_default_initialization(data_member, data_member->decl_context, locus, &constructor);
                     diagnostic_context_pop_and_discard();
 
@@ -7105,7 +7105,7 @@ static void default_constructor_determine_if_constexpr(
         scope_entry_t *base_class = entry_list_iterator_current(it);
 
         scope_entry_t* constructor = NULL;
-        diagnostic_context_push_buffered();
+        diagnostic_context_push_counting();
         char valid = check_default_initialization(base_class, base_class->decl_context, locus, &constructor);
         diagnostic_context_pop_and_discard();
 
@@ -7580,7 +7580,7 @@ static void declare_constructors_for_candidate_constructor(
                 candidate_constructor_type,
                 constructor_name,
                 templated_class_context,
-                inherited_constructor->locus);
+                locus_from_id(inherited_constructor->locus));
 
         new_inherited_constructor->kind = SK_TEMPLATE;
         new_inherited_constructor->type_information = template_type;
@@ -7599,7 +7599,7 @@ static void declare_constructors_for_candidate_constructor(
     }
 
     new_inherited_constructor->kind = SK_FUNCTION;
-    new_inherited_constructor->locus = locus;
+    new_inherited_constructor->locus = locus_get_id(locus);
     new_inherited_constructor->defined = 0;
 
     symbol_entity_specs_set_is_member(new_inherited_constructor, 1);
@@ -7788,7 +7788,7 @@ static void finish_class_type_cxx(type_t* class_type,
             {
                 fprintf(stderr, "BUILDSCOPE: Completing member '%s' at '%s' with type '%s'\n",
                         data_member->symbol_name,
-                        locus_to_str(data_member->locus),
+                        locus_to_str(locus_from_id(data_member->locus)),
                         print_type_str(data_member->type_information, decl_context));
             }
 
@@ -7883,7 +7883,7 @@ static void finish_class_type_cxx(type_t* class_type,
                     {
                         if (symbol_entity_specs_get_is_final(current_virtual))
                         {
-                            error_printf_at(entry->locus, "member function '%s' overrides final '%s'\n",
+                            error_printf_at(locus_from_id(entry->locus), "member function '%s' overrides final '%s'\n",
                                     print_decl_type_str(entry->type_information,
                                         entry->decl_context,
                                         get_qualified_symbol_name(entry, entry->decl_context)),
@@ -7900,7 +7900,7 @@ static void finish_class_type_cxx(type_t* class_type,
                         {
                             fprintf(stderr, "BUILDSCOPE: Function '%s' of '%s' is inheritedly virtual\n",
                                     print_decl_type_str(entry->type_information, decl_context, entry->symbol_name),
-                                    locus_to_str(entry->locus));
+                                    locus_to_str(locus_from_id(entry->locus)));
                         }
                     }
                 }
@@ -7929,7 +7929,7 @@ static void finish_class_type_cxx(type_t* class_type,
 
             if (symbol_entity_specs_get_is_final(entry) && !symbol_entity_specs_get_is_virtual(entry))
             {
-                error_printf_at(entry->locus, "member function '%s' declared as final but it is not virtual\n",
+                error_printf_at(locus_from_id(entry->locus), "member function '%s' declared as final but it is not virtual\n",
                         print_decl_type_str(entry->type_information,
                             entry->decl_context,
                             get_qualified_symbol_name(entry, entry->decl_context)));
@@ -7967,7 +7967,7 @@ static void finish_class_type_cxx(type_t* class_type,
 
                 if (!does_override)
                 {
-                    error_printf_at(entry->locus, "member function '%s' declared as override but it does not override\n",
+                    error_printf_at(locus_from_id(entry->locus), "member function '%s' declared as override but it does not override\n",
                             print_decl_type_str(entry->type_information,
                                 entry->decl_context,
                                 get_qualified_symbol_name(entry, entry->decl_context)));
@@ -8006,7 +8006,7 @@ static void finish_class_type_cxx(type_t* class_type,
                 set_defaulted_outside_class_specifier(
                         current_member_function,
                         current_member_function->decl_context,
-                        current_member_function->locus);
+                        locus_from_id(current_member_function->locus));
             }
         }
         entry_list_iterator_free(it);
@@ -8047,7 +8047,7 @@ static void finish_class_type_cxx(type_t* class_type,
                 constructor_name);
 
         implicit_default_constructor->kind = SK_FUNCTION;
-        implicit_default_constructor->locus = locus;
+        implicit_default_constructor->locus = locus_get_id(locus);
         symbol_entity_specs_set_is_member(implicit_default_constructor, 1);
         symbol_entity_specs_set_access(implicit_default_constructor, AS_PUBLIC);
         symbol_entity_specs_set_class_type(implicit_default_constructor, type_info);
@@ -8399,7 +8399,7 @@ static void finish_class_type_cxx(type_t* class_type,
                 constructor_name);
 
         implicit_copy_constructor->kind = SK_FUNCTION;
-        implicit_copy_constructor->locus = locus;
+        implicit_copy_constructor->locus = locus_get_id(locus);
         symbol_entity_specs_set_is_member(implicit_copy_constructor, 1);
         symbol_entity_specs_set_access(implicit_copy_constructor, AS_PUBLIC);
         symbol_entity_specs_set_class_type(implicit_copy_constructor, type_info);
@@ -8621,7 +8621,7 @@ static void finish_class_type_cxx(type_t* class_type,
                     1, REF_QUALIFIER_NONE);
 
             implicit_move_constructor->kind = SK_FUNCTION;
-            implicit_move_constructor->locus = locus;
+            implicit_move_constructor->locus = locus_get_id(locus);
             symbol_entity_specs_set_is_member(implicit_move_constructor, 1);
             symbol_entity_specs_set_access(implicit_move_constructor, AS_PUBLIC);
             symbol_entity_specs_set_class_type(implicit_move_constructor, type_info);
@@ -8733,7 +8733,7 @@ static void finish_class_type_cxx(type_t* class_type,
                 STR_OPERATOR_ASSIGNMENT);
 
         implicit_copy_assignment_function->kind = SK_FUNCTION;
-        implicit_copy_assignment_function->locus = locus;
+        implicit_copy_assignment_function->locus = locus_get_id(locus);
         symbol_entity_specs_set_is_member(implicit_copy_assignment_function, 1);
         symbol_entity_specs_set_access(implicit_copy_assignment_function, AS_PUBLIC);
         symbol_entity_specs_set_class_type(implicit_copy_assignment_function, type_info);
@@ -9036,7 +9036,7 @@ static void finish_class_type_cxx(type_t* class_type,
                     STR_OPERATOR_ASSIGNMENT);
 
             implicit_move_assignment_function->kind = SK_FUNCTION;
-            implicit_move_assignment_function->locus = locus;
+            implicit_move_assignment_function->locus = locus_get_id(locus);
             symbol_entity_specs_set_is_member(implicit_move_assignment_function, 1);
             symbol_entity_specs_set_access(implicit_move_assignment_function, AS_PUBLIC);
             symbol_entity_specs_set_class_type(implicit_move_assignment_function, type_info);
@@ -9106,7 +9106,7 @@ static void finish_class_type_cxx(type_t* class_type,
                     NULL, 0, REF_QUALIFIER_NONE));
 
         implicit_destructor->kind = SK_FUNCTION;
-        implicit_destructor->locus = locus;
+        implicit_destructor->locus = locus_get_id(locus);
         implicit_destructor->type_information = destructor_type;
         symbol_entity_specs_set_is_member(implicit_destructor, 1);
         symbol_entity_specs_set_access(implicit_destructor, AS_PUBLIC);
@@ -9250,6 +9250,16 @@ static void build_scope_delayed_function_decl_clear_pending(void)
     _next_delayed_function_decl = 0;
 }
 
+// Wraps a tree to be checked once the class specifier ends. The tree is kept
+// in the symbol, which outlives the parse arena, so a heap copy is wrapped
+static nodecl_t make_cxx_parse_later_of_tree(AST tree)
+{
+    nodecl_t result = nodecl_make_cxx_parse_later(ast_get_locus(tree));
+    nodecl_set_child(result, 0, _nodecl_wrap(ast_copy(tree)));
+
+    return result;
+}
+
 static void build_noexcept_spec(type_t* function_type UNUSED_PARAMETER,
         AST a, const decl_context_t* decl_context,
         nodecl_t* nodecl_output);
@@ -9473,20 +9483,20 @@ static void insert_symbols_in_enclosing_context(const decl_context_t* enclosing_
         {
             symbol_entity_specs_set_is_member_of_anonymous(member, 1);
             symbol_entity_specs_set_anonymous_accessor(member,
-                nodecl_make_symbol(accessor_symbol, accessor_symbol->locus));
+                nodecl_make_symbol(accessor_symbol, locus_from_id(accessor_symbol->locus)));
         }
         else
         {
             symbol_entity_specs_set_is_member_of_anonymous(member, 1);
 
             nodecl_t nodecl_symbol = nodecl_make_symbol(accessor_symbol,
-                             accessor_symbol->locus);
+                             locus_from_id(accessor_symbol->locus));
             nodecl_set_type(nodecl_symbol, lvalue_ref(accessor_symbol->type_information));
 
             nodecl_t nodecl_accessor = cxx_integrate_field_accesses(nodecl_symbol,
                     symbol_entity_specs_get_anonymous_accessor(member));
             nodecl_set_type(nodecl_accessor, lvalue_ref(member->type_information));
-            nodecl_set_locus(nodecl_accessor, accessor_symbol->locus);
+            nodecl_set_locus(nodecl_accessor, locus_from_id(accessor_symbol->locus));
 
             symbol_entity_specs_set_anonymous_accessor(member, nodecl_accessor);
         }
@@ -9537,7 +9547,7 @@ scope_entry_t* finish_anonymous_class(scope_entry_t* class_symbol, const decl_co
     accessor_symbol->type_information = get_user_defined_type(class_symbol);
 
     symbol_entity_specs_set_anonymous_accessor(class_symbol,
-        nodecl_make_symbol(accessor_symbol, class_symbol->locus));
+        nodecl_make_symbol(accessor_symbol, locus_from_id(class_symbol->locus)));
 
     // Sign in members in the appropiate enclosing scope
     insert_symbols_in_enclosing_context(decl_context, class_symbol, accessor_symbol);
@@ -9807,7 +9817,7 @@ void gather_type_spec_from_class_specifier(AST a, type_t** type_info,
                         prettyprint_in_buffer(class_id_expression),
                         class_entry, 
                         class_entry->decl_context->current_scope,
-                        locus_to_str(class_entry->locus));
+                        locus_to_str(locus_from_id(class_entry->locus)));
             }
 
             if (class_entry->defined
@@ -9816,7 +9826,7 @@ void gather_type_spec_from_class_specifier(AST a, type_t** type_info,
             {
                 error_printf_at(ast_get_locus(class_id_expression), "class '%s' already defined\n",
                         get_qualified_symbol_name(class_entry, class_entry->decl_context));
-                info_printf_at(class_symbol_get_canonical_symbol(class_entry)->locus, "location of previous definition\n");
+                info_printf_at(locus_from_id(class_symbol_get_canonical_symbol(class_entry)->locus), "location of previous definition\n");
                 *type_info = get_error_type();
                 return;
             }
@@ -9951,7 +9961,7 @@ void gather_type_spec_from_class_specifier(AST a, type_t** type_info,
                             ast_get_locus(class_id_expression));
                     template_type_set_related_symbol(class_entry->type_information, class_entry);
 
-                    class_entry->locus = ast_get_locus(class_id_expression);
+                    class_entry->locus = locus_get_id(ast_get_locus(class_id_expression));
 
                     // Set it as a member if needed
                     if (decl_context->current_scope->kind == CLASS_SCOPE)
@@ -9979,8 +9989,8 @@ void gather_type_spec_from_class_specifier(AST a, type_t** type_info,
                 }
             }
 
-            class_entry->locus = ast_get_locus(class_id_expression);
-            class_symbol_get_canonical_symbol(class_entry)->locus = ast_get_locus(class_id_expression);
+            class_entry->locus = locus_get_id(ast_get_locus(class_id_expression));
+            class_symbol_get_canonical_symbol(class_entry)->locus = locus_get_id(ast_get_locus(class_id_expression));
 
             inner_decl_context = new_class_context(decl_context, class_entry);
             class_type_set_inner_context(class_type, inner_decl_context);
@@ -10024,7 +10034,7 @@ void gather_type_spec_from_class_specifier(AST a, type_t** type_info,
         class_entry->type_information = get_new_class_type(decl_context, class_kind);
         class_type = class_entry->type_information;
 
-        class_entry->locus = ast_get_locus(a);
+        class_entry->locus = locus_get_id(ast_get_locus(a));
 
         symbol_entity_specs_set_is_unnamed(class_entry, 1);
 
@@ -10359,7 +10369,7 @@ static template_parameter_list_t* hide_template_parameters_because_of_members(
 
         nodecl_t nodecl_name = nodecl_make_cxx_dep_name_simple(
                 current_tpl->entry->symbol_name,
-                current_tpl->entry->locus);
+                locus_from_id(current_tpl->entry->locus));
 
         scope_entry_list_t *entry_list = query_nodecl_name_in_class(
                 decl_context,
@@ -10866,7 +10876,7 @@ static void set_array_type(type_t **declarator_type,
                 scope_entry_t* new_vla_dim = new_symbol(decl_context, decl_context->current_scope, vla_name);
 
                 new_vla_dim->kind = SK_VARIABLE;
-                new_vla_dim->locus = ast_get_locus(constant_expr);
+                new_vla_dim->locus = locus_get_id(ast_get_locus(constant_expr));
 
                 if (!equivalent_types(
                             get_unqualified_type(no_ref(nodecl_get_type(nodecl_expr))),
@@ -10889,7 +10899,7 @@ static void set_array_type(type_t **declarator_type,
                         gather_info->num_vla_dimension_symbols,
                         new_vla_dim);
 
-                nodecl_expr = nodecl_make_symbol(new_vla_dim, new_vla_dim->locus);
+                nodecl_expr = nodecl_make_symbol(new_vla_dim, locus_from_id(new_vla_dim->locus));
                 nodecl_set_type(nodecl_expr, new_vla_dim->type_information);
             }
             else if (decl_context->current_scope->kind == PROTOTYPE_SCOPE)
@@ -11102,7 +11112,7 @@ static void set_function_parameter_clause(type_t** function_type,
 
                 new_parameter->kind = SK_VARIABLE;
                 new_parameter->type_information = get_signed_int_type();
-                new_parameter->locus = ast_get_locus(kr_id);
+                new_parameter->locus = locus_get_id(ast_get_locus(kr_id));
 
                 parameter_info[num_parameters].is_ellipsis = 0;
                 parameter_info[num_parameters].type_info = get_signed_int_type();
@@ -11181,13 +11191,7 @@ static void set_function_parameter_clause(type_t** function_type,
                     //   enum { E = 3 };
                     // };
                     //
-                    AST parent = ast_get_parent(default_argument);
-
-                    nodecl_default_argument = nodecl_make_cxx_parse_later(ast_get_locus(default_argument));
-                    // Keep the current tree
-                    nodecl_set_child(nodecl_default_argument, 0, _nodecl_wrap(default_argument));
-                    // the parent was changed by nodecl_set_child, so fix it (otherwise the tree becomes inconsistent)
-                    ast_set_parent(default_argument, parent);
+                    nodecl_default_argument = make_cxx_parse_later_of_tree(default_argument);
 
                     // We will delay these function declarations in register_function
                 }
@@ -12840,7 +12844,7 @@ static scope_entry_t* register_new_typedef_name(AST declarator_id, type_t* decla
             {
                 error_printf_at(ast_get_locus(declarator_id), "symbol '%s' has been redeclared as a different symbol kind\n", 
                         prettyprint_in_buffer(declarator_id));
-                info_printf_at(entry->locus, "previous declaration of '%s'\n",
+                info_printf_at(locus_from_id(entry->locus), "previous declaration of '%s'\n",
                         entry->symbol_name);
                 return NULL;
             }
@@ -12887,7 +12891,7 @@ static scope_entry_t* register_new_typedef_name(AST declarator_id, type_t* decla
                 info_printf_at(ast_get_locus(declarator_id), "current declaration of '%s' (with type '%s')\n", 
                         prettyprint_in_buffer(declarator_id),
                         print_type_str(declarator_type, decl_context));
-                info_printf_at(entry->locus, "previous declaration of '%s' (with type '%s')\n",
+                info_printf_at(locus_from_id(entry->locus), "previous declaration of '%s' (with type '%s')\n",
                         entry->symbol_name,
                         print_type_str(
                             entry->kind == SK_TYPEDEF
@@ -12953,7 +12957,7 @@ static scope_entry_t* register_new_typedef_name(AST declarator_id, type_t* decla
         fprintf(stderr, "BUILDSCOPE: Registering typedef '%s'\n", ASTText(declarator_id));
     }
 
-    entry->locus = ast_get_locus(declarator_id);
+    entry->locus = locus_get_id(ast_get_locus(declarator_id));
     symbol_entity_specs_set_is_user_declared(entry, 1);
 
     // Dealing with typedefs against function types
@@ -13097,7 +13101,7 @@ static scope_entry_t* register_new_var_or_fun_name(AST declarator_id, type_t* de
             scope_entry_t* entry = entry_list_head(check_list);
             error_printf_at(ast_get_locus(declarator_id), "incompatible redeclaration of '%s' (look at '%s')\n",
                     prettyprint_in_buffer(declarator_id),
-                    locus_to_str(entry->locus));
+                    locus_to_str(locus_from_id(entry->locus)));
             return NULL;
         }
 
@@ -13111,7 +13115,7 @@ static scope_entry_t* register_new_var_or_fun_name(AST declarator_id, type_t* de
         scope_entry_t* entry = NULL;
         entry = new_symbol(decl_context, decl_context->current_scope, ASTText(declarator_id));
 
-        entry->locus = ast_get_locus(declarator_id);
+        entry->locus = locus_get_id(ast_get_locus(declarator_id));
         entry->kind = SK_VARIABLE;
         entry->type_information = declarator_type;
 
@@ -13188,7 +13192,7 @@ static scope_entry_t* register_function(AST declarator_id, type_t* declarator_ty
             new_entry->type_information = declarator_type;
 
             new_entry->kind = SK_FUNCTION;
-            new_entry->locus = ast_get_locus(declarator_id);
+            new_entry->locus = locus_get_id(ast_get_locus(declarator_id));
 
             symbol_entity_specs_set_linkage_spec(new_entry, linkage_current_get_name());
             symbol_entity_specs_set_is_explicit(new_entry, gather_info->is_explicit);
@@ -13254,7 +13258,7 @@ static scope_entry_t* register_function(AST declarator_id, type_t* declarator_ty
 
             // This is a template, not a plain function
             new_entry->kind = SK_TEMPLATE;
-            new_entry->locus = ast_get_locus(declarator_id);
+            new_entry->locus = locus_get_id(ast_get_locus(declarator_id));
 
             symbol_entity_specs_set_is_friend_declared(new_entry, 0);
 
@@ -13276,7 +13280,7 @@ static scope_entry_t* register_function(AST declarator_id, type_t* declarator_ty
                     template_type_get_primary_type(template_type));
 
             // Update info
-            new_entry->locus = ast_get_locus(declarator_id);
+            new_entry->locus = locus_get_id(ast_get_locus(declarator_id));
 
             symbol_entity_specs_set_is_explicit(new_entry, gather_info->is_explicit);
 
@@ -13727,7 +13731,7 @@ static char find_dependent_friend_function_declaration(AST declarator_id,
         func_templ->symbol_name = declarator_name;
 
         func_templ->kind = SK_TEMPLATE;
-        func_templ->locus = ast_get_locus(declarator_id);
+        func_templ->locus = locus_get_id(ast_get_locus(declarator_id));
         symbol_entity_specs_set_is_friend_declared(func_templ, 1);
 
         decl_context_t *updated_decl_context = decl_context_clone(decl_context);
@@ -13753,7 +13757,7 @@ static char find_dependent_friend_function_declaration(AST declarator_id,
     scope_entry_t* new_entry = NEW0(scope_entry_t);
 
     new_entry->kind = SK_DEPENDENT_FRIEND_FUNCTION;
-    new_entry->locus = ast_get_locus(declarator_id);
+    new_entry->locus = locus_get_id(ast_get_locus(declarator_id));
 
     new_entry->type_information = declarator_type;
 
@@ -13954,7 +13958,7 @@ static char find_function_declaration(AST declarator_id,
     {
         scope_entry_t* result = NEW0(scope_entry_t);
         result->kind = SK_DEPENDENT_FRIEND_FUNCTION;
-        result->locus = ast_get_locus(declarator_id);
+        result->locus = locus_get_id(ast_get_locus(declarator_id));
 
         if (ASTKind(declarator_id) == AST_TEMPLATE_ID)
         {
@@ -14194,7 +14198,7 @@ static char find_function_declaration(AST declarator_id,
                         prettyprint_in_buffer(declarator_id),
                         ast_location(declarator_id),
                         print_declarator(function_type_being_declared),
-                        locus_to_str(considered_symbol->locus),
+                        locus_to_str(locus_from_id(considered_symbol->locus)),
                         print_declarator(considered_symbol->type_information)
                        );
                 fprintf(stderr, "BUILDSCOPE: Types used for comparison will be\n"
@@ -14311,7 +14315,7 @@ static char find_function_declaration(AST declarator_id,
                             prettyprint_in_buffer(declarator_id),
                             ast_location(declarator_id),
                             considered_symbol->symbol_name,
-                            locus_to_str(considered_symbol->locus));
+                            locus_to_str(locus_from_id(considered_symbol->locus)));
                 }
             }
             else
@@ -14325,7 +14329,7 @@ static char find_function_declaration(AST declarator_id,
                         error_printf_at(ast_get_locus(declarator_id),
                                 "function '%s' has been declared with different prototype\n",
                                 ASTText(declarator_id));
-                        info_printf_at(entry->locus,
+                        info_printf_at(locus_from_id(entry->locus),
                                 "previous declaration is '%s'\n",
                                 print_decl_type_str(considered_type, decl_context, entry->symbol_name));
                         info_printf_at(ast_get_locus(declarator_id),
@@ -14416,7 +14420,7 @@ static char find_function_declaration(AST declarator_id,
             {
                 scope_entry_t* current_entry = entry_list_iterator_current(it);
 
-                info_printf_at(current_entry->locus, "%s\n",
+                info_printf_at(locus_from_id(current_entry->locus), "%s\n",
                         print_decl_type_str(current_entry->type_information, current_entry->decl_context, 
                             get_qualified_symbol_name(current_entry, current_entry->decl_context)));
             }
@@ -15152,7 +15156,7 @@ static void build_scope_template_simple_declaration(AST a, const decl_context_t*
             }
             else if (is_explicit_specialization)
             {
-                diagnostic_context_push_buffered();
+                diagnostic_context_push_counting();
                 scope_entry_t* constructor = NULL;
                 char valid = check_default_initialization(entry, entry->decl_context, ast_get_locus(a), &constructor);
                 diagnostic_context_pop_and_discard();
@@ -15332,7 +15336,7 @@ static void build_scope_template_template_parameter(AST a,
     new_entry->symbol_name = template_parameter_name;
     new_entry->decl_context = template_context;
 
-    new_entry->locus = ast_get_locus(a);
+    new_entry->locus = locus_get_id(ast_get_locus(a));
 
     if (!is_template_pack)
         new_entry->kind = SK_TEMPLATE_TEMPLATE_PARAMETER;
@@ -15348,7 +15352,7 @@ static void build_scope_template_template_parameter(AST a,
 
     new_entry->type_information = get_new_template_type(template_params_context->template_parameters, 
             /* primary_type = */ primary_type, template_parameter_name, template_context,
-            new_entry->locus);
+            locus_from_id(new_entry->locus));
     set_is_dependent_type(new_entry->type_information, 1);
 
     template_type_set_related_symbol(new_entry->type_information, new_entry);
@@ -15474,7 +15478,7 @@ static void build_scope_type_template_parameter(AST a,
     new_entry->symbol_name = template_parameter_name;
 
 
-    new_entry->locus = make_locus(file, line, 0);
+    new_entry->locus = locus_get_id(make_locus(file, line, 0));
     if (!is_template_pack)
         new_entry->kind = SK_TEMPLATE_TYPE_PARAMETER;
     else
@@ -15704,7 +15708,7 @@ static void build_scope_namespace_alias(AST a, const decl_context_t* decl_contex
     {
         alias_entry = new_symbol(decl_context, decl_context->current_scope, alias_name);
 
-        alias_entry->locus = ast_get_locus(alias_ident);
+        alias_entry->locus = locus_get_id(ast_get_locus(alias_ident));
         alias_entry->kind = SK_NAMESPACE;
         alias_entry->related_decl_context = entry->related_decl_context;
         alias_entry->defined = 1;
@@ -15777,7 +15781,7 @@ static void build_scope_namespace_definition(AST a,
             entry = new_symbol(decl_context, decl_context->current_scope, ASTText(namespace_name));
             namespace_context = new_namespace_context(decl_context, entry);
 
-            entry->locus = ast_get_locus(namespace_name);
+            entry->locus = locus_get_id(ast_get_locus(namespace_name));
             entry->kind = SK_NAMESPACE;
             entry->related_decl_context = namespace_context;
             symbol_entity_specs_set_is_user_declared(entry, 1);
@@ -15838,7 +15842,7 @@ static void build_scope_namespace_definition(AST a,
             scope_entry_t* entry = new_symbol(decl_context, decl_context->current_scope, unnamed_namespace);
             namespace_context = new_namespace_context(decl_context, entry);
 
-            entry->locus = ast_get_locus(a);
+            entry->locus = locus_get_id(ast_get_locus(a));
             entry->kind = SK_NAMESPACE;
             entry->related_decl_context = namespace_context;
 
@@ -16915,7 +16919,7 @@ static scope_entry_t* build_scope_function_definition_declarator(
         }
         error_printf_at(ast_get_locus(function_definition), "function '%s' already defined\n",
                 funct_name);
-        info_printf_at(entry->locus, "location of previous definition\n");
+        info_printf_at(locus_from_id(entry->locus), "location of previous definition\n");
         return NULL;
     }
 
@@ -17018,12 +17022,12 @@ static void emit_mercurium_pretty_function(nodecl_t body_nodecl, scope_entry_t*
                     nodecl_make_cxx_def(
                         nodecl_null(),
                         mercurium_pretty_function,
-                        mercurium_pretty_function->locus));
+                        locus_from_id(mercurium_pretty_function->locus)));
         }
         emit_mercurium_pretty_function_tree = nodecl_append_to_list(
                 emit_mercurium_pretty_function_tree,
                 nodecl_make_object_init(mercurium_pretty_function,
-                    mercurium_pretty_function->locus));
+                    locus_from_id(mercurium_pretty_function->locus)));
 
         nodecl_t statements_list = nodecl_get_child(body_nodecl, 0);
         statements_list = nodecl_concat_lists(emit_mercurium_pretty_function_tree, statements_list);
@@ -17853,7 +17857,7 @@ static void update_member_function_info(
                     {
                         fprintf(stderr, "BUILDSCOPE: Symbol '%s' at '%s' is a constructor\n", 
                                 entry->symbol_name,
-                                locus_to_str(entry->locus));
+                                locus_to_str(locus_from_id(entry->locus)));
                     }
 
                     if (can_be_called_with_number_of_arguments(entry, 1))
@@ -17862,7 +17866,7 @@ static void update_member_function_info(
                         {
                             fprintf(stderr, "BUILDSCOPE: Symbol '%s' at '%s' is a conversor constructor\n", 
                                     entry->symbol_name,
-                                    locus_to_str(entry->locus));
+                                    locus_to_str(locus_from_id(entry->locus)));
                         }
                         symbol_entity_specs_set_is_conversor_constructor(entry, 1);
                     }
@@ -18942,13 +18946,7 @@ static void build_exception_spec(type_t* function_type UNUSED_PARAMETER,
         if (gather_info->inside_class_specifier)
         {
             // Parse noexcept(E) later
-            AST parent = ast_get_parent(a);
-
-            gather_info->noexception = nodecl_make_cxx_parse_later(ast_get_locus(a));
-            nodecl_set_child(gather_info->noexception, 0, _nodecl_wrap(a));
-
-            // Restore parent modified by nodecl_set_child
-            ast_set_parent(a, parent);
+            gather_info->noexception = make_cxx_parse_later_of_tree(a);
         }
         else
         {
@@ -19800,7 +19798,7 @@ static void build_scope_for_statement_nonrange(AST a,
             nodecl_loop_init
                 = nodecl_append_to_list(
                         nodecl_loop_init,
-                        nodecl_make_object_init(entry, entry->locus));
+                        nodecl_make_object_init(entry, locus_from_id(entry->locus)));
         }
         entry_list_iterator_free(it);
 
@@ -20119,7 +20117,7 @@ static void build_scope_nodecl_for_statement_range_nondependent(
     begin_symbol->symbol_name = UNIQUESTR_LITERAL("__begin");
     begin_symbol->kind = SK_VARIABLE;
     begin_symbol->type_information = get_auto_type();
-    begin_symbol->locus = locus;
+    begin_symbol->locus = locus_get_id(locus);
 
     nodecl_initializer_tmp = nodecl_null();
     check_nodecl_initialization(
@@ -20143,7 +20141,7 @@ static void build_scope_nodecl_for_statement_range_nondependent(
     end_symbol->symbol_name = UNIQUESTR_LITERAL("__end");
     end_symbol->kind = SK_VARIABLE;
     end_symbol->type_information = get_auto_type();
-    end_symbol->locus = locus;
+    end_symbol->locus = locus_get_id(locus);
 
     nodecl_initializer_tmp = nodecl_null();
     check_nodecl_initialization(nodecl_end_init,
@@ -20242,7 +20240,7 @@ static void build_scope_nodecl_for_statement_range(
     range_symbol->symbol_name = UNIQUESTR_LITERAL("__range");
     range_symbol->kind = SK_VARIABLE;
     range_symbol->type_information = get_rvalue_reference_type(get_auto_type());
-    range_symbol->locus = locus;
+    range_symbol->locus = locus_get_id(locus);
 
     nodecl_t nodecl_orig_range_initializer = nodecl_range_initializer;
     check_nodecl_initialization(
@@ -20471,7 +20469,7 @@ scope_entry_t* add_label_if_not_found(const char* label_text, const decl_context
     {
         sym_label = new_symbol(decl_context, decl_context->function_scope, label_text);
         sym_label->kind = SK_LABEL;
-        sym_label->locus = locus;
+        sym_label->locus = locus_get_id(locus);
     }
     else
     {
@@ -21556,10 +21554,10 @@ static void finish_pragma_declaration(
             nodecl_single_pragma_declaration = nodecl_make_pragma_custom_declaration(
                     nodecl_shallow_copy(info->pragma_lines[j]),
                     nodecl_single_pragma_declaration,
-                    nodecl_make_pragma_context(decl_context, entry->locus),
+                    nodecl_make_pragma_context(decl_context, locus_from_id(entry->locus)),
                     nodecl_make_pragma_context(
                         get_prototype_context_if_any(decl_context, entry, gather_info, info),
-                        entry->locus),
+                        locus_from_id(entry->locus)),
                     entry,
                     info->pragma_texts[j],
                     nodecl_get_locus(info->pragma_lines[j]));
@@ -22238,7 +22236,7 @@ nodecl_t internal_expression_parse(const char *source, const decl_context_t* dec
     }
 
     nodecl_t nodecl_expr = nodecl_null();
-    diagnostic_context_push_buffered();
+    diagnostic_context_push_counting();
     char c = check_expression(a, decl_context, &nodecl_expr);
     diagnostic_context_pop_and_discard();
 
@@ -22617,7 +22615,7 @@ static void instantiate_template_function_code(
         check_nodecl_member_initializer_list(instantiated_nodecl_initializers,
                 v->new_function_instantiated,
                 new_decl_context,
-                v->new_function_instantiated->locus,
+                locus_from_id(v->new_function_instantiated->locus),
                 &new_nodecl_initializers);
     }
 
@@ -22626,7 +22624,7 @@ static void instantiate_template_function_code(
         call_destructor_for_data_layout_members(
                 v->new_function_instantiated,
                 v->new_decl_context,
-                v->new_function_instantiated->locus);
+                locus_from_id(v->new_function_instantiated->locus));
     }
 
     v->nodecl_result =
@@ -22635,10 +22633,10 @@ static void instantiate_template_function_code(
                     nodecl_make_context(
                         new_nodecl_stmt_list,
                         new_decl_context,
-                        v->new_function_instantiated->locus),
+                        locus_from_id(v->new_function_instantiated->locus)),
                     new_nodecl_initializers,
                     v->new_function_instantiated,
-                    v->new_function_instantiated->locus
+                    locus_from_id(v->new_function_instantiated->locus)
                     )
                 );
 
@@ -22971,7 +22969,7 @@ static void instantiate_cxx_for_ranged(nodecl_instantiate_stmt_visitor_t* v, nod
     scope_entry_t* new_iterator_symbol = instantiate_declaration_common(
             v,
             iterator_symbol,
-            iterator_symbol->locus,
+            locus_from_id(iterator_symbol->locus),
             /* is_definition */ 1,
             /* check_initializer */ 0);
 
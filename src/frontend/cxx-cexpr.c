@@ -1397,6 +1397,9 @@ static inline nodecl_t cache_const(const_value_t* v, type_t* basic_type, nodecl_
 {
     if (cached)
     {
+        ERROR_CONDITION(ast_is_in_arena(nodecl_get_ast(n)),
+                "Cached constant trees cannot live in a parse arena", 0);
+
         const_value_hash_item_set_t* cached_result =
             (const_value_hash_item_set_t*)dhash_ptr_query(_const_value_nodecl_cache, (const char*)v);
 
@@ -1429,7 +1432,7 @@ nodecl_t const_value_to_nodecl_(const_value_t* v,
     {
         if (_const_value_nodecl_cache == NULL)
         {
-            _const_value_nodecl_cache = dhash_ptr_new(5);
+            _const_value_nodecl_cache = dhash_ptr_new(256);
         }
         else
         {
@@ -110,7 +110,7 @@ void cuda_kernel_symbols_for_function_body(
                     block_context->current_scope, 
                     uniquestr(cuda_builtins[i].name));
 
-            cuda_sym->locus = ast_get_locus(function_body);
+            cuda_sym->locus = locus_get_id(ast_get_locus(function_body));
 
             cuda_sym->kind = SK_VARIABLE;
             cuda_sym->type_information = cuda_builtins[i].type;
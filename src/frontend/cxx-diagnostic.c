@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "cxx-diagnostic.h"
 #include "cxx-process.h"
@@ -41,7 +43,528 @@ typedef enum diagnostic_severity_tag
     DS_ERROR = 3,
 } diagnostic_severity_t;
 
-typedef void (*diagnose_fun_t)(diagnostic_context_t*, diagnostic_severity_t, const char*);
+//
+// Diagnostics
+//
+// A diagnostic keeps the format and a copy of its arguments. The message
+// is only formatted when it has to be printed, so diagnostics emitted in
+// buffered contexts that end up discarded (like those of the failing
+// interpretations of an ambiguity) never pay for the formatting
+//
+typedef enum diagnostic_arg_kind_tag
+{
+    DAK_INT = 0,
+    DAK_LONG,
+    DAK_LONG_LONG,
+    DAK_INTMAX,
+    DAK_SIZE,
+    DAK_PTRDIFF,
+    DAK_DOUBLE,
+    DAK_LONG_DOUBLE,
+    DAK_STRING,
+    DAK_POINTER,
+} diagnostic_arg_kind_t;
+
+typedef struct diagnostic_arg_tag
+{
+    diagnostic_arg_kind_t kind;
+    // Values of '*' width and precision, if any
+    int width;
+    int precision;
+    union {
+        int i;
+        long l;
+        long long ll;
+        intmax_t j;
+        size_t z;
+        ptrdiff_t t;
+        double d;
+        long double ld;
+        char* s;
+        void* p;
+    } value;
+} diagnostic_arg_t;
+
+typedef struct diagnostic_tag diagnostic_t;
+struct diagnostic_tag
+{
+    diagnostic_severity_t severity;
+    const locus_t* locus;
+    const char* kind_message;
+
+    // NULL if the message was already formatted
+    const char* format;
+    int num_args;
+    diagnostic_arg_t* args;
+
+    // Formatted message
+    const char* message;
+};
+
+// Parses the conversion specification starting at format (just after '%').
+// Returns the number of characters of the specification. Returns -1 if it
+// cannot be captured
+static int parse_conversion(const char* format,
+        char* width_is_star,
+        char* precision_is_star,
+        int* precision,
+        diagnostic_arg_kind_t* kind,
+        char* conversion)
+{
+    const char* p = format;
+    *width_is_star = *precision_is_star = 0;
+    *precision = -1;
+
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'')
+        p++;
+
+    if (*p == '*')
+    {
+        *width_is_star = 1;
+        p++;
+    }
+    else
+    {
+        while ('0' <= *p && *p <= '9')
+            p++;
+    }
+
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '*')
+        {
+            *precision_is_star = 1;
+            p++;
+        }
+        else
+        {
+            *precision = 0;
+            while ('0' <= *p && *p <= '9')
+            {
+                *precision = *precision * 10 + (*p - '0');
+                p++;
+            }
+        }
+    }
+
+    diagnostic_arg_kind_t int_kind = DAK_INT;
+    char long_double = 0;
+    switch (*p)
+    {
+        case 'h':
+            p++;
+            if (*p == 'h')
+                p++;
+            break;
+        case 'l':
+            p++;
+            int_kind = DAK_LONG;
+            if (*p == 'l')
+            {
+                int_kind = DAK_LONG_LONG;
+                p++;
+            }
+            break;
+        case 'q':
+            p++;
+            int_kind = DAK_LONG_LONG;
+            break;
+        case 'j':
+            p++;
+            int_kind = DAK_INTMAX;
+            break;
+        case 'z':
+            p++;
+            int_kind = DAK_SIZE;
+            break;
+        case 't':
+            p++;
+            int_kind = DAK_PTRDIFF;
+            break;
+        case 'L':
+            p++;
+            long_double = 1;
+            break;
+        default:
+            break;
+    }
+
+    *conversion = *p;
+    switch (*p)
+    {
+        case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+            *kind = int_kind;
+            break;
+        case 'c':
+            // Wide characters are not captured
+            if (int_kind != DAK_INT)
+                return -1;
+            *kind = DAK_INT;
+            break;
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+            *kind = long_double ? DAK_LONG_DOUBLE : DAK_DOUBLE;
+            break;
+        case 's':
+            // Wide strings are not captured
+            if (int_kind != DAK_INT)
+                return -1;
+            *kind = DAK_STRING;
+            break;
+        case 'p':
+            *kind = DAK_POINTER;
+            break;
+        case '%':
+            break;
+        default:
+            // %n, %m and anything unknown
+            return -1;
+    }
+
+    return (p - format) + 1;
+}
+
+static char format_can_be_captured(const char* format, int* num_args)
+{
+    *num_args = 0;
+    const char* p;
+    for (p = format; *p != '\0'; p++)
+    {
+        if (*p != '%')
+            continue;
+
+        char width_is_star, precision_is_star, conversion;
+        int precision;
+        diagnostic_arg_kind_t kind;
+        int length = parse_conversion(p + 1, &width_is_star, &precision_is_star,
+                &precision, &kind, &conversion);
+        if (length < 0)
+            return 0;
+
+        if (conversion != '%')
+            (*num_args)++;
+        p += length;
+    }
+
+    return 1;
+}
+
+static char* copy_string_arg(const char* s, int precision)
+{
+    if (s == NULL)
+        return NULL;
+
+    // With a precision the string does not have to be null ended
+    size_t length = 0;
+    while ((precision < 0 || length < (size_t)precision)
+            && s[length] != '\0')
+        length++;
+
+    char* result = NEW_VEC(char, length + 1);
+    memcpy(result, s, length);
+    result[length] = '\0';
+
+    return result;
+}
+
+static diagnostic_t* diagnostic_new_captured(diagnostic_severity_t severity,
+        const locus_t* locus,
+        const char* kind_message,
+        const char* format,
+        int num_args,
+        va_list va)
+{
+    diagnostic_t* result = NEW0(diagnostic_t);
+    result->severity = severity;
+    result->locus = locus;
+    result->kind_message = kind_message;
+    result->format = uniquestr(format);
+    result->num_args = num_args;
+    result->args = NEW_VEC0(diagnostic_arg_t, num_args);
+
+    int n = 0;
+    const char* p;
+    for (p = format; *p != '\0'; p++)
+    {
+        if (*p != '%')
+            continue;
+
+        char width_is_star, precision_is_star, conversion;
+        int precision;
+        diagnostic_arg_kind_t kind;
+        p += parse_conversion(p + 1, &width_is_star, &precision_is_star,
+                &precision, &kind, &conversion);
+
+        if (conversion == '%')
+            continue;
+
+        diagnostic_arg_t* arg = &result->args[n];
+        n++;
+
+        arg->kind = kind;
+        if (width_is_star)
+            arg->width = va_arg(va, int);
+        if (precision_is_star)
+        {
+            precision = va_arg(va, int);
+            arg->precision = precision;
+        }
+
+        switch (kind)
+        {
+            case DAK_INT: arg->value.i = va_arg(va, int); break;
+            case DAK_LONG: arg->value.l = va_arg(va, long); break;
+            case DAK_LONG_LONG: arg->value.ll = va_arg(va, long long); break;
+            case DAK_INTMAX: arg->value.j = va_arg(va, intmax_t); break;
+            case DAK_SIZE: arg->value.z = va_arg(va, size_t); break;
+            case DAK_PTRDIFF: arg->value.t = va_arg(va, ptrdiff_t); break;
+            case DAK_DOUBLE: arg->value.d = va_arg(va, double); break;
+            case DAK_LONG_DOUBLE: arg->value.ld = va_arg(va, long double); break;
+            case DAK_STRING:
+                arg->value.s = copy_string_arg(va_arg(va, const char*), precision);
+                break;
+            case DAK_POINTER: arg->value.p = va_arg(va, void*); break;
+            default:
+                internal_error("Invalid argument kind %d", kind);
+        }
+    }
+
+    return result;
+}
+
+static const char* diagnostic_prefix_message(const locus_t* locus,
+        const char* kind_message,
+        const char* message)
+{
+    if (locus != NULL)
+    {
+        uniquestr_sprintf(&message, "%s: %s: %s",
+                locus_to_str(locus),
+                kind_message,
+                message);
+    }
+    else
+    {
+        uniquestr_sprintf(&message, "%s: %s",
+                kind_message,
+                message);
+    }
+    return message;
+}
+
+static diagnostic_t* diagnostic_new_formatted(diagnostic_severity_t severity,
+        const char* message)
+{
+    diagnostic_t* result = NEW0(diagnostic_t);
+    result->severity = severity;
+    result->message = message;
+
+    return result;
+}
+
+static void append_conversion(char** buffer, size_t* length, size_t* capacity,
+        const char* spec, diagnostic_arg_t* arg)
+{
+    for (;;)
+    {
+        size_t available = *capacity - *length;
+        int n = 0;
+        switch (arg->kind)
+        {
+            case DAK_INT: n = snprintf(*buffer + *length, available, spec, arg->value.i); break;
+            case DAK_LONG: n = snprintf(*buffer + *length, available, spec, arg->value.l); break;
+            case DAK_LONG_LONG: n = snprintf(*buffer + *length, available, spec, arg->value.ll); break;
+            case DAK_INTMAX: n = snprintf(*buffer + *length, available, spec, arg->value.j); break;
+            case DAK_SIZE: n = snprintf(*buffer + *length, available, spec, arg->value.z); break;
+            case DAK_PTRDIFF: n = snprintf(*buffer + *length, available, spec, arg->value.t); break;
+            case DAK_DOUBLE: n = snprintf(*buffer + *length, available, spec, arg->value.d); break;
+            case DAK_LONG_DOUBLE: n = snprintf(*buffer + *length, available, spec, arg->value.ld); break;
+            case DAK_STRING: n = snprintf(*buffer + *length, available, spec, arg->value.s); break;
+            case DAK_POINTER: n = snprintf(*buffer + *length, available, spec, arg->value.p); break;
+            default:
+                internal_error("Invalid argument kind %d", arg->kind);
+        }
+        ERROR_CONDITION(n < 0, "Invalid format", 0);
+
+        if ((size_t)n < available)
+        {
+            *length += n;
+            return;
+        }
+
+        *capacity = 2 * (*capacity) + n;
+        *buffer = NEW_REALLOC(char, *buffer, *capacity);
+    }
+}
+
+static const char* diagnostic_get_message(diagnostic_t* d)
+{
+    if (d->message != NULL)
+        return d->message;
+
+    size_t capacity = 256;
+    size_t length = 0;
+    char* buffer = NEW_VEC(char, capacity);
+
+    int n = 0;
+    const char* p = d->format;
+    while (*p != '\0')
+    {
+        if (*p != '%')
+        {
+            if (length + 1 >= capacity)
+            {
+                capacity *= 2;
+                buffer = NEW_REALLOC(char, buffer, capacity);
+            }
+            buffer[length++] = *p++;
+            continue;
+        }
+
+        char width_is_star, precision_is_star, conversion;
+        int precision;
+        diagnostic_arg_kind_t kind;
+        int spec_length = parse_conversion(p + 1, &width_is_star, &precision_is_star,
+                &precision, &kind, &conversion);
+
+        if (conversion == '%')
+        {
+            if (length + 1 >= capacity)
+            {
+                capacity *= 2;
+                buffer = NEW_REALLOC(char, buffer, capacity);
+            }
+            buffer[length++] = '%';
+            p += spec_length + 1;
+            continue;
+        }
+
+        diagnostic_arg_t* arg = &d->args[n];
+        n++;
+
+        // Rewrite the specification replacing '*' with the captured values
+        char spec[spec_length + 64];
+        char* q = spec;
+        const char* it;
+        for (it = p; it <= p + spec_length; it++)
+        {
+            if (*it == '*' && *(it - 1) == '.')
+            {
+                // A negative precision is like no precision at all
+                q--;
+                if (arg->precision >= 0)
+                    q += sprintf(q, ".%d", arg->precision);
+            }
+            else if (*it == '*')
+            {
+                q += sprintf(q, "%d", arg->width);
+            }
+            else
+            {
+                *q++ = *it;
+            }
+        }
+        *q = '\0';
+
+        append_conversion(&buffer, &length, &capacity, spec, arg);
+        p += spec_length + 1;
+    }
+    buffer[length] = '\0';
+
+    d->message = diagnostic_prefix_message(d->locus, d->kind_message, uniquestr(buffer));
+    DELETE(buffer);
+
+    return d->message;
+}
+
+static char same_diagnostic(diagnostic_t* d1, diagnostic_t* d2)
+{
+    if (d1->severity != d2->severity)
+        return 0;
+
+    if (d1->format == NULL
+            || d2->format == NULL)
+        return diagnostic_get_message(d1) == diagnostic_get_message(d2);
+
+    if (d1->locus != d2->locus
+            || d1->kind_message != d2->kind_message
+            || d1->format != d2->format
+            || d1->num_args != d2->num_args)
+        return 0;
+
+    int i;
+    for (i = 0; i < d1->num_args; i++)
+    {
+        diagnostic_arg_t* a1 = &d1->args[i];
+        diagnostic_arg_t* a2 = &d2->args[i];
+
+        if (a1->width != a2->width
+                || a1->precision != a2->precision)
+            return 0;
+
+        switch (a1->kind)
+        {
+            case DAK_INT: if (a1->value.i != a2->value.i) return 0; break;
+            case DAK_LONG: if (a1->value.l != a2->value.l) return 0; break;
+            case DAK_LONG_LONG: if (a1->value.ll != a2->value.ll) return 0; break;
+            case DAK_INTMAX: if (a1->value.j != a2->value.j) return 0; break;
+            case DAK_SIZE: if (a1->value.z != a2->value.z) return 0; break;
+            case DAK_PTRDIFF: if (a1->value.t != a2->value.t) return 0; break;
+            case DAK_DOUBLE: if (a1->value.d != a2->value.d) return 0; break;
+            case DAK_LONG_DOUBLE: if (a1->value.ld != a2->value.ld) return 0; break;
+            case DAK_STRING:
+                {
+                    if ((a1->value.s == NULL) != (a2->value.s == NULL)
+                            || (a1->value.s != NULL
+                                && strcmp(a1->value.s, a2->value.s) != 0))
+                        return 0;
+                    break;
+                }
+            case DAK_POINTER: if (a1->value.p != a2->value.p) return 0; break;
+            default:
+                internal_error("Invalid argument kind %d", a1->kind);
+        }
+    }
+
+    return 1;
+}
+
+static void diagnostic_free(diagnostic_t* d)
+{
+    int i;
+    for (i = 0; i < d->num_args; i++)
+    {
+        if (d->args[i].kind == DAK_STRING)
+            DELETE(d->args[i].value.s);
+    }
+    DELETE(d->args);
+    DELETE(d);
+}
+
+static diagnostic_t* diagnostic_copy(diagnostic_t* d)
+{
+    diagnostic_t* result = NEW(diagnostic_t);
+    *result = *d;
+
+    result->args = NULL;
+    if (d->num_args > 0)
+    {
+        result->args = NEW_VEC(diagnostic_arg_t, d->num_args);
+        memcpy(result->args, d->args, d->num_args * sizeof(*d->args));
+
+        int i;
+        for (i = 0; i < d->num_args; i++)
+        {
+            if (d->args[i].kind == DAK_STRING)
+                result->args[i].value.s = copy_string_arg(d->args[i].value.s, /* precision */ -1);
+        }
+    }
+
+    return result;
+}
+
+// Diagnosing functions take the ownership of the diagnostic
+typedef void (*diagnose_fun_t)(diagnostic_context_t*, diagnostic_t*);
 typedef int (*get_count_fun_t)(diagnostic_context_t*, diagnostic_severity_t);
 typedef void (*discard_fun_t)(diagnostic_context_t*);
 typedef void (*commit_fun_t)(diagnostic_context_t*, diagnostic_context_t*);
@@ -74,11 +597,11 @@ struct diagnostic_context_stderr_tag
     diagnostic_context_t _base;
 };
 
-static void diagnose_to_stderr(diagnostic_context_stderr_t* ctx, diagnostic_severity_t severity, const char* message)
+static void diagnose_to_stderr(diagnostic_context_stderr_t* ctx, diagnostic_t* d)
 {
-    fputs(message, stderr);
+    fputs(diagnostic_get_message(d), stderr);
 
-    switch (severity)
+    switch (d->severity)
     {
         case DS_INFO:
             ctx->_base.num_info++;
@@ -92,8 +615,10 @@ static void diagnose_to_stderr(diagnostic_context_stderr_t* ctx, diagnostic_seve
                 raise(SIGABRT);
             break;
         default:
-            internal_error("Invalid severity value %d", severity);
+            internal_error("Invalid severity value %d", d->severity);
     }
+
+    diagnostic_free(d);
 }
 
 static int diagnose_to_stderr_count(diagnostic_context_stderr_t* ctx UNUSED_PARAMETER, diagnostic_severity_t severity)
@@ -144,54 +669,48 @@ static diagnostic_context_stderr_t diagnostic_context_stderr =
 //
 // Diagnose to buffer
 //
-struct severity_message_pair_tag
-{
-    diagnostic_severity_t severity;
-    const char* message;
-};
-
-char same_diag_pair(struct severity_message_pair_tag m1, struct severity_message_pair_tag m2)
-{
-    return (m1.severity == m2.severity
-            && m1.message == m2.message);
-}
-
-
 typedef struct diagnostic_buffered_tag diagnostic_context_buffered_t;
 
 struct diagnostic_buffered_tag
 {
     diagnostic_context_t _base;
     int num_diagnostics;
-    struct severity_message_pair_tag *diagnostics;
+    diagnostic_t** diagnostics;
+
+    // Diagnostics not kept because they were already in the buffer
+    int num_collapsed;
 };
 
 static void diagnose_to_buffer(diagnostic_context_buffered_t* ctx,
-        diagnostic_severity_t severity,
-        const char* message)
+        diagnostic_t* d)
 {
-    struct severity_message_pair_tag pair = { severity, message };
-    int prev = ctx->num_diagnostics;
-    P_LIST_ADD_ONCE_FUN(ctx->diagnostics, ctx->num_diagnostics, pair, same_diag_pair);
-
-    if (prev < ctx->num_diagnostics)
+    int i;
+    for (i = 0; i < ctx->num_diagnostics; i++)
     {
-        // Was it actually added?
-        switch (severity)
+        if (same_diagnostic(ctx->diagnostics[i], d))
         {
-            case DS_INFO:
-                ctx->_base.num_info++;
-                break;
-            case DS_WARNING:
-                ctx->_base.num_warning++;
-                break;
-            case DS_ERROR:
-                ctx->_base.num_error++;
-                break;
-            default:
-                internal_error("Invalid severity value %d", severity);
+            ctx->num_collapsed++;
+            diagnostic_free(d);
+            return;
         }
     }
+
+    P_LIST_ADD(ctx->diagnostics, ctx->num_diagnostics, d);
+
+    switch (d->severity)
+    {
+        case DS_INFO:
+            ctx->_base.num_info++;
+            break;
+        case DS_WARNING:
+            ctx->_base.num_warning++;
+            break;
+        case DS_ERROR:
+            ctx->_base.num_error++;
+            break;
+        default:
+            internal_error("Invalid severity value %d", d->severity);
+    }
 }
 
 static int diagnose_to_buffer_count(diagnostic_context_buffered_t* ctx,
@@ -212,6 +731,11 @@ static int diagnose_to_buffer_count(diagnostic_context_buffered_t* ctx,
 
 static void diagnose_to_buffer_discard(diagnostic_context_buffered_t* ctx)
 {
+    int i;
+    for (i = 0; i < ctx->num_diagnostics; i++)
+    {
+        diagnostic_free(ctx->diagnostics[i]);
+    }
     DELETE(ctx->diagnostics);
     DELETE(ctx);
 }
@@ -221,7 +745,7 @@ static void diagnose_to_buffer_commit(diagnostic_context_buffered_t* ctx, diagno
     int i;
     for (i = 0; i < ctx->num_diagnostics; i++)
     {
-        (dest->diagnose)(dest, ctx->diagnostics[i].severity, ctx->diagnostics[i].message);
+        (dest->diagnose)(dest, ctx->diagnostics[i]);
     }
     DELETE(ctx->diagnostics);
     DELETE(ctx);
@@ -239,6 +763,133 @@ diagnostic_context_t* diagnostic_context_new_buffered(void)
     return (diagnostic_context_t*)result;
 }
 
+diagnostic_context_t* diagnostic_context_new_buffered_copy(diagnostic_context_t* ctx)
+{
+    ERROR_CONDITION(ctx->commit != (commit_fun_t)diagnose_to_buffer_commit,
+            "Only buffered diagnostic contexts can be copied", 0);
+    diagnostic_context_buffered_t* buffered_ctx = (diagnostic_context_buffered_t*)ctx;
+
+    diagnostic_context_buffered_t* result =
+        (diagnostic_context_buffered_t*)diagnostic_context_new_buffered();
+
+    int i;
+    for (i = 0; i < buffered_ctx->num_diagnostics; i++)
+    {
+        diagnose_to_buffer(result, diagnostic_copy(buffered_ctx->diagnostics[i]));
+    }
+
+    return (diagnostic_context_t*)result;
+}
+
+char diagnostic_context_mark(diagnostic_mark_t* mark)
+{
+    diagnostic_context_t* ctx = current_diagnostic_context;
+    if (ctx->diagnose != (diagnose_fun_t)diagnose_to_buffer)
+        return 0;
+
+    diagnostic_context_buffered_t* buffered_ctx = (diagnostic_context_buffered_t*)ctx;
+    mark->num_diagnostics = buffered_ctx->num_diagnostics;
+    mark->num_collapsed = buffered_ctx->num_collapsed;
+
+    return 1;
+}
+
+char diagnostic_context_copy_since_mark(const diagnostic_mark_t* mark,
+        diagnostic_context_t** copy)
+{
+    diagnostic_context_t* ctx = current_diagnostic_context;
+    ERROR_CONDITION(ctx->diagnose != (diagnose_fun_t)diagnose_to_buffer,
+            "The current diagnostic context is not buffered", 0);
+
+    diagnostic_context_buffered_t* buffered_ctx = (diagnostic_context_buffered_t*)ctx;
+    *copy = NULL;
+    if (buffered_ctx->num_collapsed != mark->num_collapsed)
+        return 0;
+
+    if (buffered_ctx->num_diagnostics == mark->num_diagnostics)
+        return 1;
+
+    diagnostic_context_buffered_t* result =
+        (diagnostic_context_buffered_t*)diagnostic_context_new_buffered();
+
+    int i;
+    for (i = mark->num_diagnostics; i < buffered_ctx->num_diagnostics; i++)
+    {
+        diagnose_to_buffer(result, diagnostic_copy(buffered_ctx->diagnostics[i]));
+    }
+
+    *copy = (diagnostic_context_t*)result;
+    return 1;
+}
+
+//
+// Diagnose to counter
+//
+static void diagnose_to_counter(diagnostic_context_t* ctx, diagnostic_t* d)
+{
+    switch (d->severity)
+    {
+        case DS_INFO:
+            ctx->num_info++;
+            break;
+        case DS_WARNING:
+            ctx->num_warning++;
+            break;
+        case DS_ERROR:
+            ctx->num_error++;
+            break;
+        default:
+            internal_error("Invalid severity value %d", d->severity);
+    }
+
+    diagnostic_free(d);
+}
+
+static int diagnose_to_counter_count(diagnostic_context_t* ctx,
+        diagnostic_severity_t severity)
+{
+    switch (severity)
+    {
+        case DS_INFO:
+            return ctx->num_info;
+        case DS_WARNING:
+            return ctx->num_warning;
+        case DS_ERROR:
+            return ctx->num_error;
+        default:
+            internal_error("Invalid severity value %d", severity);
+    }
+}
+
+static void diagnose_to_counter_discard(diagnostic_context_t* ctx)
+{
+    DELETE(ctx);
+}
+
+static void diagnose_to_counter_commit(diagnostic_context_t* ctx, diagnostic_context_t* dest)
+{
+    // There are no messages to give to any other context
+    ERROR_CONDITION(dest->diagnose != diagnose_to_counter,
+            "Counting diagnostic contexts can only be committed to counting contexts", 0);
+
+    dest->num_info += ctx->num_info;
+    dest->num_warning += ctx->num_warning;
+    dest->num_error += ctx->num_error;
+    DELETE(ctx);
+}
+
+diagnostic_context_t* diagnostic_context_new_counting(void)
+{
+    diagnostic_context_t* result = NEW0(diagnostic_context_t);
+
+    result->diagnose = diagnose_to_counter;
+    result->get_count = diagnose_to_counter_count;
+    result->discard = diagnose_to_counter_discard;
+    result->commit = diagnose_to_counter_commit;
+
+    return result;
+}
+
 //
 // Diagnose for instantiation
 //
@@ -255,7 +906,17 @@ struct diagnostic_buffered_instantiation_tag
 static void diagnose_to_buffer_instantiation_commit(diagnostic_context_buffered_instantiation_t* ctx, diagnostic_context_t* dest)
 {
     diagnostic_context_buffered_t* buffered_ctx = (diagnostic_context_buffered_t*)ctx;
-    if (buffered_ctx->num_diagnostics > 0)
+    if (buffered_ctx->num_diagnostics > 0
+            && dest->diagnose == diagnose_to_counter)
+    {
+        // Only the number of diagnostics is kept, do not build the message
+        int i;
+        for (i = 0; i < buffered_ctx->num_diagnostics; i++)
+        {
+            diagnose_to_counter(dest, buffered_ctx->diagnostics[i]);
+        }
+    }
+    else if (buffered_ctx->num_diagnostics > 0)
     {
         const char* header_message = (ctx->header_message_fun.message_fun)(ctx->header_message_fun.data);
 
@@ -267,9 +928,9 @@ static void diagnose_to_buffer_instantiation_commit(diagnostic_context_buffered_
         int i;
         for (i = 0; i < buffered_ctx->num_diagnostics; i++)
         {
-            len += strlen(buffered_ctx->diagnostics[i].message);
-            severity = severity < buffered_ctx->diagnostics[i].severity
-                ?  buffered_ctx->diagnostics[i].severity
+            len += strlen(diagnostic_get_message(buffered_ctx->diagnostics[i]));
+            severity = severity < buffered_ctx->diagnostics[i]->severity
+                ?  buffered_ctx->diagnostics[i]->severity
                 : severity;
         }
 
@@ -283,7 +944,8 @@ static void diagnose_to_buffer_instantiation_commit(diagnostic_context_buffered_
 
         for (i = 0; i < buffered_ctx->num_diagnostics; i++)
         {
-            merged_message = strcat(merged_message, buffered_ctx->diagnostics[i].message);
+            merged_message = strcat(merged_message, buffered_ctx->diagnostics[i]->message);
+            diagnostic_free(buffered_ctx->diagnostics[i]);
         }
 
         merged_message[len - 1] = '\0';
@@ -291,7 +953,7 @@ static void diagnose_to_buffer_instantiation_commit(diagnostic_context_buffered_
         const char* unique_merged_message = uniquestr(merged_message);
         DELETE(merged_message);
 
-        (dest->diagnose)(dest, severity, unique_merged_message);
+        (dest->diagnose)(dest, diagnostic_new_formatted(severity, unique_merged_message));
     }
 
     DELETE(ctx->header_message_fun.data);
@@ -363,6 +1025,19 @@ diagnostic_context_t* diagnostic_context_push_buffered(void)
     return ctx;
 }
 
+diagnostic_context_t* diagnostic_context_push_counting(void)
+{
+    diagnostic_context_t *ctx = diagnostic_context_new_counting();
+    diagnostic_context_push(ctx);
+
+    return ctx;
+}
+
+char diagnostic_context_is_counting(void)
+{
+    return current_diagnostic_context->diagnose == diagnose_to_counter;
+}
+
 void diagnostic_context_pop_and_discard()
 {
     diagnostic_context_t* ctx = current_diagnostic_context;
@@ -408,84 +1083,76 @@ int diagnostics_get_warn_count(void)
     return (current_diagnostic_context->get_count)(current_diagnostic_context, DS_WARNING);
 }
 
+void diagnostics_count_error(void)
+{
+    current_diagnostic_context->num_error++;
+}
+
+void diagnostics_count_warning(void)
+{
+    current_diagnostic_context->num_warning++;
+}
+
+void diagnostics_count_info(void)
+{
+    current_diagnostic_context->num_info++;
+}
+
 //
 // Generic interface
 //
 
-void error_printf_at(const locus_t* locus, const char* format, ...)
+static void diagnose_va(const locus_t* locus,
+        diagnostic_severity_t severity,
+        const char* kind_message,
+        const char* format,
+        va_list va)
 {
-    va_list va;
-    va_start(va, format);
-    const char* message = NULL;
-    uniquestr_vsprintf(&message, format, va);
-    va_end(va);
-
-    if (locus != NULL)
+    diagnostic_t* d;
+    int num_args = 0;
+    // Diagnostics printed right away are not worth capturing
+    if (current_diagnostic_context != (diagnostic_context_t*)&diagnostic_context_stderr
+            && format_can_be_captured(format, &num_args))
     {
-        uniquestr_sprintf(&message, "%s: error: %s",
-                locus_to_str(locus),
-                message);
+        d = diagnostic_new_captured(severity, locus, kind_message, format, num_args, va);
     }
     else
     {
-        uniquestr_sprintf(&message, "error: %s", message);
+        const char* message = NULL;
+        uniquestr_vsprintf(&message, format, va);
+        d = diagnostic_new_formatted(severity,
+                diagnostic_prefix_message(locus, kind_message, message));
     }
 
-    (current_diagnostic_context->diagnose)(current_diagnostic_context, DS_ERROR, message);
+    (current_diagnostic_context->diagnose)(current_diagnostic_context, d);
 }
 
-void warn_printf_at(const locus_t* locus, const char* format, ...)
+void (error_printf_at)(const locus_t* locus, const char* format, ...)
 {
     va_list va;
     va_start(va, format);
-    const char* message = NULL;
-    uniquestr_vsprintf(&message, format, va);
+    diagnose_va(locus, DS_ERROR, "error", format, va);
     va_end(va);
-
-    if (locus != NULL)
-    {
-        uniquestr_sprintf(&message, "%s: warning: %s",
-                locus_to_str(locus),
-                message);
-    }
-    else
-    {
-        uniquestr_sprintf(&message, "warning: %s", message);
-    }
-
-    (current_diagnostic_context->diagnose)(current_diagnostic_context, DS_WARNING, message);
 }
 
-void info_printf_at(const locus_t* locus, const char* format, ...)
+void (warn_printf_at)(const locus_t* locus, const char* format, ...)
 {
     va_list va;
     va_start(va, format);
-    const char* message = NULL;
-    uniquestr_vsprintf(&message, format, va);
+    diagnose_va(locus, DS_WARNING, "warning", format, va);
     va_end(va);
-
-    if (locus != NULL)
-    {
-        uniquestr_sprintf(&message, "%s: info: %s",
-                locus_to_str(locus),
-                message);
-    }
-    else
-    {
-        uniquestr_sprintf(&message, "info: %s", message);
-    }
-
-    (current_diagnostic_context->diagnose)(current_diagnostic_context, DS_INFO, message);
 }
 
-void warn_or_error_printf_at(const locus_t* locus, char emit_error, const char* format, ...)
+void (info_printf_at)(const locus_t* locus, const char* format, ...)
 {
     va_list va;
     va_start(va, format);
-    const char* message = NULL;
-    uniquestr_vsprintf(&message, format, va);
+    diagnose_va(locus, DS_INFO, "info", format, va);
     va_end(va);
+}
 
+void (warn_or_error_printf_at)(const locus_t* locus, char emit_error, const char* format, ...)
+{
     diagnostic_severity_t severity = DS_WARNING;
     if (emit_error)
         severity = DS_ERROR;
@@ -494,21 +1161,10 @@ void warn_or_error_printf_at(const locus_t* locus, char emit_error, const char*
     if (emit_error)
         kind_message = "error";
 
-    if (locus != NULL)
-    {
-        uniquestr_sprintf(&message, "%s: %s: %s",
-                locus_to_str(locus),
-                kind_message,
-                message);
-    }
-    else
-    {
-        uniquestr_sprintf(&message, "%s: %s",
-                kind_message,
-                message);
-    }
-
-    (current_diagnostic_context->diagnose)(current_diagnostic_context, severity, message);
+    va_list va;
+    va_start(va, format);
+    diagnose_va(locus, severity, kind_message, format, va);
+    va_end(va);
 }
 
 void fatal_printf_at(const locus_t* locus, const char* format, ...)
@@ -46,6 +46,29 @@ void warn_or_error_printf_at(const locus_t*, char emit_error, const char* format
 void fatal_printf_at(const locus_t*, const char* format, ...) NORETURN CHECK_PRINTF(2, 3);
 void sorry_printf_at(const locus_t*, const char* format, ...) NORETURN CHECK_PRINTF(2, 3);
 
+void diagnostics_count_error(void);
+void diagnostics_count_warning(void);
+void diagnostics_count_info(void);
+
+// Counting contexts only keep the number of diagnostics, so their arguments
+// are not even evaluated
+#define error_printf_at(locus, ...) \
+    (diagnostic_context_is_counting() \
+     ? diagnostics_count_error() \
+     : (error_printf_at)((locus), __VA_ARGS__))
+#define warn_printf_at(locus, ...) \
+    (diagnostic_context_is_counting() \
+     ? diagnostics_count_warning() \
+     : (warn_printf_at)((locus), __VA_ARGS__))
+#define info_printf_at(locus, ...) \
+    (diagnostic_context_is_counting() \
+     ? diagnostics_count_info() \
+     : (info_printf_at)((locus), __VA_ARGS__))
+#define warn_or_error_printf_at(locus, emit_error, ...) \
+    (diagnostic_context_is_counting() \
+     ? ((emit_error) ? diagnostics_count_error() : diagnostics_count_warning()) \
+     : (warn_or_error_printf_at)((locus), (emit_error), __VA_ARGS__))
+
 // Change diagnosting context
 
 diagnostic_context_t* diagnostic_context_get_current(void);
@@ -57,8 +80,31 @@ void diagnostic_context_commit(diagnostic_context_t*);
 void diagnostic_context_discard(diagnostic_context_t*);
 
 diagnostic_context_t* diagnostic_context_new_buffered(void);
+// Copies the diagnostics of a buffered context into a new buffered context
+diagnostic_context_t* diagnostic_context_new_buffered_copy(diagnostic_context_t*);
 
 diagnostic_context_t* diagnostic_context_push_buffered(void);
+
+// Position in the diagnostics of a buffered context
+typedef
+struct diagnostic_mark_tag
+{
+    int num_diagnostics;
+    int num_collapsed;
+} diagnostic_mark_t;
+
+// Returns zero if the current context is not buffered
+char diagnostic_context_mark(diagnostic_mark_t* mark);
+// Copies the diagnostics of the current context since the mark into a new
+// buffered context, or NULL if there are none. Returns zero if some of them
+// were collapsed with earlier diagnostics and so cannot be copied
+char diagnostic_context_copy_since_mark(const diagnostic_mark_t* mark,
+        diagnostic_context_t** copy);
+
+// For diagnostics that are always discarded and only their number matters
+diagnostic_context_t* diagnostic_context_new_counting(void);
+diagnostic_context_t* diagnostic_context_push_counting(void);
+char diagnostic_context_is_counting(void);
 void diagnostic_context_pop_and_discard(void);
 void diagnostic_context_pop_and_commit(void);
 
@@ -44,6 +44,8 @@ struct scope_entry_list_node_tag
 struct scope_entry_list_tag
 {
     int num_items_list;
+    // entry_list_copy shares the list, it is only duplicated when modified
+    int num_references;
     scope_entry_list_node_t* next;
 };
 
@@ -56,11 +58,47 @@ static scope_entry_list_t* entry_list_allocate(void)
 {
     scope_entry_list_t* new_entry_list = NEW0(scope_entry_list_t);
 
+    new_entry_list->num_references = 1;
     new_entry_list->next = entry_list_node_allocate();
 
     return new_entry_list;
 }
 
+static scope_entry_list_t* entry_list_duplicate(const scope_entry_list_t* list)
+{
+    scope_entry_list_t* result = NEW0(scope_entry_list_t);
+
+    result->num_items_list = list->num_items_list;
+    result->num_references = 1;
+    scope_entry_list_node_t* it = list->next;
+    scope_entry_list_node_t** current = &(result->next);
+
+    while (it != NULL)
+    {
+        *current = NEW0(scope_entry_list_node_t);
+        int i;
+        for (i = 0; i < NUM_IMMEDIATE; i++)
+        {
+            (*current)->list[i] = it->list[i];
+        }
+        current = &((*current)->next);
+        it = it->next;
+    }
+
+    return result;
+}
+
+// Returns a list that can be modified without affecting the other owners
+static scope_entry_list_t* entry_list_unshare(scope_entry_list_t* list)
+{
+    if (list == NULL
+            || list->num_references == 1)
+        return list;
+
+    list->num_references--;
+    return entry_list_duplicate(list);
+}
+
 scope_entry_list_t* entry_list_new(scope_entry_t* entry)
 {
     scope_entry_list_t* result = entry_list_allocate();
@@ -135,6 +173,7 @@ scope_entry_list_t* entry_list_prepend(scope_entry_list_t* list,
     }
     else
     {
+        list = entry_list_unshare(list);
         list->next = entry_list_prepend_rec(list->next, entry, list->num_items_list);
         list->num_items_list++;
         return list;
@@ -150,6 +189,7 @@ scope_entry_list_t* entry_list_add(scope_entry_list_t* list,
     }
     else
     {
+        list = entry_list_unshare(list);
         entry_list_add_to_pos_rec(list->next, entry, list->num_items_list);
         list->num_items_list++;
 
@@ -260,6 +300,7 @@ scope_entry_list_t* entry_list_add_after(scope_entry_list_t* list,
         scope_entry_t* position,
         scope_entry_t* entry)
 {
+    list = entry_list_unshare(list);
     char added_an_element = entry_list_add_after_rec(list->next, position, entry);
 
     if (added_an_element)
@@ -303,6 +344,7 @@ scope_entry_list_t* entry_list_add_before(scope_entry_list_t* list,
         scope_entry_t* position,
         scope_entry_t* entry)
 {
+    list = entry_list_unshare(list);
     char added_an_element = entry_list_add_before_rec(list->next, position, entry);
 
     if (added_an_element)
@@ -316,26 +358,13 @@ scope_entry_list_t* entry_list_copy(const scope_entry_list_t* list)
     if (list == NULL)
         return NULL;
 
-    scope_entry_list_t* result = NEW0(scope_entry_list_t);
-
-    result->num_items_list = list->num_items_list;
-    scope_entry_list_node_t* it = list->next;
-    scope_entry_list_node_t** current = &(result->next);
-
-    while (it != NULL)
-    {
-        *current = NEW0(scope_entry_list_node_t);
-        int i;
-        for (i = 0; i < NUM_IMMEDIATE; i++)
-        {
-            (*current)->list[i] = it->list[i];
-        }
-        current = &((*current)->next);
-        it = it->next;
-    }
+    // Lists are copied on write, see entry_list_unshare
+    scope_entry_list_t* result = (scope_entry_list_t*)list;
+    result->num_references++;
 
     return result;
 }
+
 static void entry_list_node_free(scope_entry_list_node_t* list)
 {
     if (list == NULL)
@@ -351,6 +380,10 @@ void entry_list_free(scope_entry_list_t* list)
     if (list == NULL)
         return;
 
+    list->num_references--;
+    if (list->num_references > 0)
+        return;
+
     entry_list_node_free(list->next);
     memset(list, 0, sizeof(*list));
     DELETE(list);
@@ -595,6 +628,10 @@ scope_entry_list_t* entry_list_remove(scope_entry_list_t* entry_list, scope_entr
     if (entry_list == NULL)
         return entry_list;
 
+    if (!entry_list_contains(entry_list, entry))
+        return entry_list;
+
+    entry_list = entry_list_unshare(entry_list);
     int number_of_matches = entry_list_remove_rec(entry_list->next, entry);
 
     entry_list->num_items_list -= number_of_matches;
@@ -50,6 +50,7 @@
 #include "cxx-codegen.h"
 #include "cxx-instantiation.h"
 #include "cxx-intelsupport.h"
+#include "red_black_tree.h"
 #include <ctype.h>
 #include <string.h>
 
@@ -216,7 +217,7 @@ scope_entry_t* expand_template_given_arguments(scope_entry_t* template_sym,
         fprintf(stderr, "EXPRTYPE: Attempting to deduce template arguments for '%s' (declared in '%s')\n",
                 print_decl_type_str(primary_symbol->type_information, primary_symbol->decl_context,
                     get_qualified_symbol_name(primary_symbol, primary_symbol->decl_context)),
-                locus_to_str(primary_symbol->locus));
+                locus_to_str(locus_from_id(primary_symbol->locus)));
     }
 
     if (deduce_template_arguments_from_function_call(
@@ -236,7 +237,7 @@ scope_entry_t* expand_template_given_arguments(scope_entry_t* template_sym,
             fprintf(stderr, "EXPRTYPE: Deduction succeeded for '%s' (declared in '%s')\n",
                     print_decl_type_str(primary_symbol->type_information, primary_symbol->decl_context,
                         get_qualified_symbol_name(primary_symbol, primary_symbol->decl_context)),
-                    locus_to_str(primary_symbol->locus));
+                    locus_to_str(locus_from_id(primary_symbol->locus)));
         }
         // Now get a specialized template type for this
         // function (this will sign it in if it does not exist)
@@ -251,7 +252,7 @@ scope_entry_t* expand_template_given_arguments(scope_entry_t* template_sym,
                 fprintf(stderr, "EXPRTYPE: Substitution failed for '%s' (declared in '%s')\n",
                         print_decl_type_str(primary_symbol->type_information, primary_symbol->decl_context,
                             get_qualified_symbol_name(primary_symbol, primary_symbol->decl_context)),
-                        locus_to_str(primary_symbol->locus));
+                        locus_to_str(locus_from_id(primary_symbol->locus)));
             }
             return NULL;
         }
@@ -263,7 +264,7 @@ scope_entry_t* expand_template_given_arguments(scope_entry_t* template_sym,
             fprintf(stderr, "EXPRTYPE: Got specialization '%s' at '%s'\n", 
                     print_decl_type_str(specialized_symbol->type_information, specialized_symbol->decl_context,
                         get_qualified_symbol_name(specialized_symbol, specialized_symbol->decl_context)),
-                    locus_to_str(specialized_symbol->locus));
+                    locus_to_str(locus_from_id(specialized_symbol->locus)));
         }
 
         return specialized_symbol;
@@ -275,7 +276,7 @@ scope_entry_t* expand_template_given_arguments(scope_entry_t* template_sym,
             fprintf(stderr, "EXPRTYPE: Discarding symbol '%s' declared at '%s' as its arguments could not be deduced.\n",
                     print_decl_type_str(primary_symbol->type_information, primary_symbol->decl_context,
                         get_qualified_symbol_name(primary_symbol, primary_symbol->decl_context)),
-                    locus_to_str(primary_symbol->locus));
+                    locus_to_str(locus_from_id(primary_symbol->locus)));
         }
     }
     return NULL;
@@ -4215,7 +4216,7 @@ char value_not_valid_for_divisor(const_value_t* v)
     if (const_value_is_object(v))
     {
         scope_entry_t* entry = const_value_object_get_base(v);
-        const_value_t* result = compute_value_of_symbol(entry, entry->locus);
+        const_value_t* result = compute_value_of_symbol(entry, locus_from_id(entry->locus));
         const_value_t* val = compute_value_of_object_subobject(result, v);
         if (val != NULL)
             return value_not_valid_for_divisor(val);
@@ -7250,7 +7251,7 @@ static char contains_wrongly_associated_template_name(AST a, const decl_context_
             || ASTKind(a) == AST_POINTER_CLASS_MEMBER_ACCESS) // E + p->f<
     {
         nodecl_t nodecl_check = nodecl_null();
-        diagnostic_context_push_buffered();
+        diagnostic_context_push_counting();
         check_expression_impl_(a, decl_context, &nodecl_check);
         diagnostic_context_pop_and_discard();
 
@@ -7537,7 +7538,7 @@ static char cxx_const_value_is_zero(const_value_t* t)
     if (const_value_is_object(t))
     {
         scope_entry_t* entry = const_value_object_get_base(t);
-        const_value_t* result = compute_value_of_symbol(entry, entry->locus);
+        const_value_t* result = compute_value_of_symbol(entry, locus_from_id(entry->locus));
         const_value_t* val = compute_value_of_object_subobject(result, t);
         if (val != NULL)
             return cxx_const_value_is_zero(val);
@@ -9635,7 +9636,7 @@ static char convert_in_conditional_expr(type_t* from_t1, type_t* to_t2,
                 || !class_type_is_base_instantiating(no_ref(to_t2), no_ref(from_t1), locus))
         {
             nodecl_t nodecl_expr = nodecl_null();
-            diagnostic_context_push_buffered();
+            diagnostic_context_push_counting();
             check_nodecl_function_argument_initialization(
                     nodecl_make_dummy(from_t1, locus),
                     decl_context,
@@ -11046,7 +11047,7 @@ static void check_delete_expression_nodecl(nodecl_t nodecl_deleted_expr,
                             entry_list_iterator_next(it))
                     {
                         scope_entry_t* current_conv = entry_list_iterator_current(it);
-                        info_printf_at(current_conv->locus, "%s\n",
+                        info_printf_at(locus_from_id(current_conv->locus), "%s\n",
                                 print_decl_type_str(current_conv->type_information,
                                     decl_context,
                                     get_qualified_symbol_name(current_conv, decl_context)));
@@ -11794,7 +11795,7 @@ static char conversion_is_valid_static_cast(
                     nodecl_get_locus(*nodecl_expression));
         nodecl_t nodecl_static_cast_output = nodecl_null();
 
-        diagnostic_context_push_buffered();
+        diagnostic_context_push_counting();
         check_nodecl_parenthesized_initializer(
                 nodecl_parenthesized_init,
                 decl_context,
@@ -12546,7 +12547,7 @@ static void check_nodecl_cast_expr(
         }
     }
 
-    diagnostic_context_push_buffered();
+    diagnostic_context_push_counting();
     *nodecl_output = cxx_nodecl_make_conversion(
             nodecl_casted_expr,
             declarator_type,
@@ -13393,7 +13394,7 @@ char can_be_called_with_number_of_arguments(scope_entry_t *entry, int num_argume
         {
             fprintf(stderr, "EXPRTYPE: Function '%s' at '%s' can be called with %d arguments since it matches the number of parameters\n",
                     entry->symbol_name,
-                    locus_to_str(entry->locus),
+                    locus_to_str(locus_from_id(entry->locus)),
                     num_arguments);
         }
         return 1;
@@ -13408,7 +13409,7 @@ char can_be_called_with_number_of_arguments(scope_entry_t *entry, int num_argume
                 fprintf(stderr, "EXPRTYPE: Function '%s' at '%s' can be called with %d (although the "
                         "function just has %d parameters) because of ellipsis\n",
                         entry->symbol_name,
-                        locus_to_str(entry->locus),
+                        locus_to_str(locus_from_id(entry->locus)),
                         num_arguments,
                         num_parameters);
             }
@@ -13421,7 +13422,7 @@ char can_be_called_with_number_of_arguments(scope_entry_t *entry, int num_argume
                 fprintf(stderr, "EXPRTYPE: Function '%s' at '%s' cannot be called with %d arguments "
                         "since it expects %d parameters\n",
                         entry->symbol_name,
-                        locus_to_str(entry->locus),
+                        locus_to_str(locus_from_id(entry->locus)),
                         num_arguments,
                         num_parameters);
             }
@@ -13458,7 +13459,7 @@ char can_be_called_with_number_of_arguments(scope_entry_t *entry, int num_argume
                 fprintf(stderr, "EXPRTYPE: Function '%s' at '%s' can be called with %d arguments "
                         "(although it has %d parameters) because of default arguments\n",
                         function_with_defaults->symbol_name,
-                        locus_to_str(function_with_defaults->locus),
+                        locus_to_str(locus_from_id(function_with_defaults->locus)),
                         num_arguments,
                         num_parameters);
             }
@@ -13469,7 +13470,7 @@ char can_be_called_with_number_of_arguments(scope_entry_t *entry, int num_argume
             fprintf(stderr, "EXPRTYPE: Function '%s' at '%s' cannot be called with %d arguments "
                     "since it expects %d parameters\n",
                     function_with_defaults->symbol_name,
-                    locus_to_str(function_with_defaults->locus),
+                    locus_to_str(locus_from_id(function_with_defaults->locus)),
                     num_arguments,
                     num_parameters);
         }
@@ -13986,7 +13987,7 @@ static void check_nodecl_function_call_cxx(
                     // Check this to be the proper context required
                     surrogate_symbol->decl_context = decl_context;
 
-                    surrogate_symbol->locus = locus;
+                    surrogate_symbol->locus = locus_get_id(locus);
 
                     // This is a surrogate function created here
                     symbol_entity_specs_set_is_surrogate_function(surrogate_symbol, 1);
@@ -14138,7 +14139,7 @@ static void check_nodecl_function_call_cxx(
                     field_path_t field_path;
                     field_path_init(&field_path);
 
-                    diagnostic_context_push_buffered();
+                    diagnostic_context_push_counting();
                     scope_entry_list_t* extra_query = get_member_of_class_type_nodecl(
                             decl_context,
                             no_ref(get_unqualified_type(class_type)),
@@ -14493,7 +14494,7 @@ static void check_function_call(AST expr, const decl_context_t* decl_context, no
                 entry = new_symbol(global_context, global_context->current_scope, ASTText(advanced_called_expression));
 
                 entry->kind = SK_FUNCTION;
-                entry->locus = ast_get_locus(advanced_called_expression);
+                entry->locus = locus_get_id(ast_get_locus(advanced_called_expression));
 
                 type_t* nonproto_type = get_nonproto_function_type(get_signed_int_type(),
                         nodecl_list_length(nodecl_argument_list));
@@ -14657,7 +14658,7 @@ static void check_nodecl_comma_operand(nodecl_t nodecl_lhs,
         scope_entry_t* selected_operator = NULL;
 
         // We do not want a warning if no overloads are available
-        diagnostic_context_push_buffered();
+        diagnostic_context_push_counting();
         type_t* computed_type = compute_user_defined_bin_operator_type(operation_comma_tree,
                 &nodecl_lhs,
                 &nodecl_rhs,
@@ -14856,7 +14857,7 @@ static void implement_nongeneric_lambda_expression(
     lambda_counter++;
 
     scope_entry_t* lambda_class = new_symbol(decl_context, decl_context->current_scope, lambda_class_name_str);
-    lambda_class->locus = locus;
+    lambda_class->locus = locus_get_id(locus);
     lambda_class->kind = SK_CLASS;
     lambda_class->type_information = get_new_class_type(decl_context, TT_STRUCT);
     symbol_entity_specs_set_is_user_declared(lambda_class, 1);
@@ -14877,7 +14878,7 @@ static void implement_nongeneric_lambda_expression(
             inner_class_context,
             inner_class_context->current_scope,
             constructor_name);
-    constructor->locus = locus;
+    constructor->locus = locus_get_id(locus);
     constructor->kind = SK_FUNCTION;
     constructor->defined = 1;
     symbol_entity_specs_set_is_member(constructor, 1);
@@ -14946,7 +14947,7 @@ static void implement_nongeneric_lambda_expression(
         type_t* pointer_to_function = get_pointer_type(lambda_function_type);
         scope_entry_t* typedef_function = new_symbol(inner_class_context, inner_class_context->current_scope,
                  "__ptr_fun_type__");
-        typedef_function->locus = locus;
+        typedef_function->locus = locus_get_id(locus);
         typedef_function->kind = SK_TYPEDEF;
         typedef_function->defined = 1;
         typedef_function->type_information = pointer_to_function;
@@ -14960,7 +14961,7 @@ static void implement_nongeneric_lambda_expression(
         conversion = new_symbol(inner_class_context, inner_class_context->current_scope,
                  "$.operator");
         conversion->kind = SK_FUNCTION;
-        conversion->locus = locus;
+        conversion->locus = locus_get_id(locus);
         conversion->defined = 1;
         symbol_entity_specs_set_is_member(conversion, 1);
         symbol_entity_specs_set_is_user_declared(conversion, 1);
@@ -14976,7 +14977,7 @@ static void implement_nongeneric_lambda_expression(
         // now emit an ancillary static member function with the same prototype as the lambda type
         ancillary = new_symbol(inner_class_context, inner_class_context->current_scope,
                  "__ancillary__");
-        ancillary->locus = locus;
+        ancillary->locus = locus_get_id(locus);
         ancillary->kind = SK_FUNCTION;
         ancillary->defined = 1;
         symbol_entity_specs_set_is_member(ancillary, 1);
@@ -15053,7 +15054,7 @@ static void implement_nongeneric_lambda_expression(
                     block_context,
                     block_context->current_scope,
                     new_name);
-            parameter->locus = locus;
+            parameter->locus = locus_get_id(locus);
             parameter->kind = SK_VARIABLE;
             parameter->defined = 1;
             parameter->type_information = parameter_info[i].type_info;
@@ -15068,7 +15069,7 @@ static void implement_nongeneric_lambda_expression(
                 inner_class_context,
                 inner_class_context->current_scope,
                 new_name);
-            field->locus = locus;
+            field->locus = locus_get_id(locus);
             field->defined = 1;
             field->kind = SK_VARIABLE;
             if (is_capture_by_copy)
@@ -15177,7 +15178,7 @@ static void implement_nongeneric_lambda_expression(
     const decl_context_t* block_context = new_block_context(inner_class_context);
     block_context->current_scope->related_entry = operator_call;
 
-    operator_call->locus = locus;
+    operator_call->locus = locus_get_id(locus);
     operator_call->kind = SK_FUNCTION;
     operator_call->defined = 1;
     symbol_entity_specs_set_is_member(operator_call, 1);
@@ -15193,7 +15194,7 @@ static void implement_nongeneric_lambda_expression(
         scope_entry_t* orig_param = symbol_entity_specs_get_related_symbols_num(lambda_symbol, i);
 
         scope_entry_t* parameter = new_symbol(block_context, block_context->current_scope, orig_param->symbol_name);
-        parameter->locus = locus;
+        parameter->locus = locus_get_id(locus);
         parameter->kind = SK_VARIABLE;
         parameter->type_information = orig_param->type_information;
 
@@ -15289,7 +15290,7 @@ static void implement_nongeneric_lambda_expression(
             scope_entry_t* orig_param = symbol_entity_specs_get_related_symbols_num(lambda_symbol, i);
 
             scope_entry_t* parameter = new_symbol(block_context, block_context->current_scope, orig_param->symbol_name);
-            parameter->locus = locus;
+            parameter->locus = locus_get_id(locus);
             parameter->kind = SK_VARIABLE;
             parameter->type_information = orig_param->type_information;
 
@@ -15307,7 +15308,7 @@ static void implement_nongeneric_lambda_expression(
 
         // The ancillary creates an object of the closure type and invokes the operator()
         scope_entry_t* obj = new_symbol(block_context, block_context->current_scope, "obj");
-        obj->locus = locus;
+        obj->locus = locus_get_id(locus);
         obj->kind = SK_VARIABLE;
         obj->type_information = get_user_defined_type(lambda_class);
         obj->defined = 1;
@@ -15462,7 +15463,7 @@ static void implement_generic_lambda_expression(
     lambda_counter++;
 
     scope_entry_t* lambda_class = new_symbol(decl_context, decl_context->current_scope, lambda_class_name_str);
-    lambda_class->locus = locus;
+    lambda_class->locus = locus_get_id(locus);
     lambda_class->kind = SK_CLASS;
     lambda_class->type_information = get_new_class_type(decl_context, TT_STRUCT);
     symbol_entity_specs_set_is_user_declared(lambda_class, 1);
@@ -15481,7 +15482,7 @@ static void implement_generic_lambda_expression(
             inner_class_context,
             inner_class_context->current_scope,
             constructor_name);
-    constructor->locus = locus;
+    constructor->locus = locus_get_id(locus);
     constructor->kind = SK_FUNCTION;
     constructor->defined = 1;
     symbol_entity_specs_set_is_member(constructor, 1);
@@ -15607,7 +15608,7 @@ static void implement_generic_lambda_expression(
         scope_entry_t* ptr_fun_template = new_symbol(inner_class_context,
                 inner_class_context->current_scope,
                  "__ptr_fun_type__");
-        ptr_fun_template->locus = locus;
+        ptr_fun_template->locus = locus_get_id(locus);
         ptr_fun_template->kind = SK_TEMPLATE;
         ptr_fun_template->defined = 1;
         ptr_fun_template->type_information = get_new_template_alias_type(invented_template_parameter_list,
@@ -15754,7 +15755,7 @@ static void implement_generic_lambda_expression(
                     block_context,
                     block_context->current_scope,
                     new_name);
-            parameter->locus = locus;
+            parameter->locus = locus_get_id(locus);
             parameter->kind = SK_VARIABLE;
             parameter->defined = 1;
             parameter->type_information = parameter_info[i].type_info;
@@ -15769,7 +15770,7 @@ static void implement_generic_lambda_expression(
                 inner_class_context,
                 inner_class_context->current_scope,
                 new_name);
-            field->locus = locus;
+            field->locus = locus_get_id(locus);
             field->defined = 1;
             field->kind = SK_VARIABLE;
             if (is_capture_by_copy)
@@ -15900,7 +15901,7 @@ static void implement_generic_lambda_expression(
     const decl_context_t* block_context = new_block_context(invented_templated_context);
     block_context->current_scope->related_entry = operator_call;
 
-    operator_call->locus = locus;
+    operator_call->locus = locus_get_id(locus);
     operator_call->kind = SK_FUNCTION;
     operator_call->defined = 1;
     symbol_entity_specs_set_is_member(operator_call, 1);
@@ -15915,7 +15916,7 @@ static void implement_generic_lambda_expression(
         scope_entry_t* orig_param = symbol_entity_specs_get_related_symbols_num(lambda_symbol, i);
 
         scope_entry_t* parameter = new_symbol(block_context, block_context->current_scope, orig_param->symbol_name);
-        parameter->locus = locus;
+        parameter->locus = locus_get_id(locus);
         parameter->kind = SK_VARIABLE;
         parameter->type_information = function_type_get_parameter_type_num(
                 invented_function_type,
@@ -16007,7 +16008,7 @@ static void implement_generic_lambda_expression(
             scope_entry_t* orig_param = symbol_entity_specs_get_related_symbols_num(lambda_symbol, i);
 
             scope_entry_t* parameter = new_symbol(block_context, block_context->current_scope, orig_param->symbol_name);
-            parameter->locus = locus;
+            parameter->locus = locus_get_id(locus);
             parameter->kind = SK_VARIABLE;
             parameter->type_information = function_type_get_parameter_type_num(
                     invented_function_type,
@@ -16027,7 +16028,7 @@ static void implement_generic_lambda_expression(
 
         // The ancillary creates an object of the closure type and invokes the operator()
         scope_entry_t* obj = new_symbol(block_context, block_context->current_scope, "obj");
-        obj->locus = locus;
+        obj->locus = locus_get_id(locus);
         obj->kind = SK_VARIABLE;
         obj->type_information = get_user_defined_type(lambda_class);
         obj->defined = 1;
@@ -16439,7 +16440,7 @@ static void check_lambda_expression(AST expression, const decl_context_t* decl_c
 
     scope_entry_t* lambda_symbol = new_symbol(decl_context, decl_context->current_scope, lambda_symbol_str);
     lambda_symbol->kind = SK_LAMBDA;
-    lambda_symbol->locus = ast_get_locus(expression);
+    lambda_symbol->locus = locus_get_id(ast_get_locus(expression));
 
     type_t* function_type = get_auto_type();
 
@@ -25164,7 +25165,7 @@ static void diagnostic_single_candidate(scope_entry_t* entry,
     entry = entry_advance_aliases(entry);
     const char *c = NULL;
     uniquestr_sprintf(&c, "%s: note:    %s%s%s\n",
-            locus_to_str(entry->locus),
+            locus_to_str(locus_from_id(entry->locus)),
             (symbol_entity_specs_get_is_member(entry) && symbol_entity_specs_get_is_static(entry)) ? "static " : "",
             !is_computed_function_type(entry->type_information)
             ?  print_decl_type_str(entry->type_information, entry->decl_context,
@@ -25432,7 +25433,7 @@ static const_value_t* compute_value_of_symbol(
                     if (const_value_is_object(value))
                     {
                         scope_entry_t* entry = const_value_object_get_base(value);
-                        const_value_t* result = compute_value_of_symbol(entry, entry->locus);
+                        const_value_t* result = compute_value_of_symbol(entry, locus_from_id(entry->locus));
                         return compute_value_of_object_subobject(result, value);
                     }
                     else if (const_value_is_array(value))
@@ -26339,7 +26340,7 @@ static const_value_t* evaluate_constexpr_constructor(
         }
 
         symbol_entity_specs_set_is_constexpr(entry,
-                check_constexpr_constructor(entry, entry->locus,
+                check_constexpr_constructor(entry, locus_from_id(entry->locus),
                     nodecl_initializer_list,
                     /* diagnose */ 0, /* emit_error */ 0));
         if (!symbol_entity_specs_get_is_constexpr(entry))
@@ -26636,7 +26637,7 @@ static const_value_t* evaluate_constexpr_regular_function_call(
         push_instantiated_entity(entry);
 
         symbol_entity_specs_set_is_constexpr(entry,
-                check_constexpr_function(entry, entry->locus,
+                check_constexpr_function(entry, locus_from_id(entry->locus),
                     /* diagnose */ 0, /* emit_error */ 0));
 
         if (!symbol_entity_specs_get_is_constexpr(entry))
@@ -26734,6 +26735,63 @@ static const_value_t* evaluate_constexpr_regular_function_call(
     return cval;
 }
 
+// Results of calls to constexpr functions keyed on the function and the
+// values of its arguments. Constant values are unique so comparing their
+// addresses is enough. Without this recursive constexpr functions are
+// evaluated once per call in the recursion tree
+typedef struct constexpr_call_memo_tag
+{
+    scope_entry_t* entry;
+    int num_arguments;
+    const_value_t** arguments;
+
+    const_value_t* value;
+} constexpr_call_memo_t;
+
+static rb_red_blk_tree* _constexpr_call_memo = NULL;
+
+static int constexpr_call_memo_compare(const void* p1, const void* p2)
+{
+    const constexpr_call_memo_t* m1 = (const constexpr_call_memo_t*)p1;
+    const constexpr_call_memo_t* m2 = (const constexpr_call_memo_t*)p2;
+
+    if (m1->entry != m2->entry)
+        return m1->entry < m2->entry ? -1 : 1;
+    if (m1->num_arguments != m2->num_arguments)
+        return m1->num_arguments < m2->num_arguments ? -1 : 1;
+
+    int i;
+    for (i = 0; i < m1->num_arguments; i++)
+    {
+        if (m1->arguments[i] != m2->arguments[i])
+            return m1->arguments[i] < m2->arguments[i] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+// Addresses and objects refer to variables whose value depends on the
+// evaluation in progress, so they do not identify the call
+static char constexpr_call_memo_valid_argument(const_value_t* v)
+{
+    if (v == NULL
+            || const_value_is_address_or_object(v))
+        return 0;
+
+    if (const_value_is_array(v)
+            || const_value_is_structured(v))
+    {
+        int i, n = const_value_get_num_elements(v);
+        for (i = 0; i < n; i++)
+        {
+            if (!constexpr_call_memo_valid_argument(const_value_get_element_num(v, i)))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
 static const_value_t* evaluate_constexpr_function_call(
         scope_entry_t* entry,
         nodecl_t converted_arg_list,
@@ -26748,22 +26806,75 @@ static const_value_t* evaluate_constexpr_function_call(
                     get_qualified_symbol_name(entry, entry->decl_context)));
     }
 
-    const_value_t* value = NULL;
     if (symbol_entity_specs_get_is_constructor(entry))
     {
-        value = evaluate_constexpr_constructor(
+        return evaluate_constexpr_constructor(
                 entry,
                 converted_arg_list,
                 decl_context,
                 locus);
     }
+
+    // The implicit argument of nonstatic members is bound to a new
+    // temporary every time, so those calls are never found in the memo
+    char can_be_memoized = !symbol_entity_specs_get_is_member(entry)
+        || symbol_entity_specs_get_is_static(entry);
+
+    constexpr_call_memo_t key;
+    memset(&key, 0, sizeof(key));
+    if (can_be_memoized)
+    {
+        key.entry = entry;
+
+        nodecl_t* list = nodecl_unpack_list(converted_arg_list, &key.num_arguments);
+        key.arguments = NEW_VEC(const_value_t*, key.num_arguments);
+        int i;
+        for (i = 0; i < key.num_arguments && can_be_memoized; i++)
+        {
+            key.arguments[i] = nodecl_get_constant(list[i]);
+            can_be_memoized = constexpr_call_memo_valid_argument(key.arguments[i]);
+        }
+        DELETE(list);
+
+        if (can_be_memoized
+                && _constexpr_call_memo != NULL)
+        {
+            rb_red_blk_node* n = rb_tree_query(_constexpr_call_memo, &key);
+            if (n != NULL)
+            {
+                DELETE(key.arguments);
+
+                constexpr_call_memo_t* memo = (constexpr_call_memo_t*)rb_node_get_info(n);
+                DEBUG_CODE()
+                {
+                    fprintf(stderr, "EXPRTYPE: Using the value of a previous evaluation of this call\n");
+                }
+                return memo->value;
+            }
+        }
+    }
+
+    const_value_t* value = evaluate_constexpr_regular_function_call(
+            entry,
+            converted_arg_list,
+            decl_context,
+            locus);
+
+    // Failures are not remembered so they are diagnosed every time
+    if (can_be_memoized
+            && value != NULL)
+    {
+        if (_constexpr_call_memo == NULL)
+            _constexpr_call_memo = rb_tree_create(constexpr_call_memo_compare, NULL, NULL);
+
+        constexpr_call_memo_t* memo = NEW(constexpr_call_memo_t);
+        *memo = key;
+        memo->value = value;
+        rb_tree_insert(_constexpr_call_memo, memo, memo);
+    }
     else
     {
-        value = evaluate_constexpr_regular_function_call(
-                entry,
-                converted_arg_list,
-                decl_context,
-                locus);
+        DELETE(key.arguments);
     }
 
     return value;
@@ -27290,7 +27401,7 @@ char check_construction_expression_for_class_type(
             seq_of_types,
             locus);
 
-    diagnostic_context_push_buffered();
+    diagnostic_context_push_counting();
 
     nodecl_t nodecl_output = nodecl_null();
     check_nodecl_parenthesized_initializer(
@@ -27347,7 +27458,7 @@ char check_assignment_expression_for_class_type(
     nodecl_t nodecl_lhs = nodecl_make_dummy(get_lvalue_reference_type(lhs_type), locus);
     nodecl_t nodecl_rhs = nodecl_make_dummy(rhs_type, locus);
 
-    diagnostic_context_push_buffered();
+    diagnostic_context_push_counting();
 
     nodecl_t nodecl_assig = nodecl_null();
     check_binary_expression_(
@@ -27691,7 +27802,7 @@ static void define_defaulted_copy_or_move_constructor(scope_entry_t* entry,
         // Create a parameter here
         param_symbol = new_symbol(block_context, block_context->current_scope, "mcc_arg_0");
         param_symbol->kind = SK_VARIABLE;
-        param_symbol->locus = locus;
+        param_symbol->locus = locus_get_id(locus);
         param_symbol->type_information = function_type_get_parameter_type_num(
                 entry->type_information,
                 0);
@@ -27737,7 +27848,7 @@ static void define_defaulted_copy_or_move_constructor(scope_entry_t* entry,
     symbol_entity_specs_set_function_code(entry, nodecl_function_code);
 
     symbol_entity_specs_set_is_constexpr(entry,
-            check_constexpr_constructor(entry, entry->locus,
+            check_constexpr_constructor(entry, locus_from_id(entry->locus),
                 nodecl_member_init_list,
                 /* diagnose */ 0, /* emit_error */ 0));
 }
@@ -27776,7 +27887,7 @@ static void define_defaulted_copy_or_move_assignment_operator(scope_entry_t* ent
         // Create a parameter here
         param_symbol = new_symbol(block_context, block_context->current_scope, "mcc_arg_0");
         param_symbol->kind = SK_VARIABLE;
-        param_symbol->locus = locus;
+        param_symbol->locus = locus_get_id(locus);
         param_symbol->type_information = function_type_get_parameter_type_num(
                 entry->type_information,
                 0);
@@ -29731,7 +29842,7 @@ static void instantiate_cxx_lambda(nodecl_instantiate_expr_visitor_t* v, nodecl_
         scope_entry_t* param = NEW0(scope_entry_t);
         param->defined = 1;
         param->kind = SK_VARIABLE;
-        param->locus = nodecl_get_locus(node);
+        param->locus = locus_get_id(nodecl_get_locus(node));
         param->type_information = update_type_for_instantiation(
             orig_param->type_information,
             v->decl_context,
@@ -31658,7 +31769,7 @@ static void check_multiexpression(AST expr, const decl_context_t* decl_context,
             {
                 warn_printf_at(ast_get_locus(identifier), "iterator name '%s' in multidependence shadows expr previous variable\n",
                         iterator_name);
-                info_printf_at(entry->locus, "declaration of the shadowed variable\n");
+                info_printf_at(locus_from_id(entry->locus), "declaration of the shadowed variable\n");
             }
         }
     }
@@ -31668,7 +31779,7 @@ static void check_multiexpression(AST expr, const decl_context_t* decl_context,
             iterator_name);
     new_iterator->kind = SK_VARIABLE;
     new_iterator->type_information = get_signed_int_type();
-    new_iterator->locus = ast_get_locus(ompss_iterator);
+    new_iterator->locus = locus_get_id(ast_get_locus(ompss_iterator));
 
     nodecl_t nodecl_range = nodecl_null();
     multiexpression_check_range(range, iterator_context, &nodecl_range);
@@ -34,6 +34,7 @@
 #include "cxx-diagnostic.h"
 #include "cxx-intelsupport.h"
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 
 /* Copyright(C) 2001, 2002, 2003, 2004, 2005 Free Software Foundation, Inc.
@@ -1132,7 +1133,7 @@ DEF_FUNCTION_TYPE_0(0, BT_VOID)
       new_builtin->type_information = (__mcxx_builtin_type__##TYPE)(); \
       symbol_entity_specs_set_is_builtin(new_builtin, 1); \
       new_builtin->do_not_print = 1; \
-      new_builtin->locus = make_locus("(gcc-builtin)", 0, 0); \
+      new_builtin->locus = locus_get_id(make_locus("(gcc-builtin)", 0, 0)); \
       if (is_function_type(new_builtin->type_information)) \
       { \
           symbol_entity_specs_reserve_default_argument_info(new_builtin, symbol_entity_specs_get_num_parameters(new_builtin)); \
@@ -3340,8 +3341,18 @@ DEF_GCC_BUILTIN        (BUILT_IN_SHUFFLE, "shuffle", BT_FN_BUILTIN_SHUFFLE, ATTR
 
 }
 
+// The large tables of target builtins are only consulted when a name is not
+// found in the global scope, and just the builtin with that name is signed
+// in. Most translation units never use them. See gcc_sign_in_lazy_builtins
+static const decl_context_t* lazy_builtins_context = NULL;
+static void clear_lazy_builtin_tables(void);
+static void sign_in_lazily(const lazy_builtin_table_t* table);
+
 void gcc_sign_in_builtins(const decl_context_t* global_context)
 {
+    lazy_builtins_context = global_context;
+    clear_lazy_builtin_tables();
+
     gcc_sign_in_builtins_0(global_context);
 
     // Target specific builtins
@@ -3538,16 +3549,28 @@ static scope_entry_t* solve_gcc_atomic_builtins_overload_name_generic(
     return NULL;
 }
 
-static void sign_in_gcc_simd_builtins(const decl_context_t* decl_context)
+// Intel architecture gcc builtins
+#define LAZY_BUILTIN(name, id, ...) \
+    static void sign_in_gcc_ia32_##id(const decl_context_t* decl_context, \
+            locus_id_t builtins_locus) __VA_ARGS__
+#include "cxx-gccbuiltins-ia32-lazy.h"
+#undef LAZY_BUILTIN
+
+#define LAZY_BUILTIN(name, id, ...) { name, sign_in_gcc_ia32_##id },
+static const lazy_builtin_t gcc_ia32_builtins[] =
 {
-    // Intel architecture gcc builtins
-    const locus_t* builtins_locus = make_locus("(gcc-builtin-ia32)", 0, 0);
-#include "cxx-gccbuiltins-ia32.h"
-}
+#include "cxx-gccbuiltins-ia32-lazy.h"
+};
+#undef LAZY_BUILTIN
+
+static const lazy_builtin_table_t gcc_ia32_builtins_table =
+{
+    "(gcc-builtin-ia32)", gcc_ia32_builtins, STATIC_ARRAY_LENGTH(gcc_ia32_builtins)
+};
 
 static void sign_in_simd_builtins(const decl_context_t* decl_context)
 {
-    sign_in_gcc_simd_builtins(decl_context);
+    sign_in_lazily(&gcc_ia32_builtins_table);
     
     sign_in_intel_simd_types(decl_context);
 }
@@ -3568,7 +3591,8 @@ extern void gcc_builtins_x86_64(const decl_context_t* global_context)
 
     if (CURRENT_CONFIGURATION->enable_intel_intrinsics)
     {
-        sign_in_icc_intrinsics(global_context);
+        sign_in_lazily(&icc_intrinsics_table);
+        sign_in_lazily(&icc_knc_intrinsics_table);
     }
 }
 
@@ -3580,6 +3604,24 @@ static type_t* get_unsigned_16x8_int(void)
 }
 #endif
 
+#define LAZY_BUILTIN(name, id, ...) \
+    static void sign_in_gcc_neon_##id(const decl_context_t* decl_context, \
+            locus_id_t builtins_locus) __VA_ARGS__
+#include "cxx-gccbuiltins-arm-neon-lazy.h"
+#undef LAZY_BUILTIN
+
+#define LAZY_BUILTIN(name, id, ...) { name, sign_in_gcc_neon_##id },
+static const lazy_builtin_t gcc_neon_builtins[] =
+{
+#include "cxx-gccbuiltins-arm-neon-lazy.h"
+};
+#undef LAZY_BUILTIN
+
+static const lazy_builtin_table_t gcc_neon_builtins_table =
+{
+    "(gcc-builtin-arm)", gcc_neon_builtins, STATIC_ARRAY_LENGTH(gcc_neon_builtins)
+};
+
 static void gcc_builtins_neon(const decl_context_t* decl_context)
 {
 
@@ -3613,7 +3655,7 @@ static void gcc_builtins_neon(const decl_context_t* decl_context)
 #define GENERATE_NEON_VECTOR(bits, elem_typename, elem_type) \
     { \
         scope_entry_t* sym = new_symbol(decl_context, decl_context->current_scope, UNIQUESTR_LITERAL(#elem_typename )); \
-        sym->locus = make_locus("(builtin-simd-type)", 0, 0); \
+        sym->locus = locus_get_id(make_locus("(builtin-simd-type)", 0, 0)); \
         sym->kind = SK_TYPEDEF; \
         sym->type_information = get_vector_type_by_elements(elem_type, bits / (type_get_size(elem_type) * 8)); \
         sym->defined = 1; \
@@ -3657,7 +3699,7 @@ static void gcc_builtins_neon(const decl_context_t* decl_context)
     for (i = 0, N = STATIC_ARRAY_LENGTH(aliased_names); i < N; i++)
     {
         scope_entry_t* sym = new_symbol(decl_context, decl_context->current_scope, uniquestr(aliased_names[i].name));
-        sym->locus = make_locus("(builtin-simd-type)", 0, 0);
+        sym->locus = locus_get_id(make_locus("(builtin-simd-type)", 0, 0));
         sym->kind = SK_TYPEDEF;
         sym->type_information = (aliased_names[i].fun)();
         sym->defined = 1;
@@ -3683,7 +3725,7 @@ static void gcc_builtins_neon(const decl_context_t* decl_context)
         const char* c = NULL;
         uniquestr_sprintf(&c, "__builtin_neon_%s", opaque_neon_builtin_types[i].name);
         scope_entry_t* sym = new_symbol(decl_context, decl_context->current_scope, c);
-        sym->locus = make_locus("(builtin-simd-type)", 0, 0);
+        sym->locus = locus_get_id(make_locus("(builtin-simd-type)", 0, 0));
         sym->kind = SK_TYPEDEF;
         sym->type_information =
             get_vector_type_by_elements(
@@ -3694,8 +3736,7 @@ static void gcc_builtins_neon(const decl_context_t* decl_context)
         symbol_entity_specs_set_is_builtin(sym, 1);
     }
 
-    const locus_t* builtins_locus = make_locus("(gcc-builtin-arm)", 0, 0);
-#include "cxx-gccbuiltins-arm-neon.h"
+    sign_in_lazily(&gcc_neon_builtins_table);
 }
 
 extern void gcc_builtins_arm(const decl_context_t* global_context)
@@ -3703,6 +3744,88 @@ extern void gcc_builtins_arm(const decl_context_t* global_context)
     gcc_builtins_neon(global_context);
 }
 
+#define LAZY_BUILTIN(name, id, ...) \
+    static void sign_in_gcc_neon_arm64_##id(const decl_context_t* decl_context, \
+            locus_id_t builtins_locus) __VA_ARGS__
+#include "cxx-gccbuiltins-arm64-neon-lazy.h"
+#undef LAZY_BUILTIN
+
+#define LAZY_BUILTIN(name, id, ...) { name, sign_in_gcc_neon_arm64_##id },
+static const lazy_builtin_t gcc_neon_arm64_builtins[] =
+{
+#include "cxx-gccbuiltins-arm64-neon-lazy.h"
+};
+#undef LAZY_BUILTIN
+
+static const lazy_builtin_table_t gcc_neon_arm64_builtins_table =
+{
+    "(gcc-builtin-aarch64)", gcc_neon_arm64_builtins, STATIC_ARRAY_LENGTH(gcc_neon_arm64_builtins)
+};
+
+static const lazy_builtin_table_t* const lazy_builtin_tables[] =
+{
+    &gcc_ia32_builtins_table,
+    &icc_intrinsics_table,
+    &icc_knc_intrinsics_table,
+    &gcc_neon_builtins_table,
+    &gcc_neon_arm64_builtins_table,
+};
+
+// Tables of the target of the current translation unit
+static char lazy_builtin_table_enabled[STATIC_ARRAY_LENGTH(lazy_builtin_tables)];
+
+static void clear_lazy_builtin_tables(void)
+{
+    memset(lazy_builtin_table_enabled, 0, sizeof(lazy_builtin_table_enabled));
+}
+
+static void sign_in_lazily(const lazy_builtin_table_t* table)
+{
+    int i;
+    for (i = 0; i < (int)STATIC_ARRAY_LENGTH(lazy_builtin_tables); i++)
+    {
+        if (lazy_builtin_tables[i] == table)
+        {
+            lazy_builtin_table_enabled[i] = 1;
+            return;
+        }
+    }
+
+    internal_error("Unknown lazy builtin table", 0);
+}
+
+static int compare_lazy_builtin(const void* key, const void* builtin)
+{
+    return strcmp((const char*)key, ((const lazy_builtin_t*)builtin)->name);
+}
+
+char gcc_sign_in_lazy_builtins(scope_t* sc, const char* name)
+{
+    if (lazy_builtins_context == NULL
+            || lazy_builtins_context->current_scope != sc)
+        return 0;
+
+    int i;
+    for (i = 0; i < (int)STATIC_ARRAY_LENGTH(lazy_builtin_tables); i++)
+    {
+        if (!lazy_builtin_table_enabled[i])
+            continue;
+
+        const lazy_builtin_table_t* table = lazy_builtin_tables[i];
+        const lazy_builtin_t* builtin = (const lazy_builtin_t*)bsearch(name,
+                table->builtins, table->num_builtins, sizeof(*table->builtins),
+                compare_lazy_builtin);
+        if (builtin != NULL)
+        {
+            builtin->sign_in(lazy_builtins_context,
+                    locus_get_id(make_locus(table->filename, 0, 0)));
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 static void gcc_builtins_neon_arm64(const decl_context_t* decl_context)
 {
 #define GENERATE_NEON_VECTOR_BUILTINS \
@@ -3735,7 +3858,7 @@ static void gcc_builtins_neon_arm64(const decl_context_t* decl_context)
 #define GENERATE_NEON_VECTOR(bits, elem_typename, elem_type) \
     { \
         scope_entry_t* sym = new_symbol(decl_context, decl_context->current_scope, UNIQUESTR_LITERAL(#elem_typename)); \
-        sym->locus = make_locus("(builtin-simd-type)", 0, 0); \
+        sym->locus = locus_get_id(make_locus("(builtin-simd-type)", 0, 0)); \
         sym->kind = SK_TYPEDEF; \
         sym->type_information = get_vector_type_by_elements(elem_type, bits / (type_get_size(elem_type) * 8)); \
         sym->defined = 1; \
@@ -3772,7 +3895,7 @@ static void gcc_builtins_neon_arm64(const decl_context_t* decl_context)
     for (i = 0, N = STATIC_ARRAY_LENGTH(aliased_names); i < N; i++)
     {
         scope_entry_t* sym = new_symbol(decl_context, decl_context->current_scope, uniquestr(aliased_names[i].name));
-        sym->locus = make_locus("(builtin-simd-type)", 0, 0);
+        sym->locus = locus_get_id(make_locus("(builtin-simd-type)", 0, 0));
         sym->kind = SK_TYPEDEF;
         sym->type_information = (aliased_names[i].fun)();
         sym->defined = 1;
@@ -3798,7 +3921,7 @@ static void gcc_builtins_neon_arm64(const decl_context_t* decl_context)
         const char* c = NULL;
         uniquestr_sprintf(&c, "__builtin_aarch64_simd_%s", opaque_neon_builtin_types[i].name);
         scope_entry_t* sym = new_symbol(decl_context, decl_context->current_scope, c);
-        sym->locus = make_locus("(builtin-simd-type)", 0, 0);
+        sym->locus = locus_get_id(make_locus("(builtin-simd-type)", 0, 0));
         sym->kind = SK_TYPEDEF;
         sym->type_information =
             get_vector_type_by_elements(
@@ -3809,8 +3932,7 @@ static void gcc_builtins_neon_arm64(const decl_context_t* decl_context)
         symbol_entity_specs_set_is_builtin(sym, 1);
     }
 
-    const locus_t* builtins_locus = make_locus("(gcc-builtin-aarch64)", 0, 0);
-#include "cxx-gccbuiltins-arm64-neon.h"
+    sign_in_lazily(&gcc_neon_arm64_builtins_table);
 }
 
 extern void gcc_builtins_arm64(const decl_context_t* global_context)
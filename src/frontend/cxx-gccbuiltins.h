@@ -35,8 +35,30 @@
 
 MCXX_BEGIN_DECLS
 
+// A builtin that is only signed in the first time its name is looked up
+typedef
+struct lazy_builtin_tag
+{
+    const char* name;
+    void (*sign_in)(const decl_context_t* decl_context, locus_id_t builtins_locus);
+} lazy_builtin_t;
+
+typedef
+struct lazy_builtin_table_tag
+{
+    // Filename of the locus of the builtins
+    const char* filename;
+    // Sorted by name
+    const lazy_builtin_t* builtins;
+    int num_builtins;
+} lazy_builtin_table_t;
+
 LIBMCXX_EXTERN void gcc_sign_in_builtins(const decl_context_t* global_context);
 
+// Signs in the builtin called name if it is in one of the lazy tables of the
+// global scope sc. Returns nonzero if it was signed in
+LIBMCXX_EXTERN char gcc_sign_in_lazy_builtins(scope_t* sc, const char* name);
+
 
 LIBMCXX_EXTERN void gcc_builtins_i386(const decl_context_t* global_context);
 LIBMCXX_EXTERN void gcc_builtins_x86_64(const decl_context_t* global_context);
@@ -176,7 +176,7 @@ static scope_entry_t* instantiate_template_type_member(type_t* template_type,
                     base_type,
                     new_member->symbol_name,
                     new_context_for_template_parameters,
-                    member_of_template->locus);
+                    locus_from_id(member_of_template->locus));
     }
     else
     {
@@ -185,7 +185,7 @@ static scope_entry_t* instantiate_template_type_member(type_t* template_type,
                     base_type,
                     new_member->symbol_name,
                     new_context_for_template_parameters,
-                    member_of_template->locus);
+                    locus_from_id(member_of_template->locus));
     }
 
     symbol_entity_specs_set_is_member(new_member, 1);
@@ -249,7 +249,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
     {
         fprintf(stderr, "INSTANTIATION: Instantiating member '%s' at '%s'\n", 
                 member_of_template->symbol_name,
-                locus_to_str(member_of_template->locus));
+                locus_to_str(locus_from_id(member_of_template->locus)));
     }
 
     switch (member_of_template->kind)
@@ -294,7 +294,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                     new_member->type_information = update_type_for_instantiation(
                             new_member->type_information,
                             context_of_being_instantiated,
-                            member_of_template->locus,
+                            locus_from_id(member_of_template->locus),
                             instantiation_symbol_map,
                             /* pack_index */ -1);
 
@@ -326,7 +326,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                                         nodecl_get_constant(symbol_entity_specs_get_bitfield_size(new_member)),
                                         const_value_get_zero(/* bytes*/ 4, /* sign */ 1))))
                         {
-                            error_printf_at(new_member->locus, "invalid bitfield of size '%d'\n",
+                            error_printf_at(locus_from_id(new_member->locus), "invalid bitfield of size '%d'\n",
                                     const_value_cast_to_4(
                                         nodecl_get_constant(symbol_entity_specs_get_bitfield_size(new_member))));
 
@@ -338,7 +338,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                     }
                     else
                     {
-                        error_printf_at(new_member->locus, "bitfield specification is not a constant expression");
+                        error_printf_at(locus_from_id(new_member->locus), "bitfield specification is not a constant expression");
 
                         // Fix it to 1
                         symbol_entity_specs_set_bitfield_size(new_member, const_value_to_nodecl(const_value_get_signed_int(1)));
@@ -411,7 +411,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                 type_t* updated_type = update_type_for_instantiation(
                         member_of_template->type_information,
                         context_of_being_instantiated,
-                        member_of_template->locus,
+                        locus_from_id(member_of_template->locus),
                         instantiation_symbol_map,
                         /* pack_index */ -1);
 
@@ -497,7 +497,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                             cxx_nodecl_make_conversion(new_enumerator->value,
                                     no_ref(nodecl_get_type(new_enumerator->value)),
                                     new_enumerator_context,
-                                    enumerator->locus);
+                                    locus_from_id(enumerator->locus));
                     }
 
                     ERROR_CONDITION(
@@ -567,7 +567,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                         update_type_for_instantiation(
                                 enum_type_get_underlying_type(member_of_template->type_information),
                                 context_of_being_instantiated,
-                                member_of_template->locus,
+                                locus_from_id(member_of_template->locus),
                                 instantiation_symbol_map,
                                 /* pack_index */ -1);
                 }
@@ -687,7 +687,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                                     template_args,
                                     member_of_template->type_information,
                                     context_of_being_instantiated,
-                                    member_of_template->locus);
+                                    locus_from_id(member_of_template->locus));
 
                         scope_entry_t* specialized_class_sym = 
                                 named_type_get_symbol(new_template_specialized_type);
@@ -750,7 +750,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                     new_member->type_information = update_type_for_instantiation(
                             new_member->type_information,
                             context_of_being_instantiated,
-                            member_of_template->locus,
+                            locus_from_id(member_of_template->locus),
                             instantiation_symbol_map,
                             /* pack_index */ -1);
 
@@ -798,7 +798,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                                 update_type_for_instantiation(
                                         ori_param->type_information,
                                         context_of_being_instantiated,
-                                        member_of_template->locus,
+                                        locus_from_id(member_of_template->locus),
                                         instantiation_symbol_map,
                                         /* pack */ -1);
 
@@ -982,7 +982,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                             /* pack_index */ -1,
                             NULL,
                             instantiation_symbol_map,
-                            member_of_template->locus);
+                            locus_from_id(member_of_template->locus));
                 }
 
                 if (entry_list == NULL)
@@ -993,7 +993,7 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                         named_type_get_symbol(being_instantiated),
                         symbol_entity_specs_get_access(member_of_template),
                         /* is_typename */ 0,
-                        member_of_template->locus);
+                        locus_from_id(member_of_template->locus));
                 break;
             }
         case SK_MEMBER_STATIC_ASSERT:
@@ -1092,7 +1092,7 @@ static void instantiate_dependent_friend_function(
     scope_entry_t* new_function = NULL;
 
     type_t* new_type = update_type_for_instantiation(friend->type_information,
-            context_of_being_instantiated, friend->locus,
+            context_of_being_instantiated, locus_from_id(friend->locus),
             instantiation_symbol_map,
             /* pack_index */ -1);
 
@@ -1190,7 +1190,7 @@ static void instantiate_dependent_friend_function(
                     {
                         scope_entry_t* current_entry = entry_list_iterator_current(it);
 
-                        info_printf_at(current_entry->locus, "%s\n",
+                        info_printf_at(locus_from_id(current_entry->locus), "%s\n",
                                 print_decl_type_str(current_entry->type_information, current_entry->decl_context, 
                                     get_qualified_symbol_name(current_entry, current_entry->decl_context)));
                     }
@@ -1308,7 +1308,7 @@ static void instantiate_dependent_friend_function(
                         {
                             scope_entry_t* current_entry = entry_list_iterator_current(it);
 
-                            info_printf_at(current_entry->locus, "%s\n",
+                            info_printf_at(locus_from_id(current_entry->locus), "%s\n",
                                     print_decl_type_str(current_entry->type_information, current_entry->decl_context, 
                                         get_qualified_symbol_name(current_entry, current_entry->decl_context)));
                         }
@@ -1337,7 +1337,7 @@ static void instantiate_dependent_friend_function(
                 new_function = new_symbol(declaration_context, declaration_context->current_scope, friend->symbol_name);
 
                 new_function->kind = SK_FUNCTION;
-                new_function->locus = locus;
+                new_function->locus = locus_get_id(locus);
                 new_function->type_information = new_type;
                 symbol_entity_specs_copy_from(new_function, friend);
                 new_function->defined = friend->defined;
@@ -1404,7 +1404,7 @@ static void instantiate_dependent_friend_function(
                 new_context->template_parameters = alineated_temp_params;
                 type_t* alineated_type = update_type_for_instantiation(new_type,
                         new_context,
-                        friend->locus,
+                        locus_from_id(friend->locus),
                         instantiation_symbol_map,
                         /* pack_index */ -1);
 
@@ -1451,7 +1451,7 @@ static void instantiate_dependent_friend_function(
                             new_decl_context->current_scope, friend->symbol_name);
 
                     new_template->kind = SK_TEMPLATE;
-                    new_template->locus = locus;
+                    new_template->locus = locus_get_id(locus);
 
                     // The new template symbol created to represent the
                     // instantiation of the current template friend function
@@ -1514,7 +1514,7 @@ static void instantiate_class_common(
             get_actual_class_type(being_instantiated),
             inner_decl_context,
             instantiation_symbol_map,
-            being_instantiated_sym->locus
+            locus_from_id(being_instantiated_sym->locus)
             );
 
     if (!symbol_entity_specs_get_is_unnamed(being_instantiated_sym))
@@ -1595,6 +1595,9 @@ static void instantiate_class_common(
 
     scope_entry_list_t * members = class_type_get_members(get_actual_class_type(selected_template));
     scope_entry_list_t * friends = class_type_get_friends(get_actual_class_type(selected_template));
+
+    // The instantiated class will have about as many names as the template
+    dhash_ptr_reserve(inner_decl_context->current_scope->dhash, entry_list_size(members));
     DEBUG_CODE()
     {
         fprintf(stderr, "INSTANTIATION: Have to instantiate %d members\n", entry_list_size(members));
@@ -1915,7 +1918,7 @@ static type_t* solve_template_for_instantiation(scope_entry_t* entry,
         template_parameter_list_t** deduced_template_arguments,
         const locus_t* locus)
 {
-    diagnostic_context_push_buffered();
+    diagnostic_context_push_counting();
 
     if (entry->kind != SK_CLASS
             && entry->kind != SK_TYPEDEF)
@@ -1934,7 +1937,7 @@ static type_t* solve_template_for_instantiation(scope_entry_t* entry,
     {
         fprintf(stderr, "INSTANTIATION: Instantiating class '%s' at '%s'\n",
                 print_type_str(get_user_defined_type(entry), entry->decl_context),
-                locus_to_str(entry->locus));
+                locus_to_str(locus_from_id(entry->locus)));
     }
 
     if (!is_template_specialized_type(template_specialized_type)
@@ -2210,6 +2213,8 @@ char instantiate_nontemplate_member_class_if_possible(scope_entry_t* entry,
 }
 
 static nodecl_t nodecl_instantiation_units;
+// Set once nodecl_instantiation_units has been added to the translation unit
+static char instantiation_units_emitted;
 typedef
 struct instantiation_item_tag
 {
@@ -2217,17 +2222,46 @@ struct instantiation_item_tag
     const locus_t* locus;
 } instantiation_item_t;
 
-static instantiation_item_t** symbols_to_instantiate;
-static int num_symbols_to_instantiate;
+// Worklist of functions to instantiate. Items are processed in the order
+// they were added and every symbol is only added once per translation unit
+static struct
+{
+    instantiation_item_t* items;
+    int num_items;
+    int size_items;
+    // Index of the first item still not processed
+    int next_item;
+
+    // Every symbol ever added
+    dhash_ptr_t* queued_symbols;
+} instantiation_worklist;
+
+static void instantiation_worklist_push(instantiation_item_t item)
+{
+    if (instantiation_worklist.num_items == instantiation_worklist.size_items)
+    {
+        instantiation_worklist.size_items = instantiation_worklist.size_items == 0
+            ? 64 : 2 * instantiation_worklist.size_items;
+        instantiation_worklist.items = NEW_REALLOC(instantiation_item_t,
+                instantiation_worklist.items,
+                instantiation_worklist.size_items);
+    }
+
+    instantiation_worklist.items[instantiation_worklist.num_items++] = item;
+}
 
 void instantiation_init(void)
 {
     nodecl_instantiation_units = nodecl_null();
-    symbols_to_instantiate = NULL;
-    num_symbols_to_instantiate = 0;
+    instantiation_units_emitted = 0;
+
+    DELETE(instantiation_worklist.items);
+    if (instantiation_worklist.queued_symbols != NULL)
+        dhash_ptr_destroy(instantiation_worklist.queued_symbols);
+    memset(&instantiation_worklist, 0, sizeof(instantiation_worklist));
 }
 
-static void instantiate_every_symbol(scope_entry_t* entry,
+static nodecl_t instantiate_every_symbol(scope_entry_t* entry,
         const locus_t* locus);
 
 static void mark_class_and_bases_as_user_declared(scope_entry_t* sym)
@@ -2263,29 +2297,154 @@ static void mark_class_and_bases_as_user_declared(scope_entry_t* sym)
     }
 }
 
-void instantiation_instantiate_pending_functions(nodecl_t* nodecl_output)
+// Symbols referenced by the nodecl that will be emitted. Functions that
+// were only referenced by tentative checks whose trees were discarded do
+// not appear here
+static void collect_used_symbols(nodecl_t n, dhash_ptr_t* used_symbols)
 {
-    while (num_symbols_to_instantiate > 0)
+    if (nodecl_is_null(n))
+        return;
+
+    // Lists are degenerated trees as deep as they are long, so avoid recursion
+    int num_stack = 0, size_stack = 64;
+    nodecl_t* stack = NEW_VEC(nodecl_t, size_stack);
+    stack[num_stack++] = n;
+
+    while (num_stack > 0)
     {
-        int tmp_num_symbols_to_instantiate = num_symbols_to_instantiate;
-        instantiation_item_t** tmp_symbols_to_instantiate = symbols_to_instantiate;
+        nodecl_t current = stack[--num_stack];
 
-        num_symbols_to_instantiate = 0;
-        symbols_to_instantiate = NULL;
+        scope_entry_t* sym = nodecl_get_symbol(current);
+        if (sym != NULL
+                && dhash_ptr_query(used_symbols, (const char*)sym) == NULL)
+        {
+            dhash_ptr_insert(used_symbols, (const char*)sym, sym);
+            // Initializers and bodies are not children of the tree that
+            // references them
+            nodecl_t more = nodecl_null();
+            if (sym->kind == SK_VARIABLE)
+                more = sym->value;
+            else if (sym->kind == SK_FUNCTION)
+                more = symbol_entity_specs_get_function_code(sym);
+
+            if (!nodecl_is_null(more))
+            {
+                if (num_stack == size_stack)
+                {
+                    size_stack *= 2;
+                    stack = NEW_REALLOC(nodecl_t, stack, size_stack);
+                }
+                stack[num_stack++] = more;
+            }
+        }
 
         int i;
-        for (i = 0; i < tmp_num_symbols_to_instantiate; i++)
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
         {
-            instantiate_every_symbol(
-                    tmp_symbols_to_instantiate[i]->symbol,
-                    tmp_symbols_to_instantiate[i]->locus);
+            nodecl_t child = nodecl_get_child(current, i);
+            if (nodecl_is_null(child))
+                continue;
 
+            if (num_stack == size_stack)
+            {
+                size_stack *= 2;
+                stack = NEW_REALLOC(nodecl_t, stack, size_stack);
+            }
+            stack[num_stack++] = child;
+        }
+    }
+
+    DELETE(stack);
+}
 
-            DELETE(tmp_symbols_to_instantiate[i]);
+static char instantiation_item_is_used(instantiation_item_t* item,
+        dhash_ptr_t* used_symbols)
+{
+    // Virtual functions are needed by the virtual table of the class
+    return dhash_ptr_query(used_symbols, (const char*)item->symbol) != NULL
+        || (item->symbol->kind == SK_FUNCTION
+                && symbol_entity_specs_get_is_virtual(item->symbol));
+}
+
+static void instantiate_pending_items(nodecl_t nodecl_output)
+{
+    if (!CURRENT_CONFIGURATION->explicit_instantiation_only_used)
+    {
+        while (instantiation_worklist.next_item < instantiation_worklist.num_items)
+        {
+            // Copy it since instantiating may add items and move the array
+            instantiation_item_t item =
+                instantiation_worklist.items[instantiation_worklist.next_item++];
+            instantiate_every_symbol(item.symbol, item.locus);
         }
-        DELETE(tmp_symbols_to_instantiate);
+        return;
     }
 
+    // Only instantiate what the emitted code references. Instantiating a
+    // function may make other deferred items used so iterate until no
+    // more progress is made
+    dhash_ptr_t* used_symbols = dhash_ptr_new(5);
+    collect_used_symbols(nodecl_output, used_symbols);
+
+    instantiation_item_t* deferred_items = NULL;
+    int num_deferred_items = 0;
+
+    char progress = 1;
+    while (progress)
+    {
+        progress = 0;
+        while (instantiation_worklist.next_item < instantiation_worklist.num_items)
+        {
+            instantiation_item_t item =
+                instantiation_worklist.items[instantiation_worklist.next_item++];
+            if (!instantiation_item_is_used(&item, used_symbols))
+            {
+                P_LIST_ADD(deferred_items, num_deferred_items, item);
+                continue;
+            }
+
+            collect_used_symbols(
+                    instantiate_every_symbol(item.symbol, item.locus),
+                    used_symbols);
+            progress = 1;
+        }
+
+        // Requeue the items that have become used
+        int i, num_still_deferred = 0;
+        for (i = 0; i < num_deferred_items; i++)
+        {
+            if (instantiation_item_is_used(&deferred_items[i], used_symbols))
+            {
+                instantiation_worklist_push(deferred_items[i]);
+                progress = 1;
+            }
+            else
+            {
+                deferred_items[num_still_deferred++] = deferred_items[i];
+            }
+        }
+        num_deferred_items = num_still_deferred;
+    }
+
+    DEBUG_CODE()
+    {
+        int i;
+        for (i = 0; i < num_deferred_items; i++)
+        {
+            fprintf(stderr, "INSTANTIATION: Not instantiating '%s' since it is not used\n",
+                    get_qualified_symbol_name(deferred_items[i].symbol,
+                        deferred_items[i].symbol->decl_context));
+        }
+    }
+
+    DELETE(deferred_items);
+    dhash_ptr_destroy(used_symbols);
+}
+
+void instantiation_instantiate_pending_functions(nodecl_t* nodecl_output)
+{
+    instantiate_pending_items(*nodecl_output);
+
     if (!nodecl_is_null(nodecl_instantiation_units))
     {
         *nodecl_output = nodecl_append_to_list(*nodecl_output,
@@ -2294,10 +2453,11 @@ void instantiation_instantiate_pending_functions(nodecl_t* nodecl_output)
         *nodecl_output = nodecl_concat_lists(*nodecl_output,
                 nodecl_instantiation_units);
     }
+    instantiation_units_emitted = 1;
 
     int N = 0;
     nodecl_t* list = nodecl_unpack_list(*nodecl_output, &N);
-    dhash_ptr_t* sym_hash = dhash_ptr_new(5);
+    dhash_ptr_t* sym_hash = dhash_ptr_new(N);
 
     // First declare template functions
     int i;
@@ -2429,9 +2589,9 @@ void instantiation_instantiate_pending_functions(nodecl_t* nodecl_output)
                                 nodecl_make_context(
                                     nodecl_null(),
                                     templated_context,
-                                    sym->locus),
+                                    locus_from_id(sym->locus)),
                                 sym,
-                                sym->locus);
+                                locus_from_id(sym->locus));
                     }
 
                     nodecl_replace(list[i], new_decl);
@@ -2481,9 +2641,9 @@ void instantiation_instantiate_pending_functions(nodecl_t* nodecl_output)
                         nodecl_make_context(
                             nodecl_null(),
                             templated_context,
-                            sym->locus),
+                            locus_from_id(sym->locus)),
                         sym,
-                        sym->locus);
+                        locus_from_id(sym->locus));
 
                 nodecl_replace(list[i], new_def);
 
@@ -2508,30 +2668,18 @@ void instantiation_instantiate_pending_functions(nodecl_t* nodecl_output)
     DELETE(list);
 }
 
-static char compare_instantiate_items(instantiation_item_t* current_item, instantiation_item_t* new_item)
-{
-    return current_item->symbol == new_item->symbol;
-}
-
 void instantiation_add_symbol_to_instantiate(scope_entry_t* entry,
         const locus_t* locus)
 {
-    instantiation_item_t* item = NEW0(instantiation_item_t);
-    item->symbol = entry;
-    item->locus = locus;
-
-    int old_num = num_symbols_to_instantiate;
+    if (instantiation_worklist.queued_symbols == NULL)
+        instantiation_worklist.queued_symbols = dhash_ptr_new(5);
+    else if (dhash_ptr_query(instantiation_worklist.queued_symbols, (const char*)entry) != NULL)
+        return;
 
-    P_LIST_ADD_ONCE_FUN(symbols_to_instantiate,
-            num_symbols_to_instantiate,
-            item,
-            compare_instantiate_items);
+    dhash_ptr_insert(instantiation_worklist.queued_symbols, (const char*)entry, entry);
 
-    // Crummy way to know if it was added
-    if (old_num == num_symbols_to_instantiate)
-    {
-        DELETE(item);
-    }
+    instantiation_item_t item = { entry, locus };
+    instantiation_worklist_push(item);
 }
 
 static char instantiate_true_template_function(scope_entry_t* entry, const locus_t* locus UNUSED_PARAMETER)
@@ -2543,7 +2691,7 @@ static char instantiate_true_template_function(scope_entry_t* entry, const locus
     ERROR_CONDITION(!nodecl_is_null(symbol_entity_specs_get_function_code(entry)),
             "Attempting to instantiate a specialized function apparently already instantiated", 0);
 
-    entry->locus = locus;
+    entry->locus = locus_get_id(locus);
 
     type_t* template_specialized_type = entry->type_information;
 
@@ -2568,7 +2716,7 @@ static char instantiate_true_template_function(scope_entry_t* entry, const locus
         fprintf(stderr, "INSTANTIATION: Instantiating function '%s' with type '%s' at '%s\n",
                 entry->symbol_name,
                 print_type_str(entry->type_information, entry->decl_context),
-                locus_to_str(entry->locus));
+                locus_to_str(locus_from_id(entry->locus)));
     }
 
     instantiation_symbol_map_t* instantiation_symbol_map = NULL;
@@ -2614,7 +2762,7 @@ static char instantiate_nontemplate_member_function_of_template_class(scope_entr
     ERROR_CONDITION(!nodecl_is_null(symbol_entity_specs_get_function_code(entry)),
             "Attempting to instantiate a specialized function apparently already instantiated", 0);
 
-    entry->locus = locus;
+    entry->locus = locus_get_id(locus);
 
     scope_entry_t* emission_template =
         symbol_entity_specs_get_emission_template(entry);
@@ -2636,7 +2784,7 @@ static char instantiate_nontemplate_member_function_of_template_class(scope_entr
         fprintf(stderr, "INSTANTIATION: Instantiating nontemplate member function of template '%s' with type '%s' at '%s\n",
                 get_qualified_symbol_name(entry, entry->decl_context),
                 print_type_str(entry->type_information, entry->decl_context),
-                locus_to_str(entry->locus));
+                locus_to_str(locus_from_id(entry->locus)));
     }
 
     nodecl_t orig_function_code = symbol_entity_specs_get_function_code(
@@ -2832,7 +2980,8 @@ static char instantiate_template_function_internal(scope_entry_t* entry, const l
 }
 
 
-static void instantiate_template_function_and_add_to_instantiation_units(scope_entry_t* entry,
+// Returns the entities that have been added to the instantiation units
+static nodecl_t instantiate_template_function_and_add_to_instantiation_units(scope_entry_t* entry,
         const locus_t* locus UNUSED_PARAMETER)
 {
     char was_instantiated = instantiate_template_function_internal(entry, locus);
@@ -2844,15 +2993,32 @@ static void instantiate_template_function_and_add_to_instantiation_units(scope_e
                 instantiated_entities,
                 symbol_entity_specs_get_function_code(entry));
 
-        nodecl_instantiation_units = nodecl_concat_lists(
-                nodecl_instantiation_units,
-                instantiated_entities);
+        if (!instantiation_units_emitted)
+        {
+            nodecl_instantiation_units = nodecl_concat_lists(
+                    nodecl_instantiation_units,
+                    instantiated_entities);
+        }
+        else
+        {
+            // Instantiated after the translation unit was built (e.g. from a
+            // TL phase) so add it straight to the top level
+            nodecl_t nodecl_top_level = CURRENT_COMPILED_FILE->nodecl;
+            nodecl_set_child(nodecl_top_level, 0,
+                    nodecl_concat_lists(
+                        nodecl_get_child(nodecl_top_level, 0),
+                        instantiated_entities));
+        }
+
+        return instantiated_entities;
     }
+
+    return nodecl_null();
 }
 
 // This function eventually may have to "instantiate" data, for the moment
 // it only instantiates functions
-static void instantiate_every_symbol(scope_entry_t* entry,
+static nodecl_t instantiate_every_symbol(scope_entry_t* entry,
         const locus_t* locus)
 {
     if (entry != NULL
@@ -2860,9 +3026,11 @@ static void instantiate_every_symbol(scope_entry_t* entry,
     {
         if (function_may_be_instantiated(entry))
         {
-            instantiate_template_function_and_add_to_instantiation_units(entry, locus);
+            return instantiate_template_function_and_add_to_instantiation_units(entry, locus);
         }
     }
+
+    return nodecl_null();
 }
 
 void instantiate_template_function(scope_entry_t* entry, const locus_t* locus)
@@ -2870,6 +3038,24 @@ void instantiate_template_function(scope_entry_t* entry, const locus_t* locus)
     instantiate_template_function_internal(entry, locus);
 }
 
+nodecl_t instantiation_get_function_code(scope_entry_t* entry, const locus_t* locus)
+{
+    ERROR_CONDITION(entry == NULL || entry->kind != SK_FUNCTION,
+            "Invalid symbol", 0);
+
+    // Bodies of members of class template specializations and of function
+    // template specializations are only instantiated when something needs
+    // them
+    if (nodecl_is_null(symbol_entity_specs_get_function_code(entry))
+            && !symbol_entity_specs_get_is_instantiated(entry)
+            && function_may_be_instantiated(entry))
+    {
+        instantiate_template_function_and_add_to_instantiation_units(entry, locus);
+    }
+
+    return symbol_entity_specs_get_function_code(entry);
+}
+
 void instantiate_template_function_and_integrate_in_translation_unit(
         scope_entry_t* entry UNUSED_PARAMETER,
         const locus_t* locus UNUSED_PARAMETER)
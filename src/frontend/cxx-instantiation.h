@@ -60,6 +60,10 @@ LIBMCXX_EXTERN void instantiation_add_symbol_to_instantiate(scope_entry_t* entry
 LIBMCXX_EXTERN char function_may_be_instantiated(scope_entry_t* entry);
 LIBMCXX_EXTERN void instantiate_template_function(scope_entry_t* entry, const locus_t* locus);
 
+// Returns the function code of entry, instantiating it first if entry is an
+// implicit instantiation whose body has not been needed yet
+LIBMCXX_EXTERN nodecl_t instantiation_get_function_code(scope_entry_t* entry, const locus_t* locus);
+
 LIBMCXX_EXTERN void instantiate_template_function_and_integrate_in_translation_unit(scope_entry_t* entry,
         const locus_t* locus);
 
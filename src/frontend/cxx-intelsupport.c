@@ -310,7 +310,7 @@ void sign_in_intel_simd_types(const decl_context_t* decl_context)
             {
                 const char* class_name = name;
                 scope_entry_t* sym = new_symbol(decl_context, decl_context->current_scope, uniquestr(class_name));
-                sym->locus = make_locus("(builtin-simd-type)", 0, 0);
+                sym->locus = locus_get_id(make_locus("(builtin-simd-type)", 0, 0));
                 sym->kind = SK_CLASS;
                 sym->type_information = get_new_class_type(decl_context, vector_names[i].type_tag);
 
@@ -320,7 +320,7 @@ void sign_in_intel_simd_types(const decl_context_t* decl_context)
             // typedef-name
             {
                 scope_entry_t* sym = new_symbol(decl_context, decl_context->current_scope, uniquestr(typedef_name));
-                sym->locus = make_locus("(builtin-simd-type)", 0, 0);
+                sym->locus = locus_get_id(make_locus("(builtin-simd-type)", 0, 0));
                 sym->kind = SK_TYPEDEF;
                 sym->type_information = *(vector_names[i].field);
                 sym->defined = 1;
@@ -561,14 +561,33 @@ char intel_vector_struct_to_intel_vector_struct_reinterpret_type(type_t* orig, t
     return 0;
 }
 
-void sign_in_icc_intrinsics(const decl_context_t* decl_context)
+#define LAZY_BUILTIN(name, id, ...) \
+    static void sign_in_icc_##id(const decl_context_t* decl_context, \
+            locus_id_t builtins_locus) __VA_ARGS__
+#include "cxx-iccbuiltins-lazy.h"
+#include "cxx-iccbuiltins-knc-lazy.h"
+#undef LAZY_BUILTIN
+
+#define LAZY_BUILTIN(name, id, ...) { name, sign_in_icc_##id },
+static const lazy_builtin_t icc_intrinsics[] =
 {
-    const locus_t* builtins_locus = make_locus("(intel-builtins)", 0, 0);
-    // Xeon
-#include "cxx-iccbuiltins.h"
+#include "cxx-iccbuiltins-lazy.h"
+};
 
-    // Knights Corner (aka MIC)
-    builtins_locus = make_locus("(intel-builtins-knc)", 0, 0);
-#include "cxx-iccbuiltins-knc.h"
-}
+static const lazy_builtin_t icc_knc_intrinsics[] =
+{
+#include "cxx-iccbuiltins-knc-lazy.h"
+};
+#undef LAZY_BUILTIN
+
+const lazy_builtin_table_t icc_intrinsics_table =
+{
+    "(intel-builtins)", icc_intrinsics, STATIC_ARRAY_LENGTH(icc_intrinsics)
+};
+
+// Knights Corner (aka MIC)
+const lazy_builtin_table_t icc_knc_intrinsics_table =
+{
+    "(intel-builtins-knc)", icc_knc_intrinsics, STATIC_ARRAY_LENGTH(icc_knc_intrinsics)
+};
 
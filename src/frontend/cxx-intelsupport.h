@@ -4,6 +4,7 @@
 #include "libmcxx-common.h"
 #include "cxx-nodecl.h"
 #include "cxx-scope-decls.h"
+#include "cxx-gccbuiltins.h"
 
 MCXX_BEGIN_DECLS
 
@@ -65,7 +66,9 @@ LIBMCXX_EXTERN type_t* vector_type_get_intel_vector_struct_type(type_t* vector_t
 LIBMCXX_EXTERN scope_entry_t* vector_type_get_intel_vector_typedef(type_t* vector_type);
 LIBMCXX_EXTERN type_t* intel_vector_struct_type_get_vector_type(type_t* vector_type);
 
-LIBMCXX_EXTERN void sign_in_icc_intrinsics(const decl_context_t* decl_context);
+// ICC intrinsics of Xeon and Knights Corner, signed in lazily
+LIBMCXX_EXTERN const lazy_builtin_table_t icc_intrinsics_table;
+LIBMCXX_EXTERN const lazy_builtin_table_t icc_knc_intrinsics_table;
 LIBMCXX_EXTERN void sign_in_intel_simd_types(const decl_context_t* decl_context);
 
 MCXX_END_DECLS
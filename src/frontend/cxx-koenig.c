@@ -36,6 +36,7 @@
 #include "cxx-typeutils.h"
 #include "cxx-utils.h"
 #include "cxx-entrylist.h"
+#include "dhash_ptr.h"
 
 // Koenig lookup may need to instantiate something
 #include "cxx-instantiation.h"
@@ -47,8 +48,33 @@ struct associated_scopes_tag
     scope_t** associated_scopes;
     int num_associated_classes;
     scope_entry_t** associated_classes;
+
+    // Set when some class involved was incomplete or dependent, its set
+    // of associated scopes and classes may still change
+    char is_provisional;
+
+    // Sets of the elements of the lists above while they are computed
+    dhash_ptr_t* associated_scopes_set;
+    dhash_ptr_t* associated_classes_set;
 } koenig_lookup_info_t;
 
+static void koenig_lookup_info_free_sets(koenig_lookup_info_t* koenig_info)
+{
+    if (koenig_info->associated_scopes_set != NULL)
+        dhash_ptr_destroy(koenig_info->associated_scopes_set);
+    if (koenig_info->associated_classes_set != NULL)
+        dhash_ptr_destroy(koenig_info->associated_classes_set);
+    koenig_info->associated_scopes_set = NULL;
+    koenig_info->associated_classes_set = NULL;
+}
+
+static void koenig_lookup_info_free(koenig_lookup_info_t* koenig_info)
+{
+    koenig_lookup_info_free_sets(koenig_info);
+    DELETE(koenig_info->associated_scopes);
+    DELETE(koenig_info->associated_classes);
+}
+
 static void compute_associated_scopes(
         koenig_lookup_info_t* koenig_lookup_info,
         int num_arguments, type_t** argument_type_list,
@@ -179,8 +205,7 @@ scope_entry_list_t* koenig_lookup(
         fprintf(stderr, "KOENIG: Argument dependent lookup ended\n");
     }
 
-    DELETE(koenig_info.associated_scopes);
-    DELETE(koenig_info.associated_classes);
+    koenig_lookup_info_free(&koenig_info);
 
     return result;
 }
@@ -203,6 +228,46 @@ static void compute_associated_scopes(
     compute_associated_scopes_aux(result, num_arguments, argument_type_list, locus);
 }
 
+static void compute_set_of_associated_classes_scope(type_t* type_info, koenig_lookup_info_t* koenig_info,
+        const locus_t* locus);
+
+static void add_associated_scope(koenig_lookup_info_t* koenig_info, scope_t* sc);
+static void add_associated_class(koenig_lookup_info_t* koenig_info, scope_entry_t* class_symbol);
+
+// Associated scopes and classes of every argument type, keyed on the
+// unqualified type. The same iterator and container types appear in many
+// calls so this saves walking their bases and template arguments again
+static dhash_ptr_t* _associated_scopes_of_type = NULL;
+
+static koenig_lookup_info_t* get_associated_scopes_of_type(
+        type_t* argument_type,
+        const locus_t* locus,
+        char *is_cached)
+{
+    if (_associated_scopes_of_type == NULL)
+        _associated_scopes_of_type = dhash_ptr_new(256);
+
+    *is_cached = 1;
+    koenig_lookup_info_t* type_info =
+        (koenig_lookup_info_t*)dhash_ptr_query(_associated_scopes_of_type, (const char*)argument_type);
+    if (type_info != NULL)
+        return type_info;
+
+    type_info = NEW0(koenig_lookup_info_t);
+    compute_associated_scopes_rec(type_info, argument_type, locus);
+    // Nothing else is added to it
+    koenig_lookup_info_free_sets(type_info);
+
+    // Empty sets are cheap to compute and would keep every fundamental or
+    // unresolved overload type in the table
+    *is_cached = !type_info->is_provisional
+        && type_info->num_associated_scopes != 0;
+    if (*is_cached)
+        dhash_ptr_insert(_associated_scopes_of_type, (const char*)argument_type, type_info);
+
+    return type_info;
+}
+
 static void compute_associated_scopes_aux(koenig_lookup_info_t* koenig_info, 
         int num_arguments, type_t** argument_type_list,
         const locus_t* locus)
@@ -210,20 +275,62 @@ static void compute_associated_scopes_aux(koenig_lookup_info_t* koenig_info,
     int i;
     for (i = 0; i < num_arguments; i++)
     {
-        type_t* argument_type = argument_type_list[i];
-        compute_associated_scopes_rec(koenig_info, argument_type, locus);
+        type_t* argument_type = get_unqualified_type(
+                no_ref(advance_over_typedefs(argument_type_list[i])));
+
+        char is_cached = 0;
+        koenig_lookup_info_t* type_info = get_associated_scopes_of_type(argument_type, locus, &is_cached);
+
+        int j;
+        for (j = 0; j < type_info->num_associated_scopes; j++)
+        {
+            add_associated_scope(koenig_info, type_info->associated_scopes[j]);
+        }
+        for (j = 0; j < type_info->num_associated_classes; j++)
+        {
+            add_associated_class(koenig_info, type_info->associated_classes[j]);
+        }
+
+        if (!is_cached)
+        {
+            koenig_lookup_info_free(type_info);
+            DELETE(type_info);
+        }
     }
 }
 
-static void compute_set_of_associated_classes_scope(type_t* type_info, koenig_lookup_info_t* koenig_info,
-        const locus_t* locus);
+static void free_associated_scopes_of_type(const char* key UNUSED_PARAMETER,
+        void* info,
+        void* walk_info UNUSED_PARAMETER)
+{
+    koenig_lookup_info_t* type_info = (koenig_lookup_info_t*)info;
+    koenig_lookup_info_free(type_info);
+    DELETE(type_info);
+}
+
+void koenig_lookup_reset(void)
+{
+    if (_associated_scopes_of_type == NULL)
+        return;
+
+    dhash_ptr_walk(_associated_scopes_of_type, free_associated_scopes_of_type, NULL);
+    dhash_ptr_destroy(_associated_scopes_of_type);
+    _associated_scopes_of_type = NULL;
+}
 
 static void add_associated_scope(koenig_lookup_info_t* koenig_info, scope_t* sc)
 {
     ERROR_CONDITION(sc->kind != NAMESPACE_SCOPE, 
             "Associated scopes by means of Koenig only can be namespace scopes", 0);
 
-    P_LIST_ADD_ONCE(koenig_info->associated_scopes, koenig_info->num_associated_scopes, sc);
+    if (koenig_info->associated_scopes_set == NULL)
+        koenig_info->associated_scopes_set = dhash_ptr_new(16);
+
+    if (dhash_ptr_query(koenig_info->associated_scopes_set, (const char*)sc) != NULL)
+        return;
+
+    dhash_ptr_insert(koenig_info->associated_scopes_set, (const char*)sc, sc);
+    P_LIST_ADD(koenig_info->associated_scopes, koenig_info->num_associated_scopes, sc);
 
     // If this scope is an inline one, add the enclosing scope as well
     if (sc->related_entry != NULL
@@ -233,6 +340,17 @@ static void add_associated_scope(koenig_lookup_info_t* koenig_info, scope_t* sc)
     }
 }
 
+static char is_specialization_of_template_template_parameter(type_t* class_type)
+{
+    if (!is_template_specialized_type(class_type))
+        return 0;
+
+    scope_entry_t* template_symbol = template_type_get_related_symbol(
+            template_specialized_type_get_related_template_type(class_type));
+    return template_symbol->kind == SK_TEMPLATE_TEMPLATE_PARAMETER
+        || template_symbol->kind == SK_TEMPLATE_TEMPLATE_PARAMETER_PACK;
+}
+
 static void add_associated_class(koenig_lookup_info_t* koenig_info, scope_entry_t* class_symbol)
 {
     if (class_symbol->kind == SK_TYPEDEF)
@@ -249,16 +367,29 @@ static void add_associated_class(koenig_lookup_info_t* koenig_info, scope_entry_
     ERROR_CONDITION(class_symbol == NULL
             || class_symbol->kind != SK_CLASS, "Symbol must be a class", 0);
 
-    int i;
-    for (i = 0; i < koenig_info->num_associated_classes; i++)
+    if (koenig_info->associated_classes_set == NULL)
+        koenig_info->associated_classes_set = dhash_ptr_new(16);
+
+    // Do not add if already there
+    type_t* class_type = class_symbol->type_information;
+    if (dhash_ptr_query(koenig_info->associated_classes_set, (const char*)class_type) != NULL)
+        return;
+
+    // Different class types are only equivalent when they are
+    // specializations built on top of template-template parameters
+    if (is_specialization_of_template_template_parameter(class_type))
     {
-        // Do not add if already there
-        if (equivalent_types(
-                    koenig_info->associated_classes[i]->type_information,
-                    class_symbol->type_information))
-            return;
+        int i;
+        for (i = 0; i < koenig_info->num_associated_classes; i++)
+        {
+            if (equivalent_types(
+                        koenig_info->associated_classes[i]->type_information,
+                        class_type))
+                return;
+        }
     }
 
+    dhash_ptr_insert(koenig_info->associated_classes_set, (const char*)class_type, class_symbol);
     P_LIST_ADD(koenig_info->associated_classes, koenig_info->num_associated_classes, class_symbol);
 }
 
@@ -479,6 +610,10 @@ static void compute_set_of_associated_classes_scope_rec(type_t* type_info,
             named_type_get_symbol(type_info)->decl_context,
             locus);
 
+    if (!is_complete_type(type_info)
+            || is_dependent_type(type_info))
+        koenig_info->is_provisional = 1;
+
     add_associated_class(koenig_info, class_symbol);
 
     if (symbol_entity_specs_get_is_member(class_symbol))
@@ -497,7 +632,10 @@ static void compute_set_of_associated_classes_scope_rec(type_t* type_info,
                 /* is_expansion */ NULL,
                 /* access_specifier */ NULL);
         if (is_dependent)
+        {
+            koenig_info->is_provisional = 1;
             continue;
+        }
 
         compute_set_of_associated_classes_scope_rec(get_user_defined_type(base_symbol), koenig_info, locus);
     }
@@ -44,6 +44,9 @@ LIBMCXX_EXTERN scope_entry_list_t* koenig_lookup(
         nodecl_t nodecl_simple_name,
         const locus_t* locus);
 
+// Frees the associated scopes computed for the current translation unit
+LIBMCXX_EXTERN void koenig_lookup_reset(void);
+
 MCXX_END_DECLS
 
 #endif // CXX_KOENIG_H
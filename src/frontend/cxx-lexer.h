@@ -79,6 +79,9 @@ LIBMCXX_EXTERN int mc99_open_file_for_scanning(const char* scanned_filename, con
 LIBMCXX_EXTERN int mcxx_prepare_string_for_scanning(const char* str);
 LIBMCXX_EXTERN int mc99_prepare_string_for_scanning(const char* str);
 
+LIBMCXX_EXTERN int mcxx_lexer_count_tokens(void);
+LIBMCXX_EXTERN int mc99_lexer_count_tokens(void);
+
 LIBMCXX_EXTERN void register_new_directive(
         compilation_configuration_t* configuration,
         const char* prefix, const char* directive, char is_construct, 
@@ -29,11 +29,15 @@
 #include <stdlib.h>
 #include "string_utils.h"
 
-struct locus_tag
+static inline locus_id_t locus_get_id(const locus_t* l)
 {
-    const char* filename;
-    unsigned int line, col;
-};
+    return (locus_id_t)(uintptr_t)l;
+}
+
+static inline const locus_t* locus_from_id(locus_id_t id)
+{
+    return (const locus_t*)(uintptr_t)id;
+}
 
 static inline const char* locus_to_str(const locus_t* l)
 {
@@ -41,10 +45,14 @@ static inline const char* locus_to_str(const locus_t* l)
     if (l == NULL)
         return ":0";
 
-    if (l->col != 0)
-        uniquestr_sprintf(&result, "%s:%d:%d", l->filename, l->line, l->col);
+    const char* filename;
+    unsigned int line, col;
+    locus_decode(l, &filename, &line, &col);
+
+    if (col != 0)
+        uniquestr_sprintf(&result, "%s:%d:%d", filename, line, col);
     else
-        uniquestr_sprintf(&result, "%s:%d", l->filename, l->line);
+        uniquestr_sprintf(&result, "%s:%d", filename, line);
 
     return result;
 }
@@ -53,15 +61,28 @@ static inline const char* locus_get_filename(const locus_t* l)
 {
     if (l == NULL)
         return "";
-    return l->filename;
+
+    const char* filename;
+    locus_decode(l, &filename, NULL, NULL);
+    return filename;
 }
 
 static inline unsigned int locus_get_line(const locus_t* l)
 {
-    return l == NULL ? 0 : l->line;
+    if (l == NULL)
+        return 0;
+
+    unsigned int line;
+    locus_decode(l, NULL, &line, NULL);
+    return line;
 }
 
 static inline unsigned int locus_get_column(const locus_t* l)
 {
-    return l == NULL ? 0 : l->col;
+    if (l == NULL)
+        return 0;
+
+    unsigned int col;
+    locus_decode(l, NULL, NULL, &col);
+    return col;
 }
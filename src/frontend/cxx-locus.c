@@ -25,126 +25,218 @@
 --------------------------------------------------------------------*/
 
 #include "cxx-locus.h"
+#include "cxx-process.h"
 #include "mem.h"
+#include <stdint.h>
 #include <string.h>
 #include "uniquestr.h"
 #include "string_utils.h"
+#include "open_hash.h"
+
+// A locus is not a pointer to a record but a 32-bit location encoded in the
+// pointer value itself, in the spirit of the source locations of clang.
+//
+// Most locations are encoded relative to a chunk, which represents a range
+// of LOCUS_CHUNK_LINES lines of a file
+//
+//   0 | chunk (15 bits) | line in chunk (8 bits) | column (8 bits)
+//
+// The chunk table is the only thing that grows with the size of the
+// translation unit. Chunk 0 is never used so no locus is encoded as 0.
+//
+// Locations that do not fit (very wide columns or an exhausted chunk
+// table) are interned in a side table
+//
+//   1 | index of the full record (31 bits)
+//
+// Filenames, lines and columns are only decoded when somebody asks for them
+
+enum
+{
+    LOCUS_COLUMN_BITS = 8,
+    LOCUS_LINE_BITS = 8,
+    LOCUS_CHUNK_BITS = 15,
+
+    LOCUS_CHUNK_LINES = 1 << LOCUS_LINE_BITS,
+    LOCUS_MAX_COLUMN = (1 << LOCUS_COLUMN_BITS) - 1,
+    LOCUS_MAX_CHUNKS = 1 << LOCUS_CHUNK_BITS,
+};
 
-// Heavily inspired in lib/char_hash.c contributed by Jan Hoogerbrugge
+#define LOCUS_OVERFLOW_BIT (1u << 31)
 
 typedef
-struct locus_item_tag
+struct locus_chunk_tag
 {
-    unsigned int hash;
-    locus_t *locus;
-} locus_item_t;
+    const char* filename;
+    unsigned int first_line;
+} locus_chunk_t;
 
 typedef
-struct locus_bucket_tag
+struct locus_record_tag
 {
-    int num;
-    int capacity;
-    locus_item_t* items;
-} locus_bucket_t;
+    const char* filename;
+    unsigned int line, col;
+} locus_record_t;
+
+// Both tables store unsigned int indexes, keyed by a locus_record_t
+static locus_chunk_t* chunks;
+static int num_chunks = 1;
+static open_hash_t chunk_index = { .entry_size = sizeof(unsigned int) };
 
+static locus_record_t* records;
+static int num_records;
+static open_hash_t record_index = { .entry_size = sizeof(unsigned int) };
 
-static locus_bucket_t *hash_table[49999];
+// Cache of the last chunk used, locations tend to come in order
+static const char* last_filename;
+static unsigned int last_first_line;
+static unsigned int last_chunk;
 
 static unsigned int hash_locus(const char *filename, unsigned int line, unsigned int col)
 {
-    unsigned int hash = 0;
-    const char *p;
+    uint64_t h = (uint64_t)(uintptr_t)filename;
+    h = open_hash_combine(h, line);
+    h = open_hash_combine(h, col);
 
-    for (p = filename; *p; p++)
-        hash = ((hash << 5) + hash) ^ *p;
-
-    hash = ((hash << 5) + hash) ^ line;
-    hash = ((hash << 5) + hash) ^ col;
+    return (unsigned int)(h ^ (h >> 32));
+}
 
-    return hash;
+static char chunk_matches(const void* e, const void* k)
+{
+    unsigned int idx = *(const unsigned int*)e;
+    const locus_record_t* key = (const locus_record_t*)k;
+    // Chunks are keyed only on the filename and the first line
+    return chunks[idx].filename == key->filename
+        && chunks[idx].first_line == key->line;
 }
 
-enum { POOL_SIZE = 1024 };
+static char record_matches(const void* e, const void* k)
+{
+    unsigned int idx = *(const unsigned int*)e;
+    const locus_record_t* key = (const locus_record_t*)k;
+    return records[idx].filename == key->filename
+        && records[idx].line == key->line
+        && records[idx].col == key->col;
+}
 
-typedef
-struct pool_locus_tag
+static unsigned int get_chunk(const char* filename, unsigned int first_line)
 {
-    int num;
-    locus_t* pool;
-    struct pool_locus_tag *prev;
-} pool_locus_t;
+    if (last_chunk != 0
+            && last_filename == filename
+            && last_first_line == first_line)
+        return last_chunk;
 
-static pool_locus_t *pool_locus;
+    locus_record_t key = { filename, first_line, 0 };
+    unsigned int hash = hash_locus(filename, first_line, 0);
+    unsigned int* idx = (unsigned int*)open_hash_query(&chunk_index, hash,
+            chunk_matches, &key);
 
-static locus_t* pool_locus_alloc(void)
-{
-    if (pool_locus == NULL
-            || pool_locus->num == POOL_SIZE)
+    if (idx == NULL)
     {
-        pool_locus_t* new_pool = NEW(pool_locus_t);
-        new_pool->num = 0;
-        new_pool->pool = NEW_VEC(locus_t, POOL_SIZE);
-        new_pool->prev = pool_locus;
+        if (num_chunks == LOCUS_MAX_CHUNKS)
+            return 0;
 
-        pool_locus = new_pool;
+        if ((num_chunks & (num_chunks - 1)) == 0)
+            chunks = NEW_REALLOC(locus_chunk_t, chunks, 2 * num_chunks);
+
+        chunks[num_chunks].filename = filename;
+        chunks[num_chunks].first_line = first_line;
+
+        unsigned int new_idx = num_chunks;
+        idx = (unsigned int*)open_hash_insert(&chunk_index, hash, &new_idx);
+        num_chunks++;
     }
 
-    locus_t* result = &pool_locus->pool[pool_locus->num];
-    pool_locus->num++;
+    last_filename = filename;
+    last_first_line = first_line;
+    last_chunk = *idx;
 
-    return result;
+    return last_chunk;
 }
 
-const locus_t* make_locus(const char* filename, unsigned int line, unsigned int col)
+static unsigned int get_record(const char* filename, unsigned int line, unsigned int col)
 {
-    if (filename == NULL)
-        filename = "";
-
+    locus_record_t key = { filename, line, col };
     unsigned int hash = hash_locus(filename, line, col);
-    unsigned int hash_index = hash % (sizeof(hash_table) / sizeof(hash_table[0]));
+    unsigned int* idx = (unsigned int*)open_hash_query(&record_index, hash,
+            record_matches, &key);
 
-    if (hash_table[hash_index] == NULL)
+    if (idx == NULL)
     {
-        hash_table[hash_index] = NEW0(locus_bucket_t);
+        ERROR_CONDITION((unsigned int)num_records >= LOCUS_OVERFLOW_BIT - 1,
+                "Too many source locations", 0);
+
+        if (num_records == 0
+                || (num_records & (num_records - 1)) == 0)
+            records = NEW_REALLOC(locus_record_t, records,
+                    num_records == 0 ? 1 : 2 * num_records);
+
+        records[num_records] = key;
+
+        unsigned int new_idx = num_records;
+        idx = (unsigned int*)open_hash_insert(&record_index, hash, &new_idx);
+        num_records++;
     }
 
-    locus_bucket_t* bucket = hash_table[hash_index];
+    return *idx;
+}
+
+static const locus_t* encode_locus(unsigned int location)
+{
+    return (const locus_t*)(uintptr_t)location;
+}
+
+const locus_t* make_locus(const char* filename, unsigned int line, unsigned int col)
+{
+    if (filename == NULL)
+        filename = "";
 
-    int i, n = bucket->num;
-    locus_item_t *items = bucket->items;
+    filename = uniquestr(filename);
 
-    for (i = 0; i < n; i++)
+    if (col <= LOCUS_MAX_COLUMN)
     {
-        if (items[i].hash == hash
-                && strcmp(items[i].locus->filename, filename) == 0
-                && items[i].locus->line == line
-                && items[i].locus->col == col)
+        unsigned int chunk = get_chunk(filename, line & ~(LOCUS_CHUNK_LINES - 1));
+        if (chunk != 0)
         {
-            return items[i].locus;
+            return encode_locus(
+                    (chunk << (LOCUS_LINE_BITS + LOCUS_COLUMN_BITS))
+                    | ((line & (LOCUS_CHUNK_LINES - 1)) << LOCUS_COLUMN_BITS)
+                    | col);
         }
     }
 
-    if (bucket->num == bucket->capacity)
-    {
-        if (bucket->capacity == 0)
-            bucket->capacity = 16;
-        else
-            bucket->capacity = 2*(bucket->capacity + 1);
+    return encode_locus(LOCUS_OVERFLOW_BIT | get_record(filename, line, col));
+}
 
-        bucket->items =
-            xrealloc(bucket->items, bucket->capacity * sizeof(*(bucket->items)));
+void locus_decode(const locus_t* l,
+        const char** filename,
+        unsigned int* line,
+        unsigned int* col)
+{
+    unsigned int location = (unsigned int)(uintptr_t)l;
 
-        items = bucket->items;
+    const char* f;
+    unsigned int ln, c;
+    if (location & LOCUS_OVERFLOW_BIT)
+    {
+        locus_record_t* r = &records[location & ~LOCUS_OVERFLOW_BIT];
+        f = r->filename;
+        ln = r->line;
+        c = r->col;
+    }
+    else
+    {
+        locus_chunk_t* ch = &chunks[location >> (LOCUS_LINE_BITS + LOCUS_COLUMN_BITS)];
+        f = ch->filename;
+        ln = ch->first_line
+            | ((location >> LOCUS_COLUMN_BITS) & (LOCUS_CHUNK_LINES - 1));
+        c = location & LOCUS_MAX_COLUMN;
     }
 
-    items[n].hash = hash;
-    items[n].locus = pool_locus_alloc();
-    items[n].locus->filename = uniquestr(filename);
-    items[n].locus->line = line;
-    items[n].locus->col = col;
-
-    bucket->num++;
-
-    return items[n].locus;
+    if (filename != NULL)
+        *filename = f;
+    if (line != NULL)
+        *line = ln;
+    if (col != NULL)
+        *col = c;
 }
-
@@ -28,13 +28,29 @@
 #define CXX_LOCUS_H
 
 #include "cxx-macros.h"
+#include <stdint.h>
 
 MCXX_BEGIN_DECLS
 
+// Opaque, a locus is a compact source location encoded in the pointer value.
+// Never dereference it, use the functions below
 typedef struct locus_tag locus_t;
 
+// The 32-bit encoding of a locus, this is what trees and symbols store. 0 is
+// the NULL locus
+typedef uint32_t locus_id_t;
+
 const locus_t* make_locus(const char* filename, unsigned int line, unsigned int col);
 
+// Any of the output arguments can be NULL
+void locus_decode(const locus_t*,
+        const char** filename,
+        unsigned int* line,
+        unsigned int* col);
+
+static inline locus_id_t locus_get_id(const locus_t*);
+static inline const locus_t* locus_from_id(locus_id_t);
+
 static inline const char* locus_to_str(const locus_t*);
 static inline const char* locus_get_filename(const locus_t*);
 static inline unsigned int locus_get_line(const locus_t*);
@@ -40,8 +40,10 @@
 #include "cxx-gccbuiltins.h"
 #include "cxx-diagnostic.h"
 #include "cxx-intelsupport.h"
+#include "open_hash.h"
 
 #include <string.h>
+#include <stdint.h>
 
 typedef
 enum implicit_conversion_sequence_kind_tag
@@ -374,7 +376,7 @@ static char is_better_initialization_ics(
 }
 #endif
 
-static char standard_conversion_between_types_for_overload(
+static char standard_conversion_between_types_for_overload_uncached(
         standard_conversion_t *scs,
         type_t* orig,
         type_t* dest,
@@ -730,7 +732,7 @@ static scope_entry_t* get_specialized_conversion(
         fprintf(stderr, "ICS: Symbol '%s' at '%s' is a template conversion function, "
                 "deducing its arguments\n",
                 conv_funct->symbol_name,
-                locus_to_str(conv_funct->locus));
+                locus_to_str(locus_from_id(conv_funct->locus)));
     }
     // This is a template so we have to get the proper specialization
 
@@ -836,7 +838,7 @@ static char solve_initialization_of_class_type_(
         scope_entry_list_t** candidates,
         char *is_ambiguous);
 
-static void compute_ics_flags(type_t* orig, type_t* dest, const decl_context_t* decl_context, 
+static void compute_ics_flags_uncached(type_t* orig, type_t* dest, const decl_context_t* decl_context, 
         implicit_conversion_sequence_t *result, 
         char no_user_defined_conversions,
         char is_implicit_argument,
@@ -1039,7 +1041,7 @@ static void compute_ics_flags(type_t* orig, type_t* dest, const decl_context_t*
                         print_declarator(result->first_sc.orig),
                         print_declarator(result->first_sc.dest),
                         result->conversor ? result->conversor->symbol_name : "<<NULL>>",
-                        result->conversor ? locus_to_str(result->conversor->locus) : locus_to_str(0),
+                        result->conversor ? locus_to_str(locus_from_id(result->conversor->locus)) : locus_to_str(0),
                         print_declarator(result->second_sc.orig),
                         print_declarator(result->second_sc.dest));
             }
@@ -1053,6 +1055,237 @@ static void compute_ics_flags(type_t* orig, type_t* dest, const decl_context_t*
     }
 }
 
+// Cache of implicit conversion sequences. Entries are keyed on the exact
+// type pointers (the cached sequence refers to them) and the flags of the
+// computation. Standard conversions do not depend on the context so they
+// are stored without it, user defined conversions are stored along with
+// the decl_context where they were computed
+enum ics_cache_flags_tag
+{
+    ICS_CACHE_NO_USER_DEFINED_CONVERSIONS = 1 << 0,
+    ICS_CACHE_IS_IMPLICIT_ARGUMENT = 1 << 1,
+    ICS_CACHE_NEEDS_CONTEXTUAL_CONVERSION = 1 << 2,
+    // Results of standard_conversion_between_types_for_overload
+    ICS_CACHE_STANDARD_CONVERSION = 1 << 3,
+    // ref_qualifier_t is stored from this bit
+    ICS_CACHE_REF_QUALIFIER_SHIFT = 4,
+};
+
+typedef struct ics_cache_entry_tag
+{
+    type_t* orig;
+    type_t* dest;
+    const decl_context_t* decl_context;
+    unsigned int flags;
+    implicit_conversion_sequence_t ics;
+} ics_cache_entry_t;
+
+static struct
+{
+    open_hash_t table;
+
+    int hits;
+    int misses;
+    int not_cacheable;
+} _ics_cache;
+
+static unsigned int ics_cache_hash(const ics_cache_entry_t* key)
+{
+    uint64_t v = (uint64_t)(uintptr_t)key->orig;
+    v = open_hash_combine(v, (uint64_t)(uintptr_t)key->dest);
+    v = open_hash_combine(v, (uint64_t)(uintptr_t)key->decl_context);
+    v = open_hash_combine(v, key->flags);
+    return (unsigned int)(v ^ (v >> 32));
+}
+
+static char ics_cache_entry_matches(const void* e, const void* k)
+{
+    const ics_cache_entry_t* entry = (const ics_cache_entry_t*)e;
+    const ics_cache_entry_t* key = (const ics_cache_entry_t*)k;
+    return entry->orig == key->orig
+        && entry->dest == key->dest
+        && entry->decl_context == key->decl_context
+        && entry->flags == key->flags;
+}
+
+static ics_cache_entry_t* ics_cache_lookup(type_t* orig, type_t* dest,
+        const decl_context_t* decl_context,
+        unsigned int flags)
+{
+    ics_cache_entry_t key = {
+        .orig = orig,
+        .dest = dest,
+        .decl_context = decl_context,
+        .flags = flags,
+    };
+    return (ics_cache_entry_t*)open_hash_query(&_ics_cache.table,
+            ics_cache_hash(&key), ics_cache_entry_matches, &key);
+}
+
+static void ics_cache_add(type_t* orig, type_t* dest,
+        const decl_context_t* decl_context,
+        unsigned int flags,
+        const implicit_conversion_sequence_t* ics)
+{
+    if (_ics_cache.table.entry_size == 0)
+        open_hash_init(&_ics_cache.table, sizeof(ics_cache_entry_t));
+
+    ics_cache_entry_t new_entry = {
+        .orig = orig,
+        .dest = dest,
+        .decl_context = decl_context,
+        .flags = flags,
+        .ics = *ics,
+    };
+    open_hash_insert(&_ics_cache.table, ics_cache_hash(&new_entry), &new_entry);
+}
+
+// Conversions involving a class can only be cached once the class is
+// complete, otherwise its bases, constructors and conversion functions
+// may still change
+static char ics_cache_type_is_stable(type_t* t)
+{
+    if (t == NULL)
+        return 0;
+
+    t = no_ref(t);
+    for (;;)
+    {
+        if (is_pointer_to_member_type(t))
+        {
+            if (!ics_cache_type_is_stable(pointer_to_member_type_get_class_type(t)))
+                return 0;
+            t = pointer_type_get_pointee_type(t);
+        }
+        else if (is_pointer_type(t))
+            t = pointer_type_get_pointee_type(t);
+        else if (is_array_type(t))
+            t = array_type_get_element_type(t);
+        else
+            break;
+    }
+
+    if (is_class_type(t))
+        return is_complete_type(t)
+            && !is_dependent_type(t);
+
+    return 1;
+}
+
+void overload_ics_cache_reset(void)
+{
+    open_hash_destroy(&_ics_cache.table);
+}
+
+void overload_ics_cache_stats(void)
+{
+    int lookups = _ics_cache.hits + _ics_cache.misses;
+    fprintf(stderr, "Implicit conversion sequences found in the cache: %d (%.2f%%)\n",
+            _ics_cache.hits,
+            lookups == 0 ? 0.0 : (100.0 * _ics_cache.hits) / lookups);
+    fprintf(stderr, "Implicit conversion sequences computed: %d\n", _ics_cache.misses);
+    fprintf(stderr, "Implicit conversion sequences not cacheable: %d\n", _ics_cache.not_cacheable);
+}
+
+static char standard_conversion_between_types_for_overload(
+        standard_conversion_t *scs,
+        type_t* orig,
+        type_t* dest,
+        const locus_t* locus)
+{
+    if (!ics_cache_type_is_stable(orig)
+            || !ics_cache_type_is_stable(dest))
+    {
+        _ics_cache.not_cacheable++;
+        return standard_conversion_between_types_for_overload_uncached(scs, orig, dest, locus);
+    }
+
+    ics_cache_entry_t* entry = ics_cache_lookup(orig, dest,
+            /* decl_context */ NULL, ICS_CACHE_STANDARD_CONVERSION);
+    if (entry != NULL)
+    {
+        _ics_cache.hits++;
+        *scs = entry->ics.first_sc;
+        return entry->ics.kind == ICSK_STANDARD;
+    }
+    _ics_cache.misses++;
+
+    implicit_conversion_sequence_t ics = invalid_ics;
+    if (standard_conversion_between_types_for_overload_uncached(&ics.first_sc, orig, dest, locus))
+        ics.kind = ICSK_STANDARD;
+    *scs = ics.first_sc;
+
+    // Completing the conversion may have instantiated something
+    if (ics_cache_type_is_stable(orig)
+            && ics_cache_type_is_stable(dest))
+        ics_cache_add(orig, dest, /* decl_context */ NULL, ICS_CACHE_STANDARD_CONVERSION, &ics);
+
+    return ics.kind == ICSK_STANDARD;
+}
+
+static void compute_ics_flags(type_t* orig, type_t* dest, const decl_context_t* decl_context, 
+        implicit_conversion_sequence_t *result, 
+        char no_user_defined_conversions,
+        char is_implicit_argument,
+        char needs_contextual_conversion,
+        ref_qualifier_t ref_qualifier,
+        const locus_t* locus)
+{
+    // Braced lists and overload sets are not canonical types
+    if (dest == NULL
+            || is_braced_list_type(orig)
+            || is_unresolved_overloaded_type(orig)
+            || !ics_cache_type_is_stable(orig)
+            || !ics_cache_type_is_stable(dest))
+    {
+        _ics_cache.not_cacheable++;
+        compute_ics_flags_uncached(orig, dest, decl_context, result,
+                no_user_defined_conversions, is_implicit_argument,
+                needs_contextual_conversion, ref_qualifier, locus);
+        return;
+    }
+
+    unsigned int flags = ((unsigned int)ref_qualifier << ICS_CACHE_REF_QUALIFIER_SHIFT)
+        | (no_user_defined_conversions ? ICS_CACHE_NO_USER_DEFINED_CONVERSIONS : 0)
+        | (is_implicit_argument ? ICS_CACHE_IS_IMPLICIT_ARGUMENT : 0)
+        | (needs_contextual_conversion ? ICS_CACHE_NEEDS_CONTEXTUAL_CONVERSION : 0);
+
+    ics_cache_entry_t* entry = ics_cache_lookup(orig, dest, /* decl_context */ NULL, flags);
+    if (entry == NULL
+            && !no_user_defined_conversions)
+        entry = ics_cache_lookup(orig, dest, decl_context, flags);
+    if (entry != NULL)
+    {
+        _ics_cache.hits++;
+        *result = entry->ics;
+        return;
+    }
+    _ics_cache.misses++;
+
+    compute_ics_flags_uncached(orig, dest, decl_context, result,
+            no_user_defined_conversions, is_implicit_argument,
+            needs_contextual_conversion, ref_qualifier, locus);
+
+    // Completing the conversion may have instantiated something
+    if (!ics_cache_type_is_stable(orig)
+            || !ics_cache_type_is_stable(dest))
+        return;
+
+    if (result->kind == ICSK_ELLIPSIS
+            || result->kind == ICSK_STANDARD
+            || no_user_defined_conversions)
+    {
+        // These never looked up any constructor or conversion function
+        ics_cache_add(orig, dest, /* decl_context */ NULL, flags, result);
+    }
+    else
+    {
+        // Lookup of constructors and conversion functions may depend on
+        // where the conversion happens
+        ics_cache_add(orig, dest, decl_context, flags, result);
+    }
+}
+
 static scope_entry_t* solve_overload_(candidate_t* candidate_set,
         const decl_context_t* decl_context,
         enum initialization_kind initialization_kind,
@@ -1211,7 +1444,7 @@ static char solve_initialization_of_direct_reference_type_ics(
                     print_declarator(dest),
                     print_declarator(orig),
                     get_qualified_symbol_name(overload_resolution, overload_resolution->decl_context),
-                    locus_to_str(overload_resolution->locus));
+                    locus_to_str(locus_from_id(overload_resolution->locus)));
         }
         else
         {
@@ -1514,7 +1747,7 @@ static char solve_initialization_of_nonclass_nonreference_type_ics(
                             print_declarator(dest),
                             print_declarator(orig),
                             get_qualified_symbol_name(overload_resolution, overload_resolution->decl_context),
-                            locus_to_str(overload_resolution->locus));
+                            locus_to_str(locus_from_id(overload_resolution->locus)));
                 }
                 else
                 {
@@ -2750,9 +2983,9 @@ static char is_better_function_despite_equal_ics(
             fprintf(stderr, "OVERLOAD: Found that [%s, %s] IS better than [%s, %s] because "
                     "the first is not a template-specialization and the second is\n",
                     print_decl_type_str(f->type_information, f->decl_context, f->symbol_name),
-                    locus_to_str(f->locus),
+                    locus_to_str(locus_from_id(f->locus)),
                     print_decl_type_str(g->type_information, g->decl_context, g->symbol_name),
-                    locus_to_str(g->locus));
+                    locus_to_str(locus_from_id(g->locus)));
         }
         return 1;
     }
@@ -2769,9 +3002,9 @@ static char is_better_function_despite_equal_ics(
             fprintf(stderr, "OVERLOAD: Found that [%s, %s] and [%s, %s] are template functions "
                     "so we have to check which one is more specialized\n",
                     print_decl_type_str(f->type_information, f->decl_context, f->symbol_name),
-                    locus_to_str(f->locus),
+                    locus_to_str(locus_from_id(f->locus)),
                     print_decl_type_str(g->type_information, g->decl_context, g->symbol_name),
-                    locus_to_str(g->locus));
+                    locus_to_str(locus_from_id(g->locus)));
         }
 
         if (is_more_specialized_template_function_in_overload(
@@ -2793,9 +3026,9 @@ static char is_better_function_despite_equal_ics(
                 fprintf(stderr, "OVERLOAD: Found that template-function [%s, %s] is more "
                         "specialized than template-function [%s, %s]\n",
                         print_decl_type_str(f->type_information, f->decl_context, f->symbol_name),
-                        locus_to_str(f->locus),
+                        locus_to_str(locus_from_id(f->locus)),
                         print_decl_type_str(g->type_information, g->decl_context, g->symbol_name),
-                        locus_to_str(g->locus));
+                        locus_to_str(locus_from_id(g->locus)));
             }
             return 1;
         }
@@ -2832,9 +3065,9 @@ char is_better_function(
     {
         fprintf(stderr, "OVERLOAD: Checking if [%s, %s] is better than [%s, %s]\n",
                 print_decl_type_str(f->type_information, f->decl_context, f->symbol_name),
-                locus_to_str(f->locus),
+                locus_to_str(locus_from_id(f->locus)),
                 print_decl_type_str(g->type_information, g->decl_context, g->symbol_name),
-                locus_to_str(g->locus));
+                locus_to_str(locus_from_id(g->locus)));
     }
 
     int first_type = 0;
@@ -2896,9 +3129,9 @@ char is_better_function(
                         " than [%s, %s] because some argument in the first"
                         " function has a better ICS than the respective one in the second\n",
                         print_decl_type_str(f->type_information, f->decl_context, f->symbol_name),
-                        locus_to_str(f->locus),
+                        locus_to_str(locus_from_id(f->locus)),
                         print_decl_type_str(g->type_information, g->decl_context, g->symbol_name),
-                        locus_to_str(g->locus));
+                        locus_to_str(locus_from_id(g->locus)));
             }
             return 1;
         }
@@ -2936,9 +3169,9 @@ char is_better_function(
                             "the target of the standard conversion of ICS1 is better than ICS2, "
                             " so [%s, %s] is better than [%s, %s]\n",
                             print_decl_type_str(f->type_information, f->decl_context, f->symbol_name),
-                            locus_to_str(f->locus),
+                            locus_to_str(locus_from_id(f->locus)),
                             print_decl_type_str(g->type_information, g->decl_context, g->symbol_name),
-                            locus_to_str(g->locus));
+                            locus_to_str(locus_from_id(g->locus)));
                 }
                 return 1;
             }
@@ -2968,9 +3201,9 @@ char is_better_function(
                             "function reference, the target of the standard conversion of ICS1 is better than ICS2, "
                             " so [%s, %s] is better than [%s, %s]\n",
                             print_decl_type_str(f->type_information, f->decl_context, f->symbol_name),
-                            locus_to_str(f->locus),
+                            locus_to_str(locus_from_id(f->locus)),
                             print_decl_type_str(g->type_information, g->decl_context, g->symbol_name),
-                            locus_to_str(g->locus));
+                            locus_to_str(locus_from_id(g->locus)));
                 }
                 return 1;
             }
@@ -2990,9 +3223,9 @@ char is_better_function(
     {
         fprintf(stderr, "OVERLOAD: Found that [%s, %s] is NOT better than [%s, %s]\n",
                 print_decl_type_str(f->type_information, f->decl_context, f->symbol_name),
-                locus_to_str(f->locus),
+                locus_to_str(locus_from_id(f->locus)),
                 print_decl_type_str(g->type_information, g->decl_context, g->symbol_name),
-                locus_to_str(g->locus));
+                locus_to_str(locus_from_id(g->locus)));
     }
     return 0;
 }
@@ -3022,7 +3255,7 @@ static scope_entry_t* solve_overload_(candidate_t* candidate_set,
                 fprintf(stderr, "OVERLOAD: Candidate %d: %s, %s [%s] %s\n",
                         i,
                         entry->symbol_name,
-                        locus_to_str(entry->locus),
+                        locus_to_str(locus_from_id(entry->locus)),
                         print_declarator(entry->type_information),
                         (symbol_entity_specs_get_is_builtin(entry) ? "<builtin function>" : ""));
 
@@ -3138,7 +3371,7 @@ static scope_entry_t* solve_overload_(candidate_t* candidate_set,
             {
                 scope_entry_t* entry = entry_advance_aliases(it->candidate->entry);
                 fprintf(stderr, "OVERLOAD:    %s: %s %s\n",
-                        locus_to_str(entry->locus),
+                        locus_to_str(locus_from_id(entry->locus)),
                         print_decl_type_str(
                             entry->type_information,
                             entry->decl_context,
@@ -3843,7 +4076,7 @@ static char solve_initialization_of_class_type_(
             fprintf(stderr, "OVERLOAD: Solving initialization of class type '%s' succeeded using constructor '%s' at '%s'\n",
                     print_declarator(class_type),
                     get_qualified_symbol_name(*constructor, (*constructor)->decl_context),
-                    locus_to_str((*constructor)->locus));
+                    locus_to_str(locus_from_id((*constructor)->locus)));
         }
         else
         {
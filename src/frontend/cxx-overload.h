@@ -82,6 +82,10 @@ LIBMCXX_EXTERN char solve_list_initialization_of_class_type(
         scope_entry_t** constructor,
         scope_entry_list_t** candidates);
 
+// Per translation unit cache of implicit conversion sequences
+LIBMCXX_EXTERN void overload_ics_cache_reset(void);
+LIBMCXX_EXTERN void overload_ics_cache_stats(void);
+
 MCXX_END_DECLS
 
 #endif // CXX_OVERLOAD_H
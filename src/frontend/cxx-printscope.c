@@ -185,7 +185,7 @@ static void print_scope_entry(const char* key, scope_entry_t* entry, int global_
 
     fprintf(stderr, "\n");
 
-    PRINT_INDENTED_LINE(stderr, global_indent+1, "Declared in %s\n", locus_to_str(entry->locus));
+    PRINT_INDENTED_LINE(stderr, global_indent+1, "Declared in %s\n", locus_to_str(locus_from_id(entry->locus)));
 
     if (entry->kind == SK_UNDEFINED)
     {
@@ -471,7 +471,7 @@ static void print_scope_entry(const char* key, scope_entry_t* entry, int global_
             if (related_entry != NULL)
             {
                 PRINT_INDENTED_LINE(stderr, global_indent+1, "[%d] \"%s\" at %s\n",
-                        i, related_entry->symbol_name, locus_to_str(related_entry->locus));
+                        i, related_entry->symbol_name, locus_to_str(locus_from_id(related_entry->locus)));
             }
             else
             {
@@ -334,6 +334,9 @@ struct scope_entry_tag
     // routines would create an infinite recursion.
     bool do_not_print:1;
 
+    // Locus where the symbol was registered
+    locus_id_t locus;
+
     // Decl context when the symbol was declared it contains the scope where
     // the symbol was registered
     const decl_context_t* decl_context;
@@ -355,9 +358,6 @@ struct scope_entry_tag
     //  - enumerator values
     nodecl_t value;
 
-    // Locus where the symbol was registered
-    const locus_t* locus;
-
     // If you use this field you will be fired.
     // This is only for functions in cxx-entity-specifiers-ops.h
     entity_specifiers_t _entity_specs;
@@ -399,6 +399,12 @@ struct scope_tag
     // they contain the namespace symbol, the class symbol
     // and the function symbol
     scope_entry_t* related_entry;
+
+    // Generation of the last insertion or removal in dhash
+    unsigned int last_modified;
+
+    // Unqualified lookups starting in this scope, created on demand
+    dhash_ptr_t* lookup_cache;
 };
 
 typedef const char* (*print_symbol_callback_t)(scope_entry_t*, const decl_context_t*, void*);
@@ -49,6 +49,7 @@
 #include "cxx-entrylist.h"
 #include "cxx-diagnostic.h"
 #include "dhash_ptr.h"
+#include "cxx-gccbuiltins.h"
 
 
 // Lookup of a simple name within a given declaration context
@@ -196,21 +197,51 @@ static scope_t* new_class_scope(scope_t* enclosing_scope, scope_entry_t* class_e
 //         return 0;
 // }
 
-// Any new scope should be created using this one
-scope_t* _new_scope(void)
+// Incremented every time a scope is modified
+static unsigned int _scope_generation = 0;
+
+static void lookup_memo_name_modified(const char* name);
+
+static void scope_modified(scope_t* sc, const char* name)
+{
+    _scope_generation++;
+    sc->last_modified = _scope_generation;
+
+    lookup_memo_name_modified(name);
+}
+
+// Capacity hints for the table of names of each kind of scope. Including
+// the usual C and C++ headers already declares a few thousand names in the
+// global namespace while most blocks only declare a handful
+enum
+{
+    GLOBAL_SCOPE_EXPECTED_NAMES = 2048,
+    NAMESPACE_SCOPE_EXPECTED_NAMES = 64,
+    CLASS_SCOPE_EXPECTED_NAMES = 16,
+    DEFAULT_SCOPE_EXPECTED_NAMES = 5,
+};
+
+static scope_t* new_scope_with_capacity(int expected_num_names)
 {
     scope_t* result = NEW0(scope_t);
 
-    result->dhash = dhash_ptr_new(5);
+    result->dhash = dhash_ptr_new(expected_num_names);
 
     return result;
 }
 
+// Any new scope should be created using this one
+scope_t* _new_scope(void)
+{
+    return new_scope_with_capacity(DEFAULT_SCOPE_EXPECTED_NAMES);
+}
+
 // Creates a new namespace scope and optionally it gives it a
 // related_entry->symbol_name. Global scope has st == NULL and qualification_name == NULL
 static scope_t* new_namespace_scope(scope_t* st, scope_entry_t* related_entry)
 {
-    scope_t* result = _new_scope();
+    scope_t* result = new_scope_with_capacity(
+            st == NULL ? GLOBAL_SCOPE_EXPECTED_NAMES : NAMESPACE_SCOPE_EXPECTED_NAMES);
 
     result->kind = NAMESPACE_SCOPE;
     result->contained_in = st;
@@ -279,7 +310,7 @@ static scope_t* new_function_scope(void)
 // Creates a new class scope and optionally it is given a qualification name
 static scope_t* new_class_scope(scope_t* enclosing_scope, scope_entry_t* class_entry)
 {
-    scope_t* result = _new_scope();
+    scope_t* result = new_scope_with_capacity(CLASS_SCOPE_EXPECTED_NAMES);
 
     result->kind = CLASS_SCOPE;
     result->contained_in = enclosing_scope;
@@ -451,6 +482,7 @@ void insert_alias(scope_t* sc, scope_entry_t* entry, const char* name)
     }
 
     dhash_ptr_insert(sc->dhash, symbol_name, result_set);
+    scope_modified(sc, symbol_name);
 }
 
 static const char* scope_names[] =
@@ -485,6 +517,23 @@ char same_scope(scope_t* stA, scope_t* stB)
     return (stA->dhash == stB->dhash);
 }
 
+// Some builtins are only signed in the global scope the first time their
+// name is looked up
+static scope_entry_list_t* query_scope_dhash(scope_t* sc, const char* name)
+{
+    scope_entry_list_t *result = (scope_entry_list_t*)dhash_ptr_query(sc->dhash, name);
+
+    if (result == NULL
+            && sc->kind == NAMESPACE_SCOPE
+            && sc->contained_in == NULL
+            && gcc_sign_in_lazy_builtins(sc, name))
+    {
+        result = (scope_entry_list_t*)dhash_ptr_query(sc->dhash, name);
+    }
+
+    return result;
+}
+
 static scope_entry_list_t* query_name_in_scope(scope_t* sc, const char* name)
 {
     DEBUG_CODE()
@@ -506,7 +555,7 @@ static scope_entry_list_t* query_name_in_scope(scope_t* sc, const char* name)
         }
     }
 
-    scope_entry_list_t *result = (scope_entry_list_t*)dhash_ptr_query(sc->dhash, name);
+    scope_entry_list_t *result = query_scope_dhash(sc, name);
 
     // ERROR_CONDITION(name != uniquestr(name), "Invalid name", 0);
 
@@ -554,12 +603,14 @@ void insert_entry(scope_t* sc, scope_entry_t* entry)
         {
             result_set = entry_list_prepend(result_set, entry);
             dhash_ptr_insert(sc->dhash, entry->symbol_name, result_set);
+            scope_modified(sc, entry->symbol_name);
         }
     }
     else
     {
         result_set = entry_list_new(entry);
         dhash_ptr_insert(sc->dhash, entry->symbol_name, result_set);
+        scope_modified(sc, entry->symbol_name);
     }
 }
 
@@ -579,6 +630,7 @@ void remove_entry(scope_t* sc, scope_entry_t* entry)
     {
         dhash_ptr_remove(sc->dhash, entry->symbol_name);
     }
+    scope_modified(sc, entry->symbol_name);
 }
 
 scope_entry_list_t* filter_symbol_kind_set(scope_entry_list_t* entry_list, int num_kinds, enum cxx_symbol_kind* symbol_kind_set)
@@ -965,7 +1017,7 @@ char compute_type_of_dependent_conversion_type_id(
         ast_set_child(type_specifier_seq, 1, nodecl_get_ast(nodecl_id_expression));
     }
 
-    diagnostic_context_push_buffered();
+    diagnostic_context_push_counting();
     type_t* t = compute_type_for_type_id_tree(type_id, decl_context,
             /* out_simple_type */ NULL, /* out_gather_info */ NULL);
     diagnostic_context_pop_and_discard();
@@ -1717,7 +1769,7 @@ static void error_ambiguity(scope_entry_list_t* entry_list, const locus_t* locus
 
         const char *single_candidate;
         uniquestr_sprintf(&single_candidate, "%s: info:    %s\n", 
-                locus_to_str(entry->locus),
+                locus_to_str(locus_from_id(entry->locus)),
                 get_qualified_symbol_name(entry, entry->decl_context));
 
         candidates = strappend(candidates, single_candidate);
@@ -2077,6 +2129,196 @@ static void transitive_add_using_namespaces(decl_flags_t decl_flags,
     }
 }
 
+// Memos of unqualified lookups, kept in the innermost scope of the lookup
+// for every name and set of flags. Only lookups that did not walk class
+// scopes nor scopes with using directives, and whose flags did not discard
+// any symbol, are memoized. Inserting or removing the name anywhere
+// invalidates its memos
+typedef
+struct lookup_memo_name_tag
+{
+    unsigned int generation;
+} lookup_memo_name_t;
+
+typedef struct lookup_memo_tag lookup_memo_t;
+struct lookup_memo_tag
+{
+    decl_flags_t decl_flags;
+
+    lookup_memo_name_t* name;
+    unsigned int cached_at;
+
+    // Scopes walked, from the innermost one. If the name was not found the
+    // last one is the outermost scope
+    int num_scopes;
+    scope_t** scopes;
+
+    // Shared with every lookup that uses this memo
+    scope_entry_list_t* result;
+
+    // Memo of the same name and scope with other flags
+    lookup_memo_t* next;
+};
+
+enum
+{
+    // Lookups that walk more scopes are not memoized
+    LOOKUP_MEMO_MAX_SCOPES = 32,
+};
+
+// Names that have memos
+static dhash_ptr_t* _lookup_memo_names = NULL;
+
+// Scopes that have memos
+static int _num_lookup_memo_scopes = 0;
+static scope_t** _lookup_memo_scopes = NULL;
+
+static int _lookup_memo_hits = 0;
+static int _lookup_memo_misses = 0;
+
+static void lookup_memo_name_modified(const char* name)
+{
+    if (_lookup_memo_names == NULL)
+        return;
+
+    lookup_memo_name_t* memo_name = (lookup_memo_name_t*)dhash_ptr_query(_lookup_memo_names, name);
+    if (memo_name != NULL)
+        memo_name->generation++;
+}
+
+static char lookup_memo_is_valid(lookup_memo_t* memo, scope_t* sc)
+{
+    if (memo->name->generation != memo->cached_at)
+        return 0;
+
+    int i;
+    for (i = 0; i < memo->num_scopes; i++)
+    {
+        // Scopes may be reparented or get using directives after the memo
+        if (sc != memo->scopes[i]
+                || sc->num_used_namespaces != 0)
+            return 0;
+        sc = sc->contained_in;
+    }
+
+    // Names not found were looked up up to the outermost scope
+    return memo->result != NULL
+        || sc == NULL;
+}
+
+// Returns the memo of the lookup, valid or not, or NULL if there is none
+static lookup_memo_t* lookup_memo_get(scope_t* sc, const char* name, decl_flags_t decl_flags)
+{
+    if (sc->lookup_cache == NULL)
+        return NULL;
+
+    lookup_memo_t* memo = (lookup_memo_t*)dhash_ptr_query(sc->lookup_cache, name);
+    while (memo != NULL
+            && memo->decl_flags != decl_flags)
+    {
+        memo = memo->next;
+    }
+
+    return memo;
+}
+
+static void lookup_memo_set(scope_t* sc, const char* name, decl_flags_t decl_flags,
+        int num_scopes, scope_t** scopes,
+        scope_entry_list_t* result)
+{
+    lookup_memo_t* memo = lookup_memo_get(sc, name, decl_flags);
+    if (memo == NULL)
+    {
+        if (sc->lookup_cache == NULL)
+        {
+            sc->lookup_cache = dhash_ptr_new(5);
+            P_LIST_ADD(_lookup_memo_scopes, _num_lookup_memo_scopes, sc);
+        }
+
+        if (_lookup_memo_names == NULL)
+            _lookup_memo_names = dhash_ptr_new(256);
+
+        lookup_memo_name_t* memo_name = (lookup_memo_name_t*)dhash_ptr_query(_lookup_memo_names, name);
+        if (memo_name == NULL)
+        {
+            memo_name = NEW0(lookup_memo_name_t);
+            dhash_ptr_insert(_lookup_memo_names, name, memo_name);
+        }
+
+        memo = NEW0(lookup_memo_t);
+        memo->decl_flags = decl_flags;
+        memo->name = memo_name;
+        memo->next = (lookup_memo_t*)dhash_ptr_query(sc->lookup_cache, name);
+        dhash_ptr_insert(sc->lookup_cache, name, memo);
+    }
+    else
+    {
+        DELETE(memo->scopes);
+        entry_list_free(memo->result);
+    }
+
+    memo->cached_at = memo->name->generation;
+    memo->num_scopes = num_scopes;
+    memo->scopes = NEW_VEC(scope_t*, num_scopes);
+    memcpy(memo->scopes, scopes, num_scopes * sizeof(*scopes));
+    memo->result = entry_list_copy(result);
+}
+
+static void lookup_memo_free_scope(const char* name UNUSED_PARAMETER,
+        void* info,
+        void* walk_info UNUSED_PARAMETER)
+{
+    lookup_memo_t* memo = (lookup_memo_t*)info;
+    while (memo != NULL)
+    {
+        lookup_memo_t* next = memo->next;
+        DELETE(memo->scopes);
+        entry_list_free(memo->result);
+        DELETE(memo);
+        memo = next;
+    }
+}
+
+static void lookup_memo_free_name(const char* name UNUSED_PARAMETER,
+        void* info,
+        void* walk_info UNUSED_PARAMETER)
+{
+    DELETE(info);
+}
+
+void scope_lookup_memo_reset(void)
+{
+    int i;
+    for (i = 0; i < _num_lookup_memo_scopes; i++)
+    {
+        scope_t* sc = _lookup_memo_scopes[i];
+        dhash_ptr_walk(sc->lookup_cache, lookup_memo_free_scope, NULL);
+        dhash_ptr_destroy(sc->lookup_cache);
+        sc->lookup_cache = NULL;
+    }
+    DELETE(_lookup_memo_scopes);
+    _lookup_memo_scopes = NULL;
+    _num_lookup_memo_scopes = 0;
+
+    if (_lookup_memo_names != NULL)
+    {
+        dhash_ptr_walk(_lookup_memo_names, lookup_memo_free_name, NULL);
+        dhash_ptr_destroy(_lookup_memo_names);
+        _lookup_memo_names = NULL;
+    }
+}
+
+unsigned int scope_get_generation(void)
+{
+    return _scope_generation;
+}
+
+void scope_lookup_memo_stats(void)
+{
+    fprintf(stderr, "Unqualified lookups that used a memo: %d\n", _lookup_memo_hits);
+    fprintf(stderr, "Unqualified lookups that walked the scopes: %d\n", _lookup_memo_misses);
+}
+
 static scope_entry_list_t* name_lookup(const decl_context_t* decl_context,
         const char* name,
         field_path_t* field_path,
@@ -2125,9 +2367,43 @@ static scope_entry_list_t* name_lookup(const decl_context_t* decl_context,
 
     scope_t* current_scope = decl_context->current_scope;
 
+    // Lookups restricted to the current scope are not memoized
+    char use_memo = current_scope != NULL
+        && !BITMAP_TEST(decl_flags, DF_ONLY_CURRENT_SCOPE);
+    if (use_memo)
+    {
+        lookup_memo_t* memo = lookup_memo_get(current_scope, name, decl_flags);
+        if (memo != NULL
+                && lookup_memo_is_valid(memo, current_scope))
+        {
+            _lookup_memo_hits++;
+            return entry_list_copy(memo->result);
+        }
+        _lookup_memo_misses++;
+    }
+
+    scope_t* innermost_scope = current_scope;
+    int num_walked_scopes = 0;
+    scope_t* walked_scopes[LOOKUP_MEMO_MAX_SCOPES];
+
     while (result == NULL
             && current_scope != NULL)
     {
+        if (use_memo)
+        {
+            if (current_scope->kind == CLASS_SCOPE
+                    || current_scope->num_used_namespaces != 0
+                    || num_walked_scopes == LOOKUP_MEMO_MAX_SCOPES)
+            {
+                use_memo = 0;
+            }
+            else
+            {
+                walked_scopes[num_walked_scopes] = current_scope;
+                num_walked_scopes++;
+            }
+        }
+
         transitive_add_using_namespaces(decl_flags, 
                 current_scope, 
                 current_scope,
@@ -2164,6 +2440,8 @@ static scope_entry_list_t* name_lookup(const decl_context_t* decl_context,
             result = query_name_in_scope(current_scope, name);
         }
 
+        // The filters below may discard what was found here
+        int num_found_in_scope = entry_list_size(result);
 
         if (BITMAP_TEST(decl_flags, DF_IGNORE_FRIEND_DECL))
         {
@@ -2282,11 +2560,23 @@ static scope_entry_list_t* name_lookup(const decl_context_t* decl_context,
             return result;
         }
 
+        // Whether the discarded symbols are discarded again may change
+        // without inserting nor removing them
+        if (entry_list_size(result) != num_found_in_scope)
+            use_memo = 0;
+
         current_scope = current_scope->contained_in;
     }
 
     DELETE(associated_namespaces);
 
+    if (use_memo)
+    {
+        lookup_memo_set(innermost_scope, name, decl_flags,
+                num_walked_scopes, walked_scopes,
+                result);
+    }
+
     return result;
 }
 
@@ -6491,7 +6781,7 @@ static scope_entry_list_t* query_nodecl_simple_name(
                 new_sym->kind = SK_DEPENDENT_ENTITY;
                 new_sym->symbol_name = nodecl_get_text(nodecl_name_get_last_part(nodecl_name));
                 new_sym->decl_context = decl_context;
-                new_sym->locus = locus;
+                new_sym->locus = locus_get_id(locus);
                 new_sym->type_information = build_dependent_typename_for_entry(
                         named_type_get_symbol(symbol_entity_specs_get_class_type(head)),
                         nodecl_name,
@@ -6613,7 +6903,7 @@ static scope_entry_list_t* query_nodecl_simple_name_in_class(
         scope_entry_t* new_sym = NEW0(scope_entry_t);
         new_sym->kind = SK_DEPENDENT_ENTITY;
         new_sym->decl_context = decl_context;
-        new_sym->locus = locus;
+        new_sym->locus = locus_get_id(locus);
         new_sym->symbol_name = nodecl_get_text(nodecl_name_get_last_part(nodecl_name));
         new_sym->type_information = build_dependent_typename_for_entry(
                 decl_context->current_scope->related_entry,
@@ -6740,7 +7030,7 @@ scope_entry_list_t* query_nodecl_template_id(
 
             scope_entry_t* new_sym = NEW0(scope_entry_t);
             new_sym->kind = SK_DEPENDENT_ENTITY;
-            new_sym->locus = nodecl_get_locus(nodecl_name);
+            new_sym->locus = locus_get_id(nodecl_get_locus(nodecl_name));
             new_sym->symbol_name = dependent_entity->symbol_name;
             new_sym->decl_context = decl_context;
             new_sym->type_information = build_dependent_typename_for_entry(
@@ -6882,7 +7172,7 @@ scope_entry_list_t* query_nodecl_template_id(
 
             scope_entry_t* new_sym = NEW0(scope_entry_t);
             new_sym->kind = SK_DEPENDENT_ENTITY;
-            new_sym->locus = nodecl_get_locus(nodecl_name);
+            new_sym->locus = locus_get_id(nodecl_get_locus(nodecl_name));
             new_sym->symbol_name = dependent_entity->symbol_name;
             new_sym->decl_context = decl_context;
             new_sym->type_information = build_dependent_typename_for_entry(
@@ -7006,12 +7296,12 @@ static scope_entry_list_t* query_nodecl_conversion_name(
             ast_set_child(type_specifier_seq, 1, nodecl_get_ast(nodecl_id_expression));
         }
 
-        diagnostic_context_push_buffered();
+        diagnostic_context_push_counting();
         type_t* type_looked_up_in_class = compute_type_for_type_id_tree(type_id, class_context,
                 /* out_simple_type */ NULL, /* out_gather_info */ NULL);
         diagnostic_context_pop_and_discard();
 
-        diagnostic_context_push_buffered();
+        diagnostic_context_push_counting();
         type_t* type_looked_up_in_enclosing = compute_type_for_type_id_tree(type_id, top_level_decl_context,
                 /* out_simple_type */ NULL, /* out_gather_info */ NULL
                 );
@@ -8023,7 +8313,7 @@ static scope_entry_list_t* query_nodecl_decltype(const decl_context_t* decl_cont
         // Creating a new artificial symbol that represents the whole decltype-specifier
         scope_entry_t* new_sym = NEW0(scope_entry_t);
         new_sym->kind = SK_DECLTYPE;
-        new_sym->locus = nodecl_get_locus(nodecl_name);
+        new_sym->locus = locus_get_id(nodecl_get_locus(nodecl_name));
         new_sym->symbol_name = ".decltype_auxiliar_symbol";
         new_sym->decl_context = decl_context;
         new_sym->type_information = computed_type;
@@ -8460,7 +8750,7 @@ scope_entry_list_t* query_dependent_entity_in_context(
 
                     scope_entry_t* new_sym = NEW0(scope_entry_t);
                     new_sym->kind = SK_DEPENDENT_ENTITY;
-                    new_sym->locus = locus;
+                    new_sym->locus = locus_get_id(locus);
                     new_sym->symbol_name = new_class_dependent_entry->symbol_name;
                     new_sym->decl_context = decl_context;
                     new_sym->type_information = get_dependent_typename_type_from_parts(
@@ -8474,7 +8764,7 @@ scope_entry_list_t* query_dependent_entity_in_context(
                 {
                     scope_entry_t* new_sym = NEW0(scope_entry_t);
                     new_sym->kind = SK_DEPENDENT_ENTITY;
-                    new_sym->locus = locus;
+                    new_sym->locus = locus_get_id(locus);
                     new_sym->symbol_name = dependent_entity->symbol_name;
                     new_sym->decl_context = decl_context;
                     new_sym->type_information = get_dependent_typename_type_from_parts(
@@ -227,6 +227,15 @@ LIBMCXX_EXTERN void scope_for_each_entity(scope_t* sc, void *data, void (fun)(sc
 // Internal use only
 LIBMCXX_EXTERN scope_t* _new_scope(void);
 
+// Prints statistics of the unqualified lookup memos
+LIBMCXX_EXTERN void scope_lookup_memo_stats(void);
+
+// Frees the unqualified lookup memos of the current translation unit
+LIBMCXX_EXTERN void scope_lookup_memo_reset(void);
+
+// Changes every time a symbol is inserted in or removed from any scope
+LIBMCXX_EXTERN unsigned int scope_get_generation(void);
+
 // Return a descriptive name of the symbol kind, used during diagnostics
 const char* symbol_kind_descriptive_name(enum cxx_symbol_kind symbol_kind);
 
@@ -80,7 +80,7 @@ type_t* solve_class_template(type_t* template_type,
         {
             fprintf(stderr, "SOLVETEMPLATE: Checking with specialization defined in '%s' (%s)\n",
                     print_declarator(current_specialized_type),
-                    locus_to_str(current_specialized_class->locus));
+                    locus_to_str(locus_from_id(current_specialized_class->locus)));
         }
 
         // We do not want aliases for instantiation purposes either
@@ -91,7 +91,7 @@ type_t* solve_class_template(type_t* template_type,
                 fprintf(stderr, "SOLVETEMPLATE: Discarding '%s' (%s) since it is actually "
                         "an alias to another specialized type\n",
                         print_declarator(current_specialized_type),
-                        locus_to_str(current_specialized_class->locus));
+                        locus_to_str(locus_from_id(current_specialized_class->locus)));
             }
             continue;
         }
@@ -103,7 +103,7 @@ type_t* solve_class_template(type_t* template_type,
             {
                 fprintf(stderr, "SOLVETEMPLATE: Discarding '%s' (%s) since it has been created by the typesystem\n",
                         print_declarator(current_specialized_type),
-                        locus_to_str(current_specialized_class->locus));
+                        locus_to_str(locus_from_id(current_specialized_class->locus)));
             }
             continue;
         }
@@ -166,7 +166,7 @@ type_t* solve_class_template(type_t* template_type,
                     entry_list_iterator_next(it))
             {
                 scope_entry_t* entry = entry_list_iterator_current(it);
-                info_printf_at(entry->locus, "%s\n",
+                info_printf_at(locus_from_id(entry->locus), "%s\n",
                         print_type_str(get_user_defined_type(entry), entry->decl_context));
             }
             entry_list_iterator_free(it);
@@ -229,7 +229,7 @@ static type_t* determine_most_specialized_template_class(
             scope_entry_t* current = named_type_get_symbol(matching_specializations[j]);
             fprintf(stderr, "SOLVETEMPLATE:     Matching specialization: [%d] '%s'\n",
                     j,
-                    locus_to_str(current->locus));
+                    locus_to_str(locus_from_id(current->locus)));
         }
         fprintf(stderr, "SOLVETEMPLATE: No more specializations matched\n");
     }
@@ -243,9 +243,9 @@ static type_t* determine_most_specialized_template_class(
             scope_entry_t* current = named_type_get_symbol(matching_specializations[i]);
             fprintf(stderr, "SOLVETEMPLATE: Checking current most specialized template [%d] '%s' against [%d] '%s'\n",
                     current_i,
-                    locus_to_str(minimum->locus),
+                    locus_to_str(locus_from_id(minimum->locus)),
                     i,
-                    locus_to_str(current->locus));
+                    locus_to_str(locus_from_id(current->locus)));
         }
         if (is_more_specialized_template_class(
                     matching_specializations[i],
@@ -259,8 +259,8 @@ static type_t* determine_most_specialized_template_class(
                 scope_entry_t* minimum = named_type_get_symbol(current_most_specialized);
                 scope_entry_t* current = named_type_get_symbol(matching_specializations[i]);
                 fprintf(stderr, "SOLVETEMPLATE: Template specialization '%s' is more specialized than '%s'\n",
-                        locus_to_str(current->locus),
-                        locus_to_str(minimum->locus));
+                        locus_to_str(locus_from_id(current->locus)),
+                        locus_to_str(locus_from_id(minimum->locus)));
             }
             current_i = i;
             current_most_specialized = matching_specializations[i];
@@ -272,7 +272,7 @@ static type_t* determine_most_specialized_template_class(
         scope_entry_t* minimum = named_type_get_symbol(current_most_specialized);
         fprintf(stderr, "SOLVETEMPLATE: Checking that [%d] %s is actually the most specialized template class\n", 
                 current_i,
-                locus_to_str(minimum->locus));
+                locus_to_str(locus_from_id(minimum->locus)));
     }
 
     // Now check it is actually the minimum
@@ -293,8 +293,8 @@ static type_t* determine_most_specialized_template_class(
                 scope_entry_t* current = named_type_get_symbol(matching_specializations[i]);
                 fprintf(stderr, "SOLVETEMPLATE: There is not a most specialized template since '%s' is not less "
                         "specialized as '%s'\n", 
-                        locus_to_str(current->locus),
-                        locus_to_str(minimum->locus));
+                        locus_to_str(locus_from_id(current->locus)),
+                        locus_to_str(locus_from_id(minimum->locus)));
             }
 
             // Return the ambiguity as a list
@@ -310,7 +310,7 @@ static type_t* determine_most_specialized_template_class(
     {
         scope_entry_t* minimum = named_type_get_symbol(current_most_specialized);
         fprintf(stderr, "SOLVETEMPLATE: Most specialized template is [%d] '%s'\n",
-                current_i, locus_to_str(minimum->locus));
+                current_i, locus_to_str(locus_from_id(minimum->locus)));
     }
 
     return current_most_specialized;
@@ -332,7 +332,7 @@ type_t* determine_most_specialized_template_function(
     {
         fprintf(stderr, "SOLVETEMPLATE: Starting with '%s' at '%s' as the most specialized template-function\n",
                     named_type_get_symbol(most_specialized)->symbol_name,
-                    locus_to_str(named_type_get_symbol(most_specialized)->locus));
+                    locus_to_str(locus_from_id(named_type_get_symbol(most_specialized)->locus)));
     }
 
     int i;
@@ -342,9 +342,9 @@ type_t* determine_most_specialized_template_function(
         {
             fprintf(stderr, "SOLVETEMPLATE: Comparing '%s' at '%s' against '%s' at '%s'\n",
                     named_type_get_symbol(most_specialized)->symbol_name,
-                    locus_to_str(named_type_get_symbol(most_specialized)->locus),
+                    locus_to_str(locus_from_id(named_type_get_symbol(most_specialized)->locus)),
                     named_type_get_symbol(feasible_templates[i])->symbol_name,
-                    locus_to_str(named_type_get_symbol(feasible_templates[i])->locus));
+                    locus_to_str(locus_from_id(named_type_get_symbol(feasible_templates[i])->locus)));
         }
 
         char is_conversion = 
@@ -377,9 +377,9 @@ type_t* determine_most_specialized_template_function(
                 fprintf(stderr, "SOLVETEMPLATE: Found that '%s' at '%s' is "
                         "more specialized than '%s' at '%s'\n",
                         named_type_get_symbol(feasible_templates[i])->symbol_name,
-                        locus_to_str(named_type_get_symbol(feasible_templates[i])->locus),
+                        locus_to_str(locus_from_id(named_type_get_symbol(feasible_templates[i])->locus)),
                         named_type_get_symbol(most_specialized)->symbol_name,
-                        locus_to_str(named_type_get_symbol(most_specialized)->locus));
+                        locus_to_str(locus_from_id(named_type_get_symbol(most_specialized)->locus)));
             }
 
             most_specialized = feasible_templates[i];
@@ -397,9 +397,9 @@ type_t* determine_most_specialized_template_function(
             fprintf(stderr, "SOLVETEMPLATE: Checking that '%s' at '%s' is "
                     "more specialized than '%s' at '%s'\n",
                     named_type_get_symbol(most_specialized)->symbol_name,
-                    locus_to_str(named_type_get_symbol(most_specialized)->locus),
+                    locus_to_str(locus_from_id(named_type_get_symbol(most_specialized)->locus)),
                     named_type_get_symbol(feasible_templates[i])->symbol_name,
-                    locus_to_str(named_type_get_symbol(feasible_templates[i])->locus));
+                    locus_to_str(locus_from_id(named_type_get_symbol(feasible_templates[i])->locus)));
         }
 
         char is_conversion =
@@ -432,9 +432,9 @@ type_t* determine_most_specialized_template_function(
                 fprintf(stderr, "SOLVETEMPLATE: Found that '%s' at '%s' is "
                         "not the most specialized. '%s' at '%s' is not less specialized\n",
                         named_type_get_symbol(most_specialized)->symbol_name,
-                        locus_to_str(named_type_get_symbol(most_specialized)->locus),
+                        locus_to_str(locus_from_id(named_type_get_symbol(most_specialized)->locus)),
                         named_type_get_symbol(feasible_templates[i])->symbol_name,
-                        locus_to_str(named_type_get_symbol(feasible_templates[i])->locus));
+                        locus_to_str(locus_from_id(named_type_get_symbol(feasible_templates[i])->locus)));
             }
 
             // Return the ambiguity as a list
@@ -449,7 +449,7 @@ type_t* determine_most_specialized_template_function(
     {
         fprintf(stderr, "SOLVETEMPLATE: Determined '%s' at '%s' as the most specialized template-function\n",
                     named_type_get_symbol(most_specialized)->symbol_name,
-                    locus_to_str(named_type_get_symbol(most_specialized)->locus));
+                    locus_to_str(locus_from_id(named_type_get_symbol(most_specialized)->locus)));
     }
 
     return most_specialized;
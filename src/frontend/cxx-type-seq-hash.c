@@ -0,0 +1,115 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#include "cxx-type-seq-hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "cxx-typeutils.h"
+#include "open_hash.h"
+
+// Hash table of whole sequences of types, each one mapped to a type
+typedef struct type_seq_hash_element_tag
+{
+    int num_types;
+    const type_t** type_seq;
+    const type_t* function_type;
+} type_seq_hash_element_t;
+
+struct type_seq_hash_tag
+{
+    // Of type_seq_hash_element_t
+    open_hash_t elements;
+};
+
+static unsigned int hash_type_seq(const type_t** type_seq, int num_types)
+{
+    uint64_t v = (uint64_t)num_types;
+    int i;
+    for (i = 0; i < num_types; i++)
+    {
+        v = open_hash_combine(v, (uint64_t)(uintptr_t)type_seq[i]);
+    }
+    return (unsigned int)(v ^ (v >> 32));
+}
+
+static char element_matches(const void* e, const void* k)
+{
+    const type_seq_hash_element_t* elem = (const type_seq_hash_element_t*)e;
+    const type_seq_hash_element_t* key = (const type_seq_hash_element_t*)k;
+    return elem->num_types == key->num_types
+        && (key->num_types == 0
+                || memcmp(elem->type_seq, key->type_seq, key->num_types * sizeof(*key->type_seq)) == 0);
+}
+
+type_seq_hash_t* allocate_type_seq_hash(void)
+{
+    type_seq_hash_t* t = NEW0(type_seq_hash_t);
+    open_hash_init(&t->elements, sizeof(type_seq_hash_element_t));
+    return t;
+}
+
+void insert_type_seq_hash(type_seq_hash_t* table, const type_t** type_seq, int num_types, const type_t* funct_type)
+{
+    type_seq_hash_element_t key = {
+        .num_types = num_types,
+        .type_seq = type_seq,
+    };
+    unsigned int hash = hash_type_seq(type_seq, num_types);
+    // The first type inserted wins
+    if (open_hash_query(&table->elements, hash, element_matches, &key) != NULL)
+        return;
+
+    type_seq_hash_element_t new_elem = {
+        .num_types = num_types,
+        .type_seq = NEW_VEC(const type_t*, num_types),
+        .function_type = funct_type,
+    };
+    if (num_types > 0)
+        memcpy(new_elem.type_seq, type_seq, num_types * sizeof(*type_seq));
+
+    open_hash_insert(&table->elements, hash, &new_elem);
+}
+
+const type_t* lookup_type_seq_hash(type_seq_hash_t* table, const type_t** type_seq, int num_types)
+{
+    type_seq_hash_element_t key = {
+        .num_types = num_types,
+        .type_seq = type_seq,
+    };
+    type_seq_hash_element_t* elem = (type_seq_hash_element_t*)open_hash_query(&table->elements,
+            hash_type_seq(type_seq, num_types),
+            element_matches,
+            &key);
+    if (elem == NULL)
+        return NULL;
+
+    return elem->function_type;
+}
@@ -27,20 +27,20 @@
 
 
 
-#ifndef CXX_TYPE_TRIE_H
-#define CXX_TYPE_TRIE_H
+#ifndef CXX_TYPE_SEQ_HASH_H
+#define CXX_TYPE_SEQ_HASH_H
 
 #include "cxx-type-decls.h"
 
 MCXX_BEGIN_DECLS
 
-typedef struct type_trie_tag type_trie_t;
+typedef struct type_seq_hash_tag type_seq_hash_t;
 
-type_trie_t* allocate_type_trie(void);
+type_seq_hash_t* allocate_type_seq_hash(void);
 
-const type_t* lookup_type_trie(type_trie_t* trie, const type_t** type_seq, int num_types);
-void insert_type_trie(type_trie_t* trie, const type_t** type_seq, int num_types, const type_t* funct_type);
+const type_t* lookup_type_seq_hash(type_seq_hash_t* table, const type_t** type_seq, int num_types);
+void insert_type_seq_hash(type_seq_hash_t* table, const type_t** type_seq, int num_types, const type_t* funct_type);
 
 MCXX_END_DECLS
 
-#endif // CXX_TYPE_TRIE_H
+#endif // CXX_TYPE_SEQ_HASH_H
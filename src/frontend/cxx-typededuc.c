@@ -45,6 +45,8 @@
 #include "cxx-exprtype.h"
 #include "cxx-diagnostic.h"
 #include "cxx-buildscope.h"
+#include "dhash_ptr.h"
+#include "open_hash.h"
 
 static void print_deduction_set(deduction_set_t* deduction_set)
 {
@@ -3204,7 +3206,7 @@ static deduction_result_t deduce_template_arguments_function_call_single_argumen
             decl_context_t* updated_context = decl_context_clone(decl_context);
             updated_context->template_parameters = updated_template_parameters;
 
-            diagnostic_context_push_buffered();
+            diagnostic_context_push_counting();
             type_t* deduced_argument = update_type_with_pack_index(
                     parameter,
                     updated_context,
@@ -3554,7 +3556,7 @@ deduction_result_t handle_explicit_template_arguments(
 
                 if (flat_explicit_template_arguments->arguments[current_arg]->kind == TPK_NONTYPE)
                 {
-                    diagnostic_context_push_buffered();
+                    diagnostic_context_push_counting();
                     type_t* template_argument_type =
                         update_type(
                                 template_parameters->parameters[current_param]->entry->type_information,
@@ -3638,7 +3640,7 @@ deduction_result_t handle_explicit_template_arguments(
             if (new_template_argument->kind == TPK_NONTYPE)
             {
                 new_template_argument->type = template_parameters->parameters[current_param]->entry->type_information;
-                diagnostic_context_push_buffered();
+                diagnostic_context_push_counting();
                 new_template_argument->type = update_type(
                         new_template_argument->type,
                         context_for_updating,
@@ -3952,7 +3954,7 @@ deduction_result_t finish_deduced_template_arguments(
             decl_context_t* context_for_updating = decl_context_clone(decl_context);
             context_for_updating->template_parameters = deduced_template_arguments;
             // Update the default argument
-            diagnostic_context_push_buffered();
+            diagnostic_context_push_counting();
             template_parameter_value_t* value = update_template_parameter_value(default_template_argument,
                     context_for_updating,
                     /* instantiation_symbol_map */ NULL,
@@ -4377,7 +4379,7 @@ static deduction_result_t deduce_template_arguments_from_call_function_aux(
 }
 
 // 14.8.2.1 [temp.deduct.call]
-deduction_result_t deduce_template_arguments_from_function_call(
+static deduction_result_t deduce_template_arguments_from_function_call_uncached(
         type_t** call_argument_types,
         int num_arguments,
         type_t* specialized_named_type,
@@ -4428,6 +4430,187 @@ deduction_result_t deduce_template_arguments_from_function_call(
     return deduction_result;
 }
 
+// Results of deduce_template_arguments_from_function_call of every function
+// template, keyed on the argument types. A call is checked several times
+// during ambiguity resolution and overload resolution so the same
+// deductions are repeated
+typedef
+struct deduction_cache_entry_tag
+{
+    int num_arguments;
+    type_t** argument_types;
+    template_parameter_list_t* template_parameters;
+    template_parameter_list_t* type_template_parameters;
+    const decl_context_t* decl_context;
+
+    deduction_result_t result;
+    template_parameter_list_t* deduced_template_arguments;
+    // Failures may become successes once more is declared (e.g. a class
+    // gets completed), so they are only valid for this scope generation
+    unsigned int generation;
+} deduction_cache_entry_t;
+
+// Maps the primary specialization of a function template to its cache, an
+// open_hash_t of deduction_cache_entry_t
+static dhash_ptr_t* _deduction_caches = NULL;
+
+static unsigned int deduction_cache_hash(const deduction_cache_entry_t* key)
+{
+    uint64_t v = (uint64_t)(uintptr_t)key->template_parameters;
+    v = open_hash_combine(v, (uint64_t)(uintptr_t)key->type_template_parameters);
+    v = open_hash_combine(v, (uint64_t)(uintptr_t)key->decl_context);
+    int i;
+    for (i = 0; i < key->num_arguments; i++)
+    {
+        v = open_hash_combine(v, (uint64_t)(uintptr_t)key->argument_types[i]);
+    }
+    return (unsigned int)(v ^ (v >> 32));
+}
+
+static char deduction_cache_entry_matches(const void* e, const void* k)
+{
+    const deduction_cache_entry_t* entry = (const deduction_cache_entry_t*)e;
+    const deduction_cache_entry_t* key = (const deduction_cache_entry_t*)k;
+    return entry->num_arguments == key->num_arguments
+        && entry->template_parameters == key->template_parameters
+        && entry->type_template_parameters == key->type_template_parameters
+        && entry->decl_context == key->decl_context
+        && (key->num_arguments == 0
+                || memcmp(entry->argument_types, key->argument_types,
+                    key->num_arguments * sizeof(*key->argument_types)) == 0);
+}
+
+deduction_result_t deduce_template_arguments_from_function_call(
+        type_t** call_argument_types,
+        int num_arguments,
+        type_t* specialized_named_type,
+        template_parameter_list_t* template_parameters,         // those of the primary
+        template_parameter_list_t* type_template_parameters,    // those of the template-type
+        template_parameter_list_t* raw_explicit_template_arguments, // explicit by the user
+        const decl_context_t* decl_context,
+        const locus_t* locus,
+        // out
+        template_parameter_list_t **out_deduced_template_arguments)
+{
+    // Explicit template arguments are built anew for every call so they
+    // would never be found
+    if (raw_explicit_template_arguments != NULL)
+    {
+        return deduce_template_arguments_from_function_call_uncached(
+                call_argument_types, num_arguments,
+                specialized_named_type,
+                template_parameters, type_template_parameters,
+                raw_explicit_template_arguments,
+                decl_context, locus,
+                out_deduced_template_arguments);
+    }
+
+    if (_deduction_caches == NULL)
+        _deduction_caches = dhash_ptr_new(256);
+
+    open_hash_t* cache =
+        (open_hash_t*)dhash_ptr_query(_deduction_caches, (const char*)specialized_named_type);
+    if (cache == NULL)
+    {
+        cache = NEW(open_hash_t);
+        open_hash_init(cache, sizeof(deduction_cache_entry_t));
+        dhash_ptr_insert(_deduction_caches, (const char*)specialized_named_type, cache);
+    }
+
+    deduction_cache_entry_t key = {
+        .num_arguments = num_arguments,
+        .argument_types = call_argument_types,
+        .template_parameters = template_parameters,
+        .type_template_parameters = type_template_parameters,
+        .decl_context = decl_context,
+    };
+    unsigned int hash = deduction_cache_hash(&key);
+    deduction_cache_entry_t* entry = (deduction_cache_entry_t*)open_hash_query(cache, hash,
+            deduction_cache_entry_matches, &key);
+
+    if (entry != NULL
+            && (entry->result == DEDUCTION_OK
+                || entry->generation == scope_get_generation()))
+    {
+        DEBUG_CODE()
+        {
+            fprintf(stderr, "TYPEDEDUC: Using cached deduction result\n");
+        }
+        if (entry->result == DEDUCTION_OK)
+        {
+            *out_deduced_template_arguments = NULL;
+            if (entry->deduced_template_arguments != NULL)
+                *out_deduced_template_arguments =
+                    duplicate_template_argument_list(entry->deduced_template_arguments);
+        }
+        return entry->result;
+    }
+
+    template_parameter_list_t* deduced_template_arguments = NULL;
+    deduction_result_t result = deduce_template_arguments_from_function_call_uncached(
+            call_argument_types, num_arguments,
+            specialized_named_type,
+            template_parameters, type_template_parameters,
+            /* raw_explicit_template_arguments */ NULL,
+            decl_context, locus,
+            &deduced_template_arguments);
+
+    // The deduction may have added entries and moved the table
+    entry = (deduction_cache_entry_t*)open_hash_query(cache, hash,
+            deduction_cache_entry_matches, &key);
+    if (entry == NULL)
+    {
+        deduction_cache_entry_t new_entry = key;
+        new_entry.argument_types = NEW_VEC(type_t*, num_arguments);
+        if (num_arguments > 0)
+            memcpy(new_entry.argument_types, call_argument_types,
+                    num_arguments * sizeof(*call_argument_types));
+
+        entry = (deduction_cache_entry_t*)open_hash_insert(cache, hash, &new_entry);
+    }
+
+    entry->result = result;
+    entry->generation = scope_get_generation();
+    free_template_parameter_list(entry->deduced_template_arguments);
+    entry->deduced_template_arguments = NULL;
+    if (result == DEDUCTION_OK)
+    {
+        if (deduced_template_arguments != NULL)
+            entry->deduced_template_arguments =
+                duplicate_template_argument_list(deduced_template_arguments);
+        *out_deduced_template_arguments = deduced_template_arguments;
+    }
+
+    return result;
+}
+
+static void free_deduction_cache_entry(void* e, void* walk_info UNUSED_PARAMETER)
+{
+    deduction_cache_entry_t* entry = (deduction_cache_entry_t*)e;
+    DELETE(entry->argument_types);
+    free_template_parameter_list(entry->deduced_template_arguments);
+}
+
+static void free_deduction_cache(const char* key UNUSED_PARAMETER,
+        void* info,
+        void* walk_info UNUSED_PARAMETER)
+{
+    open_hash_t* cache = (open_hash_t*)info;
+    open_hash_walk(cache, free_deduction_cache_entry, NULL);
+    open_hash_destroy(cache);
+    DELETE(cache);
+}
+
+void deduction_cache_reset(void)
+{
+    if (_deduction_caches == NULL)
+        return;
+
+    dhash_ptr_walk(_deduction_caches, free_deduction_cache, NULL);
+    dhash_ptr_destroy(_deduction_caches);
+    _deduction_caches = NULL;
+}
+
 // 14.8.2.2 [temp.deduct.funcaddr]
 deduction_result_t deduce_template_arguments_from_address_of_a_function_template(
         type_t* specified_type, /* A */
@@ -4616,7 +4799,7 @@ deduction_result_t deduce_template_arguments_for_conversion_function(
     decl_context_t* updating_context = decl_context_clone(decl_context);
     updating_context->template_parameters = deduced_template_arguments;
 
-    diagnostic_context_push_buffered();
+    diagnostic_context_push_counting();
     type_t* deduced_required_type = update_type(return_type,
             updating_context,
             locus);
@@ -4722,7 +4905,7 @@ deduction_result_t deduce_template_arguments_from_function_declaration(
     decl_context_t* updating_context = decl_context_clone(decl_context);
     updating_context->template_parameters = deduced_template_arguments;
 
-    diagnostic_context_push_buffered();
+    diagnostic_context_push_counting();
     type_t* deduced_type = update_type(potential_match,
             updating_context,
             locus);
@@ -4760,7 +4943,7 @@ char deduce_arguments_of_auto_initialization(
     fake_template_parameter_symbol->symbol_name = UNIQUESTR_LITERAL("FakeTypeTemplateParameter");
     fake_template_parameter_symbol->kind = SK_TEMPLATE_TYPE_PARAMETER;
     symbol_entity_specs_set_is_template_parameter(fake_template_parameter_symbol, 1);
-    fake_template_parameter_symbol->locus = locus;
+    fake_template_parameter_symbol->locus = locus_get_id(locus);
     symbol_entity_specs_set_template_parameter_nesting(fake_template_parameter_symbol, 1);
     symbol_entity_specs_set_template_parameter_position(fake_template_parameter_symbol, 0);
 
@@ -4830,7 +5013,8 @@ char deduce_arguments_of_auto_initialization(
 
     type_t* primary_specialization = template_type_get_primary_type(fake_template_type);
 
-    return deduce_template_arguments_from_function_call(
+    // The fake template is new every time, do not cache it
+    return deduce_template_arguments_from_function_call_uncached(
             &initializer_type, 1,
             primary_specialization,
             fake_template_parameter_list,
@@ -104,6 +104,9 @@ LIBMCXX_EXTERN deduction_result_t deduce_template_arguments_from_address_of_a_fu
         // out
         template_parameter_list_t **out_deduced_template_arguments);
 
+// Forgets the deductions cached by deduce_template_arguments_from_function_call
+LIBMCXX_EXTERN void deduction_cache_reset(void);
+
 // Used in cxx-typeorder
 deduction_result_t deduction_combine_to_second(
         deduction_set_t* current_deduction,
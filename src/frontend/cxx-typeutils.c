@@ -32,7 +32,7 @@
 #include "cxx-buildscope.h"
 #include "cxx-typeutils.h"
 #include "cxx-typeenviron.h"
-#include "cxx-type-trie.h"
+#include "cxx-type-seq-hash.h"
 #include "cxx-utils.h"
 #include "cxx-cexpr.h"
 #include "cxx-exprtype.h"
@@ -54,6 +54,7 @@
 #include "fortran03-scope.h"
 
 #include "dhash_ptr.h"
+#include "open_hash.h"
 #include "red_black_tree.h"
 
 /*
@@ -315,9 +316,10 @@ struct simple_type_tag {
     //   Unique specialized types
     int num_unique_specialized_types;
     type_t** unique_specialized_types;
-    //   All specialized types
-    int num_all_specialized_types;
-    type_t** all_specialized_types;
+    //   The same hashed by equivalent template arguments
+    struct specialization_set_tag* unique_specialized_set;
+    //   All specialized types hashed by identical template arguments
+    struct specialization_set_tag* all_specialized_set;
 
     // Template dependent types (STK_TEMPLATE_DEPENDENT_TYPE)
     scope_entry_t* dependent_entry;
@@ -1441,6 +1443,13 @@ static char same_template_argument_list(
         template_parameter_list_t* template_parameter_list_1,
         template_parameter_list_t* template_parameter_list_2);
 
+typedef struct specialization_set_tag specialization_set_t;
+static void specialization_set_add(specialization_set_t** set,
+        unsigned int hash,
+        type_t* specialization);
+static unsigned int template_argument_list_identical_hash(
+        template_parameter_list_t* template_parameter_list);
+
 static int compare_dependent_parts(const void *v1, const void *v2)
 {
     nodecl_t n1 = _nodecl_wrap((AST)v1);
@@ -1964,7 +1973,7 @@ template_parameter_list_t* compute_template_parameter_values_of_primary(template
                 }
             case TPK_NONTYPE :
                 {
-                    nodecl_t n = nodecl_make_symbol(param->entry, param->entry->locus);
+                    nodecl_t n = nodecl_make_symbol(param->entry, locus_from_id(param->entry->locus));
                     nodecl_expr_set_is_value_dependent(n, 1);
                     nodecl_set_type(n, param->entry->type_information);
 
@@ -1989,14 +1998,14 @@ template_parameter_list_t* compute_template_parameter_values_of_primary(template
             case TPK_NONTYPE_PACK :
                 {
                     nodecl_t sym_ref =
-                            nodecl_make_symbol(param->entry, param->entry->locus);
+                            nodecl_make_symbol(param->entry, locus_from_id(param->entry->locus));
                     type_t* pack_type = get_pack_type(param->entry->type_information);
                     nodecl_set_type(sym_ref, pack_type);
 
                     nodecl_t n = nodecl_make_cxx_value_pack(
                             sym_ref,
                             param->entry->type_information,
-                            param->entry->locus
+                            locus_from_id(param->entry->locus)
                             );
                     nodecl_expr_set_is_type_dependent(n, is_dependent_type(pack_type));
                     nodecl_expr_set_is_value_dependent(n, 1);
@@ -2037,7 +2046,7 @@ extern inline type_t* get_new_template_alias_type(template_parameter_list_t* tem
     primary_symbol->type_information = primary_type;
     primary_symbol->decl_context = decl_context;
 
-    primary_symbol->locus = locus;
+    primary_symbol->locus = locus_get_id(locus);
     symbol_entity_specs_set_is_user_declared(primary_symbol, 1);
     symbol_entity_specs_set_is_instantiable(primary_symbol, 1);
 
@@ -2069,8 +2078,8 @@ extern inline type_t* get_new_template_alias_type(template_parameter_list_t* tem
 
     type_info->type->primary_specialization = get_user_defined_type(primary_symbol);
 
-    P_LIST_ADD(type_info->type->all_specialized_types,
-            type_info->type->num_all_specialized_types,
+    specialization_set_add(&type_info->type->all_specialized_set,
+            template_argument_list_identical_hash(primary_type->template_arguments),
             type_info->type->primary_specialization);
 
     DEBUG_CODE()
@@ -2119,7 +2128,7 @@ extern inline type_t* get_new_template_type(template_parameter_list_t* template_
     primary_symbol->type_information = primary_type;
     primary_symbol->decl_context = decl_context;
 
-    primary_symbol->locus = locus;
+    primary_symbol->locus = locus_get_id(locus);
     symbol_entity_specs_set_is_user_declared(primary_symbol, 1);
     symbol_entity_specs_set_is_instantiable(primary_symbol, 1);
 
@@ -2141,8 +2150,8 @@ extern inline type_t* get_new_template_type(template_parameter_list_t* template_
 
     type_info->type->primary_specialization = get_user_defined_type(primary_symbol);
 
-    P_LIST_ADD(type_info->type->all_specialized_types,
-            type_info->type->num_all_specialized_types,
+    specialization_set_add(&type_info->type->all_specialized_set,
+            template_argument_list_identical_hash(primary_type->template_arguments),
             type_info->type->primary_specialization);
 
     DEBUG_CODE()
@@ -2537,76 +2546,167 @@ static int compare_identical_template_argument_list(const void* v1, const void*
     return 0;
 }
 
-static int compare_identical_template_argument_list_of_named_types(
-        const void *v1,
-        const void *v2)
+// Set of specializations of a template type hashed by their template
+// arguments
+struct specialization_set_tag
 {
-    type_t* t1 = *(type_t**)v1;
-    type_t* t2 = *(type_t**)v2;
+    // Of type_t*
+    open_hash_t specializations;
+};
 
-    t1 = named_type_get_symbol(t1)->type_information;
-    t2 = named_type_get_symbol(t2)->type_information;
+typedef int (*template_argument_list_compare_fn_t)(
+        template_parameter_list_t*,
+        template_parameter_list_t*);
 
-    return compare_identical_template_argument_list(
-            template_specialized_type_get_template_arguments(t1),
-            template_specialized_type_get_template_arguments(t2));
+static unsigned int hash_combine(unsigned int h, unsigned int v)
+{
+    return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
 }
 
-static type_t* template_type_get_identical_specialized_type(type_t* t,
-        template_parameter_list_t* template_parameters,
-        const decl_context_t* decl_context UNUSED_PARAMETER)
+static unsigned int hash_pointer(const void* p)
 {
-    ERROR_CONDITION(!is_template_type(t), "This is not a template type", 0);
+    uint64_t v = (uint64_t)(uintptr_t)p;
+    return (unsigned int)(v >> 4) ^ (unsigned int)(v >> 32);
+}
+
+static unsigned int hash_const_value(const_value_t* cv)
+{
+    if (cv == NULL
+            || const_value_is_address_or_object(cv))
+        return 0;
+    if (!const_value_is_integer(cv))
+        return 1;
+
+    uint64_t v = const_value_cast_to_8(cv);
+    return hash_combine((unsigned int)v, (unsigned int)(v >> 32));
+}
+
+static template_parameter_list_t* specialization_get_template_arguments(type_t* specialization)
+{
+    return template_specialized_type_get_template_arguments(
+            named_type_get_symbol(specialization)->type_information);
+}
 
-    type_t* specialization = NULL;
+typedef
+struct specialization_set_key_tag
+{
+    template_parameter_list_t* template_parameters;
+    template_argument_list_compare_fn_t compare;
+} specialization_set_key_t;
 
-    int lower = 0;
-    int upper = t->type->num_all_specialized_types - 1;
+static char specialization_set_matches(const void* e, const void* k)
+{
+    type_t* specialization = *(type_t* const*)e;
+    const specialization_set_key_t* key = (const specialization_set_key_t*)k;
+    return key->compare(key->template_parameters,
+            specialization_get_template_arguments(specialization)) == 0;
+}
 
-    while (lower <= upper)
+static void specialization_set_add(specialization_set_t** set,
+        unsigned int hash,
+        type_t* specialization)
+{
+    if (*set == NULL)
     {
-        int middle = (lower + upper) / 2;
+        *set = NEW0(specialization_set_t);
+        open_hash_init(&(*set)->specializations, sizeof(type_t*));
+    }
 
-        type_t* current_specialization = t->type->all_specialized_types[middle];
+    open_hash_insert(&(*set)->specializations, hash, &specialization);
+}
 
-        scope_entry_t* entry = named_type_get_symbol(current_specialization);
-        template_parameter_list_t* specialization_template_parameters =
-            template_specialized_type_get_template_arguments(entry->type_information);
+static type_t* specialization_set_query(specialization_set_t* set,
+        unsigned int hash,
+        template_parameter_list_t* template_parameters,
+        template_argument_list_compare_fn_t compare)
+{
+    if (set == NULL)
+        return NULL;
 
-        DEBUG_CODE()
-        {
-            fprintf(stderr, "TYPEUTILS: Checking with specialization %p: #%d in [%d<=%d, %d<=%d] '%s' (%p) at '%s'\n",
-                    t->type,
-                    middle,
-                    0,
-                    lower,
-                    upper,
-                    t->type->num_all_specialized_types - 1,
-                    print_type_str(current_specialization, entry->decl_context),
-                    entry->type_information,
-                    locus_to_str(entry->locus));
-        }
+    specialization_set_key_t key = {
+        .template_parameters = template_parameters,
+        .compare = compare,
+    };
+    type_t** specialization = (type_t**)open_hash_query(&set->specializations,
+            hash, specialization_set_matches, &key);
+    if (specialization == NULL)
+        return NULL;
 
-        int cmp = compare_identical_template_argument_list(
-                template_parameters,
-                specialization_template_parameters);
+    return *specialization;
+}
 
-        if (cmp == 0)
-        {
-            specialization = current_specialization;
-            break;
-        }
-        else if (cmp < 0)
-        {
-            upper = middle - 1;
-        }
-        else if (cmp > 0)
+// Must agree with template_arg_value_type_identical_compare
+static unsigned int template_arg_value_identical_hash(nodecl_t n)
+{
+    if (nodecl_is_null(n))
+        return 0;
+
+    unsigned int h = nodecl_get_kind(n);
+    h = hash_combine(h, hash_pointer(nodecl_get_symbol(n)));
+    h = hash_combine(h, hash_const_value(nodecl_get_constant(n)));
+    h = hash_combine(h, hash_pointer(nodecl_get_type(n)));
+
+    int i;
+    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+    {
+        h = hash_combine(h, template_arg_value_identical_hash(nodecl_get_child(n, i)));
+    }
+
+    return h;
+}
+
+static unsigned int template_argument_list_identical_hash(
+        template_parameter_list_t* template_parameter_list)
+{
+    unsigned int h = template_parameter_list->num_parameters;
+
+    int i;
+    for (i = 0; i < template_parameter_list->num_parameters; i++)
+    {
+        template_parameter_value_t* targ = template_parameter_list->arguments[i];
+        h = hash_combine(h, targ->kind);
+        switch (targ->kind)
         {
-            lower = middle + 1;
+            case TPK_TYPE:
+            case TPK_TEMPLATE:
+                {
+                    h = hash_combine(h, hash_pointer(targ->type));
+                    break;
+                }
+            case TPK_NONTYPE:
+                {
+                    h = hash_combine(h, template_arg_value_identical_hash(targ->value));
+                    break;
+                }
+            default:
+                {
+                    internal_error("Invalid template argument kind", 0);
+                }
         }
     }
 
-    return specialization;
+    return h;
+}
+
+static int compare_identical_template_argument_list_fn(
+        template_parameter_list_t* template_parameter_list_1,
+        template_parameter_list_t* template_parameter_list_2)
+{
+    return compare_identical_template_argument_list(
+            template_parameter_list_1,
+            template_parameter_list_2);
+}
+
+static type_t* template_type_get_identical_specialized_type(type_t* t,
+        template_parameter_list_t* template_parameters,
+        const decl_context_t* decl_context UNUSED_PARAMETER)
+{
+    ERROR_CONDITION(!is_template_type(t), "This is not a template type", 0);
+
+    return specialization_set_query(t->type->all_specialized_set,
+            template_argument_list_identical_hash(template_parameters),
+            template_parameters,
+            compare_identical_template_argument_list_fn);
 }
 
 
@@ -3279,19 +3379,161 @@ static int compare_equivalent_template_argument_list(
     return 0;
 }
 
-static int compare_equivalent_template_argument_list_of_named_template_specialized_types(
-        const void* v1,
-        const void* v2)
+// Must agree with template_arg_value_type_equivalent_compare: types that
+// compare equal must have the same hash. It does not need to discriminate
+// everything the comparison does
+static unsigned int template_arg_type_equivalent_hash(type_t* t, int depth)
 {
-    type_t* t1 = *(type_t**)v1;
-    type_t* t2 = *(type_t**)v2;
+    if (t == NULL)
+        return 0;
+
+    cv_qualifier_t cv_qualifier = CV_NONE;
+    t = advance_over_typedefs_with_cv_qualif(t, &cv_qualifier);
 
-    t1 = named_type_get_symbol(t1)->type_information;
-    t2 = named_type_get_symbol(t2)->type_information;
+    unsigned int h = hash_combine(t->kind, cv_qualifier);
 
-    return compare_equivalent_template_argument_list(
-            template_specialized_type_get_template_arguments(t1),
-            template_specialized_type_get_template_arguments(t2));
+    // Deep types are rare enough
+    if (depth > 8)
+        return h;
+
+    switch (t->kind)
+    {
+        case TK_DIRECT:
+            {
+                h = hash_combine(h, t->type->kind);
+                switch (t->type->kind)
+                {
+                    case STK_BUILTIN_TYPE:
+                        {
+                            h = hash_combine(h, t->type->builtin_type);
+                            h = hash_combine(h, t->type->is_signed);
+                            h = hash_combine(h, t->type->is_unsigned);
+                            h = hash_combine(h, t->type->is_long);
+                            h = hash_combine(h, t->type->is_short);
+                            break;
+                        }
+                    case STK_CLASS:
+                        {
+                            if (t->info->is_template_specialized_type)
+                            {
+                                scope_entry_t* entry = template_type_get_related_symbol(t->related_template_type);
+                                h = hash_combine(h, entry->kind);
+                                if (entry->kind == SK_TEMPLATE_TEMPLATE_PARAMETER
+                                        || entry->kind == SK_TEMPLATE_TEMPLATE_PARAMETER_PACK)
+                                {
+                                    h = hash_combine(h, symbol_entity_specs_get_template_parameter_nesting(entry));
+                                    h = hash_combine(h, symbol_entity_specs_get_template_parameter_position(entry));
+                                    break;
+                                }
+                            }
+                            h = hash_combine(h, hash_pointer(t->type));
+                            break;
+                        }
+                    case STK_ENUM:
+                    case STK_TEMPLATE_TYPE:
+                        {
+                            h = hash_combine(h, hash_pointer(t->type));
+                            break;
+                        }
+                    case STK_INDIRECT:
+                        {
+                            scope_entry_t* entry = t->type->user_defined_type;
+                            h = hash_combine(h, entry->kind);
+                            if (symbol_entity_specs_get_is_template_parameter(entry))
+                            {
+                                h = hash_combine(h, symbol_entity_specs_get_template_parameter_nesting(entry));
+                                h = hash_combine(h, symbol_entity_specs_get_template_parameter_position(entry));
+                            }
+                            break;
+                        }
+                    case STK_COMPLEX:
+                        {
+                            h = hash_combine(h,
+                                    template_arg_type_equivalent_hash(t->type->complex_element, depth + 1));
+                            break;
+                        }
+                    case STK_VECTOR:
+                        {
+                            h = hash_combine(h,
+                                    template_arg_type_equivalent_hash(t->type->vector_element, depth + 1));
+                            h = hash_combine(h, t->type->vector_size);
+                            break;
+                        }
+                    default:
+                        break;
+                }
+                break;
+            }
+        case TK_POINTER:
+        case TK_LVALUE_REFERENCE:
+        case TK_RVALUE_REFERENCE:
+        case TK_REBINDABLE_REFERENCE:
+            {
+                h = hash_combine(h, template_arg_type_equivalent_hash(t->pointer->pointee, depth + 1));
+                break;
+            }
+        case TK_POINTER_TO_MEMBER:
+            {
+                h = hash_combine(h, template_arg_type_equivalent_hash(t->pointer->pointee_class_type, depth + 1));
+                h = hash_combine(h, template_arg_type_equivalent_hash(t->pointer->pointee, depth + 1));
+                break;
+            }
+        case TK_ARRAY:
+            {
+                h = hash_combine(h, template_arg_type_equivalent_hash(t->array->element_type, depth + 1));
+                break;
+            }
+        case TK_FUNCTION:
+            {
+                h = hash_combine(h, template_arg_type_equivalent_hash(t->function->return_type, depth + 1));
+                h = hash_combine(h, t->function->num_parameters);
+                break;
+            }
+        case TK_PACK:
+            {
+                h = hash_combine(h, template_arg_type_equivalent_hash(t->pack_type->packed, depth + 1));
+                break;
+            }
+        default:
+            break;
+    }
+
+    return h;
+}
+
+// Must agree with template_arg_value_expr_equivalent_compare
+static unsigned int template_arg_value_equivalent_hash(nodecl_t n)
+{
+    if (nodecl_is_null(n))
+        return 0;
+
+    const_value_t* cv = nodecl_get_constant(n);
+    if (cv == NULL)
+        return 1;
+
+    // Only integers are discriminated, everything else just states that
+    // there is a constant
+    return hash_combine(2, hash_const_value(cv));
+}
+
+static unsigned int template_argument_list_equivalent_hash(
+        template_parameter_list_t* template_parameter_list)
+{
+    unsigned int h = template_parameter_list->num_parameters;
+
+    int i;
+    for (i = 0; i < template_parameter_list->num_parameters; i++)
+    {
+        template_parameter_value_t* targ = template_parameter_list->arguments[i];
+        h = hash_combine(h, targ->kind);
+        h = hash_combine(h, template_arg_type_equivalent_hash(targ->type, /* depth */ 0));
+        if (targ->kind == TPK_NONTYPE)
+        {
+            h = hash_combine(h, template_arg_value_equivalent_hash(targ->value));
+        }
+    }
+
+    return h;
 }
 
 static type_t* template_type_get_equivalent_specialized_type(type_t* t,
@@ -3316,53 +3558,10 @@ static type_t* template_type_get_equivalent_specialized_type(type_t* t,
                 template_type_get_num_specializations(t));
     }
 
-    type_t* specialization = NULL;
-
-    int lower = 0;
-    int upper = t->type->num_unique_specialized_types - 1;
-
-    while (lower <= upper)
-    {
-        int middle = (lower + upper) / 2;
-
-        type_t* current_specialization = t->type->unique_specialized_types[middle];
-
-        scope_entry_t* entry = named_type_get_symbol(current_specialization);
-        template_parameter_list_t* specialization_template_parameters =
-            template_specialized_type_get_template_arguments(entry->type_information);
-
-        DEBUG_CODE()
-        {
-            fprintf(stderr, "TYPEUTILS: Checking with specialization %p: #%d in [%d<=%d, %d<=%d] '%s' (%p) at '%s'\n",
-                    t->type,
-                    middle,
-                    0,
-                    lower,
-                    upper,
-                    t->type->num_unique_specialized_types - 1,
-                    print_type_str(current_specialization, entry->decl_context),
-                    entry->type_information,
-                    locus_to_str(entry->locus));
-        }
-
-        int cmp = compare_equivalent_template_argument_list(
-                template_parameters,
-                specialization_template_parameters);
-
-        if (cmp == 0)
-        {
-            specialization = current_specialization;
-            break;
-        }
-        else if (cmp < 0)
-        {
-            upper = middle - 1;
-        }
-        else if (cmp > 0)
-        {
-            lower = middle + 1;
-        }
-    }
+    type_t* specialization = specialization_set_query(t->type->unique_specialized_set,
+            template_argument_list_equivalent_hash(template_parameters),
+            template_parameters,
+            compare_equivalent_template_argument_list);
 
     if (specialization == NULL)
     {
@@ -3375,7 +3574,7 @@ static type_t* template_type_get_equivalent_specialized_type(type_t* t,
             fprintf(stderr, "TYPEUTILS: Checking with primary specialization '%s' (%p) at '%s'\n",
                     print_type_str(current_specialization, entry->decl_context),
                     entry->type_information,
-                    locus_to_str(entry->locus));
+                    locus_to_str(locus_from_id(entry->locus)));
         }
 
         template_parameter_list_t* specialization_template_parameters =
@@ -3623,7 +3822,7 @@ static type_t* template_type_get_specialized_type_(
     updated_decl_context->template_parameters = template_arguments;
     specialized_symbol->decl_context = updated_decl_context;
 
-    specialized_symbol->locus = locus;
+    specialized_symbol->locus = locus_get_id(locus);
 
     // Keep information of the entity except for some attributes that
     // must be cleared
@@ -3773,110 +3972,12 @@ static type_t* template_type_get_specialized_type_(
 #endif
 
         // Register this new specialization in the unique specialization list
-        // This is to make room
         P_LIST_ADD(template_type->type->unique_specialized_types,
                 template_type->type->num_unique_specialized_types,
                 result);
-        // And now we make an "binary insertion"
-        {
-            int lower = 0;
-            int upper = template_type->type->num_unique_specialized_types - 2;
-
-            while (lower <= upper)
-            {
-                int middle = (lower + upper) / 2;
-
-                int cmp = compare_equivalent_template_argument_list_of_named_template_specialized_types(
-                        &result,
-                        &template_type->type->unique_specialized_types[middle]);
-
-                if (cmp < 0)
-                {
-                    upper = middle - 1;
-                }
-                else if (cmp > 0)
-                {
-                    lower = middle + 1;
-                }
-                else
-                {
-                    internal_error("This cannot happen %p\nnew %s\n%03d: %s",
-                            template_type->type,
-                            print_declarator(result),
-                            middle, print_declarator(template_type->type->unique_specialized_types[middle]));
-                }
-            }
-            // lower tells us where the new element goes
-
-            int j;
-            // Shift all items right
-            for (j = template_type->type->num_unique_specialized_types - 1; j >= lower + 1; j--)
-            {
-                template_type->type->unique_specialized_types[j] =
-                    template_type->type->unique_specialized_types[j-1];
-            }
-            template_type->type->unique_specialized_types[lower] = result;
-#if 0
-            int i;
-            for (i = 0; i < template_type->type->num_unique_specialized_types - 1; i++)
-            {
-                int cmp = compare_template_argument_list_of_named_template_specialized_types(
-                        &result,
-                        &template_type->type->specialized_types[i]);
-
-                ERROR_CONDITION(cmp == 0, "This cannot happen %p\nnew %s\n%03d: %s",
-                        template_type->type,
-                        print_declarator(result),
-                        i, print_declarator(template_type->type->specialized_types[i]));
-                if (cmp > 0)
-                    continue;
-                else if (cmp < 0)
-                {
-                    int j;
-#if 0
-                    // Integrity verification
-                    for (j = i + 1; j < template_type->type->num_unique_specialized_types - 1; j++)
-                    {
-                        cmp = compare_template_argument_list_of_named_template_specialized_types(
-                                &result,
-                                &template_type->type->specialized_types[j]);
-
-                        if (cmp != -1)
-                        {
-                            extern void _enable_debug();
-                            extern void _disable_debug();
-                            _enable_debug();
-                            fprintf(stderr, "result < j?\n");
-                            compare_template_argument_list_of_named_template_specialized_types(
-                                    &result,
-                                    &template_type->type->specialized_types[j]);
-                            fprintf(stderr, "result > j?\n");
-                            compare_template_argument_list_of_named_template_specialized_types(
-                                    &template_type->type->specialized_types[j],
-                                    &result);
-                            fprintf(stderr, "====\n");
-                            _disable_debug();
-                        }
-
-                        ERROR_CONDITION(cmp != -1, "Wrong ordering %p\nnew %s\n%03d: %s",
-                                template_type->type,
-                                print_declarator(result),
-                                j, print_declarator(template_type->type->specialized_types[j]));
-                    }
-#endif
-
-                    // Shift all items right
-                    for (j = template_type->type->num_unique_specialized_types - 1; j >= i + 1; j--)
-                    {
-                        template_type->type->specialized_types[j] =
-                            template_type->type->specialized_types[j-1];
-                    }
-                    template_type->type->specialized_types[i] = result;
-                    break;
-                }
-            }
-#endif
-        }
+        specialization_set_add(&template_type->type->unique_specialized_set,
+                template_argument_list_equivalent_hash(template_arguments),
+                result);
 
 #if 0
         // Integrity verification
@@ -3962,48 +4063,9 @@ static type_t* template_type_get_specialized_type_(
     }
 
     // Register this specialization in the all specializations set
-    {
-        P_LIST_ADD(template_type->type->all_specialized_types,
-                template_type->type->num_all_specialized_types,
-                result);
-        int lower = 0;
-        int upper = template_type->type->num_all_specialized_types - 2;
-
-        // Binary insertion
-        while (lower <= upper)
-        {
-            int middle = (lower + upper) / 2;
-
-            int cmp = compare_identical_template_argument_list_of_named_types(
-                    &result,
-                    &template_type->type->all_specialized_types[middle]);
-
-            if (cmp < 0)
-            {
-                upper = middle - 1;
-            }
-            else if (cmp > 0)
-            {
-                lower = middle + 1;
-            }
-            else
-            {
-                internal_error("This cannot happen %p\nnew %s\n%03d: %s",
-                        template_type->type,
-                        print_declarator(result),
-                        middle, print_declarator(template_type->type->all_specialized_types[middle]));
-            }
-        }
-
-        int j;
-        // Shift all items right
-        for (j = template_type->type->num_all_specialized_types - 1; j >= lower + 1; j--)
-        {
-            template_type->type->all_specialized_types[j] =
-                template_type->type->all_specialized_types[j-1];
-        }
-        template_type->type->all_specialized_types[lower] = result;
-    }
+    specialization_set_add(&template_type->type->all_specialized_set,
+            template_argument_list_identical_hash(template_arguments),
+            result);
 
     return result;
 }
@@ -4190,7 +4252,8 @@ static void init_qualification_hash(void)
                 i < (int)((CV_CONST|CV_VOLATILE|CV_RESTRICT) + 1);
                 i++)
         {
-            _qualification[i] = dhash_ptr_new(5);
+            // Most qualified types are just const
+            _qualification[i] = dhash_ptr_new(i == CV_CONST ? 1024 : 64);
         }
         _qualif_hash_initialized = 1;
     }
@@ -4385,7 +4448,7 @@ extern inline type_t* get_pointer_type(type_t* t)
 
     if (_pointer_types == NULL)
     {
-        _pointer_types = dhash_ptr_new(5);
+        _pointer_types = dhash_ptr_new(1024);
     }
 
     type_t* pointed_type = dhash_ptr_query(_pointer_types, (const char*)t);
@@ -4473,7 +4536,7 @@ static type_t* get_internal_reference_type(type_t* t, enum type_kind reference_k
 
     if ((*reference_types) == NULL)
     {
-        (*reference_types) = dhash_ptr_new(5);
+        (*reference_types) = dhash_ptr_new(256);
     }
 
     dhash_ptr_t *reference_hash = *reference_types;
@@ -4930,6 +4993,11 @@ static type_t* _get_array_type(
 
                 result->array->is_string_literal = is_string_literal;
 
+                ERROR_CONDITION(ast_is_in_arena(nodecl_get_ast(whole_size))
+                        || ast_is_in_arena(nodecl_get_ast(lower_bound))
+                        || ast_is_in_arena(nodecl_get_ast(upper_bound)),
+                        "Bounds of cached array types cannot live in a parse arena", 0);
+
                 dhash_ptr_insert(array_sized_hash, (const char*)element_type, result);
             }
             else
@@ -5476,21 +5544,21 @@ type_t* get_new_function_type_common(type_t* t,
 {
 #define MY_MAX(a, b) ((a) > (b) ? (a) : (b))
 #define MAX_REF_QUALIFIER MY_MAX(REF_QUALIFIER_NONE, MY_MAX(REF_QUALIFIER_RVALUE, REF_QUALIFIER_LVALUE))
-    static type_trie_t* _function_tries[2][2][MAX_REF_QUALIFIER + 1] = { };
+    static type_seq_hash_t* _function_type_seq_hashes[2][2][MAX_REF_QUALIFIER + 1] = { };
 #undef MAX_REF_QUALIFIER
 #undef MY_MAX
 
-    type_trie_t* used_trie = NULL;
+    type_seq_hash_t* used_hash = NULL;
 
-    if (_function_tries[!!is_trailing][!!t][ref_qualifier] == NULL)
+    if (_function_type_seq_hashes[!!is_trailing][!!t][ref_qualifier] == NULL)
     {
-        _function_tries[!!is_trailing][!!t][ref_qualifier] = allocate_type_trie();
+        _function_type_seq_hashes[!!is_trailing][!!t][ref_qualifier] = allocate_type_seq_hash();
     }
 
-    used_trie = _function_tries[!!is_trailing][!!t][ref_qualifier];
+    used_hash = _function_type_seq_hashes[!!is_trailing][!!t][ref_qualifier];
 
     const type_t* type_seq[num_parameters + 1];
-    //  Don't worry, this 'void' is just for the trie
+    //  Don't worry, this 'void' is just for the hash
     type_seq[0] = (t != NULL ? t : get_void_type());
 
     char fun_type_is_dependent = 0;
@@ -5520,19 +5588,19 @@ type_t* get_new_function_type_common(type_t* t,
         }
         else
         {
-            // This type is just for the trie 
+            // This type is just for the hash
             type_seq[i + 1] = get_ellipsis_type();
         }
     }
 
     // Cast to drop 'const'
-    type_t* function_type = (type_t*)lookup_type_trie(used_trie, 
+    type_t* function_type = (type_t*)lookup_type_seq_hash(used_hash, 
             type_seq, num_parameters + 1);
 
     if (function_type == NULL)
     {
         type_t* new_funct_type = _get_new_function_type(t, parameter_info, num_parameters, is_trailing, ref_qualifier);
-        insert_type_trie(used_trie, type_seq, num_parameters + 1, new_funct_type);
+        insert_type_seq_hash(used_hash, type_seq, num_parameters + 1, new_funct_type);
         function_type = new_funct_type;
 
         set_is_dependent_type(function_type, fun_type_is_dependent);
@@ -11690,21 +11758,21 @@ const char *get_named_simple_type_name(scope_entry_t* user_defined_type)
             {
                 snprintf(user_defined_str, MAX_LENGTH, "enum %s {%s}", 
                         get_qualified_symbol_name(user_defined_type, user_defined_type->decl_context),
-                        locus_to_str(user_defined_type->locus));
+                        locus_to_str(locus_from_id(user_defined_type->locus)));
                 break;
             }
         case SK_CLASS :
             {
                 snprintf(user_defined_str, MAX_LENGTH, "class %s {%s}", 
                         get_qualified_symbol_name(user_defined_type, user_defined_type->decl_context),
-                        locus_to_str(user_defined_type->locus));
+                        locus_to_str(locus_from_id(user_defined_type->locus)));
                 break;
             }
         case SK_TEMPLATE_ALIAS :
             {
                 snprintf(user_defined_str, MAX_LENGTH, "template-alias %s {%s}", 
                         get_qualified_symbol_name(user_defined_type, user_defined_type->decl_context),
-                        locus_to_str(user_defined_type->locus));
+                        locus_to_str(locus_from_id(user_defined_type->locus)));
                 break;
             }
         case SK_TYPEDEF :
@@ -11723,7 +11791,7 @@ const char *get_named_simple_type_name(scope_entry_t* user_defined_type)
                     user_defined_type->symbol_name,
                     symbol_entity_specs_get_template_parameter_nesting(user_defined_type),
                     symbol_entity_specs_get_template_parameter_position(user_defined_type),
-                    locus_to_str(user_defined_type->locus)
+                    locus_to_str(locus_from_id(user_defined_type->locus))
                     );
             break;
         case SK_TEMPLATE_TYPE_PARAMETER_PACK :
@@ -11731,7 +11799,7 @@ const char *get_named_simple_type_name(scope_entry_t* user_defined_type)
                     user_defined_type->symbol_name,
                     symbol_entity_specs_get_template_parameter_nesting(user_defined_type),
                     symbol_entity_specs_get_template_parameter_position(user_defined_type),
-                    locus_to_str(user_defined_type->locus)
+                    locus_to_str(locus_from_id(user_defined_type->locus))
                     );
             break;
         case SK_TEMPLATE_TEMPLATE_PARAMETER :
@@ -11739,7 +11807,7 @@ const char *get_named_simple_type_name(scope_entry_t* user_defined_type)
                     user_defined_type->symbol_name,
                     symbol_entity_specs_get_template_parameter_nesting(user_defined_type),
                     symbol_entity_specs_get_template_parameter_position(user_defined_type),
-                    locus_to_str(user_defined_type->locus)
+                    locus_to_str(locus_from_id(user_defined_type->locus))
                     );
             break;
         case SK_TEMPLATE_TEMPLATE_PARAMETER_PACK :
@@ -11747,7 +11815,7 @@ const char *get_named_simple_type_name(scope_entry_t* user_defined_type)
                     user_defined_type->symbol_name,
                     symbol_entity_specs_get_template_parameter_nesting(user_defined_type),
                     symbol_entity_specs_get_template_parameter_position(user_defined_type),
-                    locus_to_str(user_defined_type->locus)
+                    locus_to_str(locus_from_id(user_defined_type->locus))
                     );
             break;
         case SK_TEMPLATE_NONTYPE_PARAMETER :
@@ -11755,7 +11823,7 @@ const char *get_named_simple_type_name(scope_entry_t* user_defined_type)
                     user_defined_type->symbol_name,
                     symbol_entity_specs_get_template_parameter_nesting(user_defined_type),
                     symbol_entity_specs_get_template_parameter_position(user_defined_type),
-                    locus_to_str(user_defined_type->locus)
+                    locus_to_str(locus_from_id(user_defined_type->locus))
                     );
             break;
         case SK_TEMPLATE_NONTYPE_PARAMETER_PACK :
@@ -11763,7 +11831,7 @@ const char *get_named_simple_type_name(scope_entry_t* user_defined_type)
                     user_defined_type->symbol_name,
                     symbol_entity_specs_get_template_parameter_nesting(user_defined_type),
                     symbol_entity_specs_get_template_parameter_position(user_defined_type),
-                    locus_to_str(user_defined_type->locus)
+                    locus_to_str(locus_from_id(user_defined_type->locus))
                     );
             break;
         case SK_TEMPLATE :
@@ -14004,10 +14072,10 @@ extern inline type_t* get_braced_list_type(int num_types, type_t** type_list)
         return _empty_braces_type;
     }
 
-    static type_trie_t* _braced_types_trie = NULL;
-    if (_braced_types_trie == NULL)
+    static type_seq_hash_t* _braced_types_hash = NULL;
+    if (_braced_types_hash == NULL)
     {
-        _braced_types_trie = allocate_type_trie();
+        _braced_types_hash = allocate_type_seq_hash();
     }
 
     int i;
@@ -14018,7 +14086,7 @@ extern inline type_t* get_braced_list_type(int num_types, type_t** type_list)
         any_is_dependent = is_dependent_type(type_list[i]);
     }
 
-    type_t* result = (type_t*)lookup_type_trie(_braced_types_trie, (const type_t**)type_list, num_types);
+    type_t* result = (type_t*)lookup_type_seq_hash(_braced_types_hash, (const type_t**)type_list, num_types);
 
     if (result == NULL)
     {
@@ -16281,10 +16349,10 @@ extern inline type_t* get_sequence_of_types(int num_types, type_t** types)
         return _empty_sequence;
     }
 
-    static type_trie_t *_sequence_types_trie = NULL;
-    if (_sequence_types_trie == NULL)
+    static type_seq_hash_t *_sequence_types_hash = NULL;
+    if (_sequence_types_hash == NULL)
     {
-        _sequence_types_trie = allocate_type_trie();
+        _sequence_types_hash = allocate_type_seq_hash();
     }
 
     char any_is_dependent = 0;
@@ -16296,7 +16364,7 @@ extern inline type_t* get_sequence_of_types(int num_types, type_t** types)
         any_is_dependent = any_is_dependent || is_dependent_type(types[i]);
     }
 
-    type_t* result = (type_t*)lookup_type_trie(_sequence_types_trie, (const type_t**)types, num_types);
+    type_t* result = (type_t*)lookup_type_seq_hash(_sequence_types_hash, (const type_t**)types, num_types);
 
     if (result == NULL)
     {
@@ -16311,7 +16379,7 @@ extern inline type_t* get_sequence_of_types(int num_types, type_t** types)
 
         result->info->is_dependent = any_is_dependent;
 
-        insert_type_trie(_sequence_types_trie, (const type_t**)types, num_types, result);
+        insert_type_seq_hash(_sequence_types_hash, (const type_t**)types, num_types, result);
     }
 
     return result;
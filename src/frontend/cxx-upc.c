@@ -46,7 +46,7 @@ void upc_sign_in_builtins(const decl_context_t* decl_context)
     upc_THREADS->type_information = get_const_qualified_type(get_signed_int_type());
     upc_THREADS->defined = 1;
     upc_THREADS->do_not_print = 1;
-    upc_THREADS->locus = make_locus("(global scope)", 0, 0);
+    upc_THREADS->locus = locus_get_id(make_locus("(global scope)", 0, 0));
     symbol_entity_specs_set_is_builtin(upc_THREADS, 1);
     if (CURRENT_CONFIGURATION->upc_threads != NULL)
     {
@@ -61,7 +61,7 @@ void upc_sign_in_builtins(const decl_context_t* decl_context)
     upc_MYTHREAD->type_information = get_const_qualified_type(get_signed_int_type());
     upc_MYTHREAD->defined = 1;
     upc_MYTHREAD->do_not_print = 1;
-    upc_MYTHREAD->locus = make_locus("(global scope)", 0, 0);
+    upc_MYTHREAD->locus = locus_get_id(make_locus("(global scope)", 0, 0));
     symbol_entity_specs_set_is_builtin(upc_MYTHREAD, 1);
     
     // UPC_MAX_BLOCK_SIZE
@@ -72,7 +72,7 @@ void upc_sign_in_builtins(const decl_context_t* decl_context)
     upc_UPC_MAX_BLOCK_SIZE->type_information = get_const_qualified_type(get_signed_int_type());
     upc_UPC_MAX_BLOCK_SIZE->defined = 1;
     upc_UPC_MAX_BLOCK_SIZE->do_not_print = 1;
-    upc_UPC_MAX_BLOCK_SIZE->locus = make_locus("(global scope)", 0, 0);
+    upc_UPC_MAX_BLOCK_SIZE->locus = locus_get_id(make_locus("(global scope)", 0, 0));
     symbol_entity_specs_set_is_builtin(upc_UPC_MAX_BLOCK_SIZE, 1);
 
     // upc_lock_t
@@ -83,7 +83,7 @@ void upc_sign_in_builtins(const decl_context_t* decl_context)
     upc_lock_t->defined = 1;
     upc_lock_t->type_information = get_void_type();
     upc_lock_t->do_not_print = 1;
-    upc_lock_t->locus = make_locus("(global scope)", 0, 0);
+    upc_lock_t->locus = locus_get_id(make_locus("(global scope)", 0, 0));
     symbol_entity_specs_set_is_builtin(upc_lock_t, 1);
 }
 
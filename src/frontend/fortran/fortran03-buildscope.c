@@ -351,7 +351,7 @@ static void check_untyped_symbols(const decl_context_t* decl_context)
             continue;
         }
 
-        error_printf_at(entry->locus, "symbol '%s' has no IMPLICIT type\n",
+        error_printf_at(locus_from_id(entry->locus), "symbol '%s' has no IMPLICIT type\n",
                 entry->symbol_name);
     }
 
@@ -388,7 +388,7 @@ static void update_untyped_symbols(const decl_context_t* decl_context)
             {
                 fprintf(stderr, "BUILDSCOPE: Type of symbol '%s' at '%s' updated to %s\n", 
                         entry->symbol_name,
-                        locus_to_str(entry->locus),
+                        locus_to_str(locus_from_id(entry->locus)),
                         entry->type_information == NULL ? "<<NULL>>" : print_declarator(entry->type_information));
             }
         }
@@ -439,18 +439,18 @@ static void check_not_fully_defined_symbols(const decl_context_t* decl_context)
 
         if (entry->kind == SK_COMMON)
         {
-            error_printf_at(entry->locus, "COMMON '%s' does not exist\n",
+            error_printf_at(locus_from_id(entry->locus), "COMMON '%s' does not exist\n",
                     entry->symbol_name + strlen(".common."));
         }
         else if (entry->kind == SK_FUNCTION
                 && symbol_entity_specs_get_is_module_procedure(entry))
         {
-            error_printf_at(entry->locus, "MODULE PROCEDURE '%s' does not exist\n",
+            error_printf_at(locus_from_id(entry->locus), "MODULE PROCEDURE '%s' does not exist\n",
                     entry->symbol_name);
         }
         else if (entry->kind == SK_CLASS)
         {
-            error_printf_at(entry->locus, "derived type name 'TYPE(%s)' has not been defined\n",
+            error_printf_at(locus_from_id(entry->locus), "derived type name 'TYPE(%s)' has not been defined\n",
                     entry->symbol_name);
         }
         else
@@ -558,7 +558,7 @@ static void check_intent_declared_symbols(const decl_context_t* decl_context)
         if (!symbol_is_parameter_of_function(entry,
                     decl_context->current_scope->related_entry))
         {
-            error_printf_at(entry->locus, "entity '%s' is not a dummy argument\n",
+            error_printf_at(locus_from_id(entry->locus), "entity '%s' is not a dummy argument\n",
                     entry->symbol_name);
         }
         else
@@ -587,7 +587,7 @@ static scope_entry_t* create_fortran_symbol_for_name_(const decl_context_t* decl
     add_untyped_symbol(decl_context, result);
 
     symbol_entity_specs_set_is_implicit_basic_type(result, 1);
-    result->locus = ast_get_locus(location);
+    result->locus = locus_get_id(ast_get_locus(location));
 
     if (decl_context->current_scope->related_entry != NULL
             && (decl_context->current_scope->related_entry->kind == SK_MODULE
@@ -1117,7 +1117,7 @@ static void build_scope_main_program_unit(AST program_unit,
     }
     scope_entry_t* program_sym = new_fortran_symbol_not_unknown(decl_context, program_name);
     program_sym->kind = SK_PROGRAM;
-    program_sym->locus = ast_get_locus(program_unit);
+    program_sym->locus = locus_get_id(ast_get_locus(program_unit));
 
     symbol_entity_specs_set_is_global_hidden(program_sym, 1);
     
@@ -1439,7 +1439,7 @@ static void build_scope_module_program_unit(AST program_unit,
     remove_unknown_kind_symbol(decl_context, new_entry);
 
     new_entry->related_decl_context = program_unit_context;
-    new_entry->locus = ast_get_locus(module_stmt);
+    new_entry->locus = locus_get_id(ast_get_locus(module_stmt));
     new_entry->defined = 1;
     program_unit_context->current_scope->related_entry = new_entry;
 
@@ -1542,7 +1542,7 @@ static void build_scope_block_data_program_unit(AST program_unit,
 
     scope_entry_t* program_sym = new_fortran_symbol_not_unknown(decl_context, program_name);
     program_sym->kind = SK_BLOCKDATA;
-    program_sym->locus = ast_get_locus(program_unit);
+    program_sym->locus = locus_get_id(ast_get_locus(program_unit));
 
     if (program_sym->decl_context->current_scope == decl_context->global_scope)
         symbol_entity_specs_set_is_global_hidden(program_sym, 1);
@@ -1716,7 +1716,7 @@ static scope_entry_t* new_procedure_symbol(
     if (entry->kind == SK_UNDEFINED)
         entry->kind = SK_FUNCTION;
 
-    entry->locus = ast_get_locus(name);
+    entry->locus = locus_get_id(ast_get_locus(name));
     symbol_entity_specs_set_is_implicit_basic_type(entry, 1);
     entry->defined = 1;
 
@@ -1849,7 +1849,7 @@ static scope_entry_t* new_procedure_symbol(
                 add_untyped_symbol(program_unit_context, dummy_arg);
             }
 
-            dummy_arg->locus = ast_get_locus(dummy_arg_name);
+            dummy_arg->locus = locus_get_id(ast_get_locus(dummy_arg_name));
 
             symbol_set_as_parameter_of_function(dummy_arg, entry,
                     /* nesting */ 0,
@@ -1881,7 +1881,7 @@ static scope_entry_t* new_procedure_symbol(
             result_sym = get_symbol_for_name(program_unit_context, result, ASTText(result));
 
             result_sym->kind = SK_VARIABLE;
-            result_sym->locus = ast_get_locus(result);
+            result_sym->locus = locus_get_id(ast_get_locus(result));
             symbol_entity_specs_set_is_result_var(result_sym, 1);
 
             symbol_entity_specs_set_is_implicit_basic_type(result_sym, 1);
@@ -2028,7 +2028,7 @@ static scope_entry_t* new_entry_symbol(const decl_context_t* decl_context,
     entry->decl_context = decl_context;
 
     entry->kind = SK_FUNCTION;
-    entry->locus = ast_get_locus(name);
+    entry->locus = locus_get_id(ast_get_locus(name));
     symbol_entity_specs_set_is_entry(entry, 1);
     symbol_entity_specs_set_is_implicit_basic_type(entry, 1);
     entry->defined = 1;
@@ -2112,7 +2112,7 @@ static scope_entry_t* new_entry_symbol(const decl_context_t* decl_context,
                 remove_intent_declared_symbol(decl_context, dummy_arg);
             }
 
-            dummy_arg->locus = ast_get_locus(dummy_arg_name);
+            dummy_arg->locus = locus_get_id(ast_get_locus(dummy_arg_name));
 
             symbol_set_as_parameter_of_function(dummy_arg, entry,
                     /* nesting */ 0,
@@ -2145,7 +2145,7 @@ static scope_entry_t* new_entry_symbol(const decl_context_t* decl_context,
             ERROR_CONDITION(result_sym == existing_name, "Wrong symbol found", 0);
 
             result_sym->kind = SK_VARIABLE;
-            result_sym->locus = ast_get_locus(result);
+            result_sym->locus = locus_get_id(ast_get_locus(result));
             symbol_entity_specs_set_is_result_var(result_sym, 1);
 
             remove_unknown_kind_symbol(decl_context, result_sym);
@@ -3875,13 +3875,13 @@ static type_t* eval_array_spec(type_t* basic_type,
                 }
 
                 new_vla_dim->kind = SK_VARIABLE;
-                new_vla_dim->locus = nodecl_get_locus(lower_bound);
+                new_vla_dim->locus = locus_get_id(nodecl_get_locus(lower_bound));
                 new_vla_dim->value = lower_bound;
                 new_vla_dim->type_information = get_ptrdiff_t_type();
                 symbol_entity_specs_set_is_saved_expression(new_vla_dim, 1);
 
                 lower_bound = nodecl_make_symbol(new_vla_dim,
-                        new_vla_dim->locus);
+                        locus_from_id(new_vla_dim->locus));
                 nodecl_set_type(lower_bound, new_vla_dim->type_information);
 
                 *nodecl_output = nodecl_append_to_list(*nodecl_output,
@@ -3916,13 +3916,13 @@ static type_t* eval_array_spec(type_t* basic_type,
                 }
 
                 new_vla_dim->kind = SK_VARIABLE;
-                new_vla_dim->locus = nodecl_get_locus(upper_bound);
+                new_vla_dim->locus = locus_get_id(nodecl_get_locus(upper_bound));
                 new_vla_dim->value = upper_bound;
                 new_vla_dim->type_information = get_ptrdiff_t_type();
                 symbol_entity_specs_set_is_saved_expression(new_vla_dim, 1);
 
                 upper_bound = nodecl_make_symbol(new_vla_dim,
-                        new_vla_dim->locus);
+                        locus_from_id(new_vla_dim->locus));
                 nodecl_set_type(upper_bound, new_vla_dim->type_information);
 
                 *nodecl_output = nodecl_append_to_list(*nodecl_output,
@@ -4796,7 +4796,7 @@ static void build_scope_common_stmt(AST a,
         {
             // If the symbol is not found, we should create a new one
             common_sym = new_common(decl_context, common_name_str);
-            common_sym->locus = ast_get_locus(a);
+            common_sym->locus = locus_get_id(ast_get_locus(a));
         }
         else
         {
@@ -5000,7 +5000,7 @@ scope_entry_t* fortran_query_label_str_(const char* label,
         // Fix the symbol name (which for labels does not match the query name)
         new_label->symbol_name = label;
         new_label->kind = SK_LABEL;
-        new_label->locus = locus;
+        new_label->locus = locus_get_id(locus);
         new_label->do_not_print = 1;
         new_label->defined = is_definition;
     }
@@ -5013,7 +5013,7 @@ scope_entry_t* fortran_query_label_str_(const char* label,
             {
                 error_printf_at(locus, "label %s has already been defined in %s\n",
                         new_label->symbol_name,
-                        locus_to_str(new_label->locus));
+                        locus_to_str(locus_from_id(new_label->locus)));
             }
             else
             {
@@ -5057,7 +5057,7 @@ scope_entry_t* fortran_query_construct_name_str(
             // Sign in the symbol in the program unit scope
             new_label = new_symbol(program_unit_context, program_unit_context->current_scope, construct_name);
             new_label->kind = SK_LABEL;
-            new_label->locus = locus;
+            new_label->locus = locus_get_id(locus);
             new_label->do_not_print = 1;
             new_label->defined = 1;
         }
@@ -5081,7 +5081,7 @@ scope_entry_t* fortran_query_construct_name_str(
             {
                 error_printf_at(locus, "construct name %s has already been defined in %s\n",
                         new_label->symbol_name,
-                        locus_to_str(new_label->locus));
+                        locus_to_str(locus_from_id(new_label->locus)));
             }
             else
             {
@@ -5513,7 +5513,7 @@ static void build_scope_derived_type_data_component_def(
 
         entry->kind = SK_VARIABLE;
 
-        entry->locus = ast_get_locus(declaration);
+        entry->locus = locus_get_id(ast_get_locus(declaration));
         remove_unknown_kind_symbol(inner_decl_context, entry);
 
         entry->type_information = basic_type;
@@ -5836,7 +5836,7 @@ static void build_scope_derived_type_def(AST a, const decl_context_t* decl_conte
     }
 
     class_name->kind = SK_CLASS;
-    class_name->locus = ast_get_locus(name);
+    class_name->locus = locus_get_id(ast_get_locus(name));
     class_name->type_information = get_new_class_type(decl_context, TT_STRUCT);
     if (!nodecl_is_null(attr_spec.bind_info)
         && !nodecl_is_err_expr(attr_spec.bind_info))
@@ -6269,7 +6269,7 @@ static void build_scope_enum_def(AST a,
 
     scope_entry_t *new_enum
         = new_symbol(decl_context, decl_context->current_scope, enum_name);
-    new_enum->locus = ast_get_locus(enum_def_stmt);
+    new_enum->locus = locus_get_id(ast_get_locus(enum_def_stmt));
     new_enum->kind = SK_ENUM;
     new_enum->type_information
         = get_new_enum_type(decl_context, /* enum_is_scoped */ 0);
@@ -6318,7 +6318,7 @@ static void build_scope_enum_def(AST a,
             scope_entry_t *new_enumerator = new_symbol(
                 decl_context, decl_context->current_scope, enumerator_name);
             new_enumerator->kind = SK_ENUMERATOR;
-            new_enumerator->locus = ast_get_locus(name);
+            new_enumerator->locus = locus_get_id(ast_get_locus(name));
             new_enumerator->type_information = enum_type;
 
             nodecl_t nodecl_expr = nodecl_null();
@@ -7244,7 +7244,7 @@ static void build_scope_interface_block(AST a,
 
             // If this name is not related to a specific interface, make it void
             generic_spec_sym->type_information = get_void_type();
-            generic_spec_sym->locus = ast_get_locus(generic_spec);
+            generic_spec_sym->locus = locus_get_id(ast_get_locus(generic_spec));
         }
 
         // The symbol won't be unknown anymore
@@ -7444,7 +7444,7 @@ static void build_scope_namelist_stmt(AST a, const decl_context_t* decl_context,
         }
 
         new_namelist->kind = SK_NAMELIST;
-        new_namelist->locus = ast_get_locus(a);
+        new_namelist->locus = locus_get_id(ast_get_locus(a));
 
         remove_unknown_kind_symbol(decl_context, new_namelist);
 
@@ -8233,7 +8233,7 @@ static void build_scope_save_stmt(AST a, const decl_context_t* decl_context, nod
             if (entry == NULL)
             {
                 entry = new_common(decl_context,ASTText(ASTSon0(saved_entity)));
-                entry->locus = ast_get_locus(a);
+                entry->locus = locus_get_id(ast_get_locus(a));
 
                 add_not_fully_defined_symbol(decl_context, entry);
             }
@@ -8534,7 +8534,7 @@ static void build_scope_declaration_common_stmt(AST a, const decl_context_t* dec
         {
             error_printf_at(ast_get_locus(declaration), "redeclaration of entity '%s', first declared at '%s'\n",
                     entry->symbol_name,
-                    locus_to_str(entry->locus));
+                    locus_to_str(locus_from_id(entry->locus)));
             continue;
         }
 
@@ -8561,7 +8561,7 @@ static void build_scope_declaration_common_stmt(AST a, const decl_context_t* dec
                     entry);
         }
 
-        entry->locus = ast_get_locus(declaration);
+        entry->locus = locus_get_id(ast_get_locus(declaration));
 
         if (entry->kind == SK_FUNCTION)
         {
@@ -9059,6 +9059,9 @@ scope_entry_t* insert_symbol_from_module(scope_entry_t* entry,
 {
     ERROR_CONDITION(local_name == NULL, "Invalid alias name", 0);
 
+    // The symbol is copied below, so it must be complete
+    materialize_module_symbol(entry);
+
     scope_entry_list_t* check_repeated_name = query_in_scope_str_flags(decl_context, local_name, NULL, DF_ONLY_CURRENT_SCOPE);
 
     if (check_repeated_name != NULL
@@ -9088,6 +9091,7 @@ scope_entry_t* insert_symbol_from_module(scope_entry_t* entry,
         ERROR_CONDITION(symbol_entity_specs_get_alias_to(entry) == NULL, 
                 "Bad symbol with from_module attribute but no alias set", 0);
         entry = symbol_entity_specs_get_alias_to(entry);
+        materialize_module_symbol(entry);
     }
 
     // Why do we duplicate instead of insert_entry or insert_alias?
@@ -9110,7 +9114,7 @@ scope_entry_t* insert_symbol_from_module(scope_entry_t* entry,
     }
 
     current_symbol->symbol_name = local_name;
-    current_symbol->locus = locus;
+    current_symbol->locus = locus_get_id(locus);
 
     symbol_entity_specs_set_from_module(current_symbol, module_symbol);
     symbol_entity_specs_set_alias_to(current_symbol, entry);
@@ -10897,7 +10901,7 @@ static void resolve_external_calls_rec(nodecl_t node,
                                 nodecl_locus_to_str(node),
                                 entry->symbol_name);
                         fprintf(stderr, "%s: info: to this program unit definition\n",
-                                locus_to_str(external_symbol->locus));
+                                locus_to_str(locus_from_id(external_symbol->locus)));
                     }
 
                     //  Fix up
@@ -2522,7 +2522,7 @@ static scope_entry_list_t* get_specific_interface_aux(scope_entry_t* symbol,
         DEBUG_CODE()
         {
             fprintf(stderr, "EXPRTYPE: Checking with specific interface %s\n",
-                    locus_to_str(specific_symbol->locus));
+                    locus_to_str(locus_from_id(specific_symbol->locus)));
             int i;
             for (i = 0; (i < num_parameters) && ok; i++)
             {
@@ -2859,12 +2859,12 @@ static void check_called_symbol_list(
                 scope_entry_t* current_generic_spec = entry_list_iterator_current(it);
                 if (current_generic_spec->kind == SK_GENERIC_NAME)
                 {
-                    info_printf_at(current_generic_spec->locus, "specific interface '%s' matches\n",
+                    info_printf_at(locus_from_id(current_generic_spec->locus), "specific interface '%s' matches\n",
                             current_generic_spec->symbol_name);
                 }
                 else if (symbol_entity_specs_get_is_builtin(current_generic_spec))
                 {
-                    info_printf_at(current_generic_spec->locus, "intrinsic '%s' matches\n",
+                    info_printf_at(locus_from_id(current_generic_spec->locus), "intrinsic '%s' matches\n",
                             current_generic_spec->symbol_name);
                 }
             }
@@ -4176,7 +4176,7 @@ static void check_symbol_of_called_name(AST sym,
                 const decl_context_t* program_unit_context = decl_context->current_scope->related_entry->related_decl_context;
                 entry = new_fortran_symbol(program_unit_context, ASTText(sym));
                 entry->kind = SK_FUNCTION;
-                entry->locus = ast_get_locus(sym);
+                entry->locus = locus_get_id(ast_get_locus(sym));
                 entry->type_information = get_nonproto_function_type(get_void_type(), 0);
 
                 remove_unknown_kind_symbol(decl_context, entry);
@@ -4498,7 +4498,7 @@ static void check_symbol_of_argument(AST sym, const decl_context_t* decl_context
                 // See a long comment in check_symbol_of_called_name
                 // explaining this case
                 entry = new_fortran_symbol(decl_context, ASTText(sym));
-                entry->locus = ast_get_locus(sym);
+                entry->locus = locus_get_id(ast_get_locus(sym));
                 entry->type_information = get_implicit_none_type();
 
                 // This is actually an implicit none, so it is actually
@@ -6827,7 +6827,7 @@ static void check_multiexpression(AST expr, const decl_context_t* decl_context,
             iterator_name);
     new_iterator->kind = SK_VARIABLE;
     new_iterator->type_information = get_signed_int_type();
-    new_iterator->locus = ast_get_locus(ompss_iterator);
+    new_iterator->locus = locus_get_id(ast_get_locus(ompss_iterator));
 
     nodecl_t nodecl_range = nodecl_null();
     multiexpression_check_range(range, iterator_context, &nodecl_range);
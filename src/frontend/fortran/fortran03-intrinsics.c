@@ -1206,7 +1206,7 @@ static scope_entry_t* get_intrinsic_symbol_(
         }
         else
         {
-            new_entry->locus = make_locus("(fortran-intrinsic)", 0, 0);
+            new_entry->locus = locus_get_id(make_locus("(fortran-intrinsic)", 0, 0));
         }
         new_entry->symbol_name = uniquestr(name);
         new_entry->decl_context = new_program_unit_context(decl_context);
@@ -1361,7 +1361,7 @@ void fortran_init_intrinsics(const decl_context_t* decl_context)
         if (!disabled) \
         { \
         scope_entry_t* new_intrinsic = new_symbol(relevant_decl_context, relevant_decl_context->current_scope, uniquestr(#name)); \
-        new_intrinsic->locus = make_locus("(fortran-intrinsic)", 0, 0); \
+        new_intrinsic->locus = locus_get_id(make_locus("(fortran-intrinsic)", 0, 0)); \
         new_intrinsic->kind = SK_FUNCTION; \
         new_intrinsic->do_not_print = 1; \
         new_intrinsic->type_information = get_computed_function_type(keyword_compute_intrinsic_##name); \
@@ -7187,7 +7187,7 @@ static void fortran_init_intrinsic_module_iso_c_binding(const decl_context_t* de
 
     scope_entry_t* iso_c_binding = new_symbol(decl_context, decl_context->current_scope, iso_c_binding_name);
     iso_c_binding->kind = SK_MODULE;
-    iso_c_binding->locus = locus;
+    iso_c_binding->locus = locus_get_id(locus);
     symbol_entity_specs_set_is_builtin(iso_c_binding, 1);
     iso_c_binding->related_decl_context = module_context;
     iso_c_binding->defined = 1;
@@ -7260,7 +7260,7 @@ static void fortran_init_intrinsic_module_iso_c_binding(const decl_context_t* de
     {
         scope_entry_t* symbol = new_symbol(module_context, module_context->current_scope,
                 uniquestr(named_constants[i].name));
-        symbol->locus = locus;
+        symbol->locus = locus_get_id(locus);
         symbol->kind = SK_VARIABLE;
         symbol->type_information = get_const_qualified_type(named_constants[i].const_type);
         symbol_entity_specs_set_in_module(symbol, iso_c_binding);
@@ -7281,7 +7281,7 @@ static void fortran_init_intrinsic_module_iso_c_binding(const decl_context_t* de
 
     {
     scope_entry_t* c_ptr = new_symbol(module_context, module_context->current_scope, UNIQUESTR_LITERAL("c_ptr"));
-    c_ptr->locus = locus;
+    c_ptr->locus = locus_get_id(locus);
     c_ptr->kind = SK_CLASS;
     c_ptr->type_information = get_new_class_type(module_context, TT_STRUCT);
     symbol_entity_specs_set_in_module(c_ptr, iso_c_binding);
@@ -7291,7 +7291,7 @@ static void fortran_init_intrinsic_module_iso_c_binding(const decl_context_t* de
 
     scope_entry_t* c_null_ptr = new_symbol(module_context, module_context->current_scope,
             UNIQUESTR_LITERAL("c_null_ptr"));
-    c_null_ptr->locus = locus;
+    c_null_ptr->locus = locus_get_id(locus);
     c_null_ptr->kind = SK_VARIABLE;
     c_null_ptr->type_information = get_const_qualified_type(get_user_defined_type(c_ptr));
     c_null_ptr->value = const_value_to_nodecl(
@@ -7306,7 +7306,7 @@ static void fortran_init_intrinsic_module_iso_c_binding(const decl_context_t* de
     {
     scope_entry_t* c_funptr = new_symbol(module_context, module_context->current_scope,
             UNIQUESTR_LITERAL("c_funptr"));
-    c_funptr->locus = locus;
+    c_funptr->locus = locus_get_id(locus);
     c_funptr->type_information = get_new_class_type(module_context, TT_STRUCT);
     c_funptr->kind = SK_CLASS;
     symbol_entity_specs_set_in_module(c_funptr, iso_c_binding);
@@ -7316,7 +7316,7 @@ static void fortran_init_intrinsic_module_iso_c_binding(const decl_context_t* de
 
     scope_entry_t* c_null_funptr = new_symbol(module_context, module_context->current_scope,
             UNIQUESTR_LITERAL("c_null_funptr"));
-    c_null_funptr->locus = locus;
+    c_null_funptr->locus = locus_get_id(locus);
     c_null_funptr->kind = SK_VARIABLE;
     c_null_funptr->type_information = get_user_defined_type(c_funptr);
     symbol_entity_specs_set_in_module(c_null_funptr, iso_c_binding);
@@ -7335,7 +7335,7 @@ static void fortran_init_intrinsic_module_ieee_exceptions(const decl_context_t*
     const char* ieee_exceptions_name = UNIQUESTR_LITERAL("ieee_exceptions");
 
     scope_entry_t* ieee_exceptions = new_symbol(decl_context, decl_context->current_scope, ieee_exceptions_name);
-    ieee_exceptions->locus = locus;
+    ieee_exceptions->locus = locus_get_id(locus);
     ieee_exceptions->kind = SK_MODULE;
     symbol_entity_specs_set_is_builtin(ieee_exceptions, 1);
     ieee_exceptions->related_decl_context = module_context;
@@ -7363,7 +7363,7 @@ static void fortran_init_intrinsic_module_ieee_exceptions(const decl_context_t*
         scope_entry_t* new_type = NULL;
         new_type = *(private_types[i].p) = new_symbol(module_context, module_context->current_scope,
                 uniquestr(private_types[i].name));
-        new_type->locus = locus;
+        new_type->locus = locus_get_id(locus);
         new_type->kind = SK_CLASS;
         symbol_entity_specs_set_in_module(new_type, ieee_exceptions);
         new_type->type_information = get_new_class_type(module_context, TT_STRUCT);
@@ -7410,7 +7410,7 @@ static void fortran_init_intrinsic_module_ieee_exceptions(const decl_context_t*
     {
         scope_entry_t* new_var = NULL;
         new_var = new_symbol(module_context, module_context->current_scope, uniquestr(global_names[i].name));
-        new_var->locus = locus;
+        new_var->locus = locus_get_id(locus);
         new_var->kind = SK_VARIABLE;
         symbol_entity_specs_set_in_module(new_var, ieee_exceptions);
         new_var->type_information = global_names[i].type;
@@ -7458,7 +7458,7 @@ static void fortran_init_intrinsic_module_ieee_arithmetic(const decl_context_t*
         scope_entry_t* new_type = NULL;
         new_type = *(private_types[i].p) = new_symbol(module_context, module_context->current_scope,
                 uniquestr(private_types[i].name));
-        new_type->locus = locus;
+        new_type->locus = locus_get_id(locus);
         new_type->kind = SK_CLASS;
         symbol_entity_specs_set_in_module(new_type, ieee_arithmetic);
         new_type->type_information = get_new_class_type(module_context, TT_STRUCT);
@@ -7509,7 +7509,7 @@ static void fortran_init_intrinsic_module_ieee_arithmetic(const decl_context_t*
     {
         scope_entry_t* new_var = NULL;
         new_var = new_symbol(module_context, module_context->current_scope, uniquestr(global_names[i].name));
-        new_var->locus = locus;
+        new_var->locus = locus_get_id(locus);
         new_var->kind = SK_VARIABLE;
         symbol_entity_specs_set_in_module(new_var, ieee_arithmetic);
         new_var->type_information = global_names[i].type;
@@ -7542,7 +7542,7 @@ static void fortran_init_intrinsic_module_ieee_arithmetic(const decl_context_t*
         new_operator_eq_class_type = new_symbol(module_context, module_context->current_scope,
                 uniquestr(operator_eq_neq[i].operator_class_type));
         new_operator_eq_class_type->kind = SK_FUNCTION;
-        new_operator_eq_class_type->locus = locus;
+        new_operator_eq_class_type->locus = locus_get_id(locus);
         parameter_info_t eq_class_type_parameter_info[2] =
         {
             { 0, lvalue_ref(ieee_class_type), NULL },
@@ -7580,7 +7580,7 @@ static void fortran_init_intrinsic_module_ieee_arithmetic(const decl_context_t*
         new_operator_eq_round_type = new_symbol(module_context, module_context->current_scope,
                 uniquestr(operator_eq_neq[i].operator_round_type));
         new_operator_eq_round_type->kind = SK_FUNCTION;
-        new_operator_eq_round_type->locus = locus;
+        new_operator_eq_round_type->locus = locus_get_id(locus);
         parameter_info_t eq_round_type_parameter_info[2] =
         {
             { 0, lvalue_ref(ieee_round_type), NULL },
@@ -7618,7 +7618,7 @@ static void fortran_init_intrinsic_module_ieee_arithmetic(const decl_context_t*
                 module_context->current_scope,
                 uniquestr(operator_eq_neq[i].operator_generic));
         new_operator_eq->kind = SK_GENERIC_NAME;
-        new_operator_eq->locus = locus;
+        new_operator_eq->locus = locus_get_id(locus);
         new_operator_eq->type_information = get_void_type();
         symbol_entity_specs_set_in_module(new_operator_eq, ieee_arithmetic);
         symbol_entity_specs_set_is_implicit_basic_type(new_operator_eq, 0);
@@ -7642,7 +7642,7 @@ static void fortran_init_intrinsic_module_ieee_features(const decl_context_t* de
     const char* ieee_features_name = UNIQUESTR_LITERAL("ieee_features");
 
     scope_entry_t* ieee_features = new_symbol(decl_context, decl_context->current_scope, ieee_features_name);
-    ieee_features->locus = locus;
+    ieee_features->locus = locus_get_id(locus);
     ieee_features->kind = SK_MODULE;
     symbol_entity_specs_set_is_builtin(ieee_features, 1);
     ieee_features->related_decl_context = module_context;
@@ -7669,7 +7669,7 @@ static void fortran_init_intrinsic_module_ieee_features(const decl_context_t* de
         scope_entry_t* new_type = NULL;
         new_type = *(private_types[i].p) = new_symbol(module_context, module_context->current_scope,
                 uniquestr(private_types[i].name));
-        new_type->locus = locus;
+        new_type->locus = locus_get_id(locus);
         new_type->kind = SK_CLASS;
         symbol_entity_specs_set_in_module(new_type, ieee_features);
         new_type->type_information = get_new_class_type(module_context, TT_STRUCT);
@@ -7708,7 +7708,7 @@ static void fortran_init_intrinsic_module_ieee_features(const decl_context_t* de
     {
         scope_entry_t* new_var = NULL;
         new_var = new_symbol(module_context, module_context->current_scope, uniquestr(global_names[i].name));
-        new_var->locus = locus;
+        new_var->locus = locus_get_id(locus);
         new_var->kind = SK_VARIABLE;
         symbol_entity_specs_set_in_module(new_var, ieee_features);
         new_var->type_information = global_names[i].type;
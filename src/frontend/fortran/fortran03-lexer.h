@@ -41,6 +41,17 @@ LIBMF03_EXTERN int mf03_open_file_for_scanning(const char* scanned_filename,
         char is_fixed_form);
 LIBMF03_EXTERN int mf03_prepare_string_for_scanning(const char* str);
 
+// Scans a Fortran file without parsing it and returns, in lowercase, the
+// names of the modules it defines and the names of the modules it uses
+// except those used as INTRINSIC
+LIBMF03_EXTERN void mf03_scan_module_dependences(const char* scanned_filename,
+        const char* input_filename,
+        char is_fixed_form,
+        int *num_provided_modules,
+        const char*** provided_modules,
+        int *num_required_modules,
+        const char*** required_modules);
+
 LIBMF03_EXTERN int mf03_flex_debug;
 LIBMF03_EXTERN int mf03debug;
 
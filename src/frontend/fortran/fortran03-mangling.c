@@ -73,7 +73,7 @@ const char* fortran_mangle_symbol(scope_entry_t* entry)
     ERROR_CONDITION(entry->decl_context->current_scope->kind == BLOCK_SCOPE
             && entry->decl_context->current_scope->related_entry->kind == SK_FUNCTION,
             "Cannot mangle local entity '%s' (%s)\n",
-            entry->symbol_name, locus_to_str(entry->locus));
+            entry->symbol_name, locus_to_str(locus_from_id(entry->locus)));
     ERROR_CONDITION(symbol_entity_specs_get_is_intrinsic_subroutine(entry)
             || symbol_entity_specs_get_is_intrinsic_subroutine(entry),
             "Cannot mangle intrinsic procedure '%s'\n",
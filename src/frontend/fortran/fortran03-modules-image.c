@@ -0,0 +1,643 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "fortran03-modules-image.h"
+#include "cxx-utils.h"
+#include "mem.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Layout of an image. All offsets are relative to the beginning of the file
+//
+//   header
+//   table headers            [num_tables]
+//   per table
+//     column names           [num_columns] data offsets
+//     keys                   [num_keys]
+//     cells                  [num_rows * num_columns] data offsets
+//   data area                every item is a 32-bit size, the bytes and a
+//                            NUL, padded to 4 bytes
+//
+// A data offset of 0 means NULL. Keys are sorted as signed integers, like
+// SQLite does.
+
+static const char module_image_magic[8] = "MF03IMG";
+
+enum { MODULE_IMAGE_FORMAT_VERSION = 1 };
+
+typedef
+struct module_image_header_tag
+{
+    char magic[8];
+    uint32_t format_version;
+    uint32_t num_tables;
+    uint32_t data_offset;
+    uint32_t data_size;
+} module_image_header_t;
+
+typedef
+struct module_image_table_header_tag
+{
+    uint32_t num_columns;
+    uint32_t column_names_offset;
+    uint32_t num_keys;
+    uint32_t keys_offset;
+    uint32_t num_rows;
+    uint32_t cells_offset;
+} module_image_table_header_t;
+
+typedef
+struct module_image_key_tag
+{
+    uint64_t key;
+    uint32_t first_row;
+    uint32_t num_rows;
+} module_image_key_t;
+
+// Writer
+
+typedef
+struct module_image_writer_table_tag
+{
+    int num_columns;
+    uint32_t* column_names;
+
+    int num_keys;
+    int capacity_keys;
+    module_image_key_t* keys;
+
+    int num_rows;
+    int num_cells;
+    int capacity_cells;
+    uint32_t* cells;
+} module_image_writer_table_t;
+
+struct module_image_writer_tag
+{
+    int num_tables;
+    module_image_writer_table_t* tables;
+
+    char* data;
+    uint32_t data_size;
+    uint32_t data_capacity;
+
+    // Open addressing table of data offsets, 0 is an empty slot
+    uint32_t* data_slots;
+    uint32_t num_data_slots;
+    uint32_t num_data_used;
+};
+
+static uint64_t hash_bytes(const void* bytes, uint32_t size)
+{
+    const unsigned char* p = (const unsigned char*)bytes;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    uint32_t i;
+    for (i = 0; i < size; i++)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 31;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 29;
+
+    return h;
+}
+
+static uint32_t data_item_size(const char* data, uint32_t offset)
+{
+    uint32_t size;
+    memcpy(&size, data + offset, sizeof(size));
+    return size;
+}
+
+static void writer_grow_data(module_image_writer_t* writer, uint32_t needed)
+{
+    if (writer->data_size + needed <= writer->data_capacity)
+        return;
+
+    while (writer->data_size + needed > writer->data_capacity)
+        writer->data_capacity *= 2;
+    writer->data = NEW_REALLOC(char, writer->data, writer->data_capacity);
+}
+
+static void writer_grow_data_slots(module_image_writer_t* writer)
+{
+    if (4 * (writer->num_data_used + 1) <= 3 * writer->num_data_slots)
+        return;
+
+    uint32_t old_num_slots = writer->num_data_slots;
+    uint32_t* old_slots = writer->data_slots;
+
+    writer->num_data_slots = 2 * old_num_slots;
+    writer->data_slots = NEW_VEC0(uint32_t, writer->num_data_slots);
+
+    uint32_t mask = writer->num_data_slots - 1;
+    uint32_t i;
+    for (i = 0; i < old_num_slots; i++)
+    {
+        uint32_t offset = old_slots[i];
+        if (offset == 0)
+            continue;
+
+        uint32_t j = hash_bytes(writer->data + offset + sizeof(uint32_t),
+                data_item_size(writer->data, offset)) & mask;
+        while (writer->data_slots[j] != 0)
+            j = (j + 1) & mask;
+        writer->data_slots[j] = offset;
+    }
+
+    DELETE(old_slots);
+}
+
+// Returns the offset of the data item with these bytes, adding it if needed
+static uint32_t writer_add_data(module_image_writer_t* writer, const void* bytes, uint32_t size)
+{
+    // SQLite returns NULL for empty blobs
+    if (size == 0)
+        bytes = "";
+
+    writer_grow_data_slots(writer);
+
+    uint32_t mask = writer->num_data_slots - 1;
+    uint32_t i = hash_bytes(bytes, size) & mask;
+    while (writer->data_slots[i] != 0)
+    {
+        uint32_t offset = writer->data_slots[i];
+        if (data_item_size(writer->data, offset) == size
+                && memcmp(writer->data + offset + sizeof(uint32_t), bytes, size) == 0)
+            return offset;
+        i = (i + 1) & mask;
+    }
+
+    // size, bytes and NUL padded to 4 bytes
+    uint32_t item_size = (sizeof(uint32_t) + size + 1 + 3) & ~3u;
+    writer_grow_data(writer, item_size);
+
+    uint32_t offset = writer->data_size;
+    memset(writer->data + offset, 0, item_size);
+    memcpy(writer->data + offset, &size, sizeof(size));
+    memcpy(writer->data + offset + sizeof(uint32_t), bytes, size);
+    writer->data_size += item_size;
+
+    writer->data_slots[i] = offset;
+    writer->num_data_used++;
+
+    return offset;
+}
+
+module_image_writer_t* module_image_writer_new(int num_tables)
+{
+    module_image_writer_t* writer = NEW0(module_image_writer_t);
+
+    writer->num_tables = num_tables;
+    writer->tables = NEW_VEC0(module_image_writer_table_t, num_tables);
+
+    // Offset 0 is reserved for NULL
+    writer->data_capacity = 4096;
+    writer->data = NEW_VEC0(char, writer->data_capacity);
+    writer->data_size = 8;
+
+    writer->num_data_slots = 1024;
+    writer->data_slots = NEW_VEC0(uint32_t, writer->num_data_slots);
+
+    return writer;
+}
+
+static void writer_table_add_cell(module_image_writer_table_t* t, uint32_t cell)
+{
+    if (t->num_cells == t->capacity_cells)
+    {
+        t->capacity_cells = (t->capacity_cells == 0) ? 64 : 2 * t->capacity_cells;
+        t->cells = NEW_REALLOC(uint32_t, t->cells, t->capacity_cells);
+    }
+    t->cells[t->num_cells] = cell;
+    t->num_cells++;
+}
+
+void module_image_writer_add_table(module_image_writer_t* writer,
+        int table,
+        sqlite3* handle,
+        const char* query)
+{
+    ERROR_CONDITION(table < 0 || table >= writer->num_tables, "Invalid table %d", table);
+    module_image_writer_table_t* t = &writer->tables[table];
+
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(handle, query, -1, &stmt, NULL) != SQLITE_OK)
+    {
+        internal_error("An error happened while preparing statement '%s' %s\n",
+                query, sqlite3_errmsg(handle));
+    }
+
+    // The key is not a cell
+    t->num_columns = sqlite3_column_count(stmt) - 1;
+    ERROR_CONDITION(t->num_columns < 0, "The query must have a key column", 0);
+
+    t->column_names = NEW_VEC0(uint32_t, t->num_columns + 1);
+    int i;
+    for (i = 0; i < t->num_columns; i++)
+    {
+        const char* name = sqlite3_column_name(stmt, i + 1);
+        t->column_names[i] = writer_add_data(writer, name, strlen(name));
+    }
+
+    int result_query;
+    while ((result_query = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        uint64_t key = (uint64_t)sqlite3_column_int64(stmt, 0);
+
+        if (t->num_keys == 0
+                || t->keys[t->num_keys - 1].key != key)
+        {
+            ERROR_CONDITION(t->num_keys > 0
+                    && (int64_t)t->keys[t->num_keys - 1].key > (int64_t)key,
+                    "Query '%s' is not sorted by its key", query);
+
+            if (t->num_keys == t->capacity_keys)
+            {
+                t->capacity_keys = (t->capacity_keys == 0) ? 64 : 2 * t->capacity_keys;
+                t->keys = NEW_REALLOC(module_image_key_t, t->keys, t->capacity_keys);
+            }
+            t->keys[t->num_keys].key = key;
+            t->keys[t->num_keys].first_row = t->num_rows;
+            t->keys[t->num_keys].num_rows = 0;
+            t->num_keys++;
+        }
+        t->keys[t->num_keys - 1].num_rows++;
+
+        for (i = 0; i < t->num_columns; i++)
+        {
+            uint32_t cell = 0;
+            int column_type = sqlite3_column_type(stmt, i + 1);
+            if (column_type == SQLITE_BLOB)
+            {
+                cell = writer_add_data(writer,
+                        sqlite3_column_blob(stmt, i + 1),
+                        sqlite3_column_bytes(stmt, i + 1));
+            }
+            else if (column_type != SQLITE_NULL)
+            {
+                const unsigned char* text = sqlite3_column_text(stmt, i + 1);
+                cell = writer_add_data(writer, text, sqlite3_column_bytes(stmt, i + 1));
+            }
+
+            writer_table_add_cell(t, cell);
+        }
+        t->num_rows++;
+    }
+
+    if (result_query != SQLITE_DONE)
+    {
+        internal_error("Unexpected error %d when running query '%s' (%s)",
+                result_query, query, sqlite3_errmsg(handle));
+    }
+
+    sqlite3_finalize(stmt);
+}
+
+static void write_or_die(FILE* f, const void* p, size_t size, const char* filename)
+{
+    if (size != 0
+            && fwrite(p, size, 1, f) != 1)
+    {
+        fatal_error("Error while writing module image '%s' (%s)\n", filename, strerror(errno));
+    }
+}
+
+void module_image_writer_finish(module_image_writer_t* writer,
+        const char* filename)
+{
+    module_image_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, module_image_magic, sizeof(header.magic));
+    header.format_version = MODULE_IMAGE_FORMAT_VERSION;
+    header.num_tables = writer->num_tables;
+
+    module_image_table_header_t table_headers[writer->num_tables + 1];
+    memset(table_headers, 0, sizeof(table_headers));
+
+    // Compute the layout, keys are 8 bytes aligned
+    uint64_t offset = sizeof(header) + writer->num_tables * sizeof(module_image_table_header_t);
+    int i;
+    for (i = 0; i < writer->num_tables; i++)
+    {
+        module_image_writer_table_t* t = &writer->tables[i];
+        module_image_table_header_t* th = &table_headers[i];
+
+        th->num_columns = t->num_columns;
+        th->num_keys = t->num_keys;
+        th->num_rows = t->num_rows;
+
+        offset = (offset + 7) & ~(uint64_t)7;
+        th->keys_offset = offset;
+        offset += t->num_keys * sizeof(module_image_key_t);
+
+        th->column_names_offset = offset;
+        offset += t->num_columns * sizeof(uint32_t);
+
+        th->cells_offset = offset;
+        offset += (uint64_t)t->num_rows * t->num_columns * sizeof(uint32_t);
+    }
+    offset = (offset + 7) & ~(uint64_t)7;
+    header.data_offset = offset;
+    header.data_size = writer->data_size;
+
+    ERROR_CONDITION(offset + writer->data_size > UINT32_MAX,
+            "Module image '%s' is too large", filename);
+
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL)
+    {
+        fatal_error("Error while creating module image '%s' (%s)\n", filename, strerror(errno));
+    }
+
+    static const char padding[8];
+    uint64_t written = 0;
+#define WRITE(p, size) \
+    do { write_or_die(f, (p), (size), filename); written += (size); } while (0)
+#define ALIGN() \
+    WRITE(padding, ((written + 7) & ~(uint64_t)7) - written)
+
+    WRITE(&header, sizeof(header));
+    WRITE(table_headers, writer->num_tables * sizeof(module_image_table_header_t));
+    for (i = 0; i < writer->num_tables; i++)
+    {
+        module_image_writer_table_t* t = &writer->tables[i];
+        ALIGN();
+        WRITE(t->keys, t->num_keys * sizeof(module_image_key_t));
+        WRITE(t->column_names, t->num_columns * sizeof(uint32_t));
+        WRITE(t->cells, (uint64_t)t->num_rows * t->num_columns * sizeof(uint32_t));
+    }
+    ALIGN();
+    WRITE(writer->data, writer->data_size);
+#undef ALIGN
+#undef WRITE
+
+    if (fclose(f) != 0)
+    {
+        fatal_error("Error while writing module image '%s' (%s)\n", filename, strerror(errno));
+    }
+
+    for (i = 0; i < writer->num_tables; i++)
+    {
+        DELETE(writer->tables[i].column_names);
+        DELETE(writer->tables[i].keys);
+        DELETE(writer->tables[i].cells);
+    }
+    DELETE(writer->tables);
+    DELETE(writer->data);
+    DELETE(writer->data_slots);
+    DELETE(writer);
+}
+
+// Reader
+
+struct module_image_tag
+{
+    const char* base;
+    size_t size;
+
+    const module_image_header_t* header;
+    const module_image_table_header_t* tables;
+    char*** column_names;
+};
+
+static char image_range_is_valid(module_image_t* image, uint64_t offset, uint64_t size)
+{
+    return offset <= image->size
+        && size <= image->size - offset;
+}
+
+static const char* image_data(module_image_t* image, uint32_t offset)
+{
+    if (offset == 0)
+        return NULL;
+
+    ERROR_CONDITION(offset > image->header->data_size - sizeof(uint32_t),
+            "Invalid data offset %u in module image", offset);
+
+    // Skip the size
+    return image->base + image->header->data_offset + offset + sizeof(uint32_t);
+}
+
+static uint32_t image_data_size(module_image_t* image, uint32_t offset)
+{
+    if (offset == 0)
+        return 0;
+
+    const char* p = image_data(image, offset) - sizeof(uint32_t);
+    uint32_t size;
+    memcpy(&size, p, sizeof(size));
+    ERROR_CONDITION(size > image->header->data_size - offset - sizeof(uint32_t),
+            "Invalid data size %u in module image", size);
+
+    return size;
+}
+
+module_image_t* module_image_open(const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        fatal_error("Error while opening module '%s' (%s)\n", filename, strerror(errno));
+    }
+
+    struct stat s;
+    if (fstat(fd, &s) < 0)
+    {
+        fatal_error("Error while opening module '%s' (%s)\n", filename, strerror(errno));
+    }
+
+    char magic[sizeof(module_image_magic)];
+    if ((size_t)s.st_size < sizeof(module_image_header_t)
+            || read(fd, magic, sizeof(magic)) != (ssize_t)sizeof(magic)
+            || memcmp(magic, module_image_magic, sizeof(magic)) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void* addr = mmap(NULL, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        fatal_error("Error while mapping module '%s' in memory (%s)\n", filename, strerror(errno));
+    }
+
+    module_image_t* image = NEW0(module_image_t);
+    image->base = (const char*)addr;
+    image->size = s.st_size;
+    image->header = (const module_image_header_t*)image->base;
+
+    if (image->header->format_version != MODULE_IMAGE_FORMAT_VERSION)
+    {
+        fatal_error("Module file '%s' has an image format not supported by this version of Mercurium "
+                "(got version %d but expected version %d)\n",
+                filename, image->header->format_version, MODULE_IMAGE_FORMAT_VERSION);
+    }
+
+    uint32_t num_tables = image->header->num_tables;
+    if (!image_range_is_valid(image, sizeof(module_image_header_t),
+                (uint64_t)num_tables * sizeof(module_image_table_header_t))
+            || !image_range_is_valid(image, image->header->data_offset, image->header->data_size))
+    {
+        fatal_error("Module file '%s' is corrupted\n", filename);
+    }
+    image->tables = (const module_image_table_header_t*)(image->base + sizeof(module_image_header_t));
+
+    image->column_names = NEW_VEC0(char**, num_tables);
+    uint32_t i;
+    for (i = 0; i < num_tables; i++)
+    {
+        const module_image_table_header_t* th = &image->tables[i];
+        if (!image_range_is_valid(image, th->keys_offset,
+                    (uint64_t)th->num_keys * sizeof(module_image_key_t))
+                || !image_range_is_valid(image, th->column_names_offset,
+                    (uint64_t)th->num_columns * sizeof(uint32_t))
+                || !image_range_is_valid(image, th->cells_offset,
+                    (uint64_t)th->num_rows * th->num_columns * sizeof(uint32_t)))
+        {
+            fatal_error("Module file '%s' is corrupted\n", filename);
+        }
+
+        const uint32_t* names = (const uint32_t*)(image->base + th->column_names_offset);
+        image->column_names[i] = NEW_VEC0(char*, th->num_columns + 1);
+        uint32_t j;
+        for (j = 0; j < th->num_columns; j++)
+        {
+            image->column_names[i][j] = (char*)image_data(image, names[j]);
+        }
+    }
+
+    return image;
+}
+
+void module_image_close(module_image_t* image)
+{
+    uint32_t i;
+    for (i = 0; i < image->header->num_tables; i++)
+    {
+        DELETE(image->column_names[i]);
+    }
+    DELETE(image->column_names);
+
+    munmap((void*)image->base, image->size);
+    DELETE(image);
+}
+
+static const module_image_table_header_t* image_table(module_image_t* image, int table)
+{
+    ERROR_CONDITION(table < 0 || (uint32_t)table >= image->header->num_tables,
+            "Invalid table %d", table);
+    return &image->tables[table];
+}
+
+int module_image_get_num_columns(module_image_t* image, int table)
+{
+    return image_table(image, table)->num_columns;
+}
+
+char** module_image_get_column_names(module_image_t* image, int table)
+{
+    image_table(image, table);
+    return image->column_names[table];
+}
+
+int module_image_find_rows(module_image_t* image, int table, uint64_t key, int* first_row)
+{
+    const module_image_table_header_t* th = image_table(image, table);
+    const module_image_key_t* keys = (const module_image_key_t*)(image->base + th->keys_offset);
+
+    int lower = 0, upper = (int)th->num_keys - 1;
+    while (lower <= upper)
+    {
+        int middle = lower + (upper - lower) / 2;
+        if (keys[middle].key == key)
+        {
+            *first_row = keys[middle].first_row;
+            return keys[middle].num_rows;
+        }
+        else if ((int64_t)keys[middle].key < (int64_t)key)
+            lower = middle + 1;
+        else
+            upper = middle - 1;
+    }
+
+    *first_row = 0;
+    return 0;
+}
+
+int module_image_get_num_rows(module_image_t* image, int table)
+{
+    return image_table(image, table)->num_rows;
+}
+
+void module_image_get_row(module_image_t* image, int table, int row, char** values)
+{
+    const module_image_table_header_t* th = image_table(image, table);
+    ERROR_CONDITION(row < 0 || (uint32_t)row >= th->num_rows, "Invalid row %d", row);
+
+    const uint32_t* cells = (const uint32_t*)(image->base + th->cells_offset)
+        + (uint64_t)row * th->num_columns;
+    uint32_t i;
+    for (i = 0; i < th->num_columns; i++)
+    {
+        values[i] = (char*)image_data(image, cells[i]);
+    }
+}
+
+static uint32_t image_cell(module_image_t* image, int table, int row, int column)
+{
+    const module_image_table_header_t* th = image_table(image, table);
+    ERROR_CONDITION(row < 0 || (uint32_t)row >= th->num_rows, "Invalid row %d", row);
+    ERROR_CONDITION(column < 0 || (uint32_t)column >= th->num_columns, "Invalid column %d", column);
+
+    const uint32_t* cells = (const uint32_t*)(image->base + th->cells_offset)
+        + (uint64_t)row * th->num_columns;
+    return cells[column];
+}
+
+const void* module_image_get_cell(module_image_t* image, int table, int row, int column)
+{
+    return image_data(image, image_cell(image, table, row, column));
+}
+
+int module_image_get_cell_size(module_image_t* image, int table, int row, int column)
+{
+    return image_data_size(image, image_cell(image, table, row, column));
+}
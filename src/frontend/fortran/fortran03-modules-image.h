@@ -0,0 +1,85 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#ifndef FORTRAN03_MODULES_IMAGE_H
+#define FORTRAN03_MODULES_IMAGE_H
+
+#include "cxx-macros.h"
+#include <stdint.h>
+#include <sqlite3.h>
+
+MCXX_BEGIN_DECLS
+
+// Binary image of a module database meant to be mapped in memory.
+//
+// It is a set of tables. Every row of a table has the same number of
+// columns and is identified by a 64-bit key. Several rows can share a key.
+// Cells are either NULL or point into a data area shared by all the tables
+// where each distinct byte string is stored once.
+
+typedef struct module_image_writer_tag module_image_writer_t;
+typedef struct module_image_tag module_image_t;
+
+module_image_writer_t* module_image_writer_new(int num_tables);
+
+// Stores the result of query as the given table. The first column of the
+// query is the key and the remaining ones are the cells of the row. The
+// query must be sorted by the key
+void module_image_writer_add_table(module_image_writer_t* writer,
+        int table,
+        sqlite3* handle,
+        const char* query);
+
+// Writes the image to filename and frees the writer
+void module_image_writer_finish(module_image_writer_t* writer,
+        const char* filename);
+
+// Returns NULL if filename is not a module image
+module_image_t* module_image_open(const char* filename);
+void module_image_close(module_image_t* image);
+
+int module_image_get_num_columns(module_image_t* image, int table);
+// Like the column names of a SQL query, used to find the columns by name
+char** module_image_get_column_names(module_image_t* image, int table);
+
+// Returns the number of rows of the key and the index of the first one
+int module_image_find_rows(module_image_t* image, int table, uint64_t key, int* first_row);
+// The number of rows of the table, regardless of their key
+int module_image_get_num_rows(module_image_t* image, int table);
+
+// Fills values with the cells of the row, NULL cells are NULL. The
+// strings are kept in the image and must not be modified
+void module_image_get_row(module_image_t* image, int table, int row, char** values);
+
+// The cell of the row at the given column, it may be a binary blob
+const void* module_image_get_cell(module_image_t* image, int table, int row, int column);
+// The size in bytes of that cell, not counting the trailing NUL
+int module_image_get_cell_size(module_image_t* image, int table, int row, int column);
+
+MCXX_END_DECLS
+
+#endif // FORTRAN03_MODULES_IMAGE_H
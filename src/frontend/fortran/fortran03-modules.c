@@ -30,6 +30,7 @@
 
 #include "fortran03-modules.h"
 #include "fortran03-modules-data.h"
+#include "fortran03-modules-image.h"
 #include "fortran03-buildscope.h"
 #include "cxx-limits.h"
 #include "cxx-utils.h"
@@ -49,6 +50,7 @@
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #ifdef Q
  #error Q cannot be defined here
@@ -68,9 +70,10 @@ enum { CURRENT_MODULE_VERSION = 22 };
   #define Q "%Q"
 #endif
 
-static void create_storage(sqlite3**, scope_entry_t*);
+static void create_storage(sqlite3**, scope_entry_t*, const char** filename);
 static void init_storage(sqlite3*);
 static void dispose_storage(sqlite3*);
+static void finalize_statements(void);
 static void prepare_statements(sqlite3*);
 
 static void start_transaction(sqlite3*);
@@ -123,6 +126,7 @@ static sqlite3_uint64 insert_type(sqlite3* handle, type_t* t);
 
 static type_t* load_type(sqlite3* handle, sqlite3_uint64 oid);
 static scope_entry_t* load_symbol(sqlite3* handle, sqlite3_uint64 oid);
+static scope_entry_t* load_symbol_stub(sqlite3* handle, sqlite3_uint64 oid);
 static AST load_ast(sqlite3* handle, sqlite3_uint64 oid);
 static nodecl_t load_nodecl(sqlite3* handle, sqlite3_uint64 oid);
 
@@ -133,6 +137,7 @@ struct module_info_tag module_info_t;
 
 static void get_module_info(sqlite3* handle, module_info_t* minfo);
 static void finish_module_file(sqlite3* handle, const char* module_name, sqlite3_uint64 module_symbol);
+static void write_module_image(sqlite3* handle, const char* filename);
 
 static sqlite3_uint64 insert_ast(sqlite3* handle, AST a);
 static sqlite3_uint64 insert_const_value(sqlite3* handle, const_value_t* value);
@@ -335,6 +340,91 @@ static sqlite3_uint64 module_oid_being_loaded = 0;
 
 static rb_red_blk_tree * _oid_map = NULL;
 
+// Non-NULL while loading a module stored as a module image, in this case
+// there is no SQLite handle
+static module_image_t* _module_image = NULL;
+
+// The members of a module loaded from a module image are stubs with only
+// their name, kind, locus, access and packed bits. They are materialized
+// from the image, which stays mapped, when they are first referenced
+typedef
+struct lazy_module_tag
+{
+    const char* filename;
+    scope_entry_t* module;
+
+    module_image_t* image;
+    rb_red_blk_tree* oid_map;
+
+    // Entry of the cross-file cache holding this module, if any
+    struct module_cache_entry_tag* cache_entry;
+
+    int num_entities;
+    int num_materialized;
+} lazy_module_t;
+
+typedef
+struct lazy_symbol_tag
+{
+    sqlite3_uint64 oid;
+    lazy_module_t* lazy_module;
+} lazy_symbol_t;
+
+// Stubs not materialized yet, indexed by their symbol
+static rb_red_blk_tree * _lazy_symbols = NULL;
+
+static int _num_lazy_modules = 0;
+static lazy_module_t** _lazy_modules = NULL;
+
+// Non-NULL while loading the members of a module as stubs
+static lazy_module_t* _current_lazy_module = NULL;
+
+// SQLite databases of the module images written by the file being compiled,
+// indexed by the filename of the module. extend_module_info adds data to them
+static rb_red_blk_tree * _module_databases = NULL;
+
+static sqlite3* get_module_database(const char* filename);
+static void register_module_database(const char* filename, sqlite3* handle);
+
+// Modules loaded by previous files compiled by this process, indexed by the
+// filename of the module. A USE copies the symbols of the module, so the
+// loaded symbols can be shared by several files while the module file does
+// not change. Writing or extending a module drops its entry.
+//
+// Array, class and enum types and default arguments of the loaded symbols
+// keep the global context of the file that loaded them, because the module
+// does not store one. Translation units are never freed and Fortran never
+// looks names up in those contexts (class members are looked up in the inner
+// context loaded from the module) so other files can share them
+typedef
+struct module_cache_entry_tag
+{
+    const char* filename;
+
+    // Identity of the module file when it was loaded
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    long mtime_nsec;
+    off_t size;
+
+    scope_entry_t* module;
+
+    // Every module reached when loading the module, including itself, and
+    // when materializing its stubs afterwards
+    int num_modules;
+    scope_entry_t** modules;
+} module_cache_entry_t;
+
+static rb_red_blk_tree * _module_cache = NULL;
+
+// Modules reached while loading a module
+static int _num_loaded_modules = 0;
+static scope_entry_t** _loaded_modules = NULL;
+
+static void module_cache_invalidate(const char* filename);
+static scope_entry_t* load_module_from_file(const char* module_name, const char* filename);
+
 void dump_module_info(scope_entry_t* module)
 {
     ERROR_CONDITION(module->kind != SK_MODULE, "Invalid symbol!", 0);
@@ -353,7 +443,8 @@ void dump_module_info(scope_entry_t* module)
     timing_start(&timing_dump_module);
 
     sqlite3* handle = NULL;
-    create_storage(&handle, module);
+    const char* filename = NULL;
+    create_storage(&handle, module, &filename);
 
     start_transaction(handle);
 
@@ -367,7 +458,20 @@ void dump_module_info(scope_entry_t* module)
 
     end_transaction(handle);
 
-    dispose_storage(handle);
+    if (debug_options.sqlite_module_files)
+    {
+        dispose_storage(handle);
+    }
+    else
+    {
+        write_module_image(handle, filename);
+
+        // Keep the database in case this module is extended later
+        finalize_statements();
+        register_module_database(filename, handle);
+    }
+
+    module_cache_invalidate(filename);
 
     timing_end(&timing_dump_module);
 
@@ -420,6 +524,202 @@ static void load_storage(sqlite3** handle, const char* filename)
     _oid_map = rb_tree_create(int64cmp_vptr, null_dtor_func, null_dtor_func);
 }
 
+static int module_database_cmp(const void* a, const void* b)
+{
+    return strcmp((const char*)a, (const char*)b);
+}
+
+static sqlite3* get_module_database(const char* filename)
+{
+    if (_module_databases == NULL)
+        return NULL;
+
+    rb_red_blk_node* n = rb_tree_query(_module_databases, filename);
+    if (n == NULL)
+        return NULL;
+
+    return (sqlite3*)rb_node_get_info(n);
+}
+
+static void register_module_database(const char* filename, sqlite3* handle)
+{
+    if (_module_databases == NULL)
+    {
+        _module_databases = rb_tree_create(module_database_cmp, null_dtor_func, null_dtor_func);
+    }
+
+    // The module may have been written again
+    sqlite3* previous_handle = get_module_database(filename);
+    if (previous_handle != NULL)
+    {
+        sqlite3_close(previous_handle);
+    }
+
+    rb_tree_insert(_module_databases, filename, handle);
+}
+
+static void close_module_database(const void* key UNUSED_PARAMETER,
+        void* info,
+        void* data UNUSED_PARAMETER)
+{
+    sqlite3_close((sqlite3*)info);
+}
+
+void fortran_close_module_databases(void)
+{
+    if (_module_databases == NULL)
+        return;
+
+    rb_tree_walk(_module_databases, close_module_database, NULL);
+    rb_tree_destroy(_module_databases);
+    _module_databases = NULL;
+}
+
+static long stat_mtime_nsec(const struct stat* s)
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    return s->st_mtim.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+// A module rewritten within the same second may keep its size, so the
+// nanoseconds and the inode (a new file renamed over the old one) are
+// checked too
+static char module_cache_entry_is_current(module_cache_entry_t* entry, const struct stat* s)
+{
+    return s->st_dev == entry->dev
+        && s->st_ino == entry->ino
+        && s->st_mtime == entry->mtime
+        && stat_mtime_nsec(s) == entry->mtime_nsec
+        && s->st_size == entry->size;
+}
+
+static void module_cache_invalidate(const char* filename)
+{
+    if (_module_cache == NULL)
+        return;
+
+    rb_red_blk_node* n = rb_tree_query(_module_cache, filename);
+    if (n != NULL)
+    {
+        rb_tree_delete(_module_cache, n);
+    }
+}
+
+static void note_loaded_module(scope_entry_t* module)
+{
+    int i;
+    for (i = 0; i < _num_loaded_modules; i++)
+    {
+        if (_loaded_modules[i] == module)
+            return;
+    }
+
+    P_LIST_ADD(_loaded_modules, _num_loaded_modules, module);
+}
+
+static scope_entry_t* module_cache_get(const char* filename)
+{
+    if (_module_cache == NULL)
+        return NULL;
+
+    rb_red_blk_node* n = rb_tree_query(_module_cache, filename);
+    if (n == NULL)
+        return NULL;
+
+    module_cache_entry_t* entry = (module_cache_entry_t*)rb_node_get_info(n);
+
+    struct stat s;
+    if (stat(filename, &s) != 0
+            || !module_cache_entry_is_current(entry, &s))
+    {
+        rb_tree_delete(_module_cache, n);
+        return NULL;
+    }
+
+    // The loaded symbols refer to the modules that were in the cache of the
+    // file that loaded them, like the intrinsic modules. If this file has
+    // other symbols for them we cannot share
+    int i;
+    for (i = 0; i < entry->num_modules; i++)
+    {
+        rb_red_blk_node* query = rb_tree_query(CURRENT_COMPILED_FILE->module_file_cache,
+                strtolower(entry->modules[i]->symbol_name));
+        if (query != NULL
+                && rb_node_get_info(query) != entry->modules[i])
+        {
+            DEBUG_CODE()
+            {
+                fprintf(stderr, "FORTRAN-MODULES: Module '%s' of cached file '%s' is not the one of this file\n",
+                        entry->modules[i]->symbol_name, filename);
+            }
+            return NULL;
+        }
+    }
+
+    for (i = 0; i < entry->num_modules; i++)
+    {
+        rb_tree_insert(CURRENT_COMPILED_FILE->module_file_cache,
+                strtolower(entry->modules[i]->symbol_name),
+                entry->modules[i]);
+    }
+
+    return entry->module;
+}
+
+static module_cache_entry_t* module_cache_add(const char* filename, scope_entry_t* module)
+{
+    struct stat s;
+    if (stat(filename, &s) != 0)
+        return NULL;
+
+    if (_module_cache == NULL)
+    {
+        _module_cache = rb_tree_create(module_database_cmp, null_dtor_func, null_dtor_func);
+    }
+
+    module_cache_entry_t* entry = NEW0(module_cache_entry_t);
+    entry->filename = uniquestr(filename);
+    entry->dev = s.st_dev;
+    entry->ino = s.st_ino;
+    entry->mtime = s.st_mtime;
+    entry->mtime_nsec = stat_mtime_nsec(&s);
+    entry->size = s.st_size;
+    entry->module = module;
+    entry->num_modules = _num_loaded_modules;
+    entry->modules = NEW_VEC(scope_entry_t*, _num_loaded_modules);
+    memcpy(entry->modules, _loaded_modules, _num_loaded_modules * sizeof(*entry->modules));
+
+    rb_tree_insert(_module_cache, entry->filename, entry);
+
+    return entry;
+}
+
+// Materializing a stub may reach modules through the module cache of the
+// file being compiled. Files reusing the entry must check them as well
+static void module_cache_entry_add_modules(module_cache_entry_t* entry,
+        int num_modules,
+        scope_entry_t** modules)
+{
+    int i;
+    for (i = 0; i < num_modules; i++)
+    {
+        char found = 0;
+        int j;
+        for (j = 0; j < entry->num_modules && !found; j++)
+        {
+            found = (entry->modules[j] == modules[i]);
+        }
+
+        if (!found)
+        {
+            P_LIST_ADD(entry->modules, entry->num_modules, modules[i]);
+        }
+    }
+}
+
 void load_module_info(const char* module_name, scope_entry_t** module)
 {
     DEBUG_CODE()
@@ -450,6 +750,34 @@ void load_module_info(const char* module_name, scope_entry_t** module)
                 module_name);
     }
 
+    *module = module_cache_get(filename);
+    if (*module != NULL)
+    {
+        if (CURRENT_CONFIGURATION->verbose)
+        {
+            fprintf(stderr, "Module '%s' reused from a previous file\n", module_name);
+        }
+    }
+    else
+    {
+        *module = load_module_from_file(module_name, filename);
+    }
+
+    if (module != NULL
+            && wrap_filename != NULL)
+    {
+        if (!symbol_entity_specs_get_is_builtin((*module)))
+        {
+            P_LIST_ADD(CURRENT_COMPILED_FILE->module_files_to_hide,
+                    CURRENT_COMPILED_FILE->num_module_files_to_hide,
+                    wrap_filename);
+        }
+    }
+
+}
+
+static scope_entry_t* load_module_from_file(const char* module_name, const char* filename)
+{
     if (CURRENT_CONFIGURATION->verbose)
     {
         fprintf(stderr, "Loading module '%s'\n", module_name);
@@ -459,8 +787,26 @@ void load_module_info(const char* module_name, scope_entry_t** module)
     timing_start(&timing_load_module);
 
     sqlite3* handle = NULL;
+    scope_entry_t* module = NULL;
 
-    load_storage(&handle, filename);
+    // Modules written by older versions of Mercurium are SQLite databases
+    _module_image = module_image_open(filename);
+    if (_module_image != NULL)
+    {
+        _oid_map = rb_tree_create(int64cmp_vptr, null_dtor_func, null_dtor_func);
+
+        if (!debug_options.eager_module_loading)
+        {
+            _current_lazy_module = NEW0(lazy_module_t);
+            _current_lazy_module->filename = uniquestr(filename);
+            _current_lazy_module->image = _module_image;
+            _current_lazy_module->oid_map = _oid_map;
+        }
+    }
+    else
+    {
+        load_storage(&handle, filename);
+    }
 
     module_info_t minfo;
     memset(&minfo, 0, sizeof(minfo));
@@ -473,19 +819,47 @@ void load_module_info(const char* module_name, scope_entry_t** module)
                 filename, minfo.version, CURRENT_MODULE_VERSION);
     }
 
-    prepare_statements(handle);
+    if (_module_image == NULL)
+    {
+        prepare_statements(handle);
 
-    start_transaction(handle);
+        start_transaction(handle);
+    }
+
+    _num_loaded_modules = 0;
 
     module_oid_being_loaded = minfo.module_oid;
-    *module = load_symbol(handle, minfo.module_oid);
+    module = load_symbol(handle, minfo.module_oid);
     module_oid_being_loaded = 0;
 
-    load_extra_data_from_module(handle, *module);
+    load_extra_data_from_module(handle, module);
 
-    end_transaction(handle);
+    module_cache_entry_t* cache_entry = module_cache_add(filename, module);
 
-    dispose_storage(handle);
+    lazy_module_t* lazy_module = _current_lazy_module;
+    _current_lazy_module = NULL;
+
+    if (lazy_module != NULL
+            && lazy_module->num_entities > 0)
+    {
+        // Keep the image mapped until the stubs are materialized
+        lazy_module->module = module;
+        lazy_module->cache_entry = cache_entry;
+        P_LIST_ADD(_lazy_modules, _num_lazy_modules, lazy_module);
+        _module_image = NULL;
+    }
+    else if (_module_image != NULL)
+    {
+        DELETE(lazy_module);
+        module_image_close(_module_image);
+        _module_image = NULL;
+    }
+    else
+    {
+        end_transaction(handle);
+
+        dispose_storage(handle);
+    }
 
     timing_end(&timing_load_module);
 
@@ -496,40 +870,46 @@ void load_module_info(const char* module_name, scope_entry_t** module)
                 timing_elapsed(&timing_load_module));
     }
 
-    if (module != NULL
-            && wrap_filename != NULL)
-    {
-        if (!symbol_entity_specs_get_is_builtin((*module)))
-        {
-            P_LIST_ADD(CURRENT_COMPILED_FILE->module_files_to_hide,
-                    CURRENT_COMPILED_FILE->num_module_files_to_hide,
-                    wrap_filename);
-        }
-    }
-
+    return module;
 }
 
-static void create_storage(sqlite3** handle, scope_entry_t* module)
+static void create_storage(sqlite3** handle, scope_entry_t* module, const char** filename)
 {
-    const char* filename = NULL;
-    driver_fortran_register_module(module->symbol_name, &filename, 
+    driver_fortran_register_module(module->symbol_name, filename, 
             /* is_intrinsic */ symbol_entity_specs_get_is_builtin(module));
 
     DEBUG_CODE()
     {
-        fprintf(stderr, "FORTRAN-MODULES: File used will be '%s'\n", filename);
+        fprintf(stderr, "FORTRAN-MODULES: File used will be '%s'\n", *filename);
+    }
+
+    // The database is only used to build the module image, so unless we
+    // want to inspect it, it is kept in memory
+    const char* database_filename = ":memory:";
+    if (debug_options.sqlite_module_files)
+    {
+        // The database is the module file, as in older versions
+        database_filename = *filename;
+    }
+    else if (debug_options.keep_module_database)
+    {
+        uniquestr_sprintf(&database_filename, "%s.sqlite", *filename);
     }
 
-    // Make sure the file has been removed
-    if (access(filename, F_OK) == 0)
+    if (strcmp(database_filename, ":memory:") != 0)
     {
-        if (remove(filename) != 0)
+        // Make sure the file has been removed
+        if (access(database_filename, F_OK) == 0)
         {
-            fatal_error("Error while removing old module '%s' (%s)\n", filename, strerror(errno));
+            if (remove(database_filename) != 0)
+            {
+                fatal_error("Error while removing old module database '%s' (%s)\n",
+                        database_filename, strerror(errno));
+            }
         }
     }
 
-    load_storage(handle, filename);
+    load_storage(handle, database_filename);
 }
 
 static int run_select_query(sqlite3* handle, const char* query, 
@@ -862,6 +1242,101 @@ static void init_storage(sqlite3* handle)
     _oid_map = rb_tree_create(int64cmp_vptr, null_dtor_func, null_dtor_func);
 }
 
+// Tables of a module image. Their rows are the same as the ones returned by
+// the SELECT statements used when loading from a SQLite database
+enum module_image_table_tag
+{
+    MIT_INFO = 0,
+    MIT_SYMBOL,
+    MIT_ATTRIBUTES,
+    MIT_SCOPE,
+    MIT_DECL_CONTEXT,
+    MIT_AST,
+    MIT_TYPE,
+    MIT_CONST_VALUE,
+    MIT_RAW_CONST_VALUE,
+    MIT_MULTI_CONST_VALUE,
+    MIT_MODULE_EXTRA_NAME,
+    MIT_MODULE_EXTRA_DATA,
+    MIT_NUM_TABLES
+};
+
+static void write_module_image(sqlite3* handle, const char* filename)
+{
+    module_image_writer_t* writer = module_image_writer_new(MIT_NUM_TABLES);
+
+    // The first column is the key of the row
+    module_image_writer_add_table(writer, MIT_INFO, handle,
+            "SELECT 0, module, date, version, build, root_symbol FROM info LIMIT 1;");
+
+    char* symbol_query = sqlite3_mprintf(
+            "SELECT s.oid, s.oid, decl_context, str1.string AS name, str2.string AS kind, type, str3.string AS file, line,"
+            " value, bit_entity_specs, related_decl_context, %s "
+            "FROM symbol s, string_table str1, string_table str2, string_table str3 "
+            "WHERE str1.oid = s.name AND str2.oid = s.kind AND str3.oid = s.file ORDER BY s.oid;",
+            attr_field_names);
+    module_image_writer_add_table(writer, MIT_SYMBOL, handle, symbol_query);
+    sqlite3_free(symbol_query);
+
+    module_image_writer_add_table(writer, MIT_ATTRIBUTES, handle,
+            "SELECT a.symbol, str.string AS name, a.value FROM attributes a, string_table str "
+            "WHERE a.name = str.oid ORDER BY a.symbol, a.oid;");
+    module_image_writer_add_table(writer, MIT_SCOPE, handle,
+            "SELECT oid, oid, kind, contained_in, related_entry FROM scope ORDER BY oid;");
+    module_image_writer_add_table(writer, MIT_DECL_CONTEXT, handle,
+            "SELECT oid, oid, " DECL_CONTEXT_FIELDS " FROM decl_context ORDER BY oid;");
+    module_image_writer_add_table(writer, MIT_AST, handle,
+            "SELECT a.oid, a.oid, str0.string AS kind, str1.string AS file, a.line, str2.string AS text, a.ast0, a.ast1, a.ast2, a.ast3, "
+            "a.type, a.symbol, a.is_lvalue, a.is_const_val, a.const_val, a.is_value_dependent "
+            "FROM ast a, string_table str0, string_table str1, string_table str2 "
+            "WHERE a.kind = str0.oid AND a.file = str1.oid AND a.text = str2.oid ORDER BY a.oid;");
+    module_image_writer_add_table(writer, MIT_TYPE, handle,
+            "SELECT oid, oid, kind, cv_qualifier, kind_size, ast0, ast1, ref_type, "
+            "types, symbols FROM type ORDER BY oid;");
+    module_image_writer_add_table(writer, MIT_CONST_VALUE, handle,
+            "SELECT oid, kind, raw_oid, struct_type FROM const_value ORDER BY oid;");
+    module_image_writer_add_table(writer, MIT_RAW_CONST_VALUE, handle,
+            "SELECT oid, raw_bytes FROM raw_const_value ORDER BY oid;");
+    module_image_writer_add_table(writer, MIT_MULTI_CONST_VALUE, handle,
+            "SELECT oid_object, oid_part FROM multi_const_value ORDER BY oid_object, oid;");
+    module_image_writer_add_table(writer, MIT_MODULE_EXTRA_NAME, handle,
+            "SELECT 0, oid, name FROM module_extra_name ORDER BY oid;");
+    module_image_writer_add_table(writer, MIT_MODULE_EXTRA_DATA, handle,
+            "SELECT oid_name, kind, value FROM module_extra_data ORDER BY oid_name, order_;");
+
+    // Readers never see a partially written module
+    const char* temporary_filename = NULL;
+    uniquestr_sprintf(&temporary_filename, "%s.%d.tmp", filename, (int)getpid());
+    module_image_writer_finish(writer, temporary_filename);
+
+    if (rename(temporary_filename, filename) != 0)
+    {
+        fatal_error("Error while renaming module '%s' to '%s' (%s)\n",
+                temporary_filename, filename, strerror(errno));
+    }
+}
+
+// Calls fun for every row of the table with this key, like
+// run_select_query_prepared does for every row of a SELECT
+static void run_image_query(int table, sqlite3_uint64 key,
+        int (*fun)(void* datum, int ncols, char** values, char **names),
+        void *datum)
+{
+    int first_row = 0;
+    int num_rows = module_image_find_rows(_module_image, table, key, &first_row);
+
+    int ncols = module_image_get_num_columns(_module_image, table);
+    char** names = module_image_get_column_names(_module_image, table);
+
+    char* values[ncols + 1];
+    int i;
+    for (i = first_row; i < first_row + num_rows; i++)
+    {
+        module_image_get_row(_module_image, table, i, values);
+        fun(datum, ncols, values, names);
+    }
+}
+
 static int get_module_info_(void *datum, 
         int ncols UNUSED_PARAMETER, 
         char **values, 
@@ -879,6 +1354,12 @@ static int get_module_info_(void *datum,
 
 static void get_module_info(sqlite3* handle, module_info_t* minfo)
 {
+    if (_module_image != NULL)
+    {
+        run_image_query(MIT_INFO, 0, get_module_info_, minfo);
+        return;
+    }
+
     const char * module_info_query = "SELECT module, date, version, build, root_symbol FROM info LIMIT 1;";
 
     char* errmsg = NULL;
@@ -1556,6 +2037,20 @@ static int get_extra_syms(void *datum,
     return 0;
 }
 
+static int get_extra_stub_syms(void *datum, 
+        int ncols UNUSED_PARAMETER,
+        char **values, 
+        char **names UNUSED_PARAMETER)
+{
+    extra_syms_t* p = (extra_syms_t*)datum;
+
+    char *attr_value = values[0];
+
+    P_LIST_ADD(p->syms, p->num_syms, load_symbol_stub(p->handle, safe_atoull(attr_value)));
+
+    return 0;
+}
+
 static int get_extra_types(void *datum, 
         int ncols UNUSED_PARAMETER,
         char **values, 
@@ -1811,6 +2306,37 @@ static void get_extended_attribute(sqlite3* handle, sqlite3_uint64 oid, const ch
         void *extra_info,
         int (*get_extra_info_fun)(void *datum, int ncols, char **values, char **names))
 {
+    if (_module_image != NULL)
+    {
+        // The members of a module loaded lazily start as stubs
+        if (_current_lazy_module != NULL
+                && oid == module_oid_being_loaded
+                && get_extra_info_fun == get_extra_syms
+                && strcmp(attr_name, "related_symbols") == 0)
+        {
+            get_extra_info_fun = get_extra_stub_syms;
+        }
+
+        int first_row = 0;
+        int num_rows = module_image_find_rows(_module_image, MIT_ATTRIBUTES, oid, &first_row);
+
+        int ncols = module_image_get_num_columns(_module_image, MIT_ATTRIBUTES);
+        char** names = module_image_get_column_names(_module_image, MIT_ATTRIBUTES);
+
+        // The first column is the name of the attribute
+        char* values[ncols + 1];
+        int i;
+        for (i = first_row; i < first_row + num_rows; i++)
+        {
+            module_image_get_row(_module_image, MIT_ATTRIBUTES, i, values);
+            if (strcmp(values[0], attr_name) == 0)
+            {
+                get_extra_info_fun(extra_info, ncols - 1, values + 1, names + 1);
+            }
+        }
+        return;
+    }
+
     sqlite3_bind_int64(_get_extended_attr_stmt, 1, oid);
     sqlite3_bind_text (_get_extended_attr_stmt, 2, attr_name, -1, SQLITE_STATIC);
 
@@ -1925,6 +2451,9 @@ static sqlite3_uint64 insert_symbol(sqlite3* handle, scope_entry_t* symbol)
     if (symbol == NULL)
         return 0;
 
+    // A stub of a module member is written like any other symbol
+    materialize_module_symbol(symbol);
+
     if (oid_already_inserted_symbol(handle, symbol))
         return (sqlite3_uint64)(uintptr_t)symbol;
 
@@ -1951,8 +2480,8 @@ static sqlite3_uint64 insert_symbol(sqlite3* handle, scope_entry_t* symbol)
             get_oid_from_string_table(handle, symbol->symbol_name), // name
             get_oid_from_string_table(handle, symbol_kind_to_str(symbol->kind)), // kind
             type_id, // type
-            get_oid_from_string_table(handle, locus_get_filename(symbol->locus)), // file
-            locus_get_line(symbol->locus), // line
+            get_oid_from_string_table(handle, locus_get_filename(locus_from_id(symbol->locus))), // file
+            locus_get_line(locus_from_id(symbol->locus)), // line
             value_oid,
             bit_str,
             related_decl_context_oid,
@@ -1997,6 +2526,9 @@ typedef struct
 {
     sqlite3* handle;
     scope_entry_t* symbol;
+
+    // The stub being materialized, if any
+    scope_entry_t* stub;
 } symbol_handle_t;
 
 static nodecl_t load_nodecl(sqlite3* handle, sqlite3_uint64 oid);
@@ -2012,6 +2544,7 @@ static int get_symbol(void *datum,
 
     sqlite3* handle = symbol_handle->handle;
     scope_entry_t** result = &(symbol_handle->symbol);
+    scope_entry_t* stub = symbol_handle->stub;
 
     sqlite3_uint64 oid = safe_atoull(values[0]);
     sqlite3_uint64 decl_context_oid = safe_atoull(values[1]);
@@ -2033,8 +2566,10 @@ static int get_symbol(void *datum,
     // see below
     module_packed_bits_t packed_bits = module_packed_bits_from_hexstr(bitfield_pack_str);
 
-    // Early checks to use already loaded symbols
-    if (symbol_kind == SK_MODULE)
+    // Early checks to use already loaded symbols. A stub is already the
+    // loaded symbol
+    if (stub == NULL
+            && symbol_kind == SK_MODULE)
     {
         rb_red_blk_node* query = rb_tree_query(CURRENT_COMPILED_FILE->module_file_cache, strtolower(name));
         // Check if this symbol is in the cache and reuse it 
@@ -2044,6 +2579,7 @@ static int get_symbol(void *datum,
             scope_entry_t* module_symbol = (scope_entry_t*)rb_node_get_info(query);
             (*result) = module_symbol;
             insert_map_ptr(handle, oid, (*result));
+            note_loaded_module(module_symbol);
 
             if (oid != module_oid_being_loaded)
             {
@@ -2060,7 +2596,8 @@ static int get_symbol(void *datum,
 
     // Is this symbol in a module?
     int i;
-    if (query_contains_field(ncols, names, "in_module", &i))
+    if (stub == NULL
+            && query_contains_field(ncols, names, "in_module", &i))
     {
         // Get the module
         scope_entry_t* in_module = load_symbol(handle, safe_atoull(values[i]));
@@ -2081,9 +2618,12 @@ static int get_symbol(void *datum,
             for (i = 0; i < symbol_entity_specs_get_num_related_symbols(in_module); i++)
             {
                 scope_entry_t* member = symbol_entity_specs_get_related_symbols_num(in_module, i);
-                if (strcasecmp(member->symbol_name, name) == 0
-                        && member->kind == (enum cxx_symbol_kind)symbol_kind
-                        && symbol_entity_specs_get_from_module(member) == from_module
+                if (strcasecmp(member->symbol_name, name) != 0
+                        || member->kind != (enum cxx_symbol_kind)symbol_kind)
+                    continue;
+
+                materialize_module_symbol(member);
+                if (symbol_entity_specs_get_from_module(member) == from_module
                         && symbol_entity_specs_get_alias_to(member) == alias_to)
                 {
                     (*result) = member;
@@ -2097,6 +2637,7 @@ static int get_symbol(void *datum,
         }
     }
 
+    if (stub == NULL)
     {
         function_parameter_info_t function_parameter_info;
         memset(&function_parameter_info, 0, sizeof(function_parameter_info));
@@ -2124,7 +2665,11 @@ static int get_symbol(void *datum,
         }
     }
 
-    if (*result == NULL)
+    if (stub != NULL)
+    {
+        (*result) = stub;
+    }
+    else if (*result == NULL)
     {
         (*result) = NEW0(scope_entry_t);
     }
@@ -2133,7 +2678,7 @@ static int get_symbol(void *datum,
 
     (*result)->symbol_name = name;
     (*result)->kind = symbol_kind;
-    (*result)->locus = make_locus(filename, line, 0);
+    (*result)->locus = locus_get_id(make_locus(filename, line, 0));
 
     // static int level = 0;
     // {
@@ -2210,6 +2755,7 @@ static int get_symbol(void *datum,
     if ((*result)->kind == SK_MODULE)
     {
         rb_tree_insert(CURRENT_COMPILED_FILE->module_file_cache, strtolower((*result)->symbol_name), (*result));
+        note_loaded_module(*result);
 
         if (module_oid_being_loaded == oid)
         {
@@ -2218,8 +2764,9 @@ static int get_symbol(void *datum,
         }
     }
 
-    // Is this symbol in a module?
-    if (query_contains_field(ncols, names, "in_module", &i))
+    // Is this symbol in a module? A stub is already one of its members
+    if (stub == NULL
+            && query_contains_field(ncols, names, "in_module", &i))
     {
         // Get the module
         scope_entry_t* in_module = load_symbol(handle, safe_atoull(values[i]));
@@ -2248,6 +2795,41 @@ static int get_symbol(void *datum,
     return 0;
 }
 
+static int get_symbol_row_from_image(sqlite3_uint64 oid)
+{
+    int first_row = 0;
+    int num_rows = module_image_find_rows(_module_image, MIT_SYMBOL, oid, &first_row);
+    if (num_rows == 0)
+    {
+        internal_error("Symbol with oid %llu not found\n", oid);
+    }
+    else if (num_rows > 1)
+    {
+        internal_error("Too many results from query of symbol oid %llu\n", oid);
+    }
+
+    return first_row;
+}
+
+static scope_entry_t* load_symbol_from_image(sqlite3* handle, sqlite3_uint64 oid, scope_entry_t* stub)
+{
+    int row = get_symbol_row_from_image(oid);
+
+    int ncols = module_image_get_num_columns(_module_image, MIT_SYMBOL);
+    char* values[ncols + 1];
+    module_image_get_row(_module_image, MIT_SYMBOL, row, values);
+
+    symbol_handle_t symbol_handle;
+    memset(&symbol_handle, 0, sizeof(symbol_handle));
+    symbol_handle.handle = handle;
+    symbol_handle.stub = stub;
+
+    get_symbol(&symbol_handle, ncols, values,
+            module_image_get_column_names(_module_image, MIT_SYMBOL));
+
+    return symbol_handle.symbol;
+}
+
 static scope_entry_t* load_symbol(sqlite3* handle, sqlite3_uint64 oid)
 {
     if (oid == 0)
@@ -2257,10 +2839,17 @@ static scope_entry_t* load_symbol(sqlite3* handle, sqlite3_uint64 oid)
         scope_entry_t* ptr = (scope_entry_t*)get_ptr_of_oid(handle, oid);
         if (ptr != NULL)
         {
+            // Symbols reach the stubs they reference
+            materialize_module_symbol(ptr);
             return ptr;
         }
     }
 
+    if (_module_image != NULL)
+    {
+        return load_symbol_from_image(handle, oid, /* stub */ NULL);
+    }
+
     // Bind the oid parameter
     sqlite3_bind_int64(_load_symbol_stmt, 1, oid);
 
@@ -2337,6 +2926,151 @@ static scope_entry_t* load_symbol(sqlite3* handle, sqlite3_uint64 oid)
     return symbol_handle.symbol;
 }
 
+static int ptrcmp_vptr(const void* ptr1, const void* ptr2)
+{
+    if (ptr1 < ptr2)
+        return -1;
+    else if (ptr1 > ptr2)
+        return 1;
+    else
+        return 0;
+}
+
+static scope_entry_t* load_symbol_stub(sqlite3* handle, sqlite3_uint64 oid)
+{
+    if (oid == 0)
+        return NULL;
+
+    {
+        scope_entry_t* ptr = (scope_entry_t*)get_ptr_of_oid(handle, oid);
+        if (ptr != NULL)
+        {
+            return ptr;
+        }
+    }
+
+    int row = get_symbol_row_from_image(oid);
+
+    int ncols = module_image_get_num_columns(_module_image, MIT_SYMBOL);
+    char** names = module_image_get_column_names(_module_image, MIT_SYMBOL);
+    char* values[ncols + 1];
+    module_image_get_row(_module_image, MIT_SYMBOL, row, values);
+
+    // See get_symbol for the layout of the row
+    int symbol_kind = symbol_str_to_kind(values[3]);
+    ERROR_CONDITION(symbol_kind == SK_UNDEFINED, "Invalid symbol '%s' loaded from module\n", values[3]);
+
+    // Modules are always loaded
+    if (symbol_kind == SK_MODULE)
+        return load_symbol(handle, oid);
+
+    scope_entry_t* stub = NEW0(scope_entry_t);
+    insert_map_ptr(handle, oid, stub);
+
+    stub->symbol_name = uniquestr(values[2]);
+    stub->kind = symbol_kind;
+    stub->locus = locus_get_id(make_locus(uniquestr(values[5]), safe_atoi(values[6]), 0));
+
+    unpack_bits(stub, module_packed_bits_from_hexstr(values[8]));
+
+    // USE filters private members before materializing them
+    int i;
+    if (query_contains_field(ncols, names, "access", &i))
+    {
+        symbol_entity_specs_set_access(stub, (access_specifier_t)safe_atoi(values[i]));
+    }
+
+    if (_lazy_symbols == NULL)
+    {
+        _lazy_symbols = rb_tree_create(ptrcmp_vptr, null_dtor_func, null_dtor_func);
+    }
+
+    lazy_symbol_t* lazy_symbol = NEW(lazy_symbol_t);
+    lazy_symbol->oid = oid;
+    lazy_symbol->lazy_module = _current_lazy_module;
+    rb_tree_insert(_lazy_symbols, stub, lazy_symbol);
+
+    _current_lazy_module->num_entities++;
+
+    return stub;
+}
+
+void materialize_module_symbol(scope_entry_t* entry)
+{
+    if (_lazy_symbols == NULL
+            || entry == NULL)
+        return;
+
+    rb_red_blk_node* n = rb_tree_query(_lazy_symbols, entry);
+    if (n == NULL)
+        return;
+
+    lazy_symbol_t* lazy_symbol = (lazy_symbol_t*)rb_node_get_info(n);
+    rb_tree_delete(_lazy_symbols, n);
+
+    lazy_module_t* lazy_module = lazy_symbol->lazy_module;
+
+    // We may be loading or writing another module
+    module_image_t* saved_module_image = _module_image;
+    rb_red_blk_tree* saved_oid_map = _oid_map;
+    sqlite3_uint64 saved_module_oid_being_loaded = module_oid_being_loaded;
+    lazy_module_t* saved_current_lazy_module = _current_lazy_module;
+    int saved_num_loaded_modules = _num_loaded_modules;
+    scope_entry_t** saved_loaded_modules = _loaded_modules;
+
+    _module_image = lazy_module->image;
+    _oid_map = lazy_module->oid_map;
+    module_oid_being_loaded = 0;
+    _current_lazy_module = NULL;
+    _num_loaded_modules = 0;
+    _loaded_modules = NULL;
+
+    load_symbol_from_image(/* handle */ NULL, lazy_symbol->oid, entry);
+    lazy_module->num_materialized++;
+
+    if (lazy_module->cache_entry != NULL)
+    {
+        module_cache_entry_add_modules(lazy_module->cache_entry,
+                _num_loaded_modules, _loaded_modules);
+    }
+    DELETE(_loaded_modules);
+
+    _module_image = saved_module_image;
+    _oid_map = saved_oid_map;
+    module_oid_being_loaded = saved_module_oid_being_loaded;
+    _current_lazy_module = saved_current_lazy_module;
+    _num_loaded_modules = saved_num_loaded_modules;
+    _loaded_modules = saved_loaded_modules;
+
+    DELETE(lazy_symbol);
+}
+
+void fortran_modules_stats(void)
+{
+    fprintf(stderr, "Fortran modules loaded lazily: %d\n", _num_lazy_modules);
+
+    int total_entities = 0;
+    int total_materialized = 0;
+    int i;
+    for (i = 0; i < _num_lazy_modules; i++)
+    {
+        lazy_module_t* lazy_module = _lazy_modules[i];
+        fprintf(stderr, " - Module '%s' (%s): %d of %d entities materialized\n",
+                lazy_module->module->symbol_name,
+                lazy_module->filename,
+                lazy_module->num_materialized,
+                lazy_module->num_entities);
+
+        total_entities += lazy_module->num_entities;
+        total_materialized += lazy_module->num_materialized;
+    }
+
+    fprintf(stderr, "Entities materialized: %d of %d (%.2f%%)\n",
+            total_materialized,
+            total_entities,
+            total_entities == 0 ? 0.0 : (100.0 * total_materialized) / total_entities);
+}
+
 
 typedef
 struct scope_info_tag
@@ -2378,6 +3112,12 @@ static scope_t* load_scope(sqlite3* handle, sqlite3_uint64 oid)
     memset(&info, 0, sizeof(info));
     info.handle = handle;
 
+    if (_module_image != NULL)
+    {
+        run_image_query(MIT_SCOPE, oid, get_scope_, &info);
+        return info.scope;
+    }
+
     sqlite3_bind_int64(_select_scope_stmt, 1, oid);
     const char *errmsg = NULL;
 
@@ -2416,6 +3156,24 @@ static sqlite3_uint64 get_current_scope_oid_of_decl_context_oid(sqlite3* handle,
 
     sqlite3_uint64 result_oid = 0;
 
+    if (_module_image != NULL)
+    {
+        int first_row = 0;
+        if (module_image_find_rows(_module_image, MIT_DECL_CONTEXT, decl_context_oid, &first_row) != 0)
+        {
+            int column = 0;
+            if (!query_contains_field(
+                        module_image_get_num_columns(_module_image, MIT_DECL_CONTEXT),
+                        module_image_get_column_names(_module_image, MIT_DECL_CONTEXT),
+                        "current_scope", &column))
+            {
+                internal_error("Module image lacks column 'current_scope'\n", 0);
+            }
+            result_oid = safe_atoull(module_image_get_cell(_module_image, MIT_DECL_CONTEXT, first_row, column));
+        }
+        return result_oid;
+    }
+
     const char *errmsg = NULL;
     sqlite3_bind_int64(_get_current_scope_of_decl_context_stmt, 1, decl_context_oid);
     if (run_select_query_prepared(handle, _get_current_scope_of_decl_context_stmt,
@@ -2470,6 +3228,12 @@ static const decl_context_t* load_decl_context(sqlite3* handle, sqlite3_uint64 d
     decl_context_info.decl_context = NULL;
     decl_context_info.handle = handle;
 
+    if (_module_image != NULL)
+    {
+        run_image_query(MIT_DECL_CONTEXT, decl_context_oid, get_decl_context_, &decl_context_info);
+        return decl_context_info.decl_context;
+    }
+
     const char *errmsg = NULL;
     sqlite3_bind_int64(_select_decl_context_stmt, 1, decl_context_oid);
     if (run_select_query_prepared(handle, _select_decl_context_stmt, get_decl_context_, &decl_context_info, &errmsg) != SQLITE_OK)
@@ -2568,6 +3332,12 @@ static AST load_ast(sqlite3* handle, sqlite3_uint64 oid)
     memset(&query_handle, 0, sizeof(query_handle));
     query_handle.handle = handle;
 
+    if (_module_image != NULL)
+    {
+        run_image_query(MIT_AST, oid, get_ast, &query_handle);
+        return query_handle.a;
+    }
+
     const char *errmsg = NULL;
     sqlite3_bind_int64(_select_ast_stmt, 1, oid);
     if (run_select_query_prepared(handle, _select_ast_stmt, get_ast, &query_handle, &errmsg) != SQLITE_OK)
@@ -2869,6 +3639,12 @@ static type_t* load_type(sqlite3* handle, sqlite3_uint64 oid)
     memset(&type_handle, 0, sizeof(type_handle));
     type_handle.handle = handle;
 
+    if (_module_image != NULL)
+    {
+        run_image_query(MIT_TYPE, oid, get_type, &type_handle);
+        return type_handle.type;
+    }
+
     const char* errmsg = NULL;
     sqlite3_bind_int64(_select_type_stmt, 1, oid);
     if (run_select_query_prepared(handle, _select_type_stmt, get_type, &type_handle, &errmsg) != SQLITE_OK)
@@ -2988,6 +3764,101 @@ static sqlite3_uint64 insert_const_value(sqlite3* handle, const_value_t* value)
     return 0;
 }
 
+static const_value_t* make_multi_const_value(int multival_kind,
+        int num_elems,
+        const_value_t** list,
+        type_t* struct_type)
+{
+    const_value_t* result = NULL;
+
+    switch (multival_kind)
+    {
+        case CKT_ARRAY:
+            {
+                result = const_value_make_array(num_elems, list);
+                break;
+            }
+        case CKT_VECTOR:
+            {
+                result = const_value_make_vector(num_elems, list);
+                break;
+            }
+        case CKT_STRUCT:
+            {
+                result = const_value_make_struct(num_elems, list, struct_type);
+                break;
+            }
+        case CKT_COMPLEX:
+            {
+                ERROR_CONDITION(num_elems != 2, "Invalid complex constant!", 0);
+
+                result = const_value_make_complex(list[0], list[1]);
+                break;
+            }
+        case CKT_STRING:
+            {
+                result = const_value_make_string_from_values(num_elems, list);
+                break;
+            }
+        case CKT_RANGE:
+            {
+                ERROR_CONDITION(num_elems != 3, "Invalid range constant!", 0);
+
+                result = const_value_make_range(list[0], list[1], list[2]);
+                break;
+            }
+        default:
+            {
+                internal_error("Code unreachable", 0);
+            }
+    }
+
+    return result;
+}
+
+static const_value_t* load_const_value_from_image(sqlite3* handle, sqlite3_uint64 oid)
+{
+    int row = 0;
+    if (module_image_find_rows(_module_image, MIT_CONST_VALUE, oid, &row) != 1)
+    {
+        internal_error("Unexpected query result", 0);
+    }
+
+    // kind, raw_oid, struct_type
+    const char* raw_oid = (const char*)module_image_get_cell(_module_image, MIT_CONST_VALUE, row, 1);
+    // Single values have a raw_oid
+    if (raw_oid != NULL)
+    {
+        int raw_row = 0;
+        if (module_image_find_rows(_module_image, MIT_RAW_CONST_VALUE, safe_atoull(raw_oid), &raw_row) != 1)
+        {
+            internal_error("Unexpected query result", 0);
+        }
+
+        return const_value_build_from_raw_data(
+                (const char*)module_image_get_cell(_module_image, MIT_RAW_CONST_VALUE, raw_row, 0));
+    }
+
+    // Multi values do not have raw_oid
+    int multival_kind = safe_atoi((const char*)module_image_get_cell(_module_image, MIT_CONST_VALUE, row, 0));
+    type_t* struct_type = load_type(handle,
+            safe_atoull((const char*)module_image_get_cell(_module_image, MIT_CONST_VALUE, row, 2)));
+
+    int first_part = 0;
+    int num_elems = module_image_find_rows(_module_image, MIT_MULTI_CONST_VALUE, oid, &first_part);
+
+    const_value_t* list[num_elems + 1];
+    int i;
+    for (i = 0; i < num_elems; i++)
+    {
+        list[i] = load_const_value(handle,
+                safe_atoull((const char*)module_image_get_cell(_module_image,
+                        MIT_MULTI_CONST_VALUE, first_part + i, 0)));
+    }
+
+    return make_multi_const_value(multival_kind, num_elems, list, struct_type);
+}
+
 static const_value_t* load_const_value(sqlite3* handle, sqlite3_uint64 oid)
 {
     void *p = get_ptr_of_oid(handle, oid);
@@ -2998,6 +3869,13 @@ static const_value_t* load_const_value(sqlite3* handle, sqlite3_uint64 oid)
 
     const_value_t* result = NULL;
 
+    if (_module_image != NULL)
+    {
+        result = load_const_value_from_image(handle, oid);
+        insert_map_ptr(handle, oid, result);
+        return result;
+    }
+
     sqlite3_bind_int64(_select_const_value_stmt, 1, oid);
 
     int result_query = sqlite3_step(_select_const_value_stmt);
@@ -3088,47 +3966,7 @@ static const_value_t* load_const_value(sqlite3* handle, sqlite3_uint64 oid)
             }
 
             // Finally build the multi const value
-            switch (multival_kind)
-            {
-                case CKT_ARRAY:
-                    {
-                        result = const_value_make_array(num_elems, list);
-                        break;
-                    }
-                case CKT_VECTOR:
-                    {
-                        result = const_value_make_vector(num_elems, list);
-                        break;
-                    }
-                case CKT_STRUCT:
-                    {
-                        result = const_value_make_struct(num_elems, list, struct_type);
-                        break;
-                    }
-                case CKT_COMPLEX:
-                    {
-                        ERROR_CONDITION(num_elems != 2, "Invalid complex constant!", 0);
-
-                        result = const_value_make_complex(list[0], list[1]);
-                        break;
-                    }
-                case CKT_STRING:
-                    {
-                        result = const_value_make_string_from_values(num_elems, list);
-                        break;
-                    }
-                case CKT_RANGE:
-                    {
-                        ERROR_CONDITION(num_elems != 3, "Invalid range constant!", 0);
-
-                        result = const_value_make_range(list[0], list[1], list[2]);
-                        break;
-                    }
-                default:
-                    {
-                        internal_error("Code unreachable", 0);
-                    }
-            }
+            result = make_multi_const_value(multival_kind, num_elems, list, struct_type);
         }
         else
         {
@@ -3145,7 +3983,7 @@ static const_value_t* load_const_value(sqlite3* handle, sqlite3_uint64 oid)
     return result;
 }
 
-static void dispose_storage(sqlite3* handle)
+static void finalize_statements(void)
 {
     int i;
     for (i = 0; _prepared_statements_registry[i] != NULL; i++)
@@ -3153,6 +3991,11 @@ static void dispose_storage(sqlite3* handle)
         sqlite3_finalize(*(_prepared_statements_registry[i]));
         *(_prepared_statements_registry[i]) = NULL;
     }
+}
+
+static void dispose_storage(sqlite3* handle)
+{
+    finalize_statements();
 
     if (sqlite3_close(handle) != SQLITE_OK)
     {
@@ -3238,6 +4081,18 @@ struct get_module_extra_name_tag
     scope_entry_t* module;
 };
 
+static void add_module_extra_data(scope_entry_t* module, fortran_modules_data_t* module_data)
+{
+    fortran_modules_data_set_t* extra_info_attr = symbol_entity_specs_get_module_extra_info(module);
+    if (extra_info_attr == NULL)
+    {
+        extra_info_attr = NEW0(fortran_modules_data_set_t);
+        symbol_entity_specs_set_module_extra_info(module, extra_info_attr);
+    }
+
+    P_LIST_ADD(extra_info_attr->data, extra_info_attr->num_data, module_data);
+}
+
 static int count_module_extra_name(void *data, 
         int num_columns UNUSED_PARAMETER, 
         char **values, 
@@ -3255,6 +4110,31 @@ static int get_module_extra_name(void *data,
 {
     struct get_module_extra_name_tag* p = (struct get_module_extra_name_tag*)data;
 
+    if (_module_image != NULL)
+    {
+        int first_row = 0;
+        int num_items = module_image_find_rows(_module_image, MIT_MODULE_EXTRA_DATA,
+                safe_atoull(values[0]), &first_row);
+        if (num_items == 0)
+            return 0;
+
+        fortran_modules_data_t *module_data = NEW0(fortran_modules_data_t);
+        module_data->name = uniquestr(values[1]);
+        module_data->num_items = num_items;
+        module_data->items = NEW_VEC0(tl_type_t, num_items);
+
+        struct get_module_extra_data_tag extra_data;
+
+        extra_data.handle = p->handle;
+        extra_data.current_item = module_data->items;
+
+        run_image_query(MIT_MODULE_EXTRA_DATA, safe_atoull(values[0]), get_module_extra_data, &extra_data);
+
+        add_module_extra_data(p->module, module_data);
+
+        return 0;
+    }
+
     char* count_query = sqlite3_mprintf(
             "SELECT COUNT(*) FROM module_extra_data WHERE oid_name = %llu;",
             safe_atoull(values[0]));
@@ -3291,14 +4171,7 @@ static int get_module_extra_name(void *data,
 
     sqlite3_free(query);
 
-    fortran_modules_data_set_t* extra_info_attr = symbol_entity_specs_get_module_extra_info(p->module);
-    if (extra_info_attr == NULL)
-    {
-        extra_info_attr = NEW0(fortran_modules_data_set_t);
-        symbol_entity_specs_set_module_extra_info(p->module, extra_info_attr);
-    }
-
-    P_LIST_ADD(extra_info_attr->data, extra_info_attr->num_data, module_data);
+    add_module_extra_data(p->module, module_data);
 
     return 0;
 }
@@ -3310,6 +4183,12 @@ static void load_extra_data_from_module(sqlite3* handle, scope_entry_t* module)
     module_extra_name.handle = handle;
     module_extra_name.module = module;
 
+    if (_module_image != NULL)
+    {
+        run_image_query(MIT_MODULE_EXTRA_NAME, 0, get_module_extra_name, &module_extra_name);
+        return;
+    }
+
     char* errmsg = NULL;
     if (run_select_query(handle, "SELECT oid, name FROM module_extra_name", get_module_extra_name, &module_extra_name, &errmsg) != SQLITE_OK)
     {
@@ -3328,7 +4207,28 @@ void extend_module_info(scope_entry_t* module, const char* domain, int num_items
 
     driver_fortran_register_module(module_name, &filename, 
             /* is_intrinsic */ symbol_entity_specs_get_is_builtin(module));
-    load_storage(&handle, filename);
+
+    // Module images written by the file being compiled are written again
+    // from the database they were written from. Modules written by older
+    // versions of Mercurium are extended in place
+    char is_image = 0;
+    handle = get_module_database(filename);
+    if (handle != NULL)
+    {
+        is_image = 1;
+        _oid_map = rb_tree_create(int64cmp_vptr, null_dtor_func, null_dtor_func);
+    }
+    else
+    {
+        module_image_t* image = module_image_open(filename);
+        if (image != NULL)
+        {
+            module_image_close(image);
+            fatal_error("Module '%s' cannot be extended because it was not written by this file\n",
+                    filename);
+        }
+        load_storage(&handle, filename);
+    }
 
     prepare_statements(handle);
 
@@ -3423,7 +4323,18 @@ void extend_module_info(scope_entry_t* module, const char* domain, int num_items
 
     end_transaction(handle);
 
-    dispose_storage(handle);
+    if (is_image)
+    {
+        write_module_image(handle, filename);
+        finalize_statements();
+    }
+    else
+    {
+        dispose_storage(handle);
+    }
+
+    // Files using this module from now on must see the new data
+    module_cache_invalidate(filename);
 }
 
 scope_entry_t* get_module_in_cache(const char* module_name)
@@ -37,9 +37,19 @@ void load_module_info(const char* module_name, scope_entry_t** module);
 
 scope_entry_t* get_module_in_cache(const char* module_name);
 
+// Members of modules loaded from module images are stubs until they are
+// referenced. This loads the whole symbol, it does nothing for other symbols
+void materialize_module_symbol(scope_entry_t* entry);
+
+void fortran_modules_stats(void);
+
 // This is used in TL
 void extend_module_info(scope_entry_t* module, const char* domain, int num_items, tl_type_t* info);
 
+// Closes the databases of the modules written by the file being compiled.
+// After this they cannot be extended anymore
+void fortran_close_module_databases(void);
+
 MCXX_END_DECLS
 
 #endif // FORTRAN03_MODULES_H
@@ -5216,3 +5216,139 @@ extern int new_mf03lex(void)
     }
     internal_error("Code unreachable", 0);
 }
+
+// Module dependences
+//
+// Only the first tokens of each statement are needed to find MODULE, USE and
+// SUBMODULE statements
+enum {
+    MAX_DEPENDENCE_TOKENS_PER_STMT = 8,
+};
+
+typedef
+struct dependence_token_tag
+{
+    int token_id;
+    const char* text;
+} dependence_token_t;
+
+static char is_name_token(dependence_token_t* token)
+{
+    return token->text != NULL
+        && is_letter(token->text[0]);
+}
+
+static void scan_module_dependences_statement(
+        int num_tokens,
+        dependence_token_t* tokens,
+        int *num_provided_modules,
+        const char*** provided_modules,
+        int *num_required_modules,
+        const char*** required_modules)
+{
+    int i = 0;
+    // Skip the label
+    if (i < num_tokens
+            && tokens[i].token_id == DECIMAL_LITERAL)
+        i++;
+
+    if (i >= num_tokens)
+        return;
+
+    if (tokens[i].token_id == TOKEN_MODULE)
+    {
+        // MODULE name [, INTRINSIC]
+        // but not MODULE PROCEDURE name or MODULE SUBROUTINE name
+        if (i + 1 < num_tokens
+                && is_name_token(&tokens[i + 1])
+                && (i + 2 == num_tokens
+                    || tokens[i + 2].token_id == ','))
+        {
+            P_LIST_ADD_ONCE(*provided_modules, *num_provided_modules,
+                    strtolower(tokens[i + 1].text));
+        }
+    }
+    else if (tokens[i].token_id == TOKEN_USE)
+    {
+        // USE [[, module-nature] ::] name
+        i++;
+        if (i + 1 < num_tokens
+                && tokens[i].token_id == ',')
+        {
+            if (strcasecmp(tokens[i + 1].text, "intrinsic") == 0)
+                return;
+            i += 2;
+        }
+        if (i + 1 < num_tokens
+                && tokens[i].token_id == ':'
+                && tokens[i + 1].token_id == ':')
+        {
+            i += 2;
+        }
+
+        if (i < num_tokens
+                && is_name_token(&tokens[i]))
+        {
+            P_LIST_ADD_ONCE(*required_modules, *num_required_modules,
+                    strtolower(tokens[i].text));
+        }
+    }
+    else if (tokens[i].token_id == TOKEN_SUBMODULE)
+    {
+        // SUBMODULE (ancestor[:parent]) name
+        if (i + 2 < num_tokens
+                && tokens[i + 1].token_id == '('
+                && is_name_token(&tokens[i + 2]))
+        {
+            P_LIST_ADD_ONCE(*required_modules, *num_required_modules,
+                    strtolower(tokens[i + 2].text));
+        }
+    }
+}
+
+extern void mf03_scan_module_dependences(const char* scanned_filename,
+        const char* input_filename,
+        char is_fixed_form,
+        int *num_provided_modules,
+        const char*** provided_modules,
+        int *num_required_modules,
+        const char*** required_modules)
+{
+    *num_provided_modules = 0;
+    *provided_modules = NULL;
+    *num_required_modules = 0;
+    *required_modules = NULL;
+
+    new_mf03_open_file_for_scanning(scanned_filename, input_filename, is_fixed_form);
+
+    dependence_token_t tokens[MAX_DEPENDENCE_TOKENS_PER_STMT];
+    int num_tokens = 0;
+
+    int token_id;
+    while ((token_id = new_mf03lex()) != 0)
+    {
+        if (token_id == EOS)
+        {
+            scan_module_dependences_statement(num_tokens, tokens,
+                    num_provided_modules, provided_modules,
+                    num_required_modules, required_modules);
+            num_tokens = 0;
+        }
+        else if (num_tokens < MAX_DEPENDENCE_TOKENS_PER_STMT)
+        {
+            tokens[num_tokens].token_id = token_id;
+            tokens[num_tokens].text = mf03lval.token_atrib.token_text;
+            num_tokens++;
+        }
+    }
+    scan_module_dependences_statement(num_tokens, tokens,
+            num_provided_modules, provided_modules,
+            num_required_modules, required_modules);
+
+    // Modules used by the same file that defines them are not dependences
+    int i;
+    for (i = 0; i < *num_provided_modules; i++)
+    {
+        P_LIST_REMOVE(*required_modules, *num_required_modules, (*provided_modules)[i]);
+    }
+}
@@ -34,6 +34,7 @@
 #include "fortran03-buildscope.h"
 #include "fortran03-typeutils.h"
 #include "fortran03-intrinsics.h"
+#include "fortran03-modules.h"
 #include <string.h>
 #include <ctype.h>
 
@@ -205,7 +206,7 @@ static scope_entry_t* new_implicit_symbol(const decl_context_t* decl_context, AS
         
         if (location != NULL)
         {
-            sym->locus = ast_get_locus(location);
+            sym->locus = locus_get_id(ast_get_locus(location));
         }
 
         return sym;
@@ -378,7 +379,7 @@ static void diagnostic_ambiguity(scope_entry_list_t* entry_list)
             entry_list_iterator_next(it))
     {
         scope_entry_t* entry = entry_list_iterator_current(it);
-        info_printf_at(entry->locus, "name '%s' first bound here\n", entry->symbol_name);
+        info_printf_at(locus_from_id(entry->locus), "name '%s' first bound here\n", entry->symbol_name);
     }
     entry_list_iterator_free(it);
 }
@@ -708,6 +709,7 @@ scope_entry_list_t* fortran_query_module_for_name(scope_entry_t* module_symbol,
                 // Filter private symbols
                 && symbol_entity_specs_get_access(sym) != AS_PRIVATE)
         {
+            materialize_module_symbol(sym);
             result = entry_list_add_once(result, sym);
         }
     }
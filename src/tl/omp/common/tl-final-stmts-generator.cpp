@@ -115,7 +115,7 @@ namespace TL {
                    return;
                 }
 
-                Nodecl::NodeclBase function_code = called_sym.get_function_code();
+                Nodecl::NodeclBase function_code = called_sym.get_function_code_instantiating();
 
                 // If the called symbol has not been defined, skip it!
                 if (function_code.is_null())
@@ -249,7 +249,7 @@ namespace TL {
                    return;
                 }
 
-                Nodecl::NodeclBase function_code = called_sym.get_function_code();
+                Nodecl::NodeclBase function_code = called_sym.get_function_code_instantiating();
                 if (!function_code.is_null())
                 {
                    const std::map<TL::Symbol, TL::Symbol>* map =
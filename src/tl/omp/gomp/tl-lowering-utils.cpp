@@ -153,7 +153,7 @@ TL::Type GOMP::create_outline_struct(
                 ::get_user_defined_type(new_class_symbol.get_internal_symbol()));
         symbol_entity_specs_set_access(field.get_internal_symbol(), AS_PUBLIC);
 
-        field.get_internal_symbol()->locus = locus;
+        field.get_internal_symbol()->locus = locus_get_id(locus);
 
         class_type_add_member(new_class_type,
                 field.get_internal_symbol(),
@@ -233,7 +233,7 @@ TL::Type GOMP::create_outline_struct_task(
                 ::get_user_defined_type(new_class_symbol.get_internal_symbol()));
         symbol_entity_specs_set_access(field.get_internal_symbol(), AS_PUBLIC);
 
-        field.get_internal_symbol()->locus = locus;
+        field.get_internal_symbol()->locus = locus_get_id(locus);
 
         class_type_add_member(new_class_type,
                 field.get_internal_symbol(),
@@ -81,7 +81,7 @@ TL::Symbol Intel::new_global_ident_symbol(Nodecl::NodeclBase location)
     symbol_entity_specs_set_is_user_declared(new_ident_sym, 1);
     new_ident_sym->defined = 1;
     symbol_entity_specs_set_is_static(new_ident_sym, 1);
-    new_ident_sym->locus = make_locus(filename.c_str(), start_line, /* col */ 0);
+    new_ident_sym->locus = locus_get_id(make_locus(filename.c_str(), start_line, /* col */ 0));
 
     Source string_literal;
     string_literal << "\"" << filename << ";" << start_line << ";" << end_line << "\"";
@@ -104,9 +104,9 @@ TL::Symbol Intel::new_global_ident_symbol(Nodecl::NodeclBase location)
                     const_value_get_zero(/* bytes */ 4, /* sign */1)),
                 /* psource */
                 string_literal_tree),
-            Nodecl::StructuredValueBracedImplicit::make(new_ident_sym->locus),
+            Nodecl::StructuredValueBracedImplicit::make(locus_from_id(new_ident_sym->locus)),
             ident_t_type,
-            new_ident_sym->locus);
+            locus_from_id(new_ident_sym->locus));
 
     new_ident_sym->value = value.get_internal_nodecl();
 
@@ -180,7 +180,7 @@ TL::Symbol Intel::get_global_lock_symbol(Nodecl::NodeclBase location, const std:
         new_ident_sym->type_information = kmp_critical_name_type.get_internal_type();
         symbol_entity_specs_set_is_user_declared(new_ident_sym, 1);
         new_ident_sym->defined = 1;
-        new_ident_sym->locus = location.get_locus();
+        new_ident_sym->locus = locus_get_id(location.get_locus());
 
         gcc_attribute_t common_gcc_attr = { "common", nodecl_null() };
 
@@ -195,9 +195,9 @@ TL::Symbol Intel::get_global_lock_symbol(Nodecl::NodeclBase location, const std:
                         kmp_int32_type,
                         const_value_get_zero(/* bytes */ 4, /* sign */1))
                     ),
-                Nodecl::StructuredValueBracedImplicit::make(new_ident_sym->locus),
+                Nodecl::StructuredValueBracedImplicit::make(locus_from_id(new_ident_sym->locus)),
                 kmp_critical_name_type,
-                new_ident_sym->locus);
+                locus_from_id(new_ident_sym->locus));
         new_ident_sym->value = value.get_internal_nodecl();
 
         result = new_ident_sym;
@@ -950,7 +950,7 @@ namespace TL { namespace Nanos6 {
         symbol_entity_specs_set_is_user_declared(field.get_internal_symbol(), 1);
 
         field.set_type( field_type );
-        field.get_internal_symbol()->locus = var_locus;
+        field.get_internal_symbol()->locus = locus_get_id(var_locus);
 
         symbol_entity_specs_set_is_member(field.get_internal_symbol(), 1);
         symbol_entity_specs_set_class_type(field.get_internal_symbol(),
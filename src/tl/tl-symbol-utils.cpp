@@ -77,7 +77,7 @@ namespace
             scope_entry_t* param = new_symbol(function_context, function_context->current_scope, uniquestr(it->c_str()));
             symbol_entity_specs_set_is_user_declared(param, 1);
             param->kind = SK_VARIABLE;
-            param->locus = make_locus("", 0, 0);
+            param->locus = locus_get_id(make_locus("", 0, 0));
 
             param->defined = 1;
 
@@ -111,7 +111,7 @@ namespace
             new_function_sym = new_symbol(decl_context, decl_context->current_scope, uniquestr(function_name.c_str()));
             symbol_entity_specs_set_is_user_declared(new_function_sym, 1);
             new_function_sym->kind = SK_FUNCTION;
-            new_function_sym->locus = make_locus("", 0, 0);
+            new_function_sym->locus = locus_get_id(make_locus("", 0, 0));
             new_function_sym->type_information = function_type;
         }
         else
@@ -119,7 +119,7 @@ namespace
             scope_entry_t* new_template_sym = new_symbol(
                     decl_context, decl_context->current_scope, uniquestr(function_name.c_str()));
             new_template_sym->kind = SK_TEMPLATE;
-            new_template_sym->locus = make_locus("", 0, 0);
+            new_template_sym->locus = locus_get_id(make_locus("", 0, 0));
 
             new_template_sym->type_information = get_new_template_type(
                     decl_context->template_parameters,
@@ -31,6 +31,7 @@
 #include "tl-scope.hpp"
 #include "tl-type.hpp"
 #include "tl-nodecl.hpp"
+#include "cxx-instantiation.h"
 
 namespace TL
 {
@@ -740,22 +741,22 @@ namespace TL
 
     const locus_t* Symbol::get_locus() const
     {
-        return _symbol->locus;
+        return locus_from_id(_symbol->locus);
     }
 
     std::string Symbol::get_locus_str() const
     {
-        return locus_to_str(_symbol->locus);
+        return locus_to_str(locus_from_id(_symbol->locus));
     }
 
     std::string Symbol::get_filename() const
     {
-        return locus_get_filename(_symbol->locus);
+        return locus_get_filename(locus_from_id(_symbol->locus));
     }
 
     unsigned int Symbol::get_line() const
     {
-        return locus_get_line(_symbol->locus);
+        return locus_get_line(locus_from_id(_symbol->locus));
     }
 
     bool Symbol::is_fortran_common() const
@@ -1040,6 +1041,11 @@ namespace TL
         return symbol_entity_specs_get_function_code(_symbol);
     }
 
+    Nodecl::NodeclBase Symbol::get_function_code_instantiating() const
+    {
+        return instantiation_get_function_code(_symbol, locus_from_id(_symbol->locus));
+    }
+
     bool Symbol::is_bind_c() const
     {
         Nodecl::NodeclBase n( symbol_entity_specs_get_bind_info(_symbol) );
@@ -743,6 +743,12 @@ namespace TL
              */
             Nodecl::NodeclBase get_default_argument_num(int i) const;
             Nodecl::NodeclBase get_function_code() const;
+            /*!
+             * Like get_function_code but instantiates the body first if this
+             * is a function template specialization or a member function of
+             * a class template specialization whose body was not needed yet
+             */
+            Nodecl::NodeclBase get_function_code_instantiating() const;
 
             //! States whether this symbol is BIND(C)
             bool is_bind_c() const;
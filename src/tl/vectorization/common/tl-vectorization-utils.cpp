@@ -767,7 +767,7 @@ namespace Utils
                 get_qualified_vector_to(orig_field_type,
                                         vec_isa_desc.get_vec_factor_for_type(
                                             orig_field_type, vec_factor)));
-            field.get_internal_symbol()->locus = it->get_locus();
+            field.get_internal_symbol()->locus = locus_get_id(it->get_locus());
             symbol_entity_specs_set_access(field.get_internal_symbol(),
                     symbol_entity_specs_get_access(it->get_internal_symbol()));
 
@@ -0,0 +1,21 @@
+! <testinfo>
+! test_generator=config/mercurium-fortran
+! compile_versions="serial parallel eager"
+! test_FFLAGS="${srcdir}/success_modules_jobs_01_mod.f03 ${srcdir}/success_modules_jobs_01_sub.f03"
+! test_FFLAGS_parallel="-j2"
+! test_FFLAGS_eager="-j2 --debug-flags=eager_module_loading"
+! </testinfo>
+!
+! The module is defined by the first companion file and used by the second
+! one and by this file, so files compiled by the same invocation share it
+
+PROGRAM JOBS_MAIN
+  USE MOD_JOBS_01
+  IMPLICIT NONE
+  TYPE(JOBS_T) :: A
+
+  A % V = 1
+  CALL JOBS_SUB(A)
+  IF (A % V /= 2) STOP 1
+  IF (JOBS_TWICE(A % V) /= 4) STOP 2
+END PROGRAM JOBS_MAIN
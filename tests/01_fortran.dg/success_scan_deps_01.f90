@@ -0,0 +1,23 @@
+! <testinfo>
+! test_generator=config/mercurium-fortran
+! compile_versions="make json file"
+! test_FFLAGS="${srcdir}/success_scan_deps_01_c.f03 ${srcdir}/success_scan_deps_01_b.f03 ${srcdir}/success_scan_deps_01_a.f03"
+! test_FFLAGS_make="--scan-deps"
+! test_FFLAGS_json="--scan-deps=json"
+! test_FFLAGS_file="--scan-deps=make -o success_scan_deps_01.d"
+! test_compile_check_make="sed -n -e 's|${srcdir}/||g' -e '/^# \|\.o: /p' \${compile_output} | diff -u ${srcdir}/success_scan_deps_01.make -"
+! test_compile_check_json="sed -n -e 's|${srcdir}/||g' -e '/^{$/,/^}$/p' \${compile_output} | diff -u ${srcdir}/success_scan_deps_01.json -"
+! test_compile_check_file="sed -e 's|${srcdir}/||g' success_scan_deps_01.d | diff -u ${srcdir}/success_scan_deps_01.make - && rm success_scan_deps_01.d"
+! </testinfo>
+!
+! USE chain MOD_SCAN_C -> MOD_SCAN_B -> MOD_SCAN_A, with the files given
+! in the opposite order. Nothing is compiled, so the modules need not exist.
+! The graph printed is compared, without the source directory, against
+! success_scan_deps_01.make and success_scan_deps_01.json
+
+PROGRAM SCAN_MAIN
+  USE MOD_SCAN_C
+  IMPLICIT NONE
+
+  PRINT *, SCAN_C()
+END PROGRAM SCAN_MAIN
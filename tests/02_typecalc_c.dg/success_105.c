@@ -0,0 +1,19 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+compile_versions="serial parallel"
+test_CFLAGS="${srcdir}/success_105_a.i ${srcdir}/success_105_b.i"
+test_CFLAGS_parallel="-j3"
+test_compile_check="sed -n -e 's|^.*/\([^/]*:[0-9]*\):[0-9]*: warning: .*$|\1|p' \${compile_output} | diff -u ${srcdir}/success_105.warnings - && rm success_105_a.o success_105_b.o success_105.o"
+</testinfo>
+*/
+
+// Each file warns about an implicit declaration. The warnings must be
+// printed in command line order and every object must be written, with
+// or without -j. The check removes the objects so that every version has
+// to write its own
+
+int f(void)
+{
+    return undeclared_main(3);
+}
@@ -0,0 +1,4 @@
+int g_a(void)
+{
+    return undeclared_a(1);
+}
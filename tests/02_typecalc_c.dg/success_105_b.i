@@ -0,0 +1,4 @@
+int g_b(void)
+{
+    return undeclared_b(2);
+}
@@ -0,0 +1,18 @@
+/*
+<testinfo>
+test_generator=config/mercurium-fe-only
+test_compile_fail=yes
+</testinfo>
+*/
+
+// The declaration interpretation of 'A(b);' is chosen and its error
+// must be reported
+struct A
+{
+    A(int, int);
+};
+
+void f(int x)
+{
+    A(b);
+}
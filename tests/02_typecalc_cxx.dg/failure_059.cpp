@@ -0,0 +1,24 @@
+/*
+<testinfo>
+test_generator=config/mercurium-fe-only
+test_compile_fail=yes
+</testinfo>
+*/
+
+// 'A(y)' is ambiguous inside an ambiguous init declarator which is checked
+// more than once. There is no constructor C(A, int)
+struct A
+{
+    A(int);
+};
+
+struct C
+{
+    C(A);
+};
+
+void f()
+{
+    int y = 0;
+    C c(A(y), 1);
+}
@@ -0,0 +1,57 @@
+/*
+<testinfo>
+test_generator="config/mercurium"
+</testinfo>
+*/
+
+// Ambiguities nested inside ambiguities. Every level is checked once per
+// interpretation of the enclosing one, so the verdicts of the inner ones
+// are reused and must stay right
+struct A
+{
+    A(int);
+    A(int, int);
+};
+
+struct B
+{
+    B(A);
+    B(A, A);
+};
+
+struct C
+{
+    C(B);
+    C(B, B);
+};
+
+struct D
+{
+    D(C);
+    D(C, C);
+};
+
+int x, y;
+
+void f()
+{
+    // Declarations of objects initialized by function-style casts
+    D d1(C(B(A(x))));
+    D d2(C(B(A(x), A(y))), C(B(A(x, y))));
+    D d3 = D(C(B(A(x))));
+
+    // Expression statements
+    D(C(B(A(x), A(y))), C(B(A(y))));
+    D(C(B(A(x), A(y))), C(B(A(y), A(1))));
+}
+
+void g()
+{
+    // A declaration of a variable 'x' of type A and of functions
+    A(x) = 1;
+    D h(C(B(A)));
+    D k(C(B(A(y))), int);
+    // Redeclarations with parameter names are fine
+    D h(C c(B(A)));
+    D k(C(B(A(x))), int n);
+}
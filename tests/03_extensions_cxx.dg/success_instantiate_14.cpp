@@ -0,0 +1,68 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+/*
+<testinfo>
+test_generator=config/mercurium-cxx11
+test_CXXFLAGS="--instantiate-only-used -y -o -"
+test_compile_check="grep -q 'int used_marker' \${compile_output} && grep -c 'int unused_marker' \${compile_output} | grep -qx 0"
+</testinfo>
+*/
+
+// unused<int> is only called by the expression interpretation of the
+// ambiguous declaration of 'a', which is discarded in favour of the
+// function declaration, so it must not be instantiated
+
+template <typename T = int>
+T used()
+{
+    T used_marker = 1;
+    return used_marker;
+}
+
+template <typename T = int>
+T unused()
+{
+    T unused_marker = 2;
+    return unused_marker;
+}
+
+struct B
+{
+    B(int);
+};
+
+struct A
+{
+    A(B);
+};
+
+int main()
+{
+    A a(B(unused()));
+    return used();
+}